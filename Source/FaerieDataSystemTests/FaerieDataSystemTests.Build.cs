@@ -23,7 +23,9 @@ public class FaerieDataSystemTests : ModuleRules
             {
                 "CoreUObject",
                 "Engine",
-                "GameplayTags"
+                "GameplayTags",
+                "FaerieInventoryContent",
+                "FaerieItemGenerator"
             }
         );
     }
@@ -3,10 +3,17 @@
 #if WITH_DEV_AUTOMATION_TESTS
 
 #include "Misc/AutomationTest.h"
+#include "BasicItemDataFilters.h"
 #include "FaerieContainerFilter.h"
+#include "FaerieContainerFilterTypes.h"
 #include "FaerieItemStorage.h"
+#include "FaerieFilterTestTypes.h"
+#include "FaerieItemDataFilterProgram.h"
 #include "FaerieItemStorageIterators.h"
+#include "FaerieTestUtils.h"
+#include "Tokens/FaerieGuidToken.h"
 #include "Tokens/FaerieInfoToken.h"
+#include "Tokens/FaerieTagToken.h"
 
 IMPLEMENT_SIMPLE_AUTOMATION_TEST(FaerieContainerFilterTests, "FDS.FaerieContainerFilterTests", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
 
@@ -117,4 +124,265 @@ bool FaerieContainerFilterTests::RunTest(const FString& Parameters)
 	return true;
 }
 
-#endif
\ No newline at end of file
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FaerieTokenIndexTests, "FDS.FaerieContainerFilterTests.TokenIndex", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FaerieTokenIndexTests::RunTest(const FString& Parameters)
+{
+	UFaerieItemToken* TagToken = UFaerieTagToken::CreateInstance(FGameplayTagContainer());
+
+	UFaerieItemStorage* Storage = NewObject<UFaerieItemStorage>();
+
+	// Add a few entries before the index exists, and the rest after, so both building and updating it are tested.
+	const int32 NumItems = 8;
+	const int32 NumTagged = NumItems / 2;
+	for (int32 i = 0; i < NumItems; ++i)
+	{
+		if (i == NumItems / 2)
+		{
+			Storage->SetTokenIndexEnabled(true);
+		}
+
+		UFaerieItem* Item = UFaerieItem::CreateNewInstance({}, EFaerieItemInstancingMutability::Mutable);
+		if (i % 2 == 0)
+		{
+			Item->AddToken(TagToken);
+		}
+
+		Storage->AddEntryFromItemObject(Item, EFaerieStorageAddStackBehavior::OnlyNewStacks);
+	}
+
+	auto FindTagged = [Storage]
+		{
+			Faerie::Storage::FItemFilter_Key KeyFilter(Storage);
+			KeyFilter.Run(Faerie::Container::FTokenClassFilter(UFaerieTagToken::StaticClass()));
+			return KeyFilter.EmitKeys();
+		};
+
+	TestEqual("(Indexed) Tagged entries", FindTagged().Num(), NumTagged);
+
+	Storage->SetTokenIndexEnabled(false);
+	TestEqual("(Unindexed) Tagged entries", FindTagged().Num(), NumTagged);
+	Storage->SetTokenIndexEnabled(true);
+
+	// Removing an entry should shift the columns along with the entries.
+	Storage->RemoveEntry(FindTagged()[0], Faerie::Inventory::Tags::RemovalDeletion);
+	TestEqual("(Indexed) Tagged entries after removal", FindTagged().Num(), NumTagged - 1);
+
+	// Removals are compacted on the next query, so remove and add several entries between queries.
+	const TArray<FEntryKey> ToRemove = FindTagged();
+	Storage->RemoveEntry(ToRemove[0], Faerie::Inventory::Tags::RemovalDeletion);
+	Storage->RemoveEntry(ToRemove.Last(), Faerie::Inventory::Tags::RemovalDeletion);
+	for (int32 i = 0; i < 3; ++i)
+	{
+		UFaerieItem* Item = UFaerieItem::CreateNewInstance({}, EFaerieItemInstancingMutability::Mutable);
+		Item->AddToken(TagToken);
+		Storage->AddEntryFromItemObject(Item, EFaerieStorageAddStackBehavior::OnlyNewStacks);
+	}
+	TestEqual("(Indexed) Tagged entries after several edits", FindTagged().Num(), NumTagged);
+
+	// The index and the per-item path must agree for every class, including ones the index has no column for.
+	auto FindWithToken = [Storage](const TSubclassOf<UFaerieItemToken> TokenClass)
+		{
+			Faerie::Storage::FItemFilter_Key KeyFilter(Storage);
+			KeyFilter.Run(Faerie::Container::FTokenClassFilter(TokenClass));
+			return KeyFilter.EmitKeys();
+		};
+
+	for (const UClass* TokenClass : { UFaerieTagToken::StaticClass(), UFaerieGuidToken::StaticClass(), UFaerieItemToken::StaticClass() })
+	{
+		Storage->SetTokenIndexEnabled(true);
+		const TArray<FEntryKey> Indexed = FindWithToken(const_cast<UClass*>(TokenClass));
+		Storage->SetTokenIndexEnabled(false);
+		const TArray<FEntryKey> PerItem = FindWithToken(const_cast<UClass*>(TokenClass));
+		TestTrue(FString::Printf(TEXT("Indexed and per-item %s filters match"), *TokenClass->GetName()), Indexed == PerItem);
+	}
+
+	return true;
+}
+
+namespace Faerie::Tests
+{
+	template <typename TRule>
+	TRule* MakeRule()
+	{
+		return NewObject<TRule>();
+	}
+
+	template <typename TRule>
+	TRule* MakeJunction(const TArray<TObjectPtr<UFaerieItemDataFilter>>& Rules)
+	{
+		TRule* Rule = NewObject<TRule>();
+		SetPropertyByName(Rule, TEXT("Rules"), Rules);
+		return Rule;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FaerieFilterProgramTests, "FDS.FaerieContainerFilterTests.FilterProgram", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FaerieFilterProgramTests::RunTest(const FString& Parameters)
+{
+	using namespace Faerie::Tests;
+
+	FGameplayTagContainer BothTags;
+	BothTags.AddTag(Faerie::Inventory::Tags::RemovalDeletion);
+	BothTags.AddTag(Faerie::Inventory::Tags::RemovalMoving);
+
+	FGameplayTagContainer OneTag;
+	OneTag.AddTag(Faerie::Inventory::Tags::RemovalDeletion);
+
+	const FFaerieAssetInfo Info{ FText::FromString(TEXT("FilterProgramTest")), FText::GetEmpty(), FText::GetEmpty(), nullptr };
+	UFaerieItemToken* InfoToken = UFaerieInfoToken::CreateInstance(Info);
+	UFaerieItemToken* OneTagToken = UFaerieTagToken::CreateInstance(OneTag);
+	UFaerieItemToken* BothTagsToken = UFaerieTagToken::CreateInstance(BothTags);
+
+	// Every combination of mutability, and info and tag tokens, that the rules below can tell apart.
+	TArray<UFaerieItem*> Items;
+	for (const EFaerieItemInstancingMutability Mutability : { EFaerieItemInstancingMutability::Automatic, EFaerieItemInstancingMutability::Mutable })
+	{
+		Items.Add(UFaerieItem::CreateNewInstance({}, Mutability));
+		Items.Add(UFaerieItem::CreateNewInstance(MakeArrayView(&InfoToken, 1), Mutability));
+		Items.Add(UFaerieItem::CreateNewInstance(MakeArrayView(&OneTagToken, 1), Mutability));
+
+		UFaerieItemToken* Tokens[] = { InfoToken, BothTagsToken };
+		Items.Add(UFaerieItem::CreateNewInstance(Tokens, Mutability));
+	}
+
+	TArray<FFaerieItemStackView> Views;
+	for (const UFaerieItem* Item : Items)
+	{
+		for (const int32 Copies : { 1, 3, 5 })
+		{
+			Views.Add(FFaerieItemStackView(Item, Copies));
+		}
+	}
+
+	auto MakeMutability = [](const bool RequireMutable)
+		{
+			UFilterRule_Mutability* Rule = MakeRule<UFilterRule_Mutability>();
+			SetPropertyByName(Rule, TEXT("RequireMutable"), RequireMutable);
+			return Rule;
+		};
+
+	auto MakeCopies = [](const ECopiesCompareOperator Operator, const int32 Amount)
+		{
+			UFilterRule_Copies* Rule = MakeRule<UFilterRule_Copies>();
+			SetPropertyByName(Rule, TEXT("Operator"), Operator);
+			SetPropertyByName(Rule, TEXT("AmountToCompare"), Amount);
+			return Rule;
+		};
+
+	auto MakeHasTokens = [](const TArray<TSubclassOf<UFaerieItemToken>>& TokenClasses)
+		{
+			UFilterRule_HasTokens* Rule = MakeRule<UFilterRule_HasTokens>();
+			SetPropertyByName(Rule, TEXT("TokenClasses"), TokenClasses);
+			return Rule;
+		};
+
+	auto MakeNot = [](UFaerieItemDataFilter* InvertedRule)
+		{
+			UFilterRule_LogicalNot* Rule = MakeRule<UFilterRule_LogicalNot>();
+			SetPropertyByName(Rule, TEXT("InvertedRule"), TObjectPtr<UFaerieItemDataFilter>(InvertedRule));
+			return Rule;
+		};
+
+	UFilterRule_GameplayTagAny* TagsAny = MakeRule<UFilterRule_GameplayTagAny>();
+	SetPropertyByName(TagsAny, TEXT("Tags"), OneTag);
+
+	UFilterRule_GameplayTagAll* TagsAll = MakeRule<UFilterRule_GameplayTagAll>();
+	SetPropertyByName(TagsAll, TEXT("Tags"), BothTags);
+
+	UFilterRule_StackLimit* Unlimited = MakeRule<UFilterRule_StackLimit>();
+	SetPropertyByName(Unlimited, TEXT("Operator"), EStackCompareOperator::HasNoLimit);
+
+	UFilterRule_Condition* Condition = MakeRule<UFilterRule_Condition>();
+	SetPropertyByName(Condition, TEXT("ConditionRule"), TObjectPtr<UFaerieItemDataFilter>(MakeMutability(true)));
+	SetPropertyByName(Condition, TEXT("TrueBranch"), TObjectPtr<UFaerieItemDataFilter>(TagsAll));
+	SetPropertyByName(Condition, TEXT("FalseBranch"), false);
+
+	UFilterRule_Ternary* Ternary = MakeRule<UFilterRule_Ternary>();
+	SetPropertyByName(Ternary, TEXT("ConditionRule"), TObjectPtr<UFaerieItemDataFilter>(MakeHasTokens({ UFaerieTagToken::StaticClass() })));
+	SetPropertyByName(Ternary, TEXT("TrueBranch"), TObjectPtr<UFaerieItemDataFilter>(MakeCopies(ECopiesCompareOperator::Less, 3)));
+	SetPropertyByName(Ternary, TEXT("FalseBranch"), TObjectPtr<UFaerieItemDataFilter>(MakeNot(MakeRule<UFilterRule_Literal>())));
+
+	const TArray<TPair<FString, UFaerieItemDataFilter*>> Filters = {
+		{ TEXT("Literal"), MakeRule<UFilterRule_Literal>() },
+		{ TEXT("Null"), nullptr },
+		{ TEXT("Mutability"), MakeMutability(false) },
+		{ TEXT("Not"), MakeNot(MakeMutability(true)) },
+		{ TEXT("HasTokens"), MakeHasTokens({ UFaerieInfoToken::StaticClass(), UFaerieTagToken::StaticClass() }) },
+		{ TEXT("Copies"), MakeCopies(ECopiesCompareOperator::GreaterOrEqual, 3) },
+		{ TEXT("StackLimit"), Unlimited },
+		{ TEXT("TagsAny"), TagsAny },
+		{ TEXT("TagsAll"), TagsAll },
+		{ TEXT("Condition"), Condition },
+		{ TEXT("Ternary"), Ternary },
+		{ TEXT("EmptyAnd"), MakeJunction<UFilterRule_LogicalAnd>({}) },
+		{ TEXT("EmptyOr"), MakeJunction<UFilterRule_LogicalOr>({}) },
+		{ TEXT("And"), MakeJunction<UFilterRule_LogicalAnd>({ MakeHasTokens({ UFaerieInfoToken::StaticClass() }), MakeCopies(ECopiesCompareOperator::NotEqual, 1), TagsAny }) },
+		{ TEXT("Or"), MakeJunction<UFilterRule_LogicalOr>({ TagsAll, MakeCopies(ECopiesCompareOperator::Equal, 5), MakeNot(Condition) }) },
+		{ TEXT("Nested"), MakeJunction<UFilterRule_LogicalOr>({ MakeJunction<UFilterRule_LogicalAnd>({ Ternary, MakeMutability(false) }), MakeNot(MakeJunction<UFilterRule_LogicalOr>({ TagsAny, Unlimited })) }) },
+	};
+
+	for (const TPair<FString, UFaerieItemDataFilter*>& Filter : Filters)
+	{
+		const Faerie::ItemData::FFilterProgram Program = Faerie::ItemData::FFilterProgram::Compile(Filter.Value);
+
+		TBitArray<> BatchResults;
+		Program.ExecBatch(Views, BatchResults);
+
+		bool AllPassed = true;
+		for (int32 i = 0; i < Views.Num(); ++i)
+		{
+			const bool Expected = IsValid(Filter.Value) && Filter.Value->Exec(Views[i]);
+			AllPassed &= Expected;
+
+			TestEqual(FString::Printf(TEXT("(%s) Exec matches for view %d"), *Filter.Key, i), Program.Exec(Views[i]), Expected);
+			TestEqual(FString::Printf(TEXT("(%s) ExecBatch matches for view %d"), *Filter.Key, i), static_cast<bool>(BatchResults[i]), Expected);
+		}
+
+		TestEqual(FString::Printf(TEXT("(%s) ExecAll matches"), *Filter.Key), Program.ExecAll(Views), AllPassed);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FaerieFilterResultCacheTests, "FDS.FaerieContainerFilterTests.FilterResultCache", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FaerieFilterResultCacheTests::RunTest(const FString& Parameters)
+{
+	using namespace Faerie::Tests;
+
+	const FFaerieAssetInfo Info{ FText::FromString(TEXT("FilterResultCacheTest")), FText::GetEmpty(), FText::GetEmpty(), nullptr };
+	UFaerieItemToken* InfoToken = UFaerieInfoToken::CreateInstance(Info);
+	const UFaerieItem* Item = UFaerieItem::CreateNewInstance(MakeArrayView(&InfoToken, 1));
+	const FFaerieItemStackView View(Item, 1);
+
+	// Compiled rules only read the view, so results for an immutable item are cached.
+	{
+		const Faerie::ItemData::FFilterProgram Program = Faerie::ItemData::FFilterProgram::Compile(MakeRule<UFilterRule_Literal>());
+		TestTrue("Compiled program is cacheable", Program.IsCacheable());
+
+		Faerie::ItemData::FFilterResultCache Cache;
+		TestTrue("(Compiled) Passes", Cache.FindOrExec(Program, View));
+		TestEqual("(Compiled) Result was cached", Cache.Num(), 1);
+	}
+
+	// Called rules can read anything, so their results must not be reused, even for an immutable item.
+	{
+		UFaerieTestFilterRule* Rule = MakeRule<UFaerieTestFilterRule>();
+		const Faerie::ItemData::FFilterProgram Program = Faerie::ItemData::FFilterProgram::Compile(
+			MakeJunction<UFilterRule_LogicalAnd>({ MakeRule<UFilterRule_Literal>(), Rule }));
+		TestFalse("Program with a call is not cacheable", Program.IsCacheable());
+
+		Faerie::ItemData::FFilterResultCache Cache;
+		TestTrue("(Call) Passes", Cache.FindOrExec(Program, View));
+
+		Rule->Passes = false;
+		TestFalse("(Call) Fails once the rule changes", Cache.FindOrExec(Program, View));
+		TestEqual("(Call) Nothing was cached", Cache.Num(), 0);
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,21 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "FaerieItemDataFilter.h"
+#include "FaerieFilterTestTypes.generated.h"
+
+/**
+ * Filter rule used by the FDS.FaerieContainerFilterTests. Its result is set by the test rather than read from the
+ * view, and it doesn't compile itself, so programs must call it.
+ */
+UCLASS(Transient)
+class UFaerieTestFilterRule : public UFaerieItemDataFilter
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool Exec(FFaerieItemStackView View) const override { return Passes; }
+
+	bool Passes = true;
+};
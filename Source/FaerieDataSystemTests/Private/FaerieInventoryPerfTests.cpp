@@ -0,0 +1,568 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "FaerieLoadTestHarness.h"
+#include "FaeriePerfTestTypes.h"
+#include "FaerieItem.h"
+#include "FaerieItemStorage.h"
+#include "FaerieItemStorageQuery.h"
+#include "ItemContainerEvent.h"
+#include "Extensions/InventoryCapacityExtension.h"
+#include "Extensions/InventorySpatialGridExtension.h"
+#include "Generation/FaerieGenerationStructs.h"
+#include "ItemInstancingContext_Crafting.h"
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Tokens/FaerieCapacityToken.h"
+#include "Tokens/FaerieInfoToken.h"
+
+/*
+ * Benchmarks for FaerieInventory, run with "Automation RunTests FDS.Perf". Each test runs once per container size.
+ * Results are appended to Saved/Automation/FaerieDataSystem/Perf.csv, or the file given with -FDSPerfCsv=<Path>.
+ * Content is generated from a fixed seed, so runs on different builds can be compared directly.
+ */
+
+namespace Faerie::Perf
+{
+	static constexpr int32 Seed = 0x5EED;
+	static constexpr int32 ContainerSizes[] = { 10, 100, 1000, 10000, 100000 };
+
+	// Filter and sort passes are much cheaper than building the container, so they are repeated to get a stable reading.
+	static constexpr int32 QueryPasses = 5;
+
+	static constexpr EAutomationTestFlags Flags = EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter;
+
+	void GetSizeTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands)
+	{
+		for (const int32 Size : ContainerSizes)
+		{
+			OutBeautifiedNames.Add(LexToString(Size));
+			OutTestCommands.Add(LexToString(Size));
+		}
+	}
+
+	FString GetOutputPath()
+	{
+		FString Path;
+		if (!FParse::Value(FCommandLine::Get(), TEXT("FDSPerfCsv="), Path))
+		{
+			Path = FPaths::Combine(FPaths::AutomationDir(), TEXT("FaerieDataSystem"), TEXT("Perf.csv"));
+		}
+		return Path;
+	}
+
+	/**
+	 * Times benchmarks for one suite and container size, and writes them out as CSV rows when destroyed.
+	 */
+	class FReport : FNoncopyable
+	{
+	public:
+		FReport(FAutomationTestBase& Test, const TCHAR* Suite, const int32 Entries)
+		  : Test(Test), Suite(Suite), Entries(Entries) {}
+
+		~FReport()
+		{
+			const FString Path = GetOutputPath();
+
+			FString Csv;
+			if (!IFileManager::Get().FileExists(*Path))
+			{
+				Csv += TEXT("Suite,Benchmark,Entries,Iterations,TotalMs,MeanUs,Seed") LINE_TERMINATOR;
+			}
+			Csv += Rows;
+
+			FFileHelper::SaveStringToFile(Csv, *Path, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM,
+				&IFileManager::Get(), FILEWRITE_Append);
+		}
+
+		template <typename FuncType>
+		void Time(const TCHAR* Benchmark, const int32 Iterations, FuncType&& Func)
+		{
+			const double Start = FPlatformTime::Seconds();
+			Func();
+			const double Seconds = FPlatformTime::Seconds() - Start;
+
+			const double TotalMs = Seconds * 1000.0;
+			const double MeanUs = Iterations > 0 ? Seconds * 1000000.0 / Iterations : 0.0;
+
+			Rows += FString::Printf(TEXT("%s,%s,%d,%d,%.4f,%.4f,%d") LINE_TERMINATOR,
+				*Suite, Benchmark, Entries, Iterations, TotalMs, MeanUs, Seed);
+			Test.AddInfo(FString::Printf(TEXT("%s.%s [%d]: %.3fms total, %.3fus mean"), *Suite, Benchmark, Entries, TotalMs, MeanUs));
+		}
+
+	private:
+		FAutomationTestBase& Test;
+		FString Suite;
+		int32 Entries;
+		FString Rows;
+	};
+
+	/**
+	 * A set of distinct items, generated from the fixed seed.
+	 */
+	struct FContent
+	{
+		FContent(const int32 Num)
+		  : Stream(Seed)
+		{
+			Items.Reserve(Num);
+			Copies.Reserve(Num);
+
+			for (int32 i = 0; i < Num; ++i)
+			{
+				const FFaerieAssetInfo Info{
+					FText::FromString(FString::Printf(TEXT("PerfItem_%d"), Stream.RandHelper(Num * 4))),
+					FText::GetEmpty(),
+					FText::GetEmpty(),
+					nullptr
+				};
+
+				FItemCapacity Capacity;
+				Capacity.Weight = Stream.RandRange(1, 1000);
+				Capacity.Bounds = FIntVector(Stream.RandRange(1, 20), Stream.RandRange(1, 20), Stream.RandRange(1, 20));
+
+				UFaerieItemToken* Tokens[] = {
+					UFaerieInfoToken::CreateInstance(Info),
+					UFaerieCapacityToken::CreateInstance(Capacity)
+				};
+
+				// Tokens differ by more than the name, so items are never interned together, and each gets its own entry.
+				Items.Add(UFaerieItem::CreateNewInstance(Tokens));
+
+				// Always at least two, so every stack can be split.
+				Copies.Add(Stream.RandRange(2, 8));
+			}
+		}
+
+		void AddTo(UFaerieItemStorage* Storage) const
+		{
+			for (int32 i = 0; i < Items.Num(); ++i)
+			{
+				Storage->AddItemStack(FFaerieItemStack(Items[i], Copies[i]), EFaerieStorageAddStackBehavior::AddToAnyStack);
+			}
+		}
+
+		int32 Num() const { return Items.Num(); }
+
+		FRandomStream Stream;
+		TArray<UFaerieItem*> Items;
+		TArray<int32> Copies;
+	};
+
+	FString GetItemName(const UFaerieItem* Item)
+	{
+		if (const UFaerieInfoToken* Info = Item ? Item->GetToken<UFaerieInfoToken>() : nullptr)
+		{
+			return Info->GetAssetInfo().ObjectName.ToString();
+		}
+		return FString();
+	}
+}
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FFaeriePerfStorageTest, "FDS.Perf.Storage", Faerie::Perf::Flags)
+
+void FFaeriePerfStorageTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	Faerie::Perf::GetSizeTests(OutBeautifiedNames, OutTestCommands);
+}
+
+bool FFaeriePerfStorageTest::RunTest(const FString& Parameters)
+{
+	using namespace Faerie::Perf;
+
+	const FContent Content(FCString::Atoi(*Parameters));
+	FReport Report(*this, TEXT("Storage"), Content.Num());
+
+	UFaerieItemStorage* Storage = NewObject<UFaerieItemStorage>();
+	UFaerieItemStorage* OtherStorage = NewObject<UFaerieItemStorage>();
+
+	Report.Time(TEXT("AddStack"), Content.Num(), [&]
+		{
+			Content.AddTo(Storage);
+		});
+
+	TestEqual("Every item got an entry", Storage->GetEntryCount(), Content.Num());
+
+	FRandomStream Stream(Seed);
+	Report.Time(TEXT("FindItem"), Content.Num(), [&]
+		{
+			for (int32 i = 0; i < Content.Num(); ++i)
+			{
+				(void)Storage->FindItem(Content.Items[Stream.RandHelper(Content.Num())], EFaerieItemEqualsCheck::ComparePointers);
+			}
+		});
+
+	TArray<FFaerieAddress> Addresses;
+	Storage->GetAllAddresses(Addresses);
+
+	Report.Time(TEXT("SplitStack"), Addresses.Num(), [&]
+		{
+			for (const FFaerieAddress Address : Addresses)
+			{
+				Storage->SplitStack(Address, 1);
+			}
+		});
+
+	TestEqual("Every stack was split", Storage->GetStackCount(), Addresses.Num() * 2);
+
+	TArray<FEntryKey> Keys;
+	Storage->GetAllKeys(Keys);
+
+	TArray<TArray<FStackKey>> StackKeys;
+	StackKeys.Reserve(Keys.Num());
+	for (const FEntryKey Key : Keys)
+	{
+		StackKeys.Add(Storage->BreakEntryIntoKeys(Key));
+	}
+
+	Report.Time(TEXT("MergeStacks"), Keys.Num(), [&]
+		{
+			for (int32 i = 0; i < Keys.Num(); ++i)
+			{
+				if (StackKeys[i].Num() > 1)
+				{
+					Storage->MergeStacks(Keys[i], StackKeys[i].Last(), StackKeys[i][0]);
+				}
+			}
+		});
+
+	TestEqual("Every split was merged", Storage->GetStackCount(), Addresses.Num());
+
+	Addresses.Reset();
+	Storage->GetAllAddresses(Addresses);
+
+	TArray<FEntryKey> MovedKeys;
+	MovedKeys.Reserve(Addresses.Num());
+	Report.Time(TEXT("MoveStack"), Addresses.Num(), [&]
+		{
+			for (const FFaerieAddress Address : Addresses)
+			{
+				MovedKeys.Add(Storage->MoveStack(OtherStorage, Address));
+			}
+		});
+
+	TestEqual("Every stack was moved", OtherStorage->GetEntryCount(), Content.Num());
+
+	Addresses.Reset();
+	OtherStorage->GetAllAddresses(Addresses);
+
+	Report.Time(TEXT("RemoveStack"), Addresses.Num(), [&]
+		{
+			for (const FFaerieAddress Address : Addresses)
+			{
+				OtherStorage->RemoveStack(Address, Faerie::Inventory::Tags::RemovalDeletion);
+			}
+		});
+
+	TestEqual("Every stack was removed", OtherStorage->GetEntryCount(), 0);
+
+	return true;
+}
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FFaeriePerfQueryTest, "FDS.Perf.Query", Faerie::Perf::Flags)
+
+void FFaeriePerfQueryTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	Faerie::Perf::GetSizeTests(OutBeautifiedNames, OutTestCommands);
+}
+
+bool FFaeriePerfQueryTest::RunTest(const FString& Parameters)
+{
+	using namespace Faerie::Perf;
+
+	const FContent Content(FCString::Atoi(*Parameters));
+	FReport Report(*this, TEXT("Query"), Content.Num());
+
+	UFaerieItemStorage* Storage = NewObject<UFaerieItemStorage>();
+	Content.AddTo(Storage);
+
+	UFaerieItemStorageQuery* FilterQuery = NewObject<UFaerieItemStorageQuery>();
+	FilterQuery->SetFilter(Faerie::Container::FItemPredicate(
+		[](const UFaerieItem* Item)
+		{
+			return GetItemName(Item).EndsWith(TEXT("7"));
+		}), nullptr);
+
+	UFaerieItemStorageQuery* SortQuery = NewObject<UFaerieItemStorageQuery>();
+	SortQuery->SetSort(Faerie::Container::FItemComparator(
+		[](const UFaerieItem* A, const UFaerieItem* B)
+		{
+			return GetItemName(A) < GetItemName(B);
+		}), nullptr);
+
+	UFaerieItemStorageQuery* ChainQuery = NewObject<UFaerieItemStorageQuery>();
+	ChainQuery->SetFilter(Faerie::Container::FStackPredicate(
+		[](const FFaerieItemStackView& Stack)
+		{
+			return Stack.Copies > 4;
+		}), nullptr);
+	ChainQuery->SetSort(Faerie::Container::FStackComparator(
+		[](const FFaerieItemStackView& A, const FFaerieItemStackView& B)
+		{
+			return A.Copies == B.Copies ? GetItemName(A.Item.Get()) < GetItemName(B.Item.Get()) : A.Copies > B.Copies;
+		}), nullptr);
+	ChainQuery->SetInvertSort(true);
+
+	TArray<FFaerieAddress> Results;
+	auto RunQuery = [&](const TCHAR* Benchmark, const UFaerieItemStorageQuery* Query)
+		{
+			Report.Time(Benchmark, QueryPasses, [&]
+				{
+					for (int32 i = 0; i < QueryPasses; ++i)
+					{
+						Results.Reset();
+						Query->QueryAllAddresses(Storage, Results);
+					}
+				});
+		};
+
+	RunQuery(TEXT("Filter"), FilterQuery);
+	RunQuery(TEXT("Sort"), SortQuery);
+	TestEqual("Sort returned every stack", Results.Num(), Storage->GetStackCount());
+	RunQuery(TEXT("FilterSort"), ChainQuery);
+
+	Report.Time(TEXT("KeyFilter"), QueryPasses, [&]
+		{
+			for (int32 i = 0; i < QueryPasses; ++i)
+			{
+				Faerie::Container::FKeyFilter KeyFilter = Faerie::Container::KeyFilter(Storage);
+				KeyFilter.Invert();
+				KeyFilter.Invert();
+				(void)KeyFilter.Num();
+			}
+		});
+
+	return true;
+}
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FFaeriePerfGridTest, "FDS.Perf.Grid", Faerie::Perf::Flags)
+
+void FFaeriePerfGridTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	Faerie::Perf::GetSizeTests(OutBeautifiedNames, OutTestCommands);
+}
+
+bool FFaeriePerfGridTest::RunTest(const FString& Parameters)
+{
+	using namespace Faerie::Perf;
+
+	const FContent Content(FCString::Atoi(*Parameters));
+	FReport Report(*this, TEXT("Grid"), Content.Num());
+
+	UFaerieItemStorage* Storage = NewObject<UFaerieItemStorage>();
+	UInventorySpatialGridExtension* Grid = Cast<UInventorySpatialGridExtension>(
+		Storage->AddExtensionByClass(UInventorySpatialGridExtension::StaticClass()));
+	if (!TestNotNull("Grid extension", Grid))
+	{
+		return false;
+	}
+
+	// Leave some room, so the last placements don't have to search a full grid.
+	const int32 Side = FMath::CeilToInt32(FMath::Sqrt(static_cast<float>(Content.Num()) * 1.25f)) + 1;
+	Grid->SetGridSize(FIntPoint(Side));
+
+	Report.Time(TEXT("Place"), Content.Num(), [&]
+		{
+			Content.AddTo(Storage);
+		});
+
+	TestEqual("Every item was placed", Storage->GetEntryCount(), Content.Num());
+
+	TArray<FFaerieAddress> Addresses;
+	Storage->GetAllAddresses(Addresses);
+
+	FRandomStream Stream(Seed);
+	Report.Time(TEXT("MoveItem"), Addresses.Num(), [&]
+		{
+			for (const FFaerieAddress Address : Addresses)
+			{
+				Grid->MoveItem(Address, FIntPoint(Stream.RandHelper(Side), Stream.RandHelper(Side)));
+			}
+		});
+
+	Report.Time(TEXT("CanAddAtLocation"), Content.Num(), [&]
+		{
+			for (int32 i = 0; i < Content.Num(); ++i)
+			{
+				(void)Grid->CanAddAtLocation(FFaerieItemStackView(Content.Items[i], 1), FIntPoint(Stream.RandHelper(Side), Stream.RandHelper(Side)));
+			}
+		});
+
+	return true;
+}
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FFaeriePerfCapacityTest, "FDS.Perf.Capacity", Faerie::Perf::Flags)
+
+void FFaeriePerfCapacityTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	Faerie::Perf::GetSizeTests(OutBeautifiedNames, OutTestCommands);
+}
+
+bool FFaeriePerfCapacityTest::RunTest(const FString& Parameters)
+{
+	using namespace Faerie::Perf;
+
+	const FContent Content(FCString::Atoi(*Parameters));
+	FReport Report(*this, TEXT("Capacity"), Content.Num());
+
+	UFaerieItemStorage* Storage = NewObject<UFaerieItemStorage>();
+	UInventoryCapacityExtension* Capacity = Cast<UInventoryCapacityExtension>(
+		Storage->AddExtensionByClass(UInventoryCapacityExtension::StaticClass()));
+	if (!TestNotNull("Capacity extension", Capacity))
+	{
+		return false;
+	}
+
+	FCapacityExtensionConfig Config;
+	Config.Checks = static_cast<int32>(ECapacityChecks::Weight | ECapacityChecks::Volume);
+	Config.MaxWeight = MAX_int32;
+	Config.DeriveVolumeFromBounds = false;
+	Config.MaxVolume = MAX_int64;
+	Capacity->SetConfiguration(Config);
+
+	Report.Time(TEXT("AddStack"), Content.Num(), [&]
+		{
+			Content.AddTo(Storage);
+		});
+
+	Report.Time(TEXT("CanAddStack"), Content.Num(), [&]
+		{
+			for (int32 i = 0; i < Content.Num(); ++i)
+			{
+				(void)Storage->CanAddStack(FFaerieItemStackView(Content.Items[i], Content.Copies[i]), EFaerieStorageAddStackBehavior::OnlyNewStacks);
+			}
+		});
+
+	Report.Time(TEXT("CanContain"), Content.Num(), [&]
+		{
+			for (int32 i = 0; i < Content.Num(); ++i)
+			{
+				(void)Capacity->CanContain(FFaerieItemStackView(Content.Items[i], Content.Copies[i]));
+			}
+		});
+
+	return true;
+}
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FFaeriePerfSaveLoadTest, "FDS.Perf.SaveLoad", Faerie::Perf::Flags)
+
+void FFaeriePerfSaveLoadTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	Faerie::Perf::GetSizeTests(OutBeautifiedNames, OutTestCommands);
+}
+
+bool FFaeriePerfSaveLoadTest::RunTest(const FString& Parameters)
+{
+	using namespace Faerie::Perf;
+
+	const FContent Content(FCString::Atoi(*Parameters));
+	FReport Report(*this, TEXT("SaveLoad"), Content.Num());
+
+	UFaerieItemStorage* Storage = NewObject<UFaerieItemStorage>();
+	Content.AddTo(Storage);
+
+	TMap<FGuid, FInstancedStruct> ExtensionData;
+	FInstancedStruct SaveData;
+	Report.Time(TEXT("Save"), Content.Num(), [&]
+		{
+			SaveData = Storage->MakeSaveData(ExtensionData);
+		});
+
+	UFaerieItemStorage* LoadedStorage = NewObject<UFaerieItemStorage>();
+	Report.Time(TEXT("Load"), Content.Num(), [&]
+		{
+			LoadedStorage->LoadSaveData(SaveData, nullptr);
+		});
+
+	LoadedStorage->MaterializeAllEntries();
+	TestEqual("Round trip kept every entry", LoadedStorage->GetEntryCount(), Storage->GetEntryCount());
+	TestEqual("Round trip kept every stack", LoadedStorage->GetStackCount(), Storage->GetStackCount());
+
+	return true;
+}
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FFaeriePerfPoolTest, "FDS.Perf.Pool", Faerie::Perf::Flags)
+
+void FFaeriePerfPoolTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	Faerie::Perf::GetSizeTests(OutBeautifiedNames, OutTestCommands);
+}
+
+bool FFaeriePerfPoolTest::RunTest(const FString& Parameters)
+{
+	using namespace Faerie::Perf;
+
+	const FContent Content(FCString::Atoi(*Parameters));
+	FReport Report(*this, TEXT("Pool"), Content.Num());
+
+	TArray<UFaeriePerfItemSource*> Sources;
+	Sources.Reserve(Content.Num());
+	for (const UFaerieItem* Item : Content.Items)
+	{
+		UFaeriePerfItemSource* Source = NewObject<UFaeriePerfItemSource>();
+		Source->Template = Item;
+		Sources.Add(Source);
+	}
+
+	UFaeriePerfItemPool* Pool = NewObject<UFaeriePerfItemPool>();
+	Pool->SetSources(Sources);
+
+	// Uses our own stream instead of a Squirrel, so results are seeded without depending on its implementation.
+	FRandomStream Stream(Seed);
+	const FFaerieItemInstancingContext_Crafting Context;
+
+	int32 Generated = 0;
+	Report.Time(TEXT("Generate"), Content.Num(), [&]
+		{
+			for (int32 i = 0; i < Content.Num(); ++i)
+			{
+				if (const FFaerieTableDrop* Drop = Pool->GetDrop(Stream.FRand()))
+				{
+					if (Drop->Resolve(Context).IsSet())
+					{
+						++Generated;
+					}
+				}
+			}
+		});
+
+	TestEqual("Every drop generated a stack", Generated, Content.Num());
+
+	return true;
+}
+
+// A small run of the load test harness, so it keeps working between real runs of the commandlet.
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFaeriePerfLoadTest, "FDS.Perf.Load", Faerie::Perf::Flags)
+
+bool FFaeriePerfLoadTest::RunTest(const FString& Parameters)
+{
+	using namespace Faerie::LoadTest;
+
+	FConfig Config;
+	Config.Seed = Faerie::Perf::Seed;
+	Config.Containers = 64;
+	Config.Operations = 10000;
+	Config.GridSize = 16;
+	Config.Extensions = { UInventoryCapacityExtension::StaticClass(), UInventorySpatialGridExtension::StaticClass() };
+
+	const FResults Results = Run(Config);
+	Results.Print(*GLog);
+
+	int32 Accounted = 0;
+	for (const FOpStats& Stats : Results.Ops)
+	{
+		Accounted += Stats.Count + Stats.Skipped;
+	}
+
+	TestEqual("Every operation ran or was skipped", Accounted, Config.Operations);
+	TestTrue("Mutable items were mutated", Results.Ops[static_cast<uint8>(EOp::Mutate)].Count > 0);
+	TestTrue("Storages kept some content", Results.EntriesEnd > 0);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,229 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+#include "BasicItemDataFilters.h"
+#include "BasicItemHashInstructions.h"
+#include "FaerieItem.h"
+#include "FaerieItemInternTable.h"
+#include "FaerieItemStackHashProgram.h"
+#include "FaerieTestUtils.h"
+#include "ItemContainerEvent.h"
+#include "Tokens/FaerieGuidToken.h"
+#include "Tokens/FaerieInfoToken.h"
+#include "Tokens/FaerieItemStorageToken.h"
+#include "Tokens/FaerieTagToken.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FaerieTokenLookupTests, "FDS.FaerieItemTests.TokenLookup", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FaerieTokenLookupTests::RunTest(const FString& Parameters)
+{
+	UFaerieItemToken* InfoToken = UFaerieInfoToken::CreateInstance(FFaerieAssetInfo());
+	UFaerieItem* Item = UFaerieItem::CreateNewInstance(MakeArrayView(&InfoToken, 1), EFaerieItemInstancingMutability::Mutable);
+	UFaerieItemToken* FirstInfo = Item->GetTokens().IsEmpty() ? nullptr : Item->GetTokens()[0].Get();
+	if (!TestNotNull("Item has an info token", FirstInfo))
+	{
+		return false;
+	}
+
+	UFaerieItemToken* SecondInfo = UFaerieInfoToken::CreateInstance(FFaerieAssetInfo());
+	UFaerieItemToken* TagToken = UFaerieTagToken::CreateInstance(FGameplayTagContainer());
+	UFaerieItemToken* StorageToken = NewObject<UFaerieItemStorageToken>();
+	Item->AddToken(TagToken);
+	Item->AddToken(SecondInfo);
+	Item->AddToken(StorageToken);
+
+	TestTrue("Exact class finds the first token of it", Item->GetToken(UFaerieInfoToken::StaticClass()) == FirstInfo);
+	TestTrue("Exact class finds a later token", Item->GetToken(UFaerieTagToken::StaticClass()) == TagToken);
+	TestTrue("Parent class finds a child token", Item->GetToken(UFaerieItemContainerToken::StaticClass()) == StorageToken);
+	TestNull("Missing class finds nothing", Item->GetToken(UFaerieGuidToken::StaticClass()));
+	TestTrue("Base class finds the first token", Item->GetToken(UFaerieItemToken::StaticClass()) == FirstInfo);
+
+	// Mutable lookups skip past tokens that can't be edited.
+	TestTrue("Mutable lookup finds the same token", Item->GetMutableToken<UFaerieItemContainerToken>() == StorageToken);
+	TestTrue("Mutable lookup by base class finds the first mutable token", Item->GetMutableToken<UFaerieItemToken>() == StorageToken);
+	TestNull("Mutable lookup ignores immutable tokens", Item->GetMutableToken<UFaerieTagToken>());
+
+	// Every lookup must agree with a scan over the tokens, in order.
+	auto ScanFor = [](const UFaerieItem* ScannedItem, const UClass* Class) -> const UFaerieItemToken*
+		{
+			for (const TObjectPtr<UFaerieItemToken>& Token : ScannedItem->GetTokens())
+			{
+				if (Token && Token->IsA(Class))
+				{
+					return Token;
+				}
+			}
+			return nullptr;
+		};
+
+	auto TestMatchesScan = [this, &ScanFor](const UFaerieItem* TestedItem, const FString& When)
+		{
+			for (const UClass* Class : { UFaerieItemToken::StaticClass(), UFaerieInfoToken::StaticClass(), UFaerieTagToken::StaticClass(),
+										 UFaerieGuidToken::StaticClass(), UFaerieItemContainerToken::StaticClass(), UFaerieItemStorageToken::StaticClass() })
+			{
+				TestTrue(FString::Printf(TEXT("(%s) %s matches a scan"), *When, *Class->GetName()), TestedItem->GetToken(Class) == ScanFor(TestedItem, Class));
+			}
+		};
+
+	TestMatchesScan(Item, TEXT("Added"));
+
+	// Removing the first token of a class should find the next one.
+	Item->RemoveToken(FirstInfo);
+	TestTrue("Removed token is replaced by the next of its class", Item->GetToken(UFaerieInfoToken::StaticClass()) == SecondInfo);
+	TestMatchesScan(Item, TEXT("Removed"));
+
+	// Only tokens of exactly this class are removed.
+	Item->RemoveTokensByClass(UFaerieItemStorageToken::StaticClass());
+	TestNull("Tokens removed by class are gone", Item->GetToken(UFaerieItemContainerToken::StaticClass()));
+	TestMatchesScan(Item, TEXT("RemovedByClass"));
+
+	// Duplicates build their own table, as mutable tokens are copied.
+	const UFaerieItem* Duplicate = Item->CreateDuplicate(EFaerieItemInstancingMutability::Mutable);
+	if (TestNotNull("Duplicate was created", Duplicate))
+	{
+		TestNotNull("Duplicate finds its info token", Duplicate->GetToken(UFaerieInfoToken::StaticClass()));
+		TestMatchesScan(Duplicate, TEXT("Duplicate"));
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FaerieItemInternTableTests, "FDS.FaerieItemTests.InternTable", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FaerieItemInternTableTests::RunTest(const FString& Parameters)
+{
+	using Faerie::ItemData::FItemInternTable;
+
+	if (!FItemInternTable::IsEnabled())
+	{
+		AddInfo("Interning is disabled with faerie.InternImmutableItems. Skipping.");
+		return true;
+	}
+
+	auto MakeItem = [](const TCHAR* Name, const EFaerieItemInstancingMutability Mutability)
+		{
+			const FFaerieAssetInfo Info{ FText::FromString(Name), FText::GetEmpty(), FText::GetEmpty(), nullptr };
+			UFaerieItemToken* InfoToken = UFaerieInfoToken::CreateInstance(Info);
+			return UFaerieItem::CreateNewInstance(MakeArrayView(&InfoToken, 1), Mutability);
+		};
+
+	UFaerieItem* ItemA = MakeItem(TEXT("InternTestA"), EFaerieItemInstancingMutability::Automatic);
+	UFaerieItem* ItemA2 = MakeItem(TEXT("InternTestA"), EFaerieItemInstancingMutability::Automatic);
+	UFaerieItem* ItemB = MakeItem(TEXT("InternTestB"), EFaerieItemInstancingMutability::Automatic);
+
+	TestTrue("Identical immutable items share one instance", ItemA == ItemA2);
+	TestTrue("Items with different content are not merged", ItemA != ItemB);
+	TestFalse("Different content is not identical", FItemInternTable::AreIdentical(ItemA, ItemB));
+
+	// A duplicate isn't interned, so it is a separate object with the same content.
+	const UFaerieItem* Duplicate = ItemA->CreateDuplicate(EFaerieItemInstancingMutability::Automatic);
+	if (TestTrue("Duplicate is a separate object", Duplicate != ItemA))
+	{
+		TestTrue("Duplicate is identical", FItemInternTable::AreIdentical(ItemA, Duplicate));
+		TestEqual("Duplicate has the same fingerprint", FItemInternTable::Fingerprint(Duplicate), FItemInternTable::Fingerprint(ItemA));
+		TestTrue("Duplicate finds the canonical instance", FItemInternTable::Get().Find(Duplicate) == ItemA);
+	}
+
+	// Mutable items can diverge at any time, so they are never shared.
+	UFaerieItem* MutableA = MakeItem(TEXT("InternTestA"), EFaerieItemInstancingMutability::Mutable);
+	UFaerieItem* MutableA2 = MakeItem(TEXT("InternTestA"), EFaerieItemInstancingMutability::Mutable);
+	TestTrue("Mutable items are not merged with each other", MutableA != MutableA2);
+	TestTrue("Mutable items are not merged with immutable ones", MutableA != ItemA);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FaerieHashProgramTests, "FDS.FaerieItemTests.HashProgram", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FaerieHashProgramTests::RunTest(const FString& Parameters)
+{
+	using namespace Faerie::Tests;
+
+	FGameplayTagContainer Tags;
+	Tags.AddTag(Faerie::Inventory::Tags::RemovalDeletion);
+
+	const FFaerieAssetInfo Info{ FText::FromString(TEXT("HashProgramTest")), FText::GetEmpty(), FText::GetEmpty(), nullptr };
+	UFaerieItemToken* InfoToken = UFaerieInfoToken::CreateInstance(Info);
+	UFaerieItemToken* TagToken = UFaerieTagToken::CreateInstance(Tags);
+
+	// Items with no tokens, and with some but not all of the classes the token instructions ask for.
+	TArray<FFaerieItemStackView> Views;
+	for (const EFaerieItemInstancingMutability Mutability : { EFaerieItemInstancingMutability::Automatic, EFaerieItemInstancingMutability::Mutable })
+	{
+		UFaerieItemToken* BothTokens[] = { InfoToken, TagToken };
+		Views.Add(FFaerieItemStackView(UFaerieItem::CreateNewInstance({}, Mutability), 1));
+		Views.Add(FFaerieItemStackView(UFaerieItem::CreateNewInstance(MakeArrayView(&InfoToken, 1), Mutability), 2));
+		Views.Add(FFaerieItemStackView(UFaerieItem::CreateNewInstance(BothTokens, Mutability), 3));
+	}
+
+	auto MakeLiteral = [](const uint32 Hash)
+		{
+			FFaerieHash Value;
+			Value.Hash = Hash;
+
+			UFISHI_Literial* Instruction = NewObject<UFISHI_Literial>();
+			SetPropertyByName(Instruction, TEXT("Value"), Value);
+			return Instruction;
+		};
+
+	auto MakeTokens = [](const TArray<TSubclassOf<UFaerieItemToken>>& TokenClasses)
+		{
+			UFISHI_Tokens* Instruction = NewObject<UFISHI_Tokens>();
+			SetPropertyByName(Instruction, TEXT("TokenClasses"), TokenClasses);
+			return Instruction;
+		};
+
+	auto MakeList = [](UFaerieItemStackHashInstruction* Instruction, const TArray<TObjectPtr<UFaerieItemStackHashInstruction>>& Instructions)
+		{
+			SetPropertyByName(Instruction, TEXT("Instructions"), Instructions);
+			return Instruction;
+		};
+
+	UFilterRule_Mutability* IsMutable = NewObject<UFilterRule_Mutability>();
+	SetPropertyByName(IsMutable, TEXT("RequireMutable"), true);
+
+	UFISHI_BooleanFilter* BooleanFilter = NewObject<UFISHI_BooleanFilter>();
+	SetPropertyByName(BooleanFilter, TEXT("Pattern"), TObjectPtr<UFaerieItemDataFilter>(IsMutable));
+
+	UFISHI_BooleanSelect* BooleanSelect = NewObject<UFISHI_BooleanSelect>();
+	SetPropertyByName(BooleanSelect, TEXT("Pattern"), TObjectPtr<UFaerieItemDataFilter>(IsMutable));
+	SetPropertyByName(BooleanSelect, TEXT("True"), TObjectPtr<UFaerieItemStackHashInstruction>(MakeTokens({ UFaerieTagToken::StaticClass() })));
+	SetPropertyByName(BooleanSelect, TEXT("False"), TObjectPtr<UFaerieItemStackHashInstruction>(MakeLiteral(7)));
+
+	UFISHI_Tokens* AllTokens = MakeTokens({ TSubclassOf<UFaerieItemToken>() });
+	UFISHI_Tokens* SomeTokens = MakeTokens({ UFaerieInfoToken::StaticClass(), UFaerieTagToken::StaticClass(), UFaerieGuidToken::StaticClass() });
+
+	const TArray<TPair<FString, UFaerieItemStackHashInstruction*>> Instructions = {
+		{ TEXT("Literal"), MakeLiteral(42) },
+		{ TEXT("IsValid"), NewObject<UFISHI_IsValid>() },
+		{ TEXT("BooleanFilter"), BooleanFilter },
+		{ TEXT("BooleanSelect"), BooleanSelect },
+		{ TEXT("TokensNone"), MakeTokens({}) },
+		{ TEXT("TokensAll"), AllTokens },
+		{ TEXT("TokensSome"), SomeTokens },
+		{ TEXT("And"), MakeList(NewObject<UFISHI_And>(), { MakeLiteral(3), SomeTokens, BooleanFilter, MakeLiteral(5) }) },
+		{ TEXT("Or"), MakeList(NewObject<UFISHI_Or>(), { MakeLiteral(0), MakeTokens({}), BooleanSelect, AllTokens }) },
+		{ TEXT("OrFails"), MakeList(NewObject<UFISHI_Or>(), { MakeLiteral(0), MakeTokens({}) }) },
+	};
+
+	for (const TPair<FString, UFaerieItemStackHashInstruction*>& Instruction : Instructions)
+	{
+		const Faerie::Hash::FHashProgram Program = Faerie::Hash::FHashProgram::Compile(Instruction.Value);
+		for (int32 i = 0; i < Views.Num(); ++i)
+		{
+			TestEqual(FString::Printf(TEXT("(%s) Program matches Hash for view %d"), *Instruction.Key, i),
+				Program.Exec(Views[i]), Instruction.Value->Hash(Views[i]));
+		}
+	}
+
+	// Only IsValid can be given an invalid view, as the other instructions read the item.
+	const UFISHI_IsValid* IsValidInstruction = NewObject<UFISHI_IsValid>();
+	TestEqual("(IsValid) Program matches Hash for an invalid view",
+		Faerie::Hash::FHashProgram::Compile(IsValidInstruction).Exec(FFaerieItemStackView()), IsValidInstruction->Hash(FFaerieItemStackView()));
+
+	return true;
+}
+
+#endif
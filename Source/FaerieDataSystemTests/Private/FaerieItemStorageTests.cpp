@@ -0,0 +1,430 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+#include "FaerieContainerIterator.h"
+#include "FaerieContainerTransaction.h"
+#include "FaerieInventorySettings.h"
+#include "FaerieItem.h"
+#include "FaerieItemStackContainer.h"
+#include "FaerieItemStorage.h"
+#include "FaerieItemStorageQuery.h"
+#include "FaerieSortedAddressView.h"
+#include "Extensions/InventoryUserdataExtension.h"
+#include "Extensions/ItemContainerExtensionEvents.h"
+#include "Tokens/FaerieInfoToken.h"
+#include "Tokens/FaerieItemStorageToken.h"
+
+namespace Faerie::Tests
+{
+	UFaerieItem* MakeTestItem(const FString& Name, const EFaerieItemInstancingMutability Mutability)
+	{
+		const FFaerieAssetInfo Info{
+			FText::FromString(Name),
+			FText::GetEmpty(),
+			FText::GetEmpty(),
+			nullptr
+		};
+
+		UFaerieItemToken* InfoToken = UFaerieInfoToken::CreateInstance(Info);
+		return UFaerieItem::CreateNewInstance(MakeArrayView(&InfoToken, 1), Mutability);
+	}
+
+	FFaerieAddressableHandle MakeHandle(UFaerieItemContainerBase* Container, const FFaerieAddress Address)
+	{
+		FFaerieAddressableHandle Handle;
+		Handle.Container = Container;
+		Handle.Address = Address;
+		return Handle;
+	}
+
+	FEntryKey FirstEntry(const UFaerieItemContainerBase* Container)
+	{
+		for (const FEntryKey Key : Container::KeyRange(Container))
+		{
+			return Key;
+		}
+		return FEntryKey::InvalidKey;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FaerieCompactSaveDataTests, "FDS.FaerieItemStorageTests.CompactSaveData", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FaerieCompactSaveDataTests::RunTest(const FString& Parameters)
+{
+	UFaerieInventorySettings* Settings = GetMutableDefault<UFaerieInventorySettings>();
+	TGuardValue<bool> CompactGuard(Settings->UseCompactStorageSaveData, true);
+	TGuardValue<int32> LazyGuard(Settings->LazyLoadEntryThreshold, 0);
+	TGuardValue<EFaerieContainerOwnershipBehavior> OwnershipGuard(Settings->ContainerMutableBehavior, EFaerieContainerOwnershipBehavior::Rename);
+
+	UFaerieItemStorage* Storage = NewObject<UFaerieItemStorage>();
+	UInventoryUserdataExtension* Userdata = Cast<UInventoryUserdataExtension>(
+		Storage->AddExtensionByClass(UInventoryUserdataExtension::StaticClass()));
+	if (!TestNotNull("Userdata extension", Userdata))
+	{
+		return false;
+	}
+
+	Storage->AddItemStack({ Faerie::Tests::MakeTestItem(TEXT("Immutable"), EFaerieItemInstancingMutability::Automatic), 5 },
+		EFaerieStorageAddStackBehavior::AddToAnyStack);
+	Storage->AddItemStack({ Faerie::Tests::MakeTestItem(TEXT("MutableA"), EFaerieItemInstancingMutability::Mutable), 1 },
+		EFaerieStorageAddStackBehavior::OnlyNewStacks);
+	Storage->AddItemStack({ Faerie::Tests::MakeTestItem(TEXT("MutableB"), EFaerieItemInstancingMutability::Mutable), 1 },
+		EFaerieStorageAddStackBehavior::OnlyNewStacks);
+
+	TArray<FFaerieAddress> Addresses;
+	for (const FFaerieAddress Address : Faerie::Container::AddressRange(Storage))
+	{
+		Addresses.Add(Address);
+	}
+	if (!TestEqual("Addresses before save", Addresses.Num(), 3))
+	{
+		return false;
+	}
+
+	const FFaerieAddress FavoriteAddress = Addresses[1];
+	TestTrue("Marked favorite", Userdata->MarkStackWithTag(Faerie::Tests::MakeHandle(Storage, FavoriteAddress), Faerie::Inventory::Tags::Favorite));
+
+	TMap<FGuid, FInstancedStruct> ExtensionData;
+	const FInstancedStruct SaveData = Storage->MakeSaveData(ExtensionData);
+	TestTrue("Saved with the compact format", SaveData.GetScriptStruct() == FFaerieItemStorageSaveData::StaticStruct());
+	TestTrue("Saved userdata extension", ExtensionData.Contains(Userdata->GetIdentifier()));
+
+	// Load into a fresh storage, with an extension that claims the same save data.
+	UFaerieItemStorage* LoadedStorage = NewObject<UFaerieItemStorage>();
+	UInventoryUserdataExtension* LoadedUserdata = NewObject<UInventoryUserdataExtension>(LoadedStorage->GetExtensionGroup());
+	const FGuid Identifier = Userdata->GetIdentifier();
+	LoadedUserdata->SetIdentifier(&Identifier);
+	LoadedStorage->AddExtension(LoadedUserdata);
+
+	UFaerieItemContainerExtensionData* LoadedExtensionData = NewObject<UFaerieItemContainerExtensionData>();
+	LoadedExtensionData->Data = ExtensionData;
+	LoadedStorage->LoadSaveData(SaveData, LoadedExtensionData);
+
+	TestEqual("Round trip kept every entry", LoadedStorage->GetEntryCount(), Storage->GetEntryCount());
+	TestEqual("Round trip kept every stack", LoadedStorage->GetStackCount(), Storage->GetStackCount());
+
+	for (const FFaerieAddress Address : Addresses)
+	{
+		const FFaerieItemStackView Original = Storage->ViewStack(Address);
+		const FFaerieItemStackView Loaded = LoadedStorage->ViewStack(Address);
+		if (!TestTrue("Loaded stack is valid", Loaded.Item.IsValid()))
+		{
+			continue;
+		}
+
+		TestEqual("Loaded stack copies", Loaded.Copies, Original.Copies);
+		TestEqual("Loaded stack mutability", Loaded.Item->CanMutate(), Original.Item->CanMutate());
+
+		const UFaerieInfoToken* OriginalInfo = Original.Item->GetToken<UFaerieInfoToken>();
+		const UFaerieInfoToken* LoadedInfo = Loaded.Item->GetToken<UFaerieInfoToken>();
+		if (TestTrue("Loaded info token", OriginalInfo && LoadedInfo))
+		{
+			TestEqual("Loaded item name", LoadedInfo->GetAssetInfo().ObjectName.ToString(), OriginalInfo->GetAssetInfo().ObjectName.ToString());
+		}
+	}
+
+	TestTrue("Favorite kept through extension data",
+		LoadedUserdata->DoesStackHaveTag(Faerie::Tests::MakeHandle(LoadedStorage, FavoriteAddress), Faerie::Inventory::Tags::Favorite));
+	TestFalse("Other stacks are not favorites",
+		LoadedUserdata->DoesStackHaveTag(Faerie::Tests::MakeHandle(LoadedStorage, Addresses[0]), Faerie::Inventory::Tags::Favorite));
+
+	// Truncated save data must not leave a partial load behind.
+	FInstancedStruct TruncatedData = SaveData;
+	TArray<uint8>& Bytes = TruncatedData.GetMutable<FFaerieItemStorageSaveData>().Data;
+	Bytes.SetNum(Bytes.Num() / 2);
+
+	AddExpectedError(TEXT("Compact item format"), EAutomationExpectedErrorFlags::Contains, 0);
+	AddExpectedError(TEXT("LoadCompactSaveData"), EAutomationExpectedErrorFlags::Contains, 0);
+	AddExpectedError(TEXT("LoadSaveData"), EAutomationExpectedErrorFlags::Contains, 1);
+
+	UFaerieItemStorage* CorruptStorage = NewObject<UFaerieItemStorage>();
+	CorruptStorage->LoadSaveData(TruncatedData, nullptr);
+	TestEqual("Corrupt save data loads nothing", CorruptStorage->GetEntryCount(), 0);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FaerieContainerGraphTests, "FDS.FaerieItemStorageTests.ContainerGraph", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FaerieContainerGraphTests::RunTest(const FString& Parameters)
+{
+	UFaerieItemStorage* Storage = NewObject<UFaerieItemStorage>();
+	UFaerieItem* Item = Faerie::Tests::MakeTestItem(TEXT("Bag"), EFaerieItemInstancingMutability::Mutable);
+	Storage->AddItemStack({ Item, 1 }, EFaerieStorageAddStackBehavior::OnlyNewStacks);
+
+	// A container token added to an item that's already in a container.
+	UFaerieItemStorageToken* Token = NewObject<UFaerieItemStorageToken>();
+	if (!TestTrue("Token added", Item->AddToken(Token)))
+	{
+		return false;
+	}
+
+	UFaerieItemStorage* Child = Token->GetItemStorage();
+	TestTrue("Added container is linked", Child->GetParentContainer() == Storage);
+	TestTrue("Child is nested in the item", Child->IsNestedIn(Item));
+	TestFalse("Item can't be added to its own container", Child->CanAddStack({ Item, 1 }, EFaerieStorageAddStackBehavior::OnlyNewStacks));
+
+	Item->RemoveToken(Token);
+	TestNull("Removed container is unlinked", Child->GetParentContainer());
+	TestFalse("Storage no longer has the child", Storage->GetChildContainers().Contains(Child));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FaerieTransactionCommitTests, "FDS.FaerieItemStorageTests.TransactionCommit", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FaerieTransactionCommitTests::RunTest(const FString& Parameters)
+{
+	UFaerieItemStorage* From = NewObject<UFaerieItemStorage>();
+	UFaerieItemStorage* To = NewObject<UFaerieItemStorage>();
+	UItemContainerExtensionEvents* FromEvents = Cast<UItemContainerExtensionEvents>(From->AddExtensionByClass(UItemContainerExtensionEvents::StaticClass()));
+	UItemContainerExtensionEvents* ToEvents = Cast<UItemContainerExtensionEvents>(To->AddExtensionByClass(UItemContainerExtensionEvents::StaticClass()));
+	if (!TestTrue("Event extensions", FromEvents && ToEvents))
+	{
+		return false;
+	}
+
+	From->AddItemStack({ Faerie::Tests::MakeTestItem(TEXT("Moved"), EFaerieItemInstancingMutability::Automatic), 3 },
+		EFaerieStorageAddStackBehavior::AddToAnyStack);
+
+	int32 Removals = 0;
+	int32 Additions = 0;
+	FromEvents->GetPostRemovalEvent().AddLambda([&Removals](const UFaerieItemContainerBase*, const Faerie::Inventory::FEventLog&) { ++Removals; });
+	ToEvents->GetPostAdditionEvent().AddLambda([&Additions](const UFaerieItemContainerBase*, const Faerie::Inventory::FEventLog&) { ++Additions; });
+
+	{
+		Faerie::Container::FTransaction Transaction;
+
+		FFaerieItemStack Stack;
+		TestTrue("Took the stack", From->TakeEntry(Faerie::Tests::FirstEntry(From), Stack, Faerie::Inventory::Tags::RemovalMoving));
+		TestTrue("Added the stack", To->AddItemStack(Stack, EFaerieStorageAddStackBehavior::AddToAnyStack));
+
+		TestTrue("Both containers joined", From->IsInTransaction() && To->IsInTransaction());
+		TestEqual("Removal hook held", Removals, 0);
+		TestEqual("Addition hook held", Additions, 0);
+
+		Transaction.Commit();
+	}
+
+	TestFalse("Containers left the transaction", From->IsInTransaction() || To->IsInTransaction());
+	TestEqual("Removal hook ran on commit", Removals, 1);
+	TestEqual("Addition hook ran on commit", Additions, 1);
+	TestEqual("Source is empty", From->GetEntryCount(), 0);
+	TestEqual("Target has the entry", To->GetEntryCount(), 1);
+	TestEqual("Target has every copy", To->View(Faerie::Tests::FirstEntry(To)).Copies, 3);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FaerieTransactionRollbackTests, "FDS.FaerieItemStorageTests.TransactionRollback", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FaerieTransactionRollbackTests::RunTest(const FString& Parameters)
+{
+	UFaerieItemStorage* Storage = NewObject<UFaerieItemStorage>();
+	UFaerieItemStackContainer* Slot = NewObject<UFaerieItemStackContainer>();
+	UItemContainerExtensionEvents* SlotEvents = Cast<UItemContainerExtensionEvents>(Slot->AddExtensionByClass(UItemContainerExtensionEvents::StaticClass()));
+	if (!TestNotNull("Event extension", SlotEvents))
+	{
+		return false;
+	}
+
+	const UFaerieItem* Item = Faerie::Tests::MakeTestItem(TEXT("Returned"), EFaerieItemInstancingMutability::Automatic);
+	Storage->AddItemStack({ Item, 3 }, EFaerieStorageAddStackBehavior::AddToAnyStack);
+	const FEntryKey Entry = Faerie::Tests::FirstEntry(Storage);
+
+	int32 Additions = 0;
+	int32 SlotChanges = 0;
+	SlotEvents->GetPostAdditionEvent().AddLambda([&Additions](const UFaerieItemContainerBase*, const Faerie::Inventory::FEventLog&) { ++Additions; });
+	Slot->GetOnContainerEvent().AddLambda([&SlotChanges](UFaerieItemStackContainer*, FFaerieInventoryTag) { ++SlotChanges; });
+
+	{
+		Faerie::Container::FTransaction Transaction;
+
+		FFaerieItemStack Stack;
+		TestTrue("Took one copy", Storage->TakeEntry(Entry, Stack, Faerie::Inventory::Tags::RemovalMoving, 1));
+		TestTrue("Set in slot", Slot->SetItemInSlot(Stack));
+		TestTrue("Both containers joined", Storage->IsInTransaction() && Slot->IsInTransaction());
+
+		// Not committed, so leaving scope rolls back.
+	}
+
+	TestFalse("Containers left the transaction", Storage->IsInTransaction() || Slot->IsInTransaction());
+	TestFalse("Slot is empty again", Slot->IsFilled());
+	TestEqual("Held addition hook was dropped", Additions, 0);
+	TestEqual("Held slot event was dropped", SlotChanges, 0);
+	TestEqual("Storage has its entry", Storage->GetEntryCount(), 1);
+	TestEqual("Storage has every copy", Storage->View(Entry).Copies, 3);
+	TestTrue("Storage has the same item", Storage->View(Entry).Item == Item);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FaerieSortedAddressViewTests, "FDS.FaerieItemStorageTests.SortedAddressView", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FaerieSortedAddressViewTests::RunTest(const FString& Parameters)
+{
+	using namespace Faerie::Tests;
+
+	UFaerieItemStorage* Storage = NewObject<UFaerieItemStorage>();
+	FRandomStream Random(0x534F5254);
+
+	// Items sort by a rank the test can change, and are filtered out while hidden. Equal ranks are ordered by pointer, so
+	// there is only ever one correct order.
+	TMap<const UFaerieItem*, int32> Ranks;
+	TSet<const UFaerieItem*> Hidden;
+
+	auto Less = [&Ranks](const UFaerieItem* A, const UFaerieItem* B)
+		{
+			const int32 RankA = Ranks.FindRef(A);
+			const int32 RankB = Ranks.FindRef(B);
+			return RankA != RankB ? RankA < RankB : reinterpret_cast<UPTRINT>(A) < reinterpret_cast<UPTRINT>(B);
+		};
+
+	UFaerieItemStorageQuery* Query = NewObject<UFaerieItemStorageQuery>();
+	Query->SetSort(Faerie::Container::FItemComparator(Less), nullptr);
+	Query->SetFilter(Faerie::Container::FItemPredicate(
+		[&Hidden](const UFaerieItem* Item)
+		{
+			return !Hidden.Contains(Item);
+		}), nullptr);
+
+	auto AddItem = [Storage, &Random, &Ranks]
+		{
+			UFaerieItem* Item = MakeTestItem(FString::Printf(TEXT("SortedViewTest%d"), Ranks.Num()), EFaerieItemInstancingMutability::Mutable);
+			Ranks.Add(Item, Random.RandRange(0, 64));
+			Storage->AddEntryFromItemObject(Item, EFaerieStorageAddStackBehavior::OnlyNewStacks);
+			return Item;
+		};
+
+	auto FindAddress = [Storage](const UFaerieItem* Item)
+		{
+			for (const FFaerieAddress Address : Faerie::Container::AddressRange(Storage))
+			{
+				if (Storage->ViewItem(Address) == Item)
+				{
+					return Address;
+				}
+			}
+			return FFaerieAddress();
+		};
+
+	auto RandomItem = [&Random, &Ranks]
+		{
+			TArray<const UFaerieItem*> Items;
+			Ranks.GenerateKeyArray(Items);
+			return Items[Random.RandRange(0, Items.Num() - 1)];
+		};
+
+	Faerie::Storage::FSortedAddressView View;
+
+	// Compare every way of reading the view against the storage, filtered and sorted from scratch.
+	auto TestConsistent = [this, Storage, &Hidden, &Less, &View](const FString& When)
+		{
+			TArray<FFaerieAddress> Expected;
+			for (const FFaerieAddress Address : Faerie::Container::AddressRange(Storage))
+			{
+				if (!Hidden.Contains(Storage->ViewItem(Address)))
+				{
+					Expected.Add(Address);
+				}
+			}
+			Algo::Sort(Expected,
+				[Storage, &Less](const FFaerieAddress A, const FFaerieAddress B)
+				{
+					return Less(Storage->ViewItem(A), Storage->ViewItem(B));
+				});
+
+			if (!TestEqual(When + TEXT(": Num"), View.Num(), Expected.Num()))
+			{
+				return;
+			}
+
+			TArray<FFaerieAddress> Addresses;
+			View.GetAddresses(Addresses);
+			TestTrue(When + TEXT(": GetAddresses is in order"), Addresses == Expected);
+
+			bool IndicesMatch = true;
+			for (int32 i = 0; i < Expected.Num(); ++i)
+			{
+				IndicesMatch &= View.IndexOf(Expected[i]) == i && View.GetAt(i) == Expected[i];
+			}
+			TestTrue(When + TEXT(": IndexOf and GetAt match every row"), IndicesMatch);
+
+			const int32 Num = Expected.Num();
+			const int32 Ranges[][2] = { { 0, Num }, { Num / 3, 5 }, { Num - 2, 10 }, { Num, 1 } };
+			for (const int32 (&Range)[2] : Ranges)
+			{
+				const int32 Start = Range[0];
+				const int32 Count = Start < 0 ? 0 : FMath::Clamp(Range[1], 0, Num - Start);
+
+				View.GetRange(Start, Range[1], Addresses);
+				TestTrue(FString::Printf(TEXT("%s: GetRange(%d, %d)"), *When, Start, Range[1]),
+					Addresses == TArray<FFaerieAddress>(Expected.GetData() + FMath::Max(Start, 0), Count));
+			}
+		};
+
+	for (int32 i = 0; i < 32; ++i)
+	{
+		const UFaerieItem* Item = AddItem();
+		if (i % 4 == 0)
+		{
+			Hidden.Add(Item);
+		}
+	}
+
+	View.Rebuild(Storage, Query);
+	TestConsistent(TEXT("Rebuild"));
+
+	for (int32 Step = 0; Step < 256; ++Step)
+	{
+		FString When;
+		switch (Ranks.IsEmpty() ? 0 : Random.RandRange(0, 3))
+		{
+		case 0:
+			{
+				When = TEXT("Insert");
+				View.Update(Storage, Query, FindAddress(AddItem()));
+			}
+			break;
+		case 1:
+			{
+				When = TEXT("Move");
+				const UFaerieItem* Item = RandomItem();
+				Ranks[Item] = Random.RandRange(0, 64);
+				View.Update(Storage, Query, FindAddress(Item));
+			}
+			break;
+		case 2:
+			{
+				When = TEXT("Filter");
+				const UFaerieItem* Item = RandomItem();
+				if (Hidden.Remove(Item) == 0)
+				{
+					Hidden.Add(Item);
+				}
+				View.Update(Storage, Query, FindAddress(Item));
+			}
+			break;
+		default:
+			{
+				When = TEXT("Remove");
+				const UFaerieItem* Item = RandomItem();
+				const FFaerieAddress Address = FindAddress(Item);
+				Storage->RemoveStack(Address, Faerie::Inventory::Tags::RemovalDeletion);
+				View.Remove(Address);
+				Ranks.Remove(Item);
+				Hidden.Remove(Item);
+			}
+			break;
+		}
+
+		TestConsistent(FString::Printf(TEXT("(Step %d) %s"), Step, *When));
+		View.ClearChanges();
+	}
+
+	return true;
+}
+
+#endif
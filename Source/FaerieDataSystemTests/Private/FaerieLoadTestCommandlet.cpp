@@ -0,0 +1,34 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "FaerieLoadTestCommandlet.h"
+#include "FaerieLoadTestHarness.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(FaerieLoadTestCommandlet)
+
+UFaerieLoadTestCommandlet::UFaerieLoadTestCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UFaerieLoadTestCommandlet::Main(const FString& Params)
+{
+	using namespace Faerie::LoadTest;
+
+	const FConfig Config = FConfig::Parse(*Params);
+	const FResults Results = Run(Config);
+	Results.Print(*GLog);
+
+	FString CsvPath;
+	if (!FParse::Value(*Params, TEXT("Csv="), CsvPath))
+	{
+		CsvPath = FPaths::Combine(FPaths::AutomationDir(), TEXT("FaerieDataSystem"), TEXT("LoadTest.csv"));
+	}
+	Results.WriteCsv(CsvPath);
+
+	return 0;
+}
@@ -0,0 +1,29 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "FaerieLoadTestCommandlet.generated.h"
+
+/**
+ * Runs the FaerieInventory load test headlessly, for sizing how many containers a server can hold.
+ *
+ * UnrealEditor-Cmd <Project> -run=FaerieLoadTest -nullrhi -unattended [-Containers=1000] [-Operations=100000]
+ *   [-InitialEntries=16] [-Seed=N] [-Extensions=InventoryCapacityExtension,InventorySpatialGridExtension] [-GridSize=N]
+ *   [-DistinctItems=256] [-MutableFraction=0.25] [-MaxCopies=8] [-Mix=Add:30,Remove:15,Move:15,Mutate:15,Query:25]
+ *   [-Csv=<Path>]
+ *
+ * Results are logged, and appended to Saved/Automation/FaerieDataSystem/LoadTest.csv, or the file given with -Csv.
+ */
+UCLASS()
+class UFaerieLoadTestCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UFaerieLoadTestCommandlet();
+
+	//~ UCommandlet
+	virtual int32 Main(const FString& Params) override;
+	//~ UCommandlet
+};
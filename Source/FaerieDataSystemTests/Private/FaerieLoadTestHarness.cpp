@@ -0,0 +1,514 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "FaerieLoadTestHarness.h"
+#include "FaerieDataSystemMemory.h"
+#include "FaerieItem.h"
+#include "FaerieItemStorage.h"
+#include "FaerieItemStorageQuery.h"
+#include "ItemContainerEvent.h"
+#include "ItemContainerExtensionBase.h"
+#include "Extensions/InventoryGridExtensionBase.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Tokens/FaerieCapacityToken.h"
+#include "Tokens/FaerieInfoToken.h"
+#include "Tokens/FaerieItemUsesToken.h"
+#include "UObject/StrongObjectPtr.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogFaerieLoadTest, Log, All);
+
+namespace Faerie::LoadTest
+{
+	const TCHAR* LexToString(const EOp Op)
+	{
+		switch (Op)
+		{
+		case EOp::Add: return TEXT("Add");
+		case EOp::Remove: return TEXT("Remove");
+		case EOp::Move: return TEXT("Move");
+		case EOp::Mutate: return TEXT("Mutate");
+		case EOp::Query: return TEXT("Query");
+		default: return TEXT("Unknown");
+		}
+	}
+
+	static UClass* FindExtensionClass(const FString& Name)
+	{
+		UClass* Class = FindFirstObject<UClass>(*Name, EFindFirstObjectOptions::NativeFirst);
+
+		// Allow the C++ name as well.
+		if (!Class && Name.StartsWith(TEXT("U"), ESearchCase::CaseSensitive))
+		{
+			Class = FindFirstObject<UClass>(*Name.RightChop(1), EFindFirstObjectOptions::NativeFirst);
+		}
+
+		if (!Class || !Class->IsChildOf<UItemContainerExtensionBase>() || Class->HasAnyClassFlags(CLASS_Abstract))
+		{
+			return nullptr;
+		}
+		return Class;
+	}
+
+	FConfig FConfig::Parse(const TCHAR* Params)
+	{
+		FConfig Config;
+		FParse::Value(Params, TEXT("Seed="), Config.Seed);
+		FParse::Value(Params, TEXT("Containers="), Config.Containers);
+		FParse::Value(Params, TEXT("InitialEntries="), Config.InitialEntries);
+		FParse::Value(Params, TEXT("Operations="), Config.Operations);
+		FParse::Value(Params, TEXT("GridSize="), Config.GridSize);
+		FParse::Value(Params, TEXT("DistinctItems="), Config.DistinctItems);
+		FParse::Value(Params, TEXT("MutableFraction="), Config.MutableFraction);
+		FParse::Value(Params, TEXT("MaxCopies="), Config.MaxCopies);
+
+		Config.Containers = FMath::Max(Config.Containers, 1);
+		Config.DistinctItems = FMath::Max(Config.DistinctItems, 1);
+		Config.MaxCopies = FMath::Max(Config.MaxCopies, 1);
+		Config.MutableFraction = FMath::Clamp(Config.MutableFraction, 0.f, 1.f);
+
+		FString ExtensionList;
+		if (FParse::Value(Params, TEXT("Extensions="), ExtensionList, false))
+		{
+			TArray<FString> Names;
+			ExtensionList.ParseIntoArray(Names, TEXT(","));
+			for (const FString& Name : Names)
+			{
+				if (UClass* Class = FindExtensionClass(Name))
+				{
+					Config.Extensions.Add(Class);
+				}
+				else
+				{
+					UE_LOG(LogFaerieLoadTest, Error, TEXT("'%s' is not an extension class. Skipping it."), *Name);
+				}
+			}
+		}
+
+		FString Mix;
+		if (FParse::Value(Params, TEXT("Mix="), Mix, false))
+		{
+			TArray<FString> Parts;
+			Mix.ParseIntoArray(Parts, TEXT(","));
+			for (const FString& Part : Parts)
+			{
+				FString OpName, Weight;
+				if (!Part.Split(TEXT(":"), &OpName, &Weight))
+				{
+					UE_LOG(LogFaerieLoadTest, Error, TEXT("Mix entry '%s' should look like Op:Weight"), *Part);
+					continue;
+				}
+
+				bool Found = false;
+				for (uint8 i = 0; i < static_cast<uint8>(EOp::MAX); ++i)
+				{
+					if (OpName.Equals(LexToString(static_cast<EOp>(i)), ESearchCase::IgnoreCase))
+					{
+						Config.Weights[i] = FMath::Max(FCString::Atoi(*Weight), 0);
+						Found = true;
+					}
+				}
+
+				if (!Found)
+				{
+					UE_LOG(LogFaerieLoadTest, Error, TEXT("Mix entry '%s' is not an operation"), *OpName);
+				}
+			}
+		}
+
+		return Config;
+	}
+
+	FString FConfig::ToString() const
+	{
+		TArray<FString> ExtensionNames;
+		for (const TSubclassOf<UItemContainerExtensionBase>& Extension : Extensions)
+		{
+			ExtensionNames.Add(Extension->GetName());
+		}
+
+		TArray<FString> Mix;
+		for (uint8 i = 0; i < static_cast<uint8>(EOp::MAX); ++i)
+		{
+			Mix.Add(FString::Printf(TEXT("%s:%d"), LexToString(static_cast<EOp>(i)), Weights[i]));
+		}
+
+		return FString::Printf(TEXT("Seed=%d Containers=%d InitialEntries=%d Operations=%d DistinctItems=%d MutableFraction=%.2f MaxCopies=%d GridSize=%d Extensions=%s Mix=%s"),
+			Seed, Containers, InitialEntries, Operations, DistinctItems, MutableFraction, MaxCopies, GridSize,
+			ExtensionNames.IsEmpty() ? TEXT("None") : *FString::Join(ExtensionNames, TEXT("+")),
+			*FString::Join(Mix, TEXT(",")));
+	}
+
+	double FOpStats::GetPercentile(const double Percentile) const
+	{
+		if (LatencyUs.IsEmpty())
+		{
+			return 0.0;
+		}
+
+		const int32 Index = FMath::CeilToInt32(Percentile / 100.0 * LatencyUs.Num()) - 1;
+		return LatencyUs[FMath::Clamp(Index, 0, LatencyUs.Num() - 1)];
+	}
+
+	int32 FResults::GetTotalOps() const
+	{
+		int32 Total = 0;
+		for (const FOpStats& Stats : Ops)
+		{
+			Total += Stats.Count;
+		}
+		return Total;
+	}
+
+	double FResults::GetThroughput() const
+	{
+		return BusySeconds > 0.0 ? GetTotalOps() / BusySeconds : 0.0;
+	}
+
+	static double GetMean(const FOpStats& Stats)
+	{
+		double Sum = 0.0;
+		for (const double Us : Stats.LatencyUs)
+		{
+			Sum += Us;
+		}
+		return Stats.LatencyUs.IsEmpty() ? 0.0 : Sum / Stats.LatencyUs.Num();
+	}
+
+	static double ToMiB(const int64 Bytes)
+	{
+		return static_cast<double>(Bytes) / (1024.0 * 1024.0);
+	}
+
+	void FResults::Print(FOutputDevice& Ar) const
+	{
+		Ar.Logf(TEXT("FDS load test: %s"), *Config.ToString());
+		Ar.Logf(TEXT("  Setup %.2fs, traffic %.2fs wall, %.2fs in operations"), SetupSeconds, WallSeconds, BusySeconds);
+		Ar.Logf(TEXT("  Throughput: %.0f ops/s over %d operations"), GetThroughput(), GetTotalOps());
+		Ar.Logf(TEXT("  %-8s %9s %9s %9s %10s %10s %10s %10s %10s %10s"),
+			TEXT("Op"), TEXT("Count"), TEXT("Skipped"), TEXT("Failed"), TEXT("Mean us"), TEXT("p50 us"), TEXT("p90 us"), TEXT("p99 us"), TEXT("p99.9 us"), TEXT("Max us"));
+
+		for (uint8 i = 0; i < static_cast<uint8>(EOp::MAX); ++i)
+		{
+			const FOpStats& Stats = Ops[i];
+			Ar.Logf(TEXT("  %-8s %9d %9d %9d %10.2f %10.2f %10.2f %10.2f %10.2f %10.2f"),
+				LexToString(static_cast<EOp>(i)), Stats.Count, Stats.Skipped, Stats.Failed, GetMean(Stats),
+				Stats.GetPercentile(50), Stats.GetPercentile(90), Stats.GetPercentile(99), Stats.GetPercentile(99.9), Stats.GetPercentile(100));
+		}
+
+		Ar.Logf(TEXT("  Process memory: %+.2f MiB during setup, %+.2f MiB during traffic"),
+			ToMiB(static_cast<int64>(UsedPhysicalSetup) - static_cast<int64>(UsedPhysicalStart)),
+			ToMiB(static_cast<int64>(UsedPhysicalEnd) - static_cast<int64>(UsedPhysicalSetup)));
+		Ar.Logf(TEXT("  Container memory: %s after setup, %s after traffic (%s per container)"),
+			*Memory::FormatBytes(ContainerBytesSetup), *Memory::FormatBytes(ContainerBytesEnd),
+			*Memory::FormatBytes(ContainerBytesEnd / FMath::Max(Config.Containers, 1)));
+		Ar.Logf(TEXT("  Final contents: %d entries, %d stacks"), EntriesEnd, StacksEnd);
+	}
+
+	void FResults::WriteCsv(const FString& Path) const
+	{
+		FString Csv;
+		if (!IFileManager::Get().FileExists(*Path))
+		{
+			Csv += TEXT("Op,Count,Skipped,Failed,MeanUs,P50Us,P90Us,P99Us,P999Us,MaxUs,OpsPerSecond,Containers,Operations,Seed,Extensions,ContainerBytes,ProcessBytesDelta") LINE_TERMINATOR;
+		}
+
+		TArray<FString> ExtensionNames;
+		for (const TSubclassOf<UItemContainerExtensionBase>& Extension : Config.Extensions)
+		{
+			ExtensionNames.Add(Extension->GetName());
+		}
+		const FString Extensions = FString::Join(ExtensionNames, TEXT("+"));
+		const int64 ProcessDelta = static_cast<int64>(UsedPhysicalEnd) - static_cast<int64>(UsedPhysicalStart);
+
+		for (uint8 i = 0; i < static_cast<uint8>(EOp::MAX); ++i)
+		{
+			const FOpStats& Stats = Ops[i];
+			Csv += FString::Printf(TEXT("%s,%d,%d,%d,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.1f,%d,%d,%d,%s,%llu,%lld") LINE_TERMINATOR,
+				LexToString(static_cast<EOp>(i)), Stats.Count, Stats.Skipped, Stats.Failed, GetMean(Stats),
+				Stats.GetPercentile(50), Stats.GetPercentile(90), Stats.GetPercentile(99), Stats.GetPercentile(99.9), Stats.GetPercentile(100),
+				GetThroughput(), Config.Containers, Config.Operations, Config.Seed, *Extensions,
+				static_cast<uint64>(ContainerBytesEnd), ProcessDelta);
+		}
+
+		FFileHelper::SaveStringToFile(Csv, *Path, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM,
+			&IFileManager::Get(), FILEWRITE_Append);
+	}
+
+	/**
+	 * Distinct items to draw from. Immutable items are shared between every stack of them, and mutable ones are
+	 * duplicated for each addition, so mutating one never touches another container's copy.
+	 */
+	struct FItemSet
+	{
+		FItemSet(const FConfig& Config, FRandomStream& Stream)
+		{
+			for (int32 i = 0; i < Config.DistinctItems; ++i)
+			{
+				const FFaerieAssetInfo Info{
+					FText::FromString(FString::Printf(TEXT("LoadItem_%d"), i)),
+					FText::GetEmpty(),
+					FText::GetEmpty(),
+					nullptr
+				};
+
+				FItemCapacity Capacity;
+				Capacity.Weight = Stream.RandRange(1, 1000);
+				Capacity.Bounds = FIntVector(Stream.RandRange(1, 20), Stream.RandRange(1, 20), Stream.RandRange(1, 20));
+
+				TArray<UFaerieItemToken*> Tokens;
+				Tokens.Add(UFaerieInfoToken::CreateInstance(Info));
+				Tokens.Add(UFaerieCapacityToken::CreateInstance(Capacity));
+				if (Stream.FRand() < Config.MutableFraction)
+				{
+					Tokens.Add(NewObject<UFaerieItemUsesToken>());
+				}
+
+				Items.Emplace(UFaerieItem::CreateNewInstance(Tokens));
+			}
+		}
+
+		FFaerieItemStack MakeStack(FRandomStream& Stream, const int32 MaxCopies) const
+		{
+			const UFaerieItem* Item = Items[Stream.RandHelper(Items.Num())].Get();
+			if (Item->IsInstanceMutable())
+			{
+				return FFaerieItemStack(Item->CreateDuplicate(), 1);
+			}
+			return FFaerieItemStack(Item, Stream.RandRange(1, MaxCopies));
+		}
+
+		TArray<TStrongObjectPtr<UFaerieItem>> Items;
+	};
+
+	static SIZE_T GetContainerBytes(TConstArrayView<TStrongObjectPtr<UFaerieItemStorage>> Storages)
+	{
+		SIZE_T Bytes = 0;
+		for (const TStrongObjectPtr<UFaerieItemStorage>& Storage : Storages)
+		{
+			Memory::FReport Report;
+			Storage->GetMemoryUsage(Report);
+			Bytes += Report.GetTotal();
+		}
+		return Bytes;
+	}
+
+	static EOp PickOp(FRandomStream& Stream, const FConfig& Config, const int32 TotalWeight)
+	{
+		int32 Roll = Stream.RandHelper(TotalWeight);
+		for (uint8 i = 0; i < static_cast<uint8>(EOp::MAX); ++i)
+		{
+			if (Roll < Config.Weights[i])
+			{
+				return static_cast<EOp>(i);
+			}
+			Roll -= Config.Weights[i];
+		}
+		return EOp::Query;
+	}
+
+	FResults Run(const FConfig& Config)
+	{
+		FResults Results;
+		Results.Config = Config;
+
+		FRandomStream Stream(Config.Seed);
+
+		Results.UsedPhysicalStart = FPlatformMemory::GetStats().UsedPhysical;
+		const double SetupStart = FPlatformTime::Seconds();
+
+		const FItemSet ItemSet(Config, Stream);
+
+		TArray<TStrongObjectPtr<UFaerieItemStorage>> Storages;
+		Storages.Reserve(Config.Containers);
+		for (int32 i = 0; i < Config.Containers; ++i)
+		{
+			UFaerieItemStorage* Storage = NewObject<UFaerieItemStorage>();
+			for (const TSubclassOf<UItemContainerExtensionBase>& ExtensionClass : Config.Extensions)
+			{
+				UItemContainerExtensionBase* Extension = Storage->AddExtensionByClass(ExtensionClass);
+				if (UInventoryGridExtensionBase* Grid = Cast<UInventoryGridExtensionBase>(Extension);
+					Grid && Config.GridSize > 0)
+				{
+					Grid->SetGridSize(FIntPoint(Config.GridSize));
+				}
+			}
+
+			for (int32 Entry = 0; Entry < Config.InitialEntries; ++Entry)
+			{
+				Storage->AddItemStack(ItemSet.MakeStack(Stream, Config.MaxCopies), EFaerieStorageAddStackBehavior::AddToAnyStack);
+			}
+
+			Storages.Emplace(Storage);
+		}
+
+		TArray<TStrongObjectPtr<UFaerieItemStorageQuery>> Queries;
+
+		UFaerieItemStorageQuery* FilterQuery = NewObject<UFaerieItemStorageQuery>();
+		FilterQuery->SetFilter(Container::FStackPredicate(
+			[Threshold = Config.MaxCopies / 2](const FFaerieItemStackView& Stack)
+			{
+				return Stack.Copies > Threshold;
+			}), nullptr);
+		Queries.Emplace(FilterQuery);
+
+		UFaerieItemStorageQuery* SortQuery = NewObject<UFaerieItemStorageQuery>();
+		SortQuery->SetSort(Container::FItemComparator(
+			[](const UFaerieItem* A, const UFaerieItem* B)
+			{
+				const UFaerieInfoToken* InfoA = A ? A->GetToken<UFaerieInfoToken>() : nullptr;
+				const UFaerieInfoToken* InfoB = B ? B->GetToken<UFaerieInfoToken>() : nullptr;
+				if (!InfoA || !InfoB)
+				{
+					return InfoA != nullptr;
+				}
+				return InfoA->GetAssetInfo().ObjectName.CompareTo(InfoB->GetAssetInfo().ObjectName) < 0;
+			}), nullptr);
+		Queries.Emplace(SortQuery);
+
+		Results.SetupSeconds = FPlatformTime::Seconds() - SetupStart;
+		Results.UsedPhysicalSetup = FPlatformMemory::GetStats().UsedPhysical;
+		Results.ContainerBytesSetup = GetContainerBytes(Storages);
+
+		int32 TotalWeight = 0;
+		for (const int32 Weight : Config.Weights)
+		{
+			TotalWeight += Weight;
+		}
+
+		for (uint8 i = 0; i < static_cast<uint8>(EOp::MAX) && TotalWeight > 0; ++i)
+		{
+			Results.Ops[i].LatencyUs.Reserve(static_cast<int64>(Config.Operations) * Config.Weights[i] / TotalWeight + 1);
+		}
+
+		TArray<FFaerieAddress> Addresses;
+		TArray<FFaerieAddress> QueryResults;
+		uint64 BusyCycles = 0;
+
+		const double TrafficStart = FPlatformTime::Seconds();
+
+		for (int32 i = 0; i < Config.Operations && TotalWeight > 0; ++i)
+		{
+			const EOp Op = PickOp(Stream, Config, TotalWeight);
+			FOpStats& Stats = Results.Ops[static_cast<uint8>(Op)];
+			UFaerieItemStorage* Storage = Storages[Stream.RandHelper(Storages.Num())].Get();
+
+			// Targets are picked before the clock starts, so only the storage's own work is measured.
+			FFaerieAddress Address;
+			if (Op == EOp::Remove || Op == EOp::Move || Op == EOp::Mutate)
+			{
+				Addresses.Reset();
+				Storage->GetAllAddresses(Addresses);
+				if (Addresses.IsEmpty())
+				{
+					Stats.Skipped++;
+					continue;
+				}
+
+				const int32 Offset = Stream.RandHelper(Addresses.Num());
+				Address = Addresses[Offset];
+
+				if (Op == EOp::Mutate)
+				{
+					// Search onward from the random start for a stack that can be mutated.
+					Address = FFaerieAddress();
+					for (int32 Search = 0; Search < Addresses.Num(); ++Search)
+					{
+						const FFaerieAddress Candidate = Addresses[(Offset + Search) % Addresses.Num()];
+						const UFaerieItem* Item = Storage->ViewStack(Candidate).Item.Get();
+						if (IsValid(Item) && Item->CanMutate())
+						{
+							Address = Candidate;
+							break;
+						}
+					}
+
+					if (!Address.IsValid())
+					{
+						Stats.Skipped++;
+						continue;
+					}
+				}
+			}
+
+			UFaerieItemStorage* MoveTarget = nullptr;
+			if (Op == EOp::Move)
+			{
+				if (Storages.Num() < 2)
+				{
+					Stats.Skipped++;
+					continue;
+				}
+
+				// Any storage but this one.
+				int32 TargetIndex = Stream.RandHelper(Storages.Num() - 1);
+				if (Storages[TargetIndex].Get() == Storage)
+				{
+					TargetIndex = Storages.Num() - 1;
+				}
+				MoveTarget = Storages[TargetIndex].Get();
+			}
+
+			const FFaerieItemStack NewStack = Op == EOp::Add ? ItemSet.MakeStack(Stream, Config.MaxCopies) : FFaerieItemStack();
+			const UFaerieItemStorageQuery* Query = Op == EOp::Query ? Queries[Stream.RandHelper(Queries.Num())].Get() : nullptr;
+
+			bool Succeeded = true;
+			const uint64 Start = FPlatformTime::Cycles64();
+
+			switch (Op)
+			{
+			case EOp::Add:
+				Succeeded = Storage->AddItemStack(NewStack, EFaerieStorageAddStackBehavior::AddToAnyStack);
+				break;
+			case EOp::Remove:
+				Succeeded = Storage->RemoveStack(Address, Inventory::Tags::RemovalDeletion);
+				break;
+			case EOp::Move:
+				Succeeded = Storage->MoveStack(MoveTarget, Address).IsValid();
+				break;
+			case EOp::Mutate:
+				if (UFaerieItemUsesToken* Uses = Storage->ViewStack(Address).Item->MutateCast()->GetMutableToken<UFaerieItemUsesToken>())
+				{
+					Uses->AddUses(1, false);
+				}
+				break;
+			case EOp::Query:
+				QueryResults.Reset();
+				Query->QueryAllAddresses(Storage, QueryResults);
+				break;
+			default:
+				break;
+			}
+
+			const uint64 Cycles = FPlatformTime::Cycles64() - Start;
+			BusyCycles += Cycles;
+
+			Stats.Count++;
+			Stats.LatencyUs.Add(FPlatformTime::ToMilliseconds64(Cycles) * 1000.0);
+			if (!Succeeded)
+			{
+				Stats.Failed++;
+			}
+		}
+
+		Results.WallSeconds = FPlatformTime::Seconds() - TrafficStart;
+		Results.BusySeconds = FPlatformTime::ToSeconds64(BusyCycles);
+
+		for (FOpStats& Stats : Results.Ops)
+		{
+			Stats.LatencyUs.Sort();
+		}
+
+		Results.UsedPhysicalEnd = FPlatformMemory::GetStats().UsedPhysical;
+		Results.ContainerBytesEnd = GetContainerBytes(Storages);
+
+		for (const TStrongObjectPtr<UFaerieItemStorage>& Storage : Storages)
+		{
+			Results.EntriesEnd += Storage->GetEntryCount();
+			Results.StacksEnd += Storage->GetStackCount();
+		}
+
+		return Results;
+	}
+}
@@ -0,0 +1,125 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "Templates/SubclassOf.h"
+
+class UItemContainerExtensionBase;
+
+/*
+ * Headless load test for FaerieInventory. Creates many storages with the same extension stack, then drives randomized
+ * add, remove, move, mutate and query traffic across them from a fixed seed. Needs no world, renderer, or network, so
+ * it runs under -nullrhi. See UFaerieLoadTestCommandlet for the command line, or FDS.Perf.Load for a small run.
+ */
+namespace Faerie::LoadTest
+{
+	enum class EOp : uint8
+	{
+		Add,
+		Remove,
+		Move,
+		Mutate,
+		Query,
+
+		MAX
+	};
+
+	const TCHAR* LexToString(EOp Op);
+
+	struct FConfig
+	{
+		int32 Seed = 0x5EED;
+
+		// Number of storages to create.
+		int32 Containers = 1000;
+
+		// Entries added to each storage before traffic starts.
+		int32 InitialEntries = 16;
+
+		// Total operations to run, spread randomly across every storage.
+		int32 Operations = 100000;
+
+		// Extensions added to every storage, in order.
+		TArray<TSubclassOf<UItemContainerExtensionBase>> Extensions;
+
+		// Grid size for grid extensions. Zero leaves the extension default.
+		int32 GridSize = 0;
+
+		// Number of distinct items to draw from.
+		int32 DistinctItems = 256;
+
+		// Fraction of distinct items that are instance-mutable. These are added one copy at a time, and are the only
+		// targets for Mutate.
+		float MutableFraction = 0.25f;
+
+		// Largest stack added for immutable items.
+		int32 MaxCopies = 8;
+
+		// Relative weight of each operation.
+		int32 Weights[static_cast<uint8>(EOp::MAX)] = { 30, 15, 15, 15, 25 };
+
+		/**
+		 * Reads a config from command line style switches, e.g. "-Containers=5000 -Extensions=InventoryCapacityExtension".
+		 * Weights are given as -Mix=Add:30,Remove:15,Move:15,Mutate:15,Query:25. Unknown extension classes are logged and
+		 * skipped.
+		 */
+		static FConfig Parse(const TCHAR* Params);
+
+		FString ToString() const;
+	};
+
+	struct FOpStats
+	{
+		// Operations that ran.
+		int32 Count = 0;
+
+		// Operations that found nothing to act on, like removing from an empty storage. These are not timed.
+		int32 Skipped = 0;
+
+		// Operations the storage refused, like an addition denied by an extension. These are timed.
+		int32 Failed = 0;
+
+		// Latency of each operation that ran, in microseconds.
+		TArray<double> LatencyUs;
+
+		// Returns the latency at a percentile in [0, 100]. LatencyUs must be sorted.
+		double GetPercentile(double Percentile) const;
+	};
+
+	struct FResults
+	{
+		FConfig Config;
+
+		FOpStats Ops[static_cast<uint8>(EOp::MAX)];
+
+		double SetupSeconds = 0.0;
+
+		// Time spent running traffic, including picking targets.
+		double WallSeconds = 0.0;
+
+		// Time spent inside timed operations. Throughput is measured against this.
+		double BusySeconds = 0.0;
+
+		// Process memory, sampled before setup, after setup, and after traffic.
+		uint64 UsedPhysicalStart = 0;
+		uint64 UsedPhysicalSetup = 0;
+		uint64 UsedPhysicalEnd = 0;
+
+		// Memory owned by the storages themselves, from UFaerieItemContainerBase::GetMemoryUsage.
+		SIZE_T ContainerBytesSetup = 0;
+		SIZE_T ContainerBytesEnd = 0;
+
+		int32 EntriesEnd = 0;
+		int32 StacksEnd = 0;
+
+		int32 GetTotalOps() const;
+		double GetThroughput() const;
+
+		void Print(FOutputDevice& Ar) const;
+
+		// Appends one row per operation to a CSV file, writing a header if the file is new.
+		void WriteCsv(const FString& Path) const;
+	};
+
+	FResults Run(const FConfig& Config);
+}
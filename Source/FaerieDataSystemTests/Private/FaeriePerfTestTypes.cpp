@@ -0,0 +1,27 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "FaeriePerfTestTypes.h"
+#include "FaerieItem.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(FaeriePerfTestTypes)
+
+TOptional<FFaerieItemStack> UFaeriePerfItemSource::CreateItemStack(const FFaerieItemInstancingContext* Context) const
+{
+	if (!IsValid(Template))
+	{
+		return NullOpt;
+	}
+
+	return FFaerieItemStack(Template->CreateDuplicate(), 1);
+}
+
+void UFaeriePerfItemPool::SetSources(const TConstArrayView<UFaeriePerfItemSource*> Sources)
+{
+	DropPool.DropList.Reset(Sources.Num());
+	for (int32 i = 0; i < Sources.Num(); ++i)
+	{
+		FFaerieWeightedDrop& Drop = DropPool.DropList.AddDefaulted_GetRef();
+		Drop.AdjustedWeight = static_cast<double>(i + 1) / Sources.Num();
+		Drop.Drop.Asset.Object = Sources[i];
+	}
+}
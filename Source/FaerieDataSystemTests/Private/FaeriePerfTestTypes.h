@@ -0,0 +1,38 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "FaerieItemPool.h"
+#include "FaerieItemSource.h"
+#include "FaeriePerfTestTypes.generated.h"
+
+/**
+ * Item source used by the FDS.Perf benchmarks. Creates a copy of a template item, so generation can be timed without
+ * needing assets.
+ */
+UCLASS(Transient)
+class UFaeriePerfItemSource : public UObject, public IFaerieItemSource
+{
+	GENERATED_BODY()
+
+public:
+	//~ IFaerieItemSource
+	virtual TOptional<FFaerieItemStack> CreateItemStack(const FFaerieItemInstancingContext* Context) const override;
+	//~ IFaerieItemSource
+
+	UPROPERTY()
+	TObjectPtr<const UFaerieItem> Template;
+};
+
+/**
+ * Item pool that can be filled at runtime, for the FDS.Perf benchmarks.
+ */
+UCLASS(Transient)
+class UFaeriePerfItemPool : public UFaerieItemPool
+{
+	GENERATED_BODY()
+
+public:
+	// Replace the pool with an evenly weighted drop for each source.
+	void SetSources(TConstArrayView<UFaeriePerfItemSource*> Sources);
+};
@@ -0,0 +1,18 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "UObject/Class.h"
+#include "UObject/UnrealType.h"
+
+namespace Faerie::Tests
+{
+	// Filter rule and hash instruction properties are only editable in the details panel, so tests set them by name.
+	template <typename T>
+	void SetPropertyByName(UObject* Object, const FName Name, const T& Value)
+	{
+		const FProperty* Property = Object->GetClass()->FindPropertyByName(Name);
+		check(Property && Property->GetElementSize() == sizeof(T));
+		*Property->ContainerPtrToValuePtr<T>(Object) = Value;
+	}
+}
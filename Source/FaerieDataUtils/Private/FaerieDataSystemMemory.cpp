@@ -0,0 +1,109 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "FaerieDataSystemMemory.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_LLM_MEMORY_STAT(TEXT("FaerieDataSystem"), STAT_FaerieDataSystemLLM, STATGROUP_LLMFULL);
+DEFINE_STAT(STAT_FaerieDataSystemSummaryLLM);
+LLM_DEFINE_TAG(FaerieDataSystem, NAME_None, NAME_None, GET_STATFNAME(STAT_FaerieDataSystemLLM), GET_STATFNAME(STAT_FaerieDataSystemSummaryLLM));
+
+namespace Faerie::Memory
+{
+	static TArray<FReportSectionRegistration*>& GetSections()
+	{
+		static TArray<FReportSectionRegistration*> Sections;
+		return Sections;
+	}
+
+	void FReport::Add(const FName Category, const SIZE_T Bytes)
+	{
+		if (TPair<FName, SIZE_T>* Existing = Categories.FindByPredicate(
+			[Category](const TPair<FName, SIZE_T>& Pair) { return Pair.Key == Category; }))
+		{
+			Existing->Value += Bytes;
+		}
+		else
+		{
+			Categories.Emplace(Category, Bytes);
+		}
+	}
+
+	void FReport::Append(const FReport& Other)
+	{
+		for (auto&& Category : Other.Categories)
+		{
+			Add(Category.Key, Category.Value);
+		}
+	}
+
+	SIZE_T FReport::Get(const FName Category) const
+	{
+		const TPair<FName, SIZE_T>* Existing = Categories.FindByPredicate(
+			[Category](const TPair<FName, SIZE_T>& Pair) { return Pair.Key == Category; });
+		return Existing ? Existing->Value : 0;
+	}
+
+	SIZE_T FReport::GetTotal() const
+	{
+		SIZE_T Total = 0;
+		for (auto&& Category : Categories)
+		{
+			Total += Category.Value;
+		}
+		return Total;
+	}
+
+	void FReport::Print(FOutputDevice& Ar, const TCHAR* Indent) const
+	{
+		TArray<TPair<FName, SIZE_T>> Sorted = Categories;
+		Sorted.Sort([](const TPair<FName, SIZE_T>& A, const TPair<FName, SIZE_T>& B) { return A.Value > B.Value; });
+
+		for (auto&& Category : Sorted)
+		{
+			Ar.Logf(TEXT("%s%-28s %s"), Indent, *Category.Key.ToString(), *FormatBytes(Category.Value));
+		}
+	}
+
+	FReportSectionRegistration::FReportSectionRegistration(const TCHAR* Name, FReportSection&& Section)
+	  : Name(Name),
+		Section(MoveTemp(Section))
+	{
+		GetSections().Add(this);
+	}
+
+	FReportSectionRegistration::~FReportSectionRegistration()
+	{
+		GetSections().Remove(this);
+	}
+
+	void PrintReport(const TArray<FString>& Args, FOutputDevice& Ar)
+	{
+		Ar.Logf(TEXT("---- Faerie Data System memory report ----"));
+		for (const FReportSectionRegistration* Registration : GetSections())
+		{
+			Ar.Logf(TEXT(""));
+			Ar.Logf(TEXT("[%s]"), Registration->GetName());
+			Registration->Print(Args, Ar);
+		}
+		Ar.Logf(TEXT("---- End of Faerie Data System memory report ----"));
+	}
+
+	FString FormatBytes(const SIZE_T Bytes)
+	{
+		if (Bytes >= 1024 * 1024)
+		{
+			return FString::Printf(TEXT("%.2f MiB"), Bytes / (1024.0 * 1024.0));
+		}
+		if (Bytes >= 1024)
+		{
+			return FString::Printf(TEXT("%.2f KiB"), Bytes / 1024.0);
+		}
+		return FString::Printf(TEXT("%llu B"), static_cast<uint64>(Bytes));
+	}
+}
+
+static FAutoConsoleCommandWithArgsAndOutputDevice MemReportCommand(
+	TEXT("faerie.MemReport"),
+	TEXT("Print how much memory each Faerie container, and each module's caches, are using. ")
+	TEXT("Optional argument: the number of containers to list individually (default 20, 0 lists all)."),
+	FConsoleCommandWithArgsAndOutputDeviceDelegate::CreateStatic(&Faerie::Memory::PrintReport));
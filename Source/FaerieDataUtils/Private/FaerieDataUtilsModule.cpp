@@ -1,8 +1,11 @@
 ﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
 
 #include "FaerieDataUtilsModule.h"
+#include "FaerieDataSystemTrace.h"
 #include "Modules/ModuleManager.h"
 
+UE_TRACE_CHANNEL_DEFINE(FaerieDataSystemChannel)
+
 #define LOCTEXT_NAMESPACE "FaerieDataUtilsModule"
 
 void FFaerieDataUtilsModule::StartupModule()
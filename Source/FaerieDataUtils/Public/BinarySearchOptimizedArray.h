@@ -5,7 +5,7 @@
 #include "Algo/BinarySearch.h"
 #include "Algo/IsSorted.h"
 #include "Algo/Sort.h"
-#include "Stats/Stats.h"
+#include "FaerieDataSystemTrace.h"
 
 DECLARE_STATS_GROUP(TEXT("FaerieDataUtils"), STATGROUP_FaerieDataUtils, STATCAT_Advanced);
 DECLARE_CYCLE_STAT(TEXT("BSOA Index Of"), STAT_BSOA_IndexOf, STATGROUP_FaerieDataUtils);
@@ -33,7 +33,7 @@ public:
 	int32 IndexOf(const KeyType Key) const
 	{
 		checkf(IsSorted(), TEXT("Array got out of order. BinarySearch will not function. Determine why Array is not sorted!"));
-		SCOPE_CYCLE_COUNTER(STAT_BSOA_IndexOf);
+		FAERIE_SCOPE_CYCLE_COUNTER(STAT_BSOA_IndexOf);
 		// Search for Key in the Items. Since those do not share Type, we project by the element key.
 		return Algo::BinarySearchBy(GetArray_Internal(), Key, &TElementType::Key);
 	}
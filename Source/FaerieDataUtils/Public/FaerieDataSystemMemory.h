@@ -0,0 +1,80 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "HAL/LowLevelMemStats.h"
+#include "HAL/LowLevelMemTracker.h"
+#include "Misc/OutputDevice.h"
+#include "Templates/Function.h"
+
+/*
+ * Root LLM tag for all Faerie modules. Modules define their own tags as children of it with FAERIE_LLM_DEFINE_TAG, so
+ * "stat LLMFULL" breaks FDS allocations down by module and subsystem, while "stat LLM" shows them summed together.
+ */
+LLM_DECLARE_TAG_API(FaerieDataSystem, FAERIEDATAUTILS_API);
+DECLARE_LLM_MEMORY_STAT_EXTERN(TEXT("FaerieDataSystem"), STAT_FaerieDataSystemSummaryLLM, STATGROUP_LLM, FAERIEDATAUTILS_API);
+
+// Defines an LLM tag parented to FaerieDataSystem. Declare it with LLM_DECLARE_TAG where it is used.
+#define FAERIE_LLM_DEFINE_TAG(Name) \
+	DECLARE_LLM_MEMORY_STAT(TEXT(#Name), STAT_##Name##LLM, STATGROUP_LLMFULL); \
+	LLM_DEFINE_TAG(Name, NAME_None, TEXT("FaerieDataSystem"), GET_STATFNAME(STAT_##Name##LLM), GET_STATFNAME(STAT_FaerieDataSystemSummaryLLM))
+
+namespace Faerie::Memory
+{
+	/**
+	 * Memory owned by an object, broken down into named categories. Only counts what the object is responsible for
+	 * freeing: its own size, and its heap allocations. Adding to a category more than once accumulates.
+	 */
+	class FAERIEDATAUTILS_API FReport
+	{
+	public:
+		void Add(FName Category, SIZE_T Bytes);
+
+		// Add the heap allocation of any container that implements GetAllocatedSize.
+		template <typename T>
+		void AddAllocation(const FName Category, const T& Container)
+		{
+			Add(Category, Container.GetAllocatedSize());
+		}
+
+		void Append(const FReport& Other);
+
+		SIZE_T Get(FName Category) const;
+		SIZE_T GetTotal() const;
+
+		TConstArrayView<TPair<FName, SIZE_T>> GetCategories() const { return Categories; }
+
+		// Print each category, largest first.
+		void Print(FOutputDevice& Ar, const TCHAR* Indent = TEXT("")) const;
+
+	private:
+		TArray<TPair<FName, SIZE_T>> Categories;
+	};
+
+	// Writes one section of the faerie.MemReport console command. Args are the arguments passed to the command.
+	using FReportSection = TFunction<void(const TArray<FString>& Args, FOutputDevice& Ar)>;
+
+	/**
+	 * Registers a section of faerie.MemReport for as long as this is alive. Modules keep one as a static, so that
+	 * anything above FaerieDataUtils can report its own caches without the command knowing about them.
+	 */
+	class FAERIEDATAUTILS_API FReportSectionRegistration : FNoncopyable
+	{
+	public:
+		FReportSectionRegistration(const TCHAR* Name, FReportSection&& Section);
+		~FReportSectionRegistration();
+
+		const TCHAR* GetName() const { return Name; }
+		void Print(const TArray<FString>& Args, FOutputDevice& Ar) const { Section(Args, Ar); }
+
+	private:
+		const TCHAR* Name;
+		FReportSection Section;
+	};
+
+	// Print every registered section. This is what faerie.MemReport runs.
+	FAERIEDATAUTILS_API void PrintReport(const TArray<FString>& Args, FOutputDevice& Ar);
+
+	// Formats a byte count for reports, e.g. "12.34 KiB".
+	FAERIEDATAUTILS_API FString FormatBytes(SIZE_T Bytes);
+}
@@ -0,0 +1,26 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "ProfilingDebugging/CountersTrace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+
+/*
+ * Trace channel shared by all Faerie modules. Enable it with -trace=cpu,FaerieDataSystem (or "Trace.Enable
+ * FaerieDataSystem") to see only FDS scopes in Insights, without turning on the much noisier stat named events.
+ */
+UE_TRACE_CHANNEL_EXTERN(FaerieDataSystemChannel, FAERIEDATAUTILS_API)
+
+// Scopes a cycle stat, and also emits it as a cpu event on the FaerieDataSystem channel.
+#define FAERIE_SCOPE_CYCLE_COUNTER(Stat) \
+	SCOPE_CYCLE_COUNTER(Stat); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(Stat, FaerieDataSystemChannel)
+
+// Emits a cpu event named after the class of Object, for timing each of a list of polymorphic objects separately.
+// The name is only built while the channel is enabled.
+#define FAERIE_TRACE_OBJECT_SCOPE(Object) \
+	TRACE_CPUPROFILER_EVENT_SCOPE_TEXT_ON_CHANNEL( \
+		UE_TRACE_CHANNELEXPR_IS_ENABLED(FaerieDataSystemChannel) ? *(Object)->GetClass()->GetName() : TEXT(""), \
+		FaerieDataSystemChannel)
@@ -2,16 +2,27 @@
 
 #include "EquipmentHashAsset.h"
 #include "EquipmentHashStatics.h"
+#include "FaerieItemStackHashInstruction.h"
 #include "UObject/ObjectSaveContext.h"
 #include "Squirrel.h"
 
 #if WITH_EDITOR
 #include "FaerieItemAsset.h"
-#include "FaerieItemStackHashInstruction.h"
 #endif
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(EquipmentHashAsset)
 
+void UFaerieEquipmentHashAsset::PostLoad()
+{
+	Super::PostLoad();
+
+	// Compile instructions now, so the first check against this asset doesn't have to.
+	for (auto&& Config : Configs)
+	{
+		Config.Program = Faerie::Hash::FHashProgram::Compile(Config.Instruction);
+	}
+}
+
 void UFaerieEquipmentHashAsset::PreSave(FObjectPreSaveContext SaveContext)
 {
 	Super::PreSave(SaveContext);
@@ -46,4 +57,30 @@ void UFaerieEquipmentHashAsset::PreSave(FObjectPreSaveContext SaveContext)
 		}
 	}
 #endif
+}
+
+#if WITH_EDITOR
+
+void UFaerieEquipmentHashAsset::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	// Edits to instructions are reported here, so their programs must be compiled again.
+	for (auto&& Config : Configs)
+	{
+		Config.Program.Reset();
+	}
+}
+
+#endif
+
+uint32 UFaerieEquipmentHashAsset::HashConfig(const int32 ConfigIndex, const FFaerieItemStackView StackView) const
+{
+	const FFaerieEquipmentHashAssetConfig& Config = Configs[ConfigIndex];
+	if (!Config.Program.IsCompiled())
+	{
+		Config.Program = Faerie::Hash::FHashProgram::Compile(Config.Instruction);
+	}
+
+	return Config.Program.Exec(StackView);
 }
\ No newline at end of file
@@ -0,0 +1,241 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "EquipmentHashEvaluator.h"
+#include "EquipmentHashAsset.h"
+#include "FaerieDataSystemTrace.h"
+#include "FaerieEquipmentManager.h"
+#include "FaerieEquipmentSlot.h"
+#include "FaerieHashStatics.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(EquipmentHashEvaluator)
+
+void UFaerieEquipmentHashEvaluator::BeginDestroy()
+{
+	// Only unbind. Refreshing here would evaluate assets and broadcast while being destroyed.
+	if (UFaerieEquipmentManager* OldManager = Manager.Get())
+	{
+		OldManager->GetOnEquipmentSlotEvent().RemoveAll(this);
+	}
+	Manager.Reset();
+
+	Super::BeginDestroy();
+}
+
+void UFaerieEquipmentHashEvaluator::SetManager(UFaerieEquipmentManager* InManager)
+{
+	if (Manager == InManager)
+	{
+		return;
+	}
+
+	if (UFaerieEquipmentManager* OldManager = Manager.Get())
+	{
+		OldManager->GetOnEquipmentSlotEvent().RemoveAll(this);
+	}
+
+	Manager = InManager;
+
+	if (IsValid(InManager))
+	{
+		InManager->GetOnEquipmentSlotEvent().AddUObject(this, &ThisClass::OnSlotEvent);
+	}
+
+	Refresh();
+}
+
+void UFaerieEquipmentHashEvaluator::RegisterAsset(const UFaerieEquipmentHashAsset* Asset)
+{
+	if (!IsValid(Asset) || Assets.Contains(Asset))
+	{
+		return;
+	}
+
+	const int32 AssetIndex = Assets.Add(Asset);
+	AssetStates.AddDefaulted();
+	BindAsset(AssetIndex);
+	UpdateMatch(AssetIndex, false);
+}
+
+void UFaerieEquipmentHashEvaluator::UnregisterAsset(const UFaerieEquipmentHashAsset* Asset)
+{
+	const int32 AssetIndex = Assets.Find(Asset);
+	if (AssetIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	Assets.RemoveAt(AssetIndex);
+	AssetStates.RemoveAt(AssetIndex);
+
+	// Indices past the removed asset have shifted, but their hashes are still valid.
+	SlotDependents.Reset();
+	NestedDependents.Reset();
+	for (int32 i = 0; i < Assets.Num(); ++i)
+	{
+		AddDependencies(i);
+	}
+}
+
+bool UFaerieEquipmentHashEvaluator::IsMatched(const UFaerieEquipmentHashAsset* Asset) const
+{
+	const int32 AssetIndex = Assets.Find(Asset);
+	return AssetIndex != INDEX_NONE && AssetStates[AssetIndex].Matched;
+}
+
+void UFaerieEquipmentHashEvaluator::Refresh()
+{
+	SlotDependents.Reset();
+	NestedDependents.Reset();
+
+	for (int32 i = 0; i < Assets.Num(); ++i)
+	{
+		BindAsset(i);
+		UpdateMatch(i, true);
+	}
+}
+
+void UFaerieEquipmentHashEvaluator::OnSlotEvent(UFaerieEquipmentSlot* Slot, const FFaerieInventoryTag Event)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(FaerieEquipmentHashEvaluator_OnSlotEvent, FaerieDataSystemChannel);
+
+	// Adding or removing a slot can change which slots are top-level, so everything is bound again.
+	if (Event == Faerie::Equipment::Tags::SlotCreated ||
+		Event == Faerie::Equipment::Tags::SlotDeleted)
+	{
+		Refresh();
+		return;
+	}
+
+	if (!IsValid(Slot))
+	{
+		return;
+	}
+
+	TBitArray<> DirtyAssets(false, Assets.Num());
+
+	if (const TArray<TPair<int32, int32>>* Dependents = SlotDependents.Find(Slot->GetSlotID()))
+	{
+		for (const TPair<int32, int32>& Dependent : *Dependents)
+		{
+			UpdateSlotHash(Dependent.Key, Dependent.Value);
+			DirtyAssets[Dependent.Key] = true;
+		}
+	}
+
+	// Nested slots live inside the items of top-level slots, so any change could have affected them.
+	for (const TPair<int32, int32>& Dependent : NestedDependents)
+	{
+		UpdateSlotHash(Dependent.Key, Dependent.Value);
+		DirtyAssets[Dependent.Key] = true;
+	}
+
+	for (TConstSetBitIterator<> It(DirtyAssets); It; ++It)
+	{
+		UpdateMatch(It.GetIndex(), true);
+	}
+}
+
+void UFaerieEquipmentHashEvaluator::BindAsset(const int32 AssetIndex)
+{
+	FAssetState& State = AssetStates[AssetIndex];
+	State.Hashes.Reset();
+
+	if (const UFaerieEquipmentHashAsset* Asset = Assets[AssetIndex])
+	{
+		for (int32 ConfigIndex = 0; ConfigIndex < Asset->Configs.Num(); ++ConfigIndex)
+		{
+			for (const FGameplayTag Tag : Asset->Configs[ConfigIndex].Slots)
+			{
+				FSlotHash& SlotHash = State.Hashes.AddDefaulted_GetRef();
+				SlotHash.Config = ConfigIndex;
+				SlotHash.SlotTag = FFaerieSlotTag::ConvertChecked(Tag);
+			}
+		}
+	}
+
+	AddDependencies(AssetIndex);
+
+	for (int32 HashIndex = 0; HashIndex < State.Hashes.Num(); ++HashIndex)
+	{
+		UpdateSlotHash(AssetIndex, HashIndex);
+	}
+}
+
+void UFaerieEquipmentHashEvaluator::AddDependencies(const int32 AssetIndex)
+{
+	const UFaerieEquipmentManager* ManagerPtr = Manager.Get();
+	const TArray<FSlotHash>& Hashes = AssetStates[AssetIndex].Hashes;
+
+	for (int32 HashIndex = 0; HashIndex < Hashes.Num(); ++HashIndex)
+	{
+		const FFaerieSlotTag SlotTag = Hashes[HashIndex].SlotTag;
+		if (IsValid(ManagerPtr) && ManagerPtr->FindSlot(SlotTag, false))
+		{
+			SlotDependents.FindOrAdd(SlotTag).Add({AssetIndex, HashIndex});
+		}
+		else
+		{
+			NestedDependents.Add({AssetIndex, HashIndex});
+		}
+	}
+}
+
+void UFaerieEquipmentHashEvaluator::UpdateSlotHash(const int32 AssetIndex, const int32 HashIndex)
+{
+	FSlotHash& SlotHash = AssetStates[AssetIndex].Hashes[HashIndex];
+	SlotHash.Hash.Reset();
+
+	const UFaerieEquipmentManager* ManagerPtr = Manager.Get();
+	const UFaerieEquipmentHashAsset* Asset = Assets[AssetIndex];
+	if (!IsValid(ManagerPtr) || !IsValid(Asset))
+	{
+		return;
+	}
+
+	if (const UFaerieEquipmentSlot* Slot = ManagerPtr->FindSlot(SlotHash.SlotTag, true);
+		Slot && Slot->IsFilled())
+	{
+		SlotHash.Hash = Asset->HashConfig(SlotHash.Config, Slot->View());
+	}
+}
+
+void UFaerieEquipmentHashEvaluator::UpdateMatch(const int32 AssetIndex, const bool Broadcast)
+{
+	const UFaerieEquipmentHashAsset* Asset = Assets[AssetIndex];
+	FAssetState& State = AssetStates[AssetIndex];
+	if (!IsValid(Asset))
+	{
+		return;
+	}
+
+	// Combined in the same order as Faerie::Hash::ExecuteHashInstructions.
+	uint32 FinalHash = 0;
+	for (int32 i = 0; i < State.Hashes.Num(); ++i)
+	{
+		const FSlotHash& SlotHash = State.Hashes[i];
+		FinalHash = Faerie::Hash::Combine(FinalHash, SlotHash.Hash.Get(0));
+
+		// Configs that match any slot stop at the first filled one.
+		if (SlotHash.Hash.IsSet() && Asset->Configs[SlotHash.Config].MatchType == EGameplayContainerMatchType::Any)
+		{
+			while (i + 1 < State.Hashes.Num() && State.Hashes[i + 1].Config == SlotHash.Config)
+			{
+				++i;
+			}
+		}
+	}
+
+	const bool Matched = IsValid(Manager.Get()) && FinalHash == static_cast<uint32>(Asset->CheckHash);
+	if (Matched == State.Matched)
+	{
+		return;
+	}
+
+	State.Matched = Matched;
+
+	if (Broadcast)
+	{
+		OnMatchChangedNative.Broadcast(Asset, Matched);
+		OnMatchChanged.Broadcast(Asset, Matched);
+	}
+}
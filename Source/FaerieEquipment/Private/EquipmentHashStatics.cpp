@@ -39,8 +39,9 @@ namespace Faerie::Hash
 
 		uint32 FinalHash = 0;
 
-		for (auto&& Config : Asset->Configs)
+		for (int32 ConfigIndex = 0; ConfigIndex < Asset->Configs.Num(); ++ConfigIndex)
 		{
+			auto&& Config = Asset->Configs[ConfigIndex];
 			for (const FGameplayTag Tag : Config.Slots)
 			{
 				const FFaerieSlotTag SlotTag = FFaerieSlotTag::ConvertChecked(Tag);
@@ -51,7 +52,7 @@ namespace Faerie::Hash
 				{
 					if (Slot->IsFilled())
 					{
-						TagHash = Config.Instruction->Hash(Slot->View());
+						TagHash = Asset->HashConfig(ConfigIndex, Slot->View());
 
 						if (Config.MatchType == EGameplayContainerMatchType::Any)
 						{
@@ -70,8 +70,20 @@ UEquipmentVisualizer::UEquipmentVisualizer()
 	PrimaryComponentTick.bCanEverTick = false;
 }
 
+void UEquipmentVisualizer::BeginPlay()
+{
+	Super::BeginPlay();
+
+	for (const FEquipmentVisualPrewarm& Prewarm : PrewarmedVisuals)
+	{
+		PrewarmVisualPool(Prewarm.Class, Prewarm.Count);
+	}
+}
+
 void UEquipmentVisualizer::OnComponentDestroyed(const bool bDestroyingHierarchy)
 {
+	EmptyVisualPool();
+
 	for (auto&& Element : SpawnedActors)
 	{
 		if (IsValid(Element.Value))
@@ -208,18 +220,20 @@ AActor* UEquipmentVisualizer::SpawnVisualActor(const FFaerieVisualKey Key, const
 		return nullptr;
 	}
 
-	UWorld* World = GetWorld();
-	if (!IsValid(World))
+	AActor* NewActor = Cast<AActor>(AcquirePooledVisual(Class));
+	if (IsValid(NewActor))
 	{
-		return nullptr;
+		NewActor->SetActorHiddenInGame(false);
+		NewActor->SetActorEnableCollision(Class.GetDefaultObject()->GetActorEnableCollision());
+		NewActor->SetActorTickEnabled(NewActor->PrimaryActorTick.bStartWithTickEnabled);
 	}
-
-	FActorSpawnParameters Params;
-	Params.Owner = GetOwner();
-	if (AActor* NewActor = World->SpawnActor(Class, &FTransform::Identity, Params))
+	else
 	{
-		NewActor->OnDestroyed.AddDynamic(this, &ThisClass::OnVisualActorDestroyed);
+		NewActor = CreateVisualActor(Class);
+	}
 
+	if (IsValid(NewActor))
+	{
 		SpawnedActors.Add(Key, NewActor);
 		ReverseMap.Add(NewActor, Key);
 
@@ -252,12 +266,19 @@ USceneComponent* UEquipmentVisualizer::SpawnVisualComponent(const FFaerieVisualK
 		return nullptr;
 	}
 
-	if (USceneComponent* NewComponent = NewObject<USceneComponent>(GetOwner(), Class);
-		IsValid(NewComponent))
+	USceneComponent* NewComponent = Cast<USceneComponent>(AcquirePooledVisual(Class));
+	if (IsValid(NewComponent))
 	{
-		GetOwner()->AddInstanceComponent(NewComponent);
-		NewComponent->RegisterComponent();
+		NewComponent->SetVisibility(true, true);
+		NewComponent->SetComponentTickEnabled(NewComponent->PrimaryComponentTick.bStartWithTickEnabled);
+	}
+	else
+	{
+		NewComponent = CreateVisualComponent(Class);
+	}
 
+	if (IsValid(NewComponent))
+	{
 		SpawnedComponents.Add(Key, NewComponent);
 		ReverseMap.Add(NewComponent, Key);
 
@@ -286,7 +307,10 @@ bool UEquipmentVisualizer::DestroyVisual(UObject* Visual, const bool ClearMetada
 
 	if (AActor* VisualActor = Cast<AActor>(Visual))
 	{
-		VisualActor->Destroy();
+		if (!ReleaseToPool(VisualActor))
+		{
+			VisualActor->Destroy();
+		}
 		SpawnedActors.Remove(Key);
 
 		OnAnyVisualDestroyedNative.Broadcast(Key);
@@ -297,7 +321,10 @@ bool UEquipmentVisualizer::DestroyVisual(UObject* Visual, const bool ClearMetada
 
 	if (USceneComponent* VisualComponent = Cast<USceneComponent>(Visual))
 	{
-		VisualComponent->DestroyComponent();
+		if (!ReleaseToPool(VisualComponent))
+		{
+			VisualComponent->DestroyComponent();
+		}
 		SpawnedComponents.Remove(Key);
 
 		OnAnyVisualDestroyedNative.Broadcast(Key);
@@ -320,8 +347,12 @@ bool UEquipmentVisualizer::DestroyVisualByKey(const FFaerieVisualKey Key, const
 
 	if (AActor* Visual = GetSpawnedActorByKey(Key))
 	{
-		// This will clear from SpawnedActors and ReverseMap via OnDestroyed
-		Visual->Destroy();
+		// Pooled actors are only hidden and detached, so OnVisualActorDestroyed never runs for them. Untrack the visual
+		// here, whether it was pooled or destroyed.
+		if (!ReleaseToPool(Visual))
+		{
+			Visual->Destroy();
+		}
 		SpawnedActors.Remove(Key);
 
 		OnAnyVisualDestroyedNative.Broadcast(Key);
@@ -334,7 +365,10 @@ bool UEquipmentVisualizer::DestroyVisualByKey(const FFaerieVisualKey Key, const
 
 	if (USceneComponent* VisualComponent = GetSpawnedComponentByKey(Key))
 	{
-		VisualComponent->DestroyComponent();
+		if (!ReleaseToPool(VisualComponent))
+		{
+			VisualComponent->DestroyComponent();
+		}
 		SpawnedComponents.Remove(Key);
 
 		OnAnyVisualDestroyedNative.Broadcast(Key);
@@ -348,6 +382,65 @@ bool UEquipmentVisualizer::DestroyVisualByKey(const FFaerieVisualKey Key, const
 	return false;
 }
 
+void UEquipmentVisualizer::PrewarmVisualPool(const TSubclassOf<UObject> Class, const int32 Count)
+{
+	if (!IsValid(Class) || MaxPooledPerClass <= 0) return;
+
+	const int32 ToCreate = FMath::Min(Count, MaxPooledPerClass) - GetNumPooledVisuals(Class);
+	for (int32 i = 0; i < ToCreate; ++i)
+	{
+		UObject* Visual = nullptr;
+		if (Class->IsChildOf<AActor>())
+		{
+			Visual = CreateVisualActor(Class.Get());
+		}
+		else if (Class->IsChildOf<USceneComponent>())
+		{
+			Visual = CreateVisualComponent(Class.Get());
+		}
+
+		if (!IsValid(Visual) || !ReleaseToPool(Visual))
+		{
+			UE_LOG(LogFaerieEquipment, Warning, TEXT("Failed to prewarm visual of class '%s'!"), *Class->GetName())
+			return;
+		}
+	}
+}
+
+void UEquipmentVisualizer::EmptyVisualPool()
+{
+	// Move the pools out first, as destroying actors will call back into OnVisualActorDestroyed.
+	TMap<TObjectPtr<UClass>, FEquipmentVisualPool> Pools = MoveTemp(VisualPools);
+	VisualPools.Reset();
+
+	for (auto&& Pool : Pools)
+	{
+		for (auto&& Visual : Pool.Value.Visuals)
+		{
+			if (AActor* Actor = Cast<AActor>(Visual);
+				IsValid(Actor))
+			{
+				Actor->OnDestroyed.RemoveAll(this);
+				Actor->Destroy();
+			}
+			else if (USceneComponent* Component = Cast<USceneComponent>(Visual);
+				IsValid(Component))
+			{
+				Component->DestroyComponent();
+			}
+		}
+	}
+}
+
+int32 UEquipmentVisualizer::GetNumPooledVisuals(const UClass* Class) const
+{
+	if (const FEquipmentVisualPool* Pool = VisualPools.Find(Class))
+	{
+		return Pool->Visuals.Num();
+	}
+	return 0;
+}
+
 FEquipmentVisualAttachment UEquipmentVisualizer::FindAttachment(const FFaerieItemProxy Proxy) const
 {
 	const UVisualSlotExtension* SlotExtension;
@@ -513,8 +606,114 @@ FFaerieVisualKey UEquipmentVisualizer::MakeVisualKeyFromProxy(const TScriptInter
 	return { Proxy.GetInterface() };
 }
 
+AActor* UEquipmentVisualizer::CreateVisualActor(const TSubclassOf<AActor>& Class)
+{
+	UWorld* World = GetWorld();
+	if (!IsValid(World))
+	{
+		return nullptr;
+	}
+
+	FActorSpawnParameters Params;
+	Params.Owner = GetOwner();
+	if (AActor* NewActor = World->SpawnActor(Class, &FTransform::Identity, Params))
+	{
+		NewActor->OnDestroyed.AddDynamic(this, &ThisClass::OnVisualActorDestroyed);
+		return NewActor;
+	}
+
+	return nullptr;
+}
+
+USceneComponent* UEquipmentVisualizer::CreateVisualComponent(const TSubclassOf<USceneComponent>& Class)
+{
+	if (USceneComponent* NewComponent = NewObject<USceneComponent>(GetOwner(), Class);
+		IsValid(NewComponent))
+	{
+		GetOwner()->AddInstanceComponent(NewComponent);
+		NewComponent->RegisterComponent();
+		return NewComponent;
+	}
+
+	return nullptr;
+}
+
+UObject* UEquipmentVisualizer::AcquirePooledVisual(const UClass* Class)
+{
+	FEquipmentVisualPool* Pool = VisualPools.Find(Class);
+	if (!Pool)
+	{
+		return nullptr;
+	}
+
+	while (!Pool->Visuals.IsEmpty())
+	{
+		// Pooled visuals can still be destroyed externally, e.g., by a level transition.
+		if (UObject* Visual = Pool->Visuals.Pop(EAllowShrinking::No);
+			IsValid(Visual))
+		{
+			return Visual;
+		}
+	}
+
+	return nullptr;
+}
+
+bool UEquipmentVisualizer::ReleaseToPool(UObject* Visual)
+{
+	if (MaxPooledPerClass <= 0 || !IsValid(Visual))
+	{
+		return false;
+	}
+
+	// The pool is not kept across a teardown.
+	if (IsBeingDestroyed() || !IsValid(GetOwner()) || GetOwner()->IsActorBeingDestroyed())
+	{
+		return false;
+	}
+
+	FEquipmentVisualPool& Pool = VisualPools.FindOrAdd(Visual->GetClass());
+	if (Pool.Visuals.Num() >= MaxPooledPerClass)
+	{
+		return false;
+	}
+
+	if (AActor* Actor = Cast<AActor>(Visual))
+	{
+		if (Actor->IsActorBeingDestroyed())
+		{
+			return false;
+		}
+
+		Actor->DetachFromActor(FDetachmentTransformRules::KeepRelativeTransform);
+		Actor->SetActorRelativeTransform(FTransform::Identity);
+		Actor->SetActorHiddenInGame(true);
+		Actor->SetActorEnableCollision(false);
+		Actor->SetActorTickEnabled(false);
+	}
+	else if (USceneComponent* Component = Cast<USceneComponent>(Visual))
+	{
+		Component->DetachFromComponent(FDetachmentTransformRules::KeepRelativeTransform);
+		Component->SetRelativeTransform(FTransform::Identity);
+		Component->SetVisibility(false, true);
+		Component->SetComponentTickEnabled(false);
+	}
+	else
+	{
+		return false;
+	}
+
+	Pool.Visuals.Add(Visual);
+	return true;
+}
+
 void UEquipmentVisualizer::OnVisualActorDestroyed(AActor* DestroyedActor)
 {
+	if (FEquipmentVisualPool* Pool = VisualPools.Find(DestroyedActor->GetClass()))
+	{
+		Pool->Visuals.RemoveSingleSwap(DestroyedActor);
+	}
+
 	if (const FFaerieVisualKey* Key = ReverseMap.Find(DestroyedActor))
 	{
 		SpawnedActors.Remove(*Key);
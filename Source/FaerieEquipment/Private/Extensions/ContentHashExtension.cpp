@@ -1,15 +1,41 @@
 ﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
 
 #include "Extensions/ContentHashExtension.h"
-#include "FaerieInventoryHashStatics.h"
+#include "FaerieContainerIterator.h"
+#include "FaerieHashStatics.h"
+#include "FaerieItem.h"
 #include "FaerieItemContainerBase.h"
+#include "ItemContainerEvent.h"
+#include "Algo/BinarySearch.h"
 #include "GameFramework/Actor.h"
 #include "Net/UnrealNetwork.h"
 #include "Net/Core/PushModel/PushModel.h"
-#include "TypeCastingUtils.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(ContentHashExtension)
 
+
+void UContentHashExtension::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	// TreeWidth is only valid once properties have been initialized.
+	LocalTree = Faerie::Hash::FHashTree(TreeWidth);
+	ServerTree = Faerie::Hash::FHashTree(TreeWidth);
+
+	if (!HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject))
+	{
+		PostGarbageCollectHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddUObject(this, &ThisClass::PruneItemHashCache);
+	}
+}
+
+void UContentHashExtension::BeginDestroy()
+{
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGarbageCollectHandle);
+	ItemHashCache.Empty();
+
+	Super::BeginDestroy();
+}
+
 void UContentHashExtension::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
@@ -17,58 +43,239 @@ void UContentHashExtension::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>
 	FDoRepLifetimeParams Params;
 	Params.bIsPushBased = true;
 	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, ServerChecksum, Params)
+	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, ServerContainerHashes, Params)
 }
 
 void UContentHashExtension::InitializeExtension(const UFaerieItemContainerBase* Container)
 {
-	RecalcContainerHash(Container);
+	RebuildContainerTree(FindOrAddState(Container));
+	RecalcLocalChecksum();
 }
 
 void UContentHashExtension::DeinitializeExtension(const UFaerieItemContainerBase* Container)
 {
-	PerContainerHash.Remove(Container);
-	RecalcLocalChecksum();
+	FContainerHashState State;
+	if (PerContainerState.RemoveAndCopyValue(Container, State))
+	{
+		RemoveContainerLeaf(State.ContainerID);
+		RecalcLocalChecksum();
+	}
+
+	if (PerContainerState.IsEmpty())
+	{
+		ItemHashCache.Empty();
+	}
+	else if (IsValid(Container))
+	{
+		for (const UFaerieItem* Item : Faerie::Container::ItemRange(Container))
+		{
+			ItemHashCache.Remove(Item);
+		}
+	}
 }
 
 void UContentHashExtension::LoadSaveData(const UFaerieItemContainerBase* Container, const FInstancedStruct&)
 {
-	RecalcContainerHash(Container);
+	RebuildContainerTree(FindOrAddState(Container));
+	RecalcLocalChecksum();
+}
+
+void UContentHashExtension::PostRemoval(const UFaerieItemContainerBase* Container, const Faerie::Inventory::FEventLog& Event)
+{
+	UpdateEntryLeaf(Container, Event);
+
+	// The item has left the container. If it is still in another one, it will be hashed again when next seen.
+	if (Event.Success && !Container->Contains(Event.EntryTouched))
+	{
+		ItemHashCache.Remove(Event.Item.Get());
+	}
 }
 
-void UContentHashExtension::PostRemoval(const UFaerieItemContainerBase* Container, const Faerie::Inventory::FEventLog&)
+void UContentHashExtension::PostEntryChanged(const UFaerieItemContainerBase* Container, const Faerie::Inventory::FEventLog& Event)
 {
-	RecalcContainerHash(Container);
+	UpdateEntryLeaf(Container, Event);
 }
 
-void UContentHashExtension::PostEntryChanged(const UFaerieItemContainerBase* Container, const Faerie::Inventory::FEventLog&)
+void UContentHashExtension::PostAddition(const UFaerieItemContainerBase* Container, const Faerie::Inventory::FEventLog& Event)
 {
-	RecalcContainerHash(Container);
+	UpdateEntryLeaf(Container, Event);
 }
 
-void UContentHashExtension::PostAddition(const UFaerieItemContainerBase* Container, const Faerie::Inventory::FEventLog&)
+uint32 UContentHashExtension::MakeContainerID(const UFaerieItemContainerBase* Container)
 {
-	RecalcContainerHash(Container);
+	// Names and slot IDs are not unique across nested containers, so servers hand out IDs, and replicate them alongside
+	// each container.
+	if (GetTypedOuter<AActor>()->GetNetMode() < NM_Client)
+	{
+		return NextContainerID++;
+	}
+
+	for (const FFaerieContainerHashLeaf& Leaf : ServerContainerHashes)
+	{
+		if (Leaf.Container == Container)
+		{
+			return Leaf.ContainerID;
+		}
+	}
+
+	// Not replicated yet. OnRep_ServerContainerHashes will assign it.
+	return 0;
+}
+
+uint32 UContentHashExtension::HashItem(const UFaerieItem* Item)
+{
+	if (!IsValid(Item))
+	{
+		return 0;
+	}
+
+	// Mutable items can change their hash at any time, so they are always rehashed.
+	if (Item->CanMutate())
+	{
+		return Faerie::Hash::HashItemByName(Item);
+	}
+
+	if (const uint32* CachedHash = ItemHashCache.Find(Item))
+	{
+		return *CachedHash;
+	}
+
+	return ItemHashCache.Add(Item, Faerie::Hash::HashItemByName(Item));
+}
+
+void UContentHashExtension::PruneItemHashCache()
+{
+	for (auto It = ItemHashCache.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().ResolveObjectPtr())
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+UContentHashExtension::FContainerHashState& UContentHashExtension::FindOrAddState(const UFaerieItemContainerBase* Container)
+{
+	if (FContainerHashState* Existing = PerContainerState.Find(Container))
+	{
+		return *Existing;
+	}
+
+	FContainerHashState& State = PerContainerState.Add(Container);
+	State.Container = Container;
+	State.ContainerID = MakeContainerID(Container);
+	State.EntryTree = Faerie::Hash::FHashTree(TreeWidth);
+	return State;
+}
+
+void UContentHashExtension::RebuildContainerTree(FContainerHashState& State)
+{
+	State.EntryTree.Reset();
+
+	if (const UFaerieItemContainerBase* Container = State.Container.Get())
+	{
+		for (const FEntryKey Key : Faerie::Container::KeyRange(Container))
+		{
+			State.EntryTree.SetLeaf(Key.Value(), HashItem(Container->View(Key).Item.Get()));
+		}
+	}
+
+	UpdateContainerLeaf(State);
 }
 
-void UContentHashExtension::RecalcContainerHash(const UFaerieItemContainerBase* Container)
+void UContentHashExtension::UpdateEntryLeaf(const UFaerieItemContainerBase* Container, const Faerie::Inventory::FEventLog& Event)
 {
-	FFaerieHash& Hash = PerContainerHash.FindOrAdd(Container);
-	Hash = Faerie::Hash::HashContainer(Container, &Faerie::Hash::HashItemByName);
+	if (!Event.Success)
+	{
+		return;
+	}
+
+	FContainerHashState& State = FindOrAddState(Container);
+
+	// Only the touched entry is rehashed, rather than the whole container.
+	if (Container->Contains(Event.EntryTouched))
+	{
+		State.EntryTree.SetLeaf(Event.EntryTouched.Value(), HashItem(Event.Item.Get()));
+	}
+	else
+	{
+		State.EntryTree.RemoveLeaf(Event.EntryTouched.Value());
+	}
+
+	UpdateContainerLeaf(State);
 	RecalcLocalChecksum();
 }
 
-void UContentHashExtension::RecalcLocalChecksum()
+void UContentHashExtension::UpdateContainerLeaf(const FContainerHashState& State)
 {
-	TArray<uint32> Hashes;
-	PerContainerHash.GenerateValueArray(*Type::Cast<TArray<FFaerieHash>*>(&Hashes));
+	// Clients can't place a container in the tree until they know the server's ID for it.
+	if (State.ContainerID == 0)
+	{
+		return;
+	}
 
-	LocalChecksum = Faerie::Hash::CombineHashes(Hashes);
+	// Empty containers are left out of the tree, so that empty containers existing on only one side don't cause a mismatch.
+	if (State.EntryTree.NumLeaves() == 0)
+	{
+		RemoveContainerLeaf(State.ContainerID);
+		return;
+	}
+
+	const FFaerieHash ContainerHash = State.EntryTree.GetRoot();
+	LocalTree.SetLeaf(State.ContainerID, ContainerHash.Hash);
+
+	if (GetTypedOuter<AActor>()->GetNetMode() < NM_Client)
+	{
+		const int32 Index = Algo::LowerBoundBy(ServerContainerHashes, State.ContainerID, &FFaerieContainerHashLeaf::ContainerID);
+		if (ServerContainerHashes.IsValidIndex(Index) &&
+			ServerContainerHashes[Index].ContainerID == State.ContainerID)
+		{
+			if (ServerContainerHashes[Index].Hash == ContainerHash)
+			{
+				return;
+			}
+			ServerContainerHashes[Index].Hash = ContainerHash;
+		}
+		else
+		{
+			ServerContainerHashes.Insert({ State.ContainerID, State.Container, ContainerHash }, Index);
+		}
+		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, ServerContainerHashes, this);
+	}
+}
+
+void UContentHashExtension::RemoveContainerLeaf(const uint32 ContainerID)
+{
+	if (ContainerID == 0)
+	{
+		return;
+	}
+
+	LocalTree.RemoveLeaf(ContainerID);
+
+	if (GetTypedOuter<AActor>()->GetNetMode() < NM_Client)
+	{
+		if (const int32 Index = Algo::BinarySearchBy(ServerContainerHashes, ContainerID, &FFaerieContainerHashLeaf::ContainerID);
+			Index != INDEX_NONE)
+		{
+			ServerContainerHashes.RemoveAt(Index);
+			MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, ServerContainerHashes, this);
+		}
+	}
+}
+
+void UContentHashExtension::RecalcLocalChecksum()
+{
+	LocalChecksum = LocalTree.GetRoot();
 
 	if (GetTypedOuter<AActor>()->GetNetMode() < NM_Client)
 	{
 		// If we are not a client, update and push the server's checksum
-		ServerChecksum = LocalChecksum;
-		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, ServerChecksum, this);
+		if (ServerChecksum != LocalChecksum)
+		{
+			ServerChecksum = LocalChecksum;
+			MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, ServerChecksum, this);
+		}
 	}
 	else
 	{
@@ -82,6 +289,16 @@ void UContentHashExtension::CheckLocalChecksum()
 	const bool OldChecksumsMatch = ChecksumsMatch;
 	ChecksumsMatch = LocalChecksum == ServerChecksum;
 
+	if (ChecksumsMatch)
+	{
+		DesynchronizedContainerIDs.Reset();
+	}
+	else
+	{
+		ResyncDivergentContainers();
+		ChecksumsMatch = LocalChecksum == ServerChecksum;
+	}
+
 	if (OldChecksumsMatch != ChecksumsMatch)
 	{
 		const EFaerieChecksumClientState BroadcastState = ChecksumsMatch ?
@@ -92,7 +309,69 @@ void UContentHashExtension::CheckLocalChecksum()
 	}
 }
 
+void UContentHashExtension::ResyncDivergentContainers()
+{
+	DesynchronizedContainerIDs.Reset();
+	LocalTree.Diff(ServerTree, DesynchronizedContainerIDs);
+
+	if (DesynchronizedContainerIDs.IsEmpty())
+	{
+		return;
+	}
+
+	// Only rehash containers that differ. Their content may have replicated since they were last hashed.
+	for (auto&& Pair : PerContainerState)
+	{
+		if (DesynchronizedContainerIDs.Contains(Pair.Value.ContainerID))
+		{
+			RebuildContainerTree(Pair.Value);
+		}
+	}
+
+	LocalChecksum = LocalTree.GetRoot();
+
+	DesynchronizedContainerIDs.Reset();
+	LocalTree.Diff(ServerTree, DesynchronizedContainerIDs);
+}
+
+TArray<const UFaerieItemContainerBase*> UContentHashExtension::GetDesynchronizedContainers() const
+{
+	TArray<const UFaerieItemContainerBase*> Out;
+	for (auto&& Pair : PerContainerState)
+	{
+		if (DesynchronizedContainerIDs.Contains(Pair.Value.ContainerID))
+		{
+			if (const UFaerieItemContainerBase* Container = Pair.Value.Container.Get())
+			{
+				Out.Add(Container);
+			}
+		}
+	}
+	return Out;
+}
+
 void UContentHashExtension::OnRep_ServerChecksum()
 {
 	CheckLocalChecksum();
-}
\ No newline at end of file
+}
+
+void UContentHashExtension::OnRep_ServerContainerHashes()
+{
+	ServerTree.Reset();
+	for (const FFaerieContainerHashLeaf& Leaf : ServerContainerHashes)
+	{
+		ServerTree.SetLeaf(Leaf.ContainerID, Leaf.Hash.Hash);
+
+		// Adopt the server's ID for containers that we are already tracking.
+		if (FContainerHashState* State = PerContainerState.Find(Leaf.Container.Get());
+			State && State->ContainerID != Leaf.ContainerID)
+		{
+			RemoveContainerLeaf(State->ContainerID);
+			State->ContainerID = Leaf.ContainerID;
+			UpdateContainerLeaf(*State);
+		}
+	}
+
+	LocalChecksum = LocalTree.GetRoot();
+	CheckLocalChecksum();
+}
@@ -48,6 +48,23 @@ void UEquipmentVisualizationUpdater::DeinitializeExtension(const UFaerieItemCont
 	}
 }
 
+void UEquipmentVisualizationUpdater::RestoreTransactionSnapshot(const UFaerieItemContainerBase* Container,
+																const FInstancedStruct& Snapshot)
+{
+	Super::RestoreTransactionSnapshot(Container, Snapshot);
+
+	// PreRemoval runs during transactions, so a visual removed by one that rolled back must be made again.
+	if (const UFaerieEquipmentSlot* Slot = Cast<UFaerieEquipmentSlot>(Container);
+		IsValid(Slot) && Slot->IsFilled())
+	{
+		if (auto&& Visualizer = GetVisualizer(Slot);
+			IsValid(Visualizer) && !Visualizer->HasVisualForKey({Slot}))
+		{
+			CreateVisualImpl(Visualizer, Slot);
+		}
+	}
+}
+
 void UEquipmentVisualizationUpdater::PostAddition(const UFaerieItemContainerBase* Container,
 												  const Faerie::Inventory::FEventLog& Event)
 {
@@ -319,6 +336,29 @@ void UEquipmentVisualizationUpdater::CreateVisualImpl(UEquipmentVisualizer* Visu
 void UEquipmentVisualizationUpdater::RemoveVisualImpl(UEquipmentVisualizer* Visualizer, const FFaerieItemProxy Proxy)
 {
 	check(Visualizer);
+
+	// Reset the visual before handing it back, as the visualizer may pool it for reuse by another item.
+	if (UObject* Visual = Visualizer->GetSpawnedVisualByKey({Proxy}))
+	{
+		if (AFaerieProxyActorBase* VisualActor = Cast<AFaerieProxyActorBase>(Visual))
+		{
+			VisualActor->GetOnDisplayFinished().RemoveAll(this);
+			VisualActor->SetSourceProxy(nullptr);
+		}
+		else if (UFaerieItemMeshComponent* VisualComponent = Cast<UFaerieItemMeshComponent>(Visual))
+		{
+			VisualComponent->GetOnMeshRebuilt().RemoveAll(this);
+			VisualComponent->SetSkeletalMeshLeaderPoseComponent(nullptr);
+			VisualComponent->ClearItemMesh();
+		}
+	}
+
+	// Drop any attachment still waiting on this visual, so that a recycled visual won't resolve it.
+	Pending.RemoveAllSwap([&Proxy](const FPendingAttachment& Attachment)
+		{
+			return Attachment.Proxy == Proxy;
+		});
+
 	Visualizer->DestroyVisualByKey({Proxy});
 
 	// Recurse over children
@@ -1,6 +1,7 @@
 ﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
 
 #include "FaerieEquipmentManager.h"
+#include "FaerieDataSystemTrace.h"
 #include "FaerieEquipmentLog.h"
 #include "FaerieEquipmentSlot.h"
 #include "FaerieItemStorage.h"
@@ -402,7 +403,7 @@ bool UFaerieEquipmentManager::RemoveExtensionFromSlot(const FFaerieSlotTag SlotI
 
 TArray<FFaerieItemContainerPath> UFaerieEquipmentManager::GetAllContainerPaths() const
 {
-	SCOPE_CYCLE_COUNTER(STAT_Equipment_BuildPaths);
+	FAERIE_SCOPE_CYCLE_COUNTER(STAT_Equipment_BuildPaths);
 
 	TArray<FFaerieItemContainerPath> OutPaths;
 	OutPaths.Reserve(Slots.Num());
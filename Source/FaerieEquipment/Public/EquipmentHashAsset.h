@@ -2,6 +2,8 @@
 
 #pragma once
 
+#include "FaerieItemStackHashProgram.h"
+#include "FaerieItemStackView.h"
 #include "GameplayTagContainer.h"
 #include "Engine/DataAsset.h"
 #include "EquipmentHashAsset.generated.h"
@@ -29,6 +31,9 @@ struct FFaerieEquipmentHashAssetConfig
 	UPROPERTY(EditAnywhere, Category = "EquipmentHashInstruction")
 	TArray<TObjectPtr<class UFaerieItemAsset>> Example;
 #endif
+
+	// Instruction, compiled the first time it's used. Reset when the asset is edited.
+	mutable Faerie::Hash::FHashProgram Program;
 };
 
 /**
@@ -40,7 +45,14 @@ class FAERIEEQUIPMENT_API UFaerieEquipmentHashAsset : public UDataAsset
 	GENERATED_BODY()
 
 public:
+	virtual void PostLoad() override;
 	virtual void PreSave(FObjectPreSaveContext SaveContext) override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	// Hash a stack with the instruction of a config. Same result as Instruction->Hash, but runs the compiled program.
+	uint32 HashConfig(int32 ConfigIndex, FFaerieItemStackView StackView) const;
 
 	UPROPERTY(EditInstanceOnly, Category = "EquipmentHashAsset")
 	TArray<FFaerieEquipmentHashAssetConfig> Configs;
@@ -0,0 +1,110 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "FaerieInventoryTag.h"
+#include "FaerieSlotTag.h"
+#include "UObject/Object.h"
+#include "EquipmentHashEvaluator.generated.h"
+
+class UFaerieEquipmentHashAsset;
+class UFaerieEquipmentManager;
+class UFaerieEquipmentSlot;
+
+namespace Faerie
+{
+	using FEquipmentHashMatchEvent = TMulticastDelegate<void(const UFaerieEquipmentHashAsset*, bool)>;
+}
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FFaerieEquipmentHashMatchEvent, const UFaerieEquipmentHashAsset*, Asset, bool, Matched);
+
+/**
+ * Keeps the result of ExecuteHashInstructions for a set of hash assets up to date, as the equipment in a manager changes.
+ * The hash of each slot read by an asset is cached, and when a slot changes, only the assets that read it are
+ * evaluated again, and only the hashes for that slot are recomputed. Slots nested in other slots can't be tracked
+ * individually, so assets that read them are evaluated again after any change.
+ */
+UCLASS(BlueprintType)
+class FAERIEEQUIPMENT_API UFaerieEquipmentHashEvaluator : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	//~ UObject
+	virtual void BeginDestroy() override;
+	//~ UObject
+
+	UFUNCTION(BlueprintCallable, Category = "Faerie|EquipmentHashing")
+	void SetManager(UFaerieEquipmentManager* InManager);
+
+	UFUNCTION(BlueprintCallable, Category = "Faerie|EquipmentHashing")
+	UFaerieEquipmentManager* GetManager() const { return Manager.Get(); }
+
+	// Start tracking an asset. It is evaluated immediately, but doesn't broadcast until its match state changes.
+	UFUNCTION(BlueprintCallable, Category = "Faerie|EquipmentHashing")
+	void RegisterAsset(const UFaerieEquipmentHashAsset* Asset);
+
+	UFUNCTION(BlueprintCallable, Category = "Faerie|EquipmentHashing")
+	void UnregisterAsset(const UFaerieEquipmentHashAsset* Asset);
+
+	// Does the equipment currently match this asset? Always false for assets that aren't registered.
+	UFUNCTION(BlueprintCallable, Category = "Faerie|EquipmentHashing")
+	bool IsMatched(const UFaerieEquipmentHashAsset* Asset) const;
+
+	// Evaluate every asset from scratch.
+	UFUNCTION(BlueprintCallable, Category = "Faerie|EquipmentHashing")
+	void Refresh();
+
+	Faerie::FEquipmentHashMatchEvent::RegistrationType& GetOnMatchChanged() { return OnMatchChangedNative; }
+
+protected:
+	void OnSlotEvent(UFaerieEquipmentSlot* Slot, FFaerieInventoryTag Event);
+
+	// Build an asset's slot hashes from its configs, and hash them all.
+	void BindAsset(int32 AssetIndex);
+
+	// Record which slots an asset's hashes are read from.
+	void AddDependencies(int32 AssetIndex);
+
+	// Recompute the hash read from a slot.
+	void UpdateSlotHash(int32 AssetIndex, int32 HashIndex);
+
+	// Combine an asset's slot hashes, and broadcast if that changed whether it matches.
+	void UpdateMatch(int32 AssetIndex, bool Broadcast);
+
+	UPROPERTY(BlueprintAssignable, Transient, Category = "Events")
+	FFaerieEquipmentHashMatchEvent OnMatchChanged;
+
+private:
+	Faerie::FEquipmentHashMatchEvent OnMatchChangedNative;
+
+	struct FSlotHash
+	{
+		int32 Config = 0;
+		FFaerieSlotTag SlotTag;
+
+		// Unset while the slot is empty, or doesn't exist.
+		TOptional<uint32> Hash;
+	};
+
+	struct FAssetState
+	{
+		// One for each tag of each config, in the order they are combined.
+		TArray<FSlotHash> Hashes;
+		bool Matched = false;
+	};
+
+	TWeakObjectPtr<UFaerieEquipmentManager> Manager;
+
+	UPROPERTY()
+	TArray<TObjectPtr<const UFaerieEquipmentHashAsset>> Assets;
+
+	// Parallel to Assets.
+	TArray<FAssetState> AssetStates;
+
+	// The assets, and their hash index, that read each top-level slot.
+	TMap<FFaerieSlotTag, TArray<TPair<int32, int32>>> SlotDependents;
+
+	// The assets, and their hash index, that read a slot which isn't top-level. These are updated after every change.
+	TArray<TPair<int32, int32>> NestedDependents;
+};
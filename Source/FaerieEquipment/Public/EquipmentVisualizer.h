@@ -69,6 +69,29 @@ struct FEquipmentVisualMetadata
 	FEquipmentVisualizerEvent ChangeCallback;
 };
 
+// Visuals of a single class that have been released, and are waiting to be reused.
+USTRUCT()
+struct FEquipmentVisualPool
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<TObjectPtr<UObject>> Visuals;
+};
+
+USTRUCT(BlueprintType)
+struct FEquipmentVisualPrewarm
+{
+	GENERATED_BODY()
+
+	// Actor or SceneComponent class to create ahead of time.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "EquipmentVisualPrewarm", meta = (AllowedClasses = "/Script/Engine.Actor,/Script/Engine.SceneComponent"))
+	TSubclassOf<UObject> Class;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "EquipmentVisualPrewarm", meta = (ClampMin = 1))
+	int32 Count = 1;
+};
+
 namespace Faerie::Equipment
 {
 	using FVisualSpawned = TMulticastDelegate<void(FFaerieVisualKey, UObject*)>;
@@ -91,6 +114,7 @@ public:
 	UEquipmentVisualizer();
 
 	//~ UActorComponent
+	virtual void BeginPlay() override;
 	virtual void OnComponentDestroyed(bool bDestroyingHierarchy) override;
 	//~ UActorComponent
 
@@ -151,12 +175,25 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Faerie|EquipmentVisualizer", meta = (AutoCreateRefTerm = "Attachment", DeterminesOutputType = "Class"))
 	USceneComponent* SpawnVisualComponent(FFaerieVisualKey Key, const TSubclassOf<USceneComponent>& Class, const FEquipmentVisualAttachment& Attachment);
 
+	// Remove a visual. If pooling is enabled, and the pool for its class isn't full, the visual is hidden and kept for reuse
+	// instead of being destroyed.
 	UFUNCTION(BlueprintCallable, Category = "Faerie|EquipmentVisualizer")
 	bool DestroyVisual(UObject* Visual, bool ClearMetadata = false);
 
 	UFUNCTION(BlueprintCallable, Category = "Faerie|EquipmentVisualizer")
 	bool DestroyVisualByKey(FFaerieVisualKey Key, bool ClearMetadata = false);
 
+	// Create visuals of a class ahead of time, so that spawning them later doesn't need to. Only up to MaxPooledPerClass
+	// will be kept.
+	UFUNCTION(BlueprintCallable, Category = "Faerie|EquipmentVisualizer", meta = (AllowedClasses = "/Script/Engine.Actor,/Script/Engine.SceneComponent"))
+	void PrewarmVisualPool(TSubclassOf<UObject> Class, int32 Count);
+
+	// Destroy all visuals waiting in the pool.
+	UFUNCTION(BlueprintCallable, Category = "Faerie|EquipmentVisualizer")
+	void EmptyVisualPool();
+
+	int32 GetNumPooledVisuals(const UClass* Class) const;
+
 	// Determine how a visual should attach
 	UFUNCTION(BlueprintCallable, Category = "Faerie|EquipmentVisualizer")
 	FEquipmentVisualAttachment FindAttachment(const FFaerieItemProxy Proxy) const;
@@ -181,6 +218,15 @@ public:
 	static FFaerieVisualKey MakeVisualKeyFromProxy(const TScriptInterface<IFaerieItemDataProxy>& Proxy);
 
 protected:
+	AActor* CreateVisualActor(const TSubclassOf<AActor>& Class);
+	USceneComponent* CreateVisualComponent(const TSubclassOf<USceneComponent>& Class);
+
+	// Take a visual of exactly this class out of the pool, if there is one.
+	UObject* AcquirePooledVisual(const UClass* Class);
+
+	// Try to hide and store a visual for reuse. Returns false if it should be destroyed instead.
+	bool ReleaseToPool(UObject* Visual);
+
 	UFUNCTION(/* Dynamic Callback */)
 	virtual void OnVisualActorDestroyed(AActor* DestroyedActor);
 
@@ -202,6 +248,15 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Config")
 	FComponentReference LeaderPoseComponent;
 
+	// How many released visuals of each class are kept around to be reused, instead of destroying them and spawning new
+	// ones the next time an item of that class is equipped. Zero disables pooling.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Pooling", meta = (ClampMin = 0))
+	int32 MaxPooledPerClass = 0;
+
+	// Visuals to create when play begins, so that the first equips don't have to spawn them.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Pooling", meta = (EditCondition = "MaxPooledPerClass > 0"))
+	TArray<FEquipmentVisualPrewarm> PrewarmedVisuals;
+
 	UPROPERTY()
 	TMap<FFaerieVisualKey, TObjectPtr<AActor>> SpawnedActors;
 
@@ -212,6 +267,10 @@ protected:
 	UPROPERTY()
 	TMap<FFaerieVisualKey, FEquipmentVisualMetadata> KeyedMetadata;
 
+	// Released visuals, keyed by their exact class.
+	UPROPERTY()
+	TMap<TObjectPtr<UClass>, FEquipmentVisualPool> VisualPools;
+
 private:
 	Faerie::Equipment::FVisualSpawned OnAnyVisualSpawnedNative;
 	Faerie::Equipment::FVisualDestroyed OnAnyVisualDestroyedNative;
@@ -3,11 +3,13 @@
 #pragma once
 
 #include "FaerieHash.h"
+#include "FaerieHashTree.h"
 #include "ItemContainerExtensionBase.h"
 #include "UObject/ObjectKey.h"
 #include "ContentHashExtension.generated.h"
 
 class UFaerieItemContainerBase;
+class UFaerieItem;
 
 UENUM(BlueprintType)
 enum class EFaerieChecksumClientState : uint8
@@ -16,11 +18,33 @@ enum class EFaerieChecksumClientState : uint8
 	Synchronized
 };
 
+/*
+ * The replicated hash of a single container tracked by a UContentHashExtension.
+ */
+USTRUCT()
+struct FFaerieContainerHashLeaf
+{
+	GENERATED_BODY()
+
+	// Identifier assigned to the container by the server. Unique per extension, and never reused.
+	UPROPERTY()
+	uint32 ContainerID = 0;
+
+	// The container this leaf hashes, so that clients can adopt the server's ID for it.
+	UPROPERTY()
+	TWeakObjectPtr<const UFaerieItemContainerBase> Container;
+
+	UPROPERTY()
+	FFaerieHash Hash;
+};
+
 using FFaerieClientChecksumEventNative = TMulticastDelegate<void(EFaerieChecksumClientState)>;
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FFaerieClientChecksumEvent, EFaerieChecksumClientState, State);
 
 /**
  * An item container extension that hashes the contents of initialized containers, and replicates the result.
+ * Hashes are maintained incrementally. Each container keeps a hash tree of its entries, and the root of each container
+ * is a leaf in a second tree, whose root is the checksum. A change to one entry only rehashes that entry's path.
  */
 // @todo move this out of Equipment module
 UCLASS()
@@ -30,6 +54,8 @@ class FAERIEEQUIPMENT_API UContentHashExtension : public UItemContainerExtension
 
 public:
 	//~ UObject
+	virtual void PostInitProperties() override;
+	virtual void BeginDestroy() override;
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 	//~ UObject
 
@@ -43,14 +69,50 @@ public:
 	//~ UItemContainerExtensionBase
 
 protected:
-	void RecalcContainerHash(const UFaerieItemContainerBase* Container);
+	struct FContainerHashState
+	{
+		TWeakObjectPtr<const UFaerieItemContainerBase> Container;
+
+		// Zero on clients until the server's leaf for this container has replicated.
+		uint32 ContainerID = 0;
+
+		Faerie::Hash::FHashTree EntryTree;
+	};
+
+	// Servers assign a new ID to each container. Clients look up the ID the server assigned, if it has replicated yet.
+	uint32 MakeContainerID(const UFaerieItemContainerBase* Container);
+
+	// Hash an item, using the cache for immutable items.
+	uint32 HashItem(const UFaerieItem* Item);
+
+	// Drop cached hashes for items that have been garbage collected.
+	void PruneItemHashCache();
+
+	FContainerHashState& FindOrAddState(const UFaerieItemContainerBase* Container);
+
+	// Rehash every entry in a container. Used on initialization, load, and client resync.
+	void RebuildContainerTree(FContainerHashState& State);
+
+	// Rehash only the entry touched by an event.
+	void UpdateEntryLeaf(const UFaerieItemContainerBase* Container, const Faerie::Inventory::FEventLog& Event);
+
+	// Push the root of a container's entry tree into the container tree.
+	void UpdateContainerLeaf(const FContainerHashState& State);
+	void RemoveContainerLeaf(uint32 ContainerID);
+
 	void RecalcLocalChecksum();
 
 	void CheckLocalChecksum();
 
+	// Rehash only the containers whose hash differs from the server's.
+	void ResyncDivergentContainers();
+
 	UFUNCTION(/* Replication */)
 	void OnRep_ServerChecksum();
 
+	UFUNCTION(/* Replication */)
+	void OnRep_ServerContainerHashes();
+
 public:
 	UFUNCTION(BlueprintCallable, Category = "Faerie|ContentHashExtension")
 	FFaerieHash GetLocalChecksum() const { return LocalChecksum; }
@@ -58,12 +120,20 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Faerie|ContentHashExtension")
 	FFaerieHash GetServerChecksum() const { return ServerChecksum; }
 
+	// Get the containers that are currently known to differ from the server. Only valid on clients.
+	TArray<const UFaerieItemContainerBase*> GetDesynchronizedContainers() const;
+
 	FFaerieClientChecksumEventNative::RegistrationType& GetOnClientChecksumEvent() { return OnClientChecksumEventNative; }
 
 protected:
 	UPROPERTY(BlueprintAssignable, Transient, Category = "Events")
 	FFaerieClientChecksumEvent OnClientChecksumEvent;
 
+	// Log2 of the number of buckets in each hash tree. Wider trees make each update cheaper for large containers, at the
+	// cost of memory. Must match between client and server, which it will, unless changed at runtime.
+	UPROPERTY(EditAnywhere, Category = "ContentHash", meta = (ClampMin = 0, ClampMax = 8))
+	int32 TreeWidth = 4;
+
 private:
 	FFaerieClientChecksumEventNative OnClientChecksumEventNative;
 
@@ -77,8 +147,31 @@ private:
 	// current equipment state.
 	FFaerieHash LocalChecksum;
 
+	// The hash of each container, sorted by ContainerID. Replicated so that clients can find which containers diverge
+	// when checksums don't match.
+	UPROPERTY(ReplicatedUsing = "OnRep_ServerContainerHashes")
+	TArray<FFaerieContainerHashLeaf> ServerContainerHashes;
+
 	// Are our checksums known to currently match.
 	bool ChecksumsMatch = true;
 
-	TMap<FObjectKey, FFaerieHash> PerContainerHash;
+	TMap<FObjectKey, FContainerHashState> PerContainerState;
+
+	// Servers only: The ID to give the next container.
+	uint32 NextContainerID = 1;
+
+	// Tree of each container's root hash. The root of this tree is the LocalChecksum.
+	Faerie::Hash::FHashTree LocalTree;
+
+	// Clients only: Tree rebuilt from ServerContainerHashes, used to diff against LocalTree.
+	Faerie::Hash::FHashTree ServerTree;
+
+	// Clients only: Containers that still differed after the last resync.
+	TArray<uint32> DesynchronizedContainerIDs;
+
+	// Cached hashes for immutable items. Their hash can never change, so these are only removed when an item leaves a
+	// container, or is garbage collected.
+	TMap<FObjectKey, uint32> ItemHashCache;
+
+	FDelegateHandle PostGarbageCollectHandle;
 };
\ No newline at end of file
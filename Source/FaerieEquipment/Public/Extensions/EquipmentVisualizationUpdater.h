@@ -19,6 +19,7 @@ class FAERIEEQUIPMENT_API UEquipmentVisualizationUpdater : public UItemContainer
 protected:
 	virtual void InitializeExtension(const UFaerieItemContainerBase* Container) override;
 	virtual void DeinitializeExtension(const UFaerieItemContainerBase* Container) override;
+	virtual void RestoreTransactionSnapshot(const UFaerieItemContainerBase* Container, const FInstancedStruct& Snapshot) override;
 
 	virtual void PostAddition(const UFaerieItemContainerBase* Container, const Faerie::Inventory::FEventLog& Event) override;
 	virtual void PreRemoval(const UFaerieItemContainerBase* Container, FEntryKey Key, int32 Removal) override;
@@ -0,0 +1,213 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "Actions/FaerieClientActionBase.h"
+#include "FaerieInventoryLog.h"
+#include "Algo/Sort.h"
+#include "Modules/ModuleManager.h"
+#include "UObject/UObjectIterator.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(FaerieClientActionBase)
+
+namespace Faerie::ClientAction
+{
+	void NetSerializeInt(FArchive& Ar, int32& Value)
+	{
+		uint32 ZigZag = (static_cast<uint32>(Value) << 1) ^ static_cast<uint32>(Value >> 31);
+		Ar.SerializeIntPacked(ZigZag);
+		if (Ar.IsLoading())
+		{
+			Value = static_cast<int32>(ZigZag >> 1) ^ -static_cast<int32>(ZigZag & 1);
+		}
+	}
+
+	void NetSerializeAddress(FArchive& Ar, FFaerieAddress& Address)
+	{
+		// Addresses are usually made of two small keys, so each half is packed on its own.
+		uint32 High = static_cast<uint32>(static_cast<uint64>(Address.Address) >> 32);
+		uint32 Low = static_cast<uint32>(Address.Address);
+		Ar.SerializeIntPacked(High);
+		Ar.SerializeIntPacked(Low);
+		if (Ar.IsLoading())
+		{
+			Address.Address = static_cast<int64>((static_cast<uint64>(High) << 32) | Low);
+		}
+	}
+
+	void NetSerializeIntPoint(FArchive& Ar, FIntPoint& Point)
+	{
+		NetSerializeInt(Ar, Point.X);
+		NetSerializeInt(Ar, Point.Y);
+	}
+
+	// Set when a module is loaded, as it may have added action structs. Kept outside the table, so that late module
+	// events during shutdown never touch it.
+	static bool ActionTableNeedsRebuild = true;
+
+	/**
+	 * Table of all native action structs, sorted by path, so that the client and server agree on each index. The checksum
+	 * is sent with each batch, to catch builds where the two disagree.
+	 */
+	class FActionStructTable
+	{
+	public:
+		static const FActionStructTable& Get()
+		{
+			static FActionStructTable Table;
+			if (ActionTableNeedsRebuild)
+			{
+				ActionTableNeedsRebuild = false;
+				Table.Rebuild();
+			}
+			return Table;
+		}
+
+		uint32 IndexOf(const UScriptStruct* Struct) const
+		{
+			const uint32* Index = Indices.Find(Struct);
+			return Index ? *Index : static_cast<uint32>(INDEX_NONE);
+		}
+
+		const UScriptStruct* GetStruct(const uint32 Index) const
+		{
+			return Structs.IsValidIndex(Index) ? Structs[Index] : nullptr;
+		}
+
+		uint32 GetChecksum() const { return Checksum; }
+
+	private:
+		FActionStructTable()
+		{
+			FModuleManager::Get().OnModulesChanged().AddLambda(
+				[](FName, const EModuleChangeReason Reason)
+				{
+					if (Reason == EModuleChangeReason::ModuleLoaded)
+					{
+						ActionTableNeedsRebuild = true;
+					}
+				});
+		}
+
+		void Rebuild()
+		{
+			Structs.Reset();
+			Indices.Reset();
+
+			const UScriptStruct* BaseStruct = FFaerieClientActionBase::StaticStruct();
+			for (TObjectIterator<UScriptStruct> It; It; ++It)
+			{
+				if (*It != BaseStruct && It->IsChildOf(BaseStruct) && It->IsNative())
+				{
+					Structs.Add(*It);
+				}
+			}
+
+			Algo::SortBy(Structs, [](const UScriptStruct* Struct) { return Struct->GetPathName(); });
+
+			Checksum = 0;
+			for (int32 i = 0; i < Structs.Num(); ++i)
+			{
+				Indices.Add(Structs[i], i);
+				Checksum = FCrc::StrCrc32(*Structs[i]->GetPathName(), Checksum);
+			}
+		}
+
+		TArray<const UScriptStruct*> Structs;
+		TMap<const UScriptStruct*, uint32> Indices;
+		uint32 Checksum = 0;
+	};
+
+	uint32 GetActionTableChecksum()
+	{
+		return FActionStructTable::Get().GetChecksum();
+	}
+}
+
+bool FFaerieClientActionBatch::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	using namespace Faerie::ClientAction;
+
+	const FActionStructTable& Table = FActionStructTable::Get();
+
+	uint32 Checksum = Table.GetChecksum();
+	Ar << Checksum;
+	if (Checksum != Table.GetChecksum())
+	{
+		UE_LOG(LogFaerieInventory, Error, TEXT("Client action batch was sent from a build with different action structs!"))
+		Ar.SetError();
+		bOutSuccess = false;
+		return true;
+	}
+
+	uint8 TypeByte = static_cast<uint8>(Type);
+	Ar.SerializeBits(&TypeByte, 2);
+	if (TypeByte > static_cast<uint8>(EFaerieClientRequestBatchType::Transaction))
+	{
+		// Two bits leave room for one more value than there are batch types.
+		Ar.SetError();
+		bOutSuccess = false;
+		return true;
+	}
+	Type = static_cast<EFaerieClientRequestBatchType>(TypeByte);
+
+	uint32 NumActions = Actions.Num();
+	Ar.SerializeIntPacked(NumActions);
+	if (NumActions > MaxBatchActions)
+	{
+		Ar.SetError();
+		bOutSuccess = false;
+		return true;
+	}
+
+	if (Ar.IsLoading())
+	{
+		Actions.Reset(NumActions);
+		Actions.SetNum(NumActions);
+	}
+
+	bOutSuccess = true;
+
+	for (TInstancedStruct<FFaerieClientActionBase>& Action : Actions)
+	{
+		// Index 0 is reserved for an invalid action.
+		uint32 StructIndex = Action.IsValid() ? Table.IndexOf(Action.GetScriptStruct()) + 1 : 0;
+		Ar.SerializeIntPacked(StructIndex);
+
+		if (Ar.IsLoading())
+		{
+			const UScriptStruct* Struct = StructIndex != 0 ? Table.GetStruct(StructIndex - 1) : nullptr;
+			if (!Struct)
+			{
+				Ar.SetError();
+				bOutSuccess = false;
+				return true;
+			}
+			Action.InitializeAsScriptStruct(Struct);
+		}
+		else if (StructIndex == 0)
+		{
+			continue;
+		}
+
+		const UScriptStruct* Struct = Action.GetScriptStruct();
+		uint8* Memory = reinterpret_cast<uint8*>(Action.GetMutablePtr());
+
+		if (EnumHasAnyFlags(Struct->StructFlags, STRUCT_NetSerializeNative))
+		{
+			bool bActionSuccess = true;
+			Struct->GetCppStructOps()->NetSerialize(Ar, Map, bActionSuccess, Memory);
+			bOutSuccess &= bActionSuccess;
+		}
+		else
+		{
+			Struct->SerializeBin(Ar, Memory);
+		}
+
+		if (Ar.IsError())
+		{
+			bOutSuccess = false;
+			return true;
+		}
+	}
+
+	return true;
+}
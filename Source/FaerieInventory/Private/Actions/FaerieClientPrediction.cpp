@@ -0,0 +1,38 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "Actions/FaerieClientPrediction.h"
+#include "Actions/FaerieInventoryClient.h"
+
+namespace Faerie::ClientAction
+{
+	FPredictionListener::~FPredictionListener()
+	{
+		Unbind();
+	}
+
+	void FPredictionListener::Bind(UFaerieInventoryClient* Client, FPredictionResolved::FDelegate&& Callback)
+	{
+		if (BoundClient.Get() == Client)
+		{
+			return;
+		}
+
+		Unbind();
+
+		if (IsValid(Client))
+		{
+			BoundClient = Client;
+			Handle = Client->GetOnPredictionResolved().Add(MoveTemp(Callback));
+		}
+	}
+
+	void FPredictionListener::Unbind()
+	{
+		if (UFaerieInventoryClient* Client = BoundClient.Get())
+		{
+			Client->GetOnPredictionResolved().Remove(Handle);
+		}
+		BoundClient.Reset();
+		Handle.Reset();
+	}
+}
@@ -1,10 +1,17 @@
 ﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
 
 #include "Actions/FaerieInventoryClient.h"
+#include "FaerieContainerTransaction.h"
+#include "FaerieInventoryComponent.h"
 #include "FaerieItemStorage.h"
 #include "FaerieInventoryLog.h"
 #include "Actions/FaerieClientActionBase.h"
+#include "Engine/World.h"
 #include "GameFramework/Actor.h"
+#include "Modules/ModuleManager.h"
+#include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
+#include "TimerManager.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(FaerieInventoryClient)
 
@@ -14,6 +21,47 @@ UFaerieInventoryClient::UFaerieInventoryClient()
 	SetIsReplicatedByDefault(true);
 }
 
+void UFaerieInventoryClient::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+	Params.Condition = COND_OwnerOnly;
+	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, ServerActionTableChecksum, Params)
+}
+
+void UFaerieInventoryClient::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (GetOwner()->HasAuthority())
+	{
+		UpdateServerActionTableChecksum();
+		FModuleManager::Get().OnModulesChanged().AddUObject(this, &ThisClass::OnModulesChanged);
+	}
+}
+
+void UFaerieInventoryClient::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	FModuleManager::Get().OnModulesChanged().RemoveAll(this);
+
+	// Don't drop requests the player already made.
+	FlushPendingActions();
+
+	// Let anything we were viewing go back to sleep.
+	for (const FViewedContainer& Viewed : ViewedContainers)
+	{
+		if (Viewed.Inventory.IsValid())
+		{
+			Viewed.Inventory->RemoveViewer(this);
+		}
+	}
+	ViewedContainers.Empty();
+
+	Super::EndPlay(EndPlayReason);
+}
+
 bool UFaerieInventoryClient::CanAccessContainer(const UFaerieItemContainerBase* Container, const UScriptStruct* RequestType) const
 {
 	// @todo implement
@@ -36,6 +84,28 @@ void UFaerieInventoryClient::RequestExecuteAction(const FFaerieClientActionBase&
 		// If called on a server, run immediately.
 		Server_RequestExecuteAction(Args);
 	}
+	else if (PredictRequests && TrySendPredicted(Args))
+	{
+		// Applied locally, and sent along with its prediction key.
+	}
+	else if (CoalesceRequests)
+	{
+		// Queue the request, to be sent along with any others made before the next flush.
+		PendingActions.AddDefaulted_GetRef().InitializeAs(Args);
+
+		if (!FlushTimer.IsValid())
+		{
+			FTimerManager& TimerManager = GetWorld()->GetTimerManager();
+			if (CoalesceWindow > 0.f)
+			{
+				TimerManager.SetTimer(FlushTimer, this, &ThisClass::FlushPendingActions, CoalesceWindow, false);
+			}
+			else
+			{
+				FlushTimer = TimerManager.SetTimerForNextTick(this, &ThisClass::FlushPendingActions);
+			}
+		}
+	}
 	else
 	{
 		// Otherwise, use the RPC version.
@@ -54,6 +124,9 @@ void UFaerieInventoryClient::RequestExecuteAction_Batch(const TArray<const FFaer
 	}
 	else
 	{
+		// Send anything queued first, so requests arrive in the order they were made.
+		FlushPendingActions();
+
 		// Otherwise, use the RPC version.
 		TArray<TInstancedStruct<FFaerieClientActionBase>> ArrayWrapper;
 		ArrayWrapper.Reserve(Args.Num());
@@ -62,7 +135,7 @@ void UFaerieInventoryClient::RequestExecuteAction_Batch(const TArray<const FFaer
 			TInstancedStruct<FFaerieClientActionBase>& ElementWrapper = ArrayWrapper.AddDefaulted_GetRef();
 			ElementWrapper.InitializeAs(*Element);
 		}
-		RequestExecuteAction_Batch(ArrayWrapper, Type);
+		SendBatch(MoveTemp(ArrayWrapper), Type);
 	}
 }
 
@@ -76,6 +149,9 @@ void UFaerieInventoryClient::RequestMoveAction(const FFaerieClientAction_MoveHan
 	}
 	else
 	{
+		// Send anything queued first, so requests arrive in the order they were made.
+		FlushPendingActions();
+
 		// Otherwise, use the RPC version.
 		TInstancedStruct<FFaerieClientAction_MoveHandlerBase> MoveFromWrapper;
 		TInstancedStruct<FFaerieClientAction_MoveHandlerBase> MoveToWrapper;
@@ -85,6 +161,107 @@ void UFaerieInventoryClient::RequestMoveAction(const FFaerieClientAction_MoveHan
 	}
 }
 
+void UFaerieInventoryClient::FlushPendingActions()
+{
+	if (FlushTimer.IsValid())
+	{
+		if (const UWorld* World = GetWorld())
+		{
+			World->GetTimerManager().ClearTimer(FlushTimer);
+		}
+		FlushTimer.Invalidate();
+	}
+
+	if (!PendingActions.IsEmpty())
+	{
+		SendBatch(MoveTemp(PendingActions), EFaerieClientRequestBatchType::Individuals);
+		PendingActions.Reset();
+	}
+}
+
+bool UFaerieInventoryClient::TrySendPredicted(const FFaerieClientActionBase& Args)
+{
+	Faerie::ClientAction::FPredictionKey Key = LastPredictionKey + 1;
+	if (Key <= 0)
+	{
+		Key = 1;
+	}
+
+	if (!Args.Client_Predict(this, Key))
+	{
+		return false;
+	}
+
+	LastPredictionKey = Key;
+
+	// Send anything queued first, so requests arrive in the order they were made.
+	FlushPendingActions();
+
+	TInstancedStruct<FFaerieClientActionBase> ArgsWrapper;
+	ArgsWrapper.InitializeAs(Args);
+	RequestExecuteAction_Predicted(ArgsWrapper, Key);
+	return true;
+}
+
+void UFaerieInventoryClient::SendBatch(TArray<TInstancedStruct<FFaerieClientActionBase>>&& Actions, const EFaerieClientRequestBatchType Type)
+{
+	// The server can't unpack batches made with a different action table, so those are sent unpacked as well.
+	if (ServerActionTableChecksum != Faerie::ClientAction::GetActionTableChecksum())
+	{
+		RequestExecuteAction_Batch(Actions, Type);
+		return;
+	}
+
+	const int32 BatchSize = FMath::Clamp(MaxActionsPerBatch, 1, Faerie::ClientAction::MaxBatchActions);
+
+	// Sequences and transactions have to run as a whole, so they can't be split. Oversized ones are sent with the unpacked RPC instead.
+	if (Type != EFaerieClientRequestBatchType::Individuals && Actions.Num() > Faerie::ClientAction::MaxBatchActions)
+	{
+		RequestExecuteAction_Batch(Actions, Type);
+		return;
+	}
+
+	FFaerieClientActionBatch Batch;
+	Batch.Type = Type;
+
+	if (Type != EFaerieClientRequestBatchType::Individuals || Actions.Num() <= BatchSize)
+	{
+		Batch.Actions = MoveTemp(Actions);
+		RequestExecuteAction_Packed(Batch);
+		return;
+	}
+
+	for (int32 Start = 0; Start < Actions.Num(); Start += BatchSize)
+	{
+		const int32 Count = FMath::Min(BatchSize, Actions.Num() - Start);
+		Batch.Actions.Reset(Count);
+		for (int32 i = Start; i < Start + Count; ++i)
+		{
+			Batch.Actions.Add(MoveTemp(Actions[i]));
+		}
+		RequestExecuteAction_Packed(Batch);
+	}
+}
+
+void UFaerieInventoryClient::OnModulesChanged(FName, const EModuleChangeReason Reason)
+{
+	if (Reason == EModuleChangeReason::ModuleLoaded)
+	{
+		// Wait a tick, as the action table may not have been told about the module yet.
+		GetWorld()->GetTimerManager().SetTimerForNextTick(this, &ThisClass::UpdateServerActionTableChecksum);
+	}
+}
+
+void UFaerieInventoryClient::UpdateServerActionTableChecksum()
+{
+	const uint32 Checksum = Faerie::ClientAction::GetActionTableChecksum();
+	if (ServerActionTableChecksum != Checksum)
+	{
+		ServerActionTableChecksum = Checksum;
+		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, ServerActionTableChecksum, this);
+	}
+}
+
 void UFaerieInventoryClient::RequestExecuteAction_Implementation(const TInstancedStruct<FFaerieClientActionBase>& Args)
 {
 	if (Args.IsValid())
@@ -109,6 +286,35 @@ void UFaerieInventoryClient::RequestExecuteAction_Batch_Implementation(
 	Server_RequestExecuteAction_Batch(ExecuteArray, Type);
 }
 
+void UFaerieInventoryClient::RequestExecuteAction_Packed_Implementation(const FFaerieClientActionBatch& Batch)
+{
+	TArray<const FFaerieClientActionBase*> ExecuteArray;
+	ExecuteArray.Reserve(Batch.Actions.Num());
+	for (auto&& Element : Batch.Actions)
+	{
+		if (!Element.IsValid())
+		{
+			UE_LOG(LogFaerieInventory, Warning, TEXT("Client sent bad Action Batch!"))
+			return;
+		}
+		ExecuteArray.Add(Element.GetPtr());
+	}
+
+	Server_RequestExecuteAction_Batch(ExecuteArray, Batch.Type);
+}
+
+void UFaerieInventoryClient::RequestExecuteAction_Predicted_Implementation(
+	const TInstancedStruct<FFaerieClientActionBase>& Args, const int32 PredictionKey)
+{
+	const bool Accepted = Args.IsValid() && Args.Get().Server_Execute(this);
+	ClientAckPrediction(PredictionKey, Accepted);
+}
+
+void UFaerieInventoryClient::ClientAckPrediction_Implementation(const int32 PredictionKey, const bool Accepted)
+{
+	OnPredictionResolved.Broadcast(PredictionKey, Accepted);
+}
+
 void UFaerieInventoryClient::RequestMoveAction_Implementation(
 	const TInstancedStruct<FFaerieClientAction_MoveHandlerBase>& MoveFrom,
 	const TInstancedStruct<FFaerieClientAction_MoveHandlerBase>& MoveTo)
@@ -179,6 +385,23 @@ void UFaerieInventoryClient::Server_RequestExecuteAction_Batch(const TArray<cons
 			}
 		}
 		break;
+	case EFaerieClientRequestBatchType::Transaction:
+		{
+			// Containers join the transaction as they are edited. Leaving scope without committing rolls them all back.
+			Faerie::Container::FTransaction Transaction;
+			for (auto&& Element : Args)
+			{
+				if (!Element->Server_Execute(this))
+				{
+					return;
+				}
+			}
+			Transaction.Commit();
+		}
+		break;
+	default:
+		UE_LOG(LogFaerieInventory, Warning, TEXT("Client sent a batch with an unknown type!"))
+		break;
 	}
 }
 
@@ -249,3 +472,64 @@ void UFaerieInventoryClient::Server_RequestMoveAction(const FFaerieClientAction_
 		UE_LOG(LogFaerieInventory, Error, TEXT("Move failed! Issue with possession!"))
 	}
 }
+
+void UFaerieInventoryClient::SetContainerViewed(UFaerieItemContainerBase* Container, const bool Viewed)
+{
+	if (GetOwner()->HasAuthority())
+	{
+		Server_SetContainerViewed(Container, Viewed);
+	}
+	else
+	{
+		ServerSetContainerViewed(Container, Viewed);
+	}
+}
+
+void UFaerieInventoryClient::ServerSetContainerViewed_Implementation(UFaerieItemContainerBase* Container, const bool Viewed)
+{
+	Server_SetContainerViewed(Container, Viewed);
+}
+
+void UFaerieInventoryClient::Server_SetContainerViewed(UFaerieItemContainerBase* Container, const bool Viewed)
+{
+	if (!IsValid(Container)) return;
+
+	UFaerieInventoryComponent* Inventory = Container->GetTypedOuter<UFaerieInventoryComponent>();
+	if (!IsValid(Inventory)) return;
+
+	if (Viewed)
+	{
+		if (!CanAccessContainer(Container, nullptr)) return;
+
+		if (!ViewedContainers.ContainsByPredicate(
+				[Container](const FViewedContainer& Other) { return Other.Container == Container; }))
+		{
+			ViewedContainers.Add({ Container, Inventory });
+		}
+		Inventory->AddViewer(this);
+		return;
+	}
+
+	// Close this container, and any that were destroyed while open.
+	TArray<TWeakObjectPtr<UFaerieInventoryComponent>, TInlineAllocator<1>> Closed;
+	ViewedContainers.RemoveAll(
+		[Container, &Closed](const FViewedContainer& Other)
+		{
+			if (Other.Container.IsValid() && Other.Container != Container)
+			{
+				return false;
+			}
+			Closed.AddUnique(Other.Inventory);
+			return true;
+		});
+
+	for (const TWeakObjectPtr<UFaerieInventoryComponent>& ClosedInventory : Closed)
+	{
+		if (ClosedInventory.IsValid() &&
+			!ViewedContainers.ContainsByPredicate(
+				[&ClosedInventory](const FViewedContainer& Other) { return Other.Inventory == ClosedInventory; }))
+		{
+			ClosedInventory->RemoveViewer(this);
+		}
+	}
+}
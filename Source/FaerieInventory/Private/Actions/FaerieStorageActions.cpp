@@ -81,6 +81,16 @@ bool FFaerieClientAction_RequestMoveEntry::Server_Execute(const UFaerieInventory
 	return Storage->MoveStack(ToStorage, Address, Amount).IsValid();
 }
 
+bool FFaerieClientAction_RequestMoveEntry::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	Ar << Storage;
+	Faerie::ClientAction::NetSerializeAddress(Ar, Address);
+	Faerie::ClientAction::NetSerializeInt(Ar, Amount);
+	Ar << ToStorage;
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
+
 bool FFaerieClientAction_MergeStacks::Server_Execute(const UFaerieInventoryClient* Client) const
 {
 	if (!IsValid(Storage)) return false;
@@ -88,9 +98,41 @@ bool FFaerieClientAction_MergeStacks::Server_Execute(const UFaerieInventoryClien
 	return Storage->MergeStacks(Entry, FromStack, ToStack, Amount);
 }
 
+bool FFaerieClientAction_MergeStacks::Client_Predict(UFaerieInventoryClient* Client, const Faerie::ClientAction::FPredictionKey Key) const
+{
+	if (!IsValid(Storage)) return false;
+	return Storage->PredictMergeStacks(Client, Key, Entry, FromStack, ToStack, Amount);
+}
+
+bool FFaerieClientAction_MergeStacks::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	Ar << Storage;
+	Faerie::ClientAction::NetSerializeKey(Ar, Entry);
+	Faerie::ClientAction::NetSerializeKey(Ar, FromStack);
+	Faerie::ClientAction::NetSerializeKey(Ar, ToStack);
+	Faerie::ClientAction::NetSerializeInt(Ar, Amount);
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
+
 bool FFaerieClientAction_SplitStack::Server_Execute(const UFaerieInventoryClient* Client) const
 {
 	if (!IsValid(Storage)) return false;
 	if (!Client->CanAccessContainer(Storage, StaticStruct())) return false;
 	return Storage->SplitStack(Address, Amount);
+}
+
+bool FFaerieClientAction_SplitStack::Client_Predict(UFaerieInventoryClient* Client, const Faerie::ClientAction::FPredictionKey Key) const
+{
+	if (!IsValid(Storage)) return false;
+	return Storage->PredictSplitStack(Client, Key, Address, Amount);
+}
+
+bool FFaerieClientAction_SplitStack::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	Ar << Storage;
+	Faerie::ClientAction::NetSerializeAddress(Ar, Address);
+	Faerie::ClientAction::NetSerializeInt(Ar, Amount);
+	bOutSuccess = !Ar.IsError();
+	return true;
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include "FaerieContainerFilterTypes.h"
 #include "FaerieItemDataFilter.h"
 #include "FaerieItemStackView.h"
+#include "FaerieItemStorageTokenIndex.h"
+#include "Tokens/FaerieTagToken.h"
 
 namespace Faerie::Container
 {
@@ -26,6 +28,121 @@ namespace Faerie::Container
 		return !Item->CanMutate();
 	}
 
+	// Disable every bit in KeyBits that isn't set in Column. A missing column means that no entry passes.
+	static void IntersectColumn(TBitArray<>& KeyBits, const TBitArray<>* Column)
+	{
+		if (Column)
+		{
+			KeyBits.CombineWithBitwiseAND(*Column, EBitwiseOperatorFlags::MaintainSize);
+		}
+		else
+		{
+			KeyBits.Init(false, KeyBits.Num());
+		}
+	}
+
+	static const FGameplayTagContainer* GetItemTags(const UFaerieItem* Item)
+	{
+		if (const UFaerieTagToken* TagToken = Item->GetToken<UFaerieTagToken>())
+		{
+			return &TagToken->GetTags();
+		}
+		return nullptr;
+	}
+
+	bool FTokenClassFilter::Passes(const UFaerieItem* Item)
+	{
+		return Item->GetToken(TokenClass) != nullptr;
+	}
+
+	bool FTokenClassFilter::PassesIndexed(const Storage::FTokenIndex& Index, TBitArray<>& KeyBits)
+	{
+		// Without a column, a missing one can't be told apart from no entry having the token.
+		if (!Storage::FTokenIndex::IsIndexedTokenClass(TokenClass))
+		{
+			return false;
+		}
+
+		IntersectColumn(KeyBits, Index.FindTokenClass(TokenClass));
+		return true;
+	}
+
+	bool FItemTagFilter::Passes(const UFaerieItem* Item)
+	{
+		if (const FGameplayTagContainer* ItemTags = GetItemTags(Item))
+		{
+			return Exact ? ItemTags->HasTagExact(Tag) : ItemTags->HasTag(Tag);
+		}
+		return false;
+	}
+
+	bool FItemTagFilter::PassesIndexed(const Storage::FTokenIndex& Index, TBitArray<>& KeyBits)
+	{
+		IntersectColumn(KeyBits, Index.FindTag(Tag, Exact));
+		return true;
+	}
+
+	bool FItemTagsFilter::Passes(const UFaerieItem* Item)
+	{
+		if (const FGameplayTagContainer* ItemTags = GetItemTags(Item))
+		{
+			if (All)
+			{
+				return Exact ? ItemTags->HasAllExact(Tags) : ItemTags->HasAll(Tags);
+			}
+			return Exact ? ItemTags->HasAnyExact(Tags) : ItemTags->HasAny(Tags);
+		}
+		return false;
+	}
+
+	bool FItemTagsFilter::PassesIndexed(const Storage::FTokenIndex& Index, TBitArray<>& KeyBits)
+	{
+		if (All)
+		{
+			// Items without a tag token never pass, even when there are no tags to match.
+			IntersectColumn(KeyBits, Index.FindTokenClass(UFaerieTagToken::StaticClass()));
+			for (const FGameplayTag& Tag : Tags)
+			{
+				IntersectColumn(KeyBits, Index.FindTag(Tag, Exact));
+			}
+			return true;
+		}
+
+		TBitArray<> AnyBits(false, KeyBits.Num());
+		for (const FGameplayTag& Tag : Tags)
+		{
+			if (const TBitArray<>* Column = Index.FindTag(Tag, Exact))
+			{
+				AnyBits.CombineWithBitwiseOR(*Column, EBitwiseOperatorFlags::MaintainSize);
+			}
+		}
+		KeyBits.CombineWithBitwiseAND(AnyBits, EBitwiseOperatorFlags::MaintainSize);
+		return true;
+	}
+
+	bool FItemTagQueryFilter::Passes(const UFaerieItem* Item)
+	{
+		if (const FGameplayTagContainer* ItemTags = GetItemTags(Item))
+		{
+			return Query.Matches(*ItemTags);
+		}
+		return false;
+	}
+
+	bool FItemTagQueryFilter::PassesIndexed(const Storage::FTokenIndex& Index, TBitArray<>& KeyBits)
+	{
+		// Queries can't be broken into columns, but the index keeps each entry's tags, so items are still left alone.
+		IntersectColumn(KeyBits, Index.FindTokenClass(UFaerieTagToken::StaticClass()));
+		for (TConstSetBitIterator<> It(KeyBits); It; ++It)
+		{
+			if (!Query.Matches(Index.GetTags(It.GetIndex())))
+			{
+				KeyBits.AccessCorrespondingBit(It) = false;
+			}
+		}
+		return true;
+	}
+
 	bool FSnapshotFilterObj::Passes(const FFaerieItemSnapshot& Snapshot)
 	{
 		if (FilterObj)
@@ -0,0 +1,84 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "FaerieContainerTransaction.h"
+#include "FaerieItemContainerBase.h"
+
+namespace Faerie::Container
+{
+	FTransaction* FTransaction::Active = nullptr;
+
+	FTransaction::FTransaction()
+	{
+		check(IsInGameThread());
+
+		if (Active == nullptr)
+		{
+			Active = this;
+			IsOuter = true;
+		}
+	}
+
+	FTransaction::~FTransaction()
+	{
+		if (!Ended)
+		{
+			End(false);
+		}
+	}
+
+	void FTransaction::Commit()
+	{
+		if (ensure(!Ended))
+		{
+			End(true);
+		}
+	}
+
+	void FTransaction::PreEdit(UFaerieItemContainerBase* Container)
+	{
+		check(Container);
+
+		if (Active == nullptr || Container->IsInTransaction())
+		{
+			return;
+		}
+
+		Active->Containers.Add(Container);
+		Container->BeginTransaction();
+	}
+
+	void FTransaction::End(const bool Committed)
+	{
+		Ended = true;
+
+		if (!IsOuter)
+		{
+			return;
+		}
+
+		// Clear Active first, so that events sent while ending can make edits of their own.
+		Active = nullptr;
+
+		if (!Committed)
+		{
+			// Undo in reverse, then let each container settle, once all of them are back in their original state.
+			for (int32 i = Containers.Num() - 1; i >= 0; --i)
+			{
+				if (UFaerieItemContainerBase* Container = Containers[i].Get())
+				{
+					Container->RollbackTransaction();
+				}
+			}
+		}
+
+		for (const TWeakObjectPtr<UFaerieItemContainerBase>& Container : Containers)
+		{
+			if (Container.IsValid())
+			{
+				Container->EndTransaction(Committed);
+			}
+		}
+
+		Containers.Empty();
+	}
+}
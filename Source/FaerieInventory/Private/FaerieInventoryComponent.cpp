@@ -4,6 +4,7 @@
 #include "FaerieInventoryLog.h"
 #include "FaerieItemStorage.h"
 #include "ItemContainerExtensionBase.h"
+#include "Engine/NetDriver.h"
 #include "GameFramework/Actor.h"
 #include "Net/UnrealNetwork.h"
 
@@ -68,6 +69,8 @@ void UFaerieInventoryComponent::ReadyForReplication()
 		AddReplicatedSubObject(Extensions);
 		Extensions->InitializeNetObject(Owner);
 	}
+
+	ApplyReplicationPolicy();
 }
 
 UItemContainerExtensionGroup* UFaerieInventoryComponent::GetExtensionGroup() const
@@ -98,6 +101,125 @@ bool UFaerieInventoryComponent::RemoveExtension(UItemContainerExtensionBase* Ext
 	return ItemStorage->RemoveExtension(Extension);
 }
 
+void UFaerieInventoryComponent::SetReplicationPolicy(const FFaerieContainerReplicationPolicy& Policy)
+{
+	ReplicationPolicy = Policy;
+	ApplyReplicationPolicy();
+}
+
+void UFaerieInventoryComponent::AddViewer(const UFaerieInventoryClient* Client)
+{
+	if (!IsValid(Client)) return;
+
+	const int32 PreviousNum = Viewers.Num();
+	Viewers.AddUnique(Client);
+	if (PreviousNum == 0 && Viewers.Num() == 1)
+	{
+		ApplyReplicationPolicy();
+	}
+}
+
+void UFaerieInventoryComponent::RemoveViewer(const UFaerieInventoryClient* Client)
+{
+	if (Viewers.IsEmpty()) return;
+
+	// Also clean up viewers that were destroyed without closing us.
+	Viewers.RemoveAll(
+		[Client](const TWeakObjectPtr<const UFaerieInventoryClient>& Viewer)
+		{
+			return !Viewer.IsValid() || Viewer.Get() == Client;
+		});
+
+	if (Viewers.IsEmpty())
+	{
+		ApplyReplicationPolicy();
+	}
+}
+
+void UFaerieInventoryComponent::ApplyReplicationPolicy()
+{
+	AActor* Owner = GetOwner();
+	if (!IsValid(Owner) || !Owner->HasAuthority())
+	{
+		return;
+	}
+
+	float UpdateRate = 0.f;
+	float Priority = 0.f;
+	bool CanSleep = true;
+	bool AnyPolicy = false;
+	UFaerieInventoryComponent* SettingsHolder = nullptr;
+
+	TInlineComponentArray<UFaerieInventoryComponent*> Inventories(Owner);
+	for (UFaerieInventoryComponent* Inventory : Inventories)
+	{
+		const FFaerieContainerReplicationPolicy& Policy = Inventory->ReplicationPolicy;
+		UpdateRate = FMath::Max(UpdateRate, Policy.MaxUpdateRate);
+		Priority = FMath::Max(Priority, Policy.Priority);
+		const bool Unviewed = Policy.DormantWhenUnviewed && !Inventory->IsViewed();
+		CanSleep &= Unviewed;
+		AnyPolicy |= !Policy.IsDefault();
+
+		if (Inventory->SavedOwnerSettings.IsSet())
+		{
+			SettingsHolder = Inventory;
+		}
+
+		// Lazily loaded content isn't created just to be replicated while no one can see it.
+		Inventory->ItemStorage->SetLazyReplicationDeferred(Unviewed);
+	}
+
+	// Actors that no policy has touched keep whatever settings they were given.
+	if (!AnyPolicy && !SettingsHolder)
+	{
+		return;
+	}
+
+	// Caps are relative to the actor's own settings from before the first policy was applied, so that applying them
+	// repeatedly doesn't keep lowering the rate. Those settings are restored once no inventory has a policy anymore.
+	if (!SettingsHolder)
+	{
+		SettingsHolder = this;
+		SavedOwnerSettings.Emplace();
+		SavedOwnerSettings->NetUpdateFrequency = Owner->GetNetUpdateFrequency();
+		SavedOwnerSettings->NetPriority = Owner->NetPriority;
+	}
+	FOwnerNetSettings& Saved = *SettingsHolder->SavedOwnerSettings;
+
+	if (!AnyPolicy)
+	{
+		CanSleep = false;
+	}
+
+	Owner->SetNetUpdateFrequency(UpdateRate > 0.f ? FMath::Min(Saved.NetUpdateFrequency, UpdateRate) : Saved.NetUpdateFrequency);
+	Owner->NetPriority = Priority > 0.f ? Priority : Saved.NetPriority;
+
+	if (CanSleep)
+	{
+		// Actors that were already dormant for their own reasons are left to whatever put them to sleep.
+		if (!Saved.DormancyBeforeSleep.IsSet() && Owner->NetDormancy != DORM_DormantAll)
+		{
+			Saved.DormancyBeforeSleep = Owner->NetDormancy;
+			Owner->SetNetDormancy(DORM_DormantAll);
+		}
+	}
+	else if (Saved.DormancyBeforeSleep.IsSet())
+	{
+		// Dormancy that only applies before the first wake can't be returned to, so those actors are simply woken.
+		const ENetDormancy PreviousDormancy = Saved.DormancyBeforeSleep.GetValue();
+		Saved.DormancyBeforeSleep.Reset();
+		if (Owner->NetDormancy == DORM_DormantAll)
+		{
+			Owner->SetNetDormancy(PreviousDormancy == DORM_Never ? DORM_Never : DORM_Awake);
+		}
+	}
+
+	if (!AnyPolicy)
+	{
+		SettingsHolder->SavedOwnerSettings.Reset();
+	}
+}
+
 void UFaerieInventoryComponent::HandleAddressEvent(UFaerieItemStorage* Storage, const EFaerieAddressEventType Type,
 	TConstArrayView<FFaerieAddress> Addresses)
 {
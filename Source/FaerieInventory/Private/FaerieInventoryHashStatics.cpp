@@ -2,8 +2,13 @@
 
 #include "FaerieInventoryHashStatics.h"
 #include "FaerieContainerIterator.h"
+#include "FaerieDataSystemTrace.h"
 #include "FaerieItemContainerBase.h"
 
+DECLARE_STATS_GROUP(TEXT("FaerieInventoryHash"), STATGROUP_FaerieInventoryHash, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Hash Container"), STAT_Hash_Container, STATGROUP_FaerieInventoryHash);
+DECLARE_CYCLE_STAT(TEXT("Hash Containers"), STAT_Hash_Containers, STATGROUP_FaerieInventoryHash);
+
 namespace Faerie::Hash
 {
 	FFaerieHash HashContainer(const UFaerieItemContainerBase* Container, const FItemHashFunction& Function)
@@ -13,6 +18,8 @@ namespace Faerie::Hash
 			return FFaerieHash();
 		}
 
+		FAERIE_SCOPE_CYCLE_COUNTER(STAT_Hash_Container);
+
 		TArray<uint32> Hashes;
 
 		for (const UFaerieItem* Item : Container::ItemRange(Container))
@@ -30,6 +37,8 @@ namespace Faerie::Hash
 			return FFaerieHash();
 		}
 
+		FAERIE_SCOPE_CYCLE_COUNTER(STAT_Hash_Containers);
+
 		TArray<uint32> Hashes;
 
 		for (auto&& Container : Containers)
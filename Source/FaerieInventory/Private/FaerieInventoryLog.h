@@ -2,6 +2,13 @@
 
 #pragma once
 
+#include "HAL/LowLevelMemTracker.h"
 #include "Logging/LogMacros.h"
 
 DEFINE_LOG_CATEGORY_STATIC(LogFaerieInventory, Log, All);
+
+// Proxy objects created for storage stacks.
+LLM_DECLARE_TAG(ItemStorageProxies);
+
+// Per-container state cached by extensions.
+LLM_DECLARE_TAG(ContainerExtensions);
@@ -1,8 +1,13 @@
 // Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
 
 #include "FaerieInventoryModule.h"
+#include "FaerieDataSystemMemory.h"
+#include "FaerieInventoryLog.h"
 #include "Modules/ModuleManager.h"
 
+FAERIE_LLM_DEFINE_TAG(ItemStorageProxies);
+FAERIE_LLM_DEFINE_TAG(ContainerExtensions);
+
 #define LOCTEXT_NAMESPACE "FaerieDataSystemCoreModule"
 
 void FFaerieInventoryModule::StartupModule()
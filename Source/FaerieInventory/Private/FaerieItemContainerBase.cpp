@@ -5,17 +5,55 @@
 #include "AssetLoadFlagFixer.h"
 #include "FaerieContainerFilter.h"
 #include "FaerieContainerFilterTypes.h"
+#include "FaerieDataSystemMemory.h"
 #include "FaerieInventoryLog.h"
+#include "FaerieItem.h"
 #include "FaerieItemToken.h"
 #include "FaerieSubObjectFilter.h"
 #include "ItemContainerExtensionBase.h"
 #include "GameFramework/Actor.h"
 #include "Net/UnrealNetwork.h"
+#include "UObject/UObjectIterator.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(FaerieItemContainerBase)
 
 using namespace Faerie;
 
+static Memory::FReportSectionRegistration ContainerMemReport(TEXT("Item Containers"),
+	[](const TArray<FString>& Args, FOutputDevice& Ar)
+	{
+		int32 MaxListed = 20;
+		if (!Args.IsEmpty())
+		{
+			LexFromString(MaxListed, *Args[0]);
+		}
+
+		TArray<TPair<const UFaerieItemContainerBase*, Memory::FReport>> Reports;
+		Memory::FReport Totals;
+		for (TObjectIterator<UFaerieItemContainerBase> It; It; ++It)
+		{
+			Memory::FReport& Report = Reports.Emplace_GetRef(*It, Memory::FReport()).Value;
+			It->GetMemoryUsage(Report);
+			Totals.Append(Report);
+		}
+
+		Reports.Sort([](const TPair<const UFaerieItemContainerBase*, Memory::FReport>& A,
+						const TPair<const UFaerieItemContainerBase*, Memory::FReport>& B)
+			{
+				return A.Value.GetTotal() > B.Value.GetTotal();
+			});
+
+		Ar.Logf(TEXT("  %i containers, %s total"), Reports.Num(), *Memory::FormatBytes(Totals.GetTotal()));
+		Totals.Print(Ar, TEXT("    "));
+
+		const int32 NumListed = MaxListed > 0 ? FMath::Min(MaxListed, Reports.Num()) : Reports.Num();
+		for (int32 i = 0; i < NumListed; ++i)
+		{
+			Ar.Logf(TEXT("  %s: %s"), *Reports[i].Key->GetPathName(), *Memory::FormatBytes(Reports[i].Value.GetTotal()));
+			Reports[i].Value.Print(Ar, TEXT("    "));
+		}
+	});
+
 UFaerieItemContainerBase::UFaerieItemContainerBase()
 {
 	Extensions = CreateDefaultSubobject<UItemContainerExtensionGroup>(FName{TEXTVIEW("Extensions")});
@@ -66,6 +104,8 @@ bool UFaerieItemContainerBase::Possess(FFaerieItemStack Stack)
 void UFaerieItemContainerBase::OnItemMutated(const UFaerieItem* Item, const UFaerieItemToken* Token, const FGameplayTag EditTag)
 {
 	// @todo more logic from the TakeOwnership protocol might belong here, in which case, maybe just move most of this there.
+	RelinkTokenContainer(Token, EditTag);
+
 	if (EditTag == Tags::TokenAdd)
 	{
 		if (AActor* Actor = GetTypedOuter<AActor>();
@@ -195,3 +235,234 @@ PURE_VIRTUAL(UFaerieItemContainerBase::CreateIterator, return TUniquePtr<Faerie:
 
 TUniquePtr<Container::IFilter> UFaerieItemContainerBase::CreateFilter(bool FilterByAddresses) const
 PURE_VIRTUAL(UFaerieItemContainerBase::CreateFilter, return TUniquePtr<Faerie::Container::IFilter>(); )
+
+const UFaerieItem* UFaerieItemContainerBase::GetOwningItem() const
+{
+	// Containers are subobjects of the token that adds them to an item.
+	return GetTypedOuter<UFaerieItem>();
+}
+
+bool UFaerieItemContainerBase::IsNestedIn(const UFaerieItem* Item) const
+{
+	if (!IsValid(Item))
+	{
+		return false;
+	}
+
+	const UFaerieItemContainerBase* Root = this;
+	for (const UFaerieItemContainerBase* Container = this; Container; Container = Container->ParentContainer.Get())
+	{
+		if (Container->GetOwningItem() == Item)
+		{
+			return true;
+		}
+		Root = Container;
+	}
+
+	// The top container is in an item, so either that item isn't in a container, or it is but wasn't linked to it. Only a
+	// search of Item's own containers can tell.
+	if (Root->GetOwningItem() == nullptr)
+	{
+		return false;
+	}
+
+	UFaerieItem* Mutable = Item->MutateCast();
+	return Mutable && GetAllContainersInItemRecursive(Mutable).Contains(this);
+}
+
+void UFaerieItemContainerBase::LinkItemContainers(const UFaerieItem* Item)
+{
+	// Only mutable items can hold containers.
+	UFaerieItem* Mutable = IsValid(Item) ? Item->MutateCast() : nullptr;
+	if (!Mutable)
+	{
+		return;
+	}
+
+	for (UFaerieItemContainerBase* Child : GetAllContainersInItem(Mutable))
+	{
+		LinkChildContainer(Child);
+	}
+
+	// Drop children that have been destroyed since they were linked.
+	ChildContainers.RemoveAllSwap(
+		[](const TWeakObjectPtr<UFaerieItemContainerBase>& Child)
+		{
+			return !Child.IsValid();
+		});
+}
+
+void UFaerieItemContainerBase::UnlinkItemContainers(const UFaerieItem* Item)
+{
+	UFaerieItem* Mutable = IsValid(Item) ? Item->MutateCast() : nullptr;
+	if (!Mutable)
+	{
+		return;
+	}
+
+	for (UFaerieItemContainerBase* Child : GetAllContainersInItem(Mutable))
+	{
+		UnlinkChildContainer(Child);
+	}
+}
+
+void UFaerieItemContainerBase::BindReplicatedItem(const UFaerieItem* Item)
+{
+	UFaerieItem* Mutable = IsValid(Item) ? Item->MutateCast() : nullptr;
+	if (!Mutable)
+	{
+		return;
+	}
+
+	// The item may have been replicated to another container first, in which case it's ours now.
+	if (auto& Notify = Mutable->GetNotifyOwnerOfSelfMutation();
+		!Notify.IsBoundToObject(this))
+	{
+		Notify.BindUObject(this, &ThisClass::OnReplicatedItemMutated);
+	}
+}
+
+void UFaerieItemContainerBase::UnbindReplicatedItem(const UFaerieItem* Item)
+{
+	UFaerieItem* Mutable = IsValid(Item) ? Item->MutateCast() : nullptr;
+	if (!Mutable)
+	{
+		return;
+	}
+
+	if (auto& Notify = Mutable->GetNotifyOwnerOfSelfMutation();
+		Notify.IsBoundToObject(this))
+	{
+		Notify.Unbind();
+	}
+}
+
+void UFaerieItemContainerBase::OnReplicatedItemMutated(const UFaerieItem* Item, const UFaerieItemToken* Token, const FGameplayTag EditTag)
+{
+	RelinkTokenContainer(Token, EditTag);
+}
+
+void UFaerieItemContainerBase::RelinkTokenContainer(const UFaerieItemToken* Token, const FGameplayTag EditTag)
+{
+	UFaerieItemContainerToken* ContainerToken = IsValid(Token) ? Token->MutateCast<UFaerieItemContainerToken>() : nullptr;
+	if (!ContainerToken)
+	{
+		return;
+	}
+
+	UFaerieItemContainerBase* Child = ContainerToken->GetItemContainer();
+	if (EditTag == Tags::TokenAdd)
+	{
+		LinkChildContainer(Child);
+	}
+	else if (EditTag == Tags::TokenRemove)
+	{
+		UnlinkChildContainer(Child);
+	}
+}
+
+void UFaerieItemContainerBase::LinkChildContainer(UFaerieItemContainerBase* Child)
+{
+	if (!IsValid(Child) || Child == this)
+	{
+		return;
+	}
+
+	if (UFaerieItemContainerBase* OldParent = Child->ParentContainer.Get();
+		OldParent && OldParent != this)
+	{
+		OldParent->ChildContainers.Remove(Child);
+	}
+
+	Child->ParentContainer = this;
+	ChildContainers.AddUnique(Child);
+}
+
+void UFaerieItemContainerBase::UnlinkChildContainer(UFaerieItemContainerBase* Child)
+{
+	// The item may have been linked to another container already.
+	if (IsValid(Child) && Child->ParentContainer == this)
+	{
+		Child->ParentContainer.Reset();
+		ChildContainers.Remove(Child);
+	}
+}
+
+void UFaerieItemContainerBase::GetMemoryUsage(Memory::FReport& Report) const
+{
+	Report.Add(TEXT("Object"), GetClass()->GetStructureSize());
+	Report.AddAllocation(TEXT("Transaction"), TransactionExtensionState);
+	Report.AddAllocation(TEXT("Transaction"), HeldExtensionHooks);
+	Report.AddAllocation(TEXT("Child Containers"), ChildContainers);
+
+	if (IsValid(UnclaimedExtensionData))
+	{
+		Report.AddAllocation(TEXT("Unclaimed Extension Data"), UnclaimedExtensionData->Data);
+	}
+
+	if (IsValid(Extensions))
+	{
+		Extensions->GetMemoryUsage(this, Report);
+	}
+}
+
+void UFaerieItemContainerBase::BeginTransaction()
+{
+	InTransaction = true;
+
+	for (UItemContainerExtensionBase* Extension : Extension::FRecursiveExtensionIterator(Extensions))
+	{
+		TransactionExtensionState.Emplace(Extension, Extension->MakeTransactionSnapshot(this));
+	}
+}
+
+void UFaerieItemContainerBase::RollbackTransaction()
+{
+	for (const TPair<TWeakObjectPtr<UItemContainerExtensionBase>, FInstancedStruct>& State : TransactionExtensionState)
+	{
+		if (State.Key.IsValid())
+		{
+			State.Key->RestoreTransactionSnapshot(this, State.Value);
+		}
+	}
+}
+
+void UFaerieItemContainerBase::EndTransaction(const bool Committed)
+{
+	InTransaction = false;
+	TransactionExtensionState.Empty();
+
+	const TArray<FHeldExtensionHook> HeldHooks = MoveTemp(HeldExtensionHooks);
+	if (!Committed)
+	{
+		return;
+	}
+
+	for (const FHeldExtensionHook& Held : HeldHooks)
+	{
+		UItemContainerExtensionBase* Extension = Held.Extension.Get();
+		if (!IsValid(Extension))
+		{
+			continue;
+		}
+
+		switch (Held.Hook)
+		{
+		case EHeldHook::PostAddition:
+			Extension->PostAddition(this, Held.Event);
+			break;
+		case EHeldHook::PostRemoval:
+			Extension->PostRemoval(this, Held.Event);
+			break;
+		case EHeldHook::PostEntryChanged:
+			Extension->PostEntryChanged(this, Held.Event);
+			break;
+		}
+	}
+}
+
+void UFaerieItemContainerBase::HoldExtensionHook(UItemContainerExtensionBase* Extension, const EHeldHook Hook,
+												 const Faerie::Inventory::FEventLog& Event)
+{
+	HeldExtensionHooks.Add({ Extension, Hook, Event });
+}
@@ -1,25 +1,23 @@
 ﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
 
 #include "FaerieItemContainerPath.h"
-#include "FaerieContainerFilter.h"
-#include "FaerieContainerFilterTypes.h"
 #include "FaerieItemContainerBase.h"
-#include "FaerieSubObjectFilter.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(FaerieItemContainerPath)
 
 void BuildPath_Recurse(UFaerieItemContainerBase* Container, const FFaerieItemContainerPath& BasePath, TArray<FFaerieItemContainerPath>& OutPaths)
 {
-	using namespace Faerie::Container;
-
-	FFaerieItemContainerPath& NewPath = OutPaths.Emplace_GetRef(BasePath);
+	// OutPaths may reallocate while recursing, so the new path is copied for children, instead of referenced.
+	FFaerieItemContainerPath NewPath = BasePath;
 	NewPath.Containers.Add(Container);
+	OutPaths.Add(NewPath);
 
-	for (UFaerieItem* Item : KeyFilter(Container).Run<FMutableFilter>().Items())
+	// Children are read from the container graph, instead of searching every item for containers.
+	for (const TWeakObjectPtr<UFaerieItemContainerBase>& SubContainer : Container->GetChildContainers())
 	{
-		for (UFaerieItemContainerBase* SubContainer : Faerie::SubObject::Iterate(Item))
+		if (SubContainer.IsValid())
 		{
-			BuildPath_Recurse(SubContainer, NewPath, OutPaths);
+			BuildPath_Recurse(SubContainer.Get(), NewPath, OutPaths);
 		}
 	}
 }
@@ -38,7 +36,7 @@ FFaerieItemContainerPath FFaerieItemContainerPath::BuildParentPath(UFaerieItemCo
 	while (IsValid(Container))
 	{
 		Path.Containers.Add(Container);
-		Container = Container->GetTypedOuter<UFaerieItemContainerBase>();
+		Container = Container->GetParentContainer();
 	}
 
 	return Path;
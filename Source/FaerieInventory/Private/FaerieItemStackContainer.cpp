@@ -3,6 +3,7 @@
 #include "FaerieItemStackContainer.h"
 
 #include "FaerieContainerFilter.h"
+#include "FaerieContainerTransaction.h"
 #include "FaerieContainerIterator.h"
 #include "FaerieInventoryLog.h"
 #include "FaerieItem.h"
@@ -173,6 +174,61 @@ bool UFaerieItemStackContainer::Contains(const FEntryKey Key) const
 	return StoredKey == Key;
 }
 
+void UFaerieItemStackContainer::BeginTransaction()
+{
+	Super::BeginTransaction();
+	TransactionStack = ItemStack;
+	TransactionKey = StoredKey;
+}
+
+void UFaerieItemStackContainer::RollbackTransaction()
+{
+	// Like UFaerieItemStorage, the original item is reclaimed once every container has rolled back, so that it has been
+	// released by whichever container took it.
+	if (ItemStack.Item != TransactionStack.Item)
+	{
+		if (IsValid(ItemStack.Item))
+		{
+			Faerie::ReleaseOwnership(this, ItemStack.Item);
+		}
+		ReclaimTransactionItem = IsValid(TransactionStack.Item);
+	}
+
+	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, ItemStack, this);
+	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, StoredKey, this);
+	ItemStack = TransactionStack;
+	StoredKey = TransactionKey;
+
+	// Restore extensions now that our content is back.
+	Super::RollbackTransaction();
+}
+
+void UFaerieItemStackContainer::EndTransaction(const bool Committed)
+{
+	Super::EndTransaction(Committed);
+
+	const FFaerieItemStack OriginalStack = MoveTemp(TransactionStack);
+	const FEntryKey OriginalKey = TransactionKey;
+	TransactionStack = FFaerieItemStack();
+	TransactionKey = FEntryKey::InvalidKey;
+
+	if (!Committed)
+	{
+		if (ReclaimTransactionItem)
+		{
+			Faerie::TakeOwnership(this, ItemStack.Item);
+			ReclaimTransactionItem = false;
+		}
+		return;
+	}
+
+	// Send the change that was held back, if the transaction left us any different.
+	if (OriginalKey != StoredKey || OriginalStack.Copies != ItemStack.Copies)
+	{
+		BroadcastChange(IsFilled() ? Faerie::Inventory::Tags::SlotSet : Faerie::Inventory::Tags::SlotTake);
+	}
+}
+
 FFaerieItemStackView UFaerieItemStackContainer::View(const FEntryKey Key) const
 {
 	if (Contains(Key))
@@ -346,6 +402,8 @@ void UFaerieItemStackContainer::BroadcastChange(const FFaerieInventoryTag Event)
 
 void UFaerieItemStackContainer::SetStoredItem_Impl(const FFaerieItemStack& Stack)
 {
+	Faerie::Container::FTransaction::PreEdit(this);
+
 	Extensions->PreAddition(this, Stack);
 
 	Faerie::Inventory::FEventLog Event;
@@ -375,7 +433,11 @@ void UFaerieItemStackContainer::SetStoredItem_Impl(const FFaerieItemStack& Stack
 
 	Extensions->PostAddition(this, Event);
 
-	BroadcastChange(Faerie::Inventory::Tags::SlotSet);
+	// Held back until the transaction commits. See EndTransaction.
+	if (!IsInTransaction())
+	{
+		BroadcastChange(Faerie::Inventory::Tags::SlotSet);
+	}
 }
 
 bool UFaerieItemStackContainer::CouldSetInSlot(const FFaerieItemStackView View) const
@@ -474,6 +536,8 @@ FFaerieItemStack UFaerieItemStackContainer::TakeItemFromSlot(int32 Copies)
 		Copies = ItemStack.Copies;
 	}
 
+	Faerie::Container::FTransaction::PreEdit(this);
+
 	Extensions->PreRemoval(this, StoredKey, Copies);
 
 	Faerie::Inventory::FEventLog Event;
@@ -504,7 +568,10 @@ FFaerieItemStack UFaerieItemStackContainer::TakeItemFromSlot(int32 Copies)
 
 	Extensions->PostRemoval(this, Event);
 
-	BroadcastChange(Faerie::Inventory::Tags::SlotTake);
+	if (!IsInTransaction())
+	{
+		BroadcastChange(Faerie::Inventory::Tags::SlotTake);
+	}
 
 	return OutStack;
 }
@@ -524,7 +591,15 @@ bool UFaerieItemStackContainer::IsFilled() const
 	return IsValid(ItemStack.Item) && ItemStack.Copies > 0;
 }
 
-void UFaerieItemStackContainer::OnRep_ItemStack()
+void UFaerieItemStackContainer::OnRep_ItemStack(const FFaerieItemStack& OldItemStack)
 {
+	if (OldItemStack.Item != ItemStack.Item)
+	{
+		UnbindReplicatedItem(OldItemStack.Item);
+		UnlinkItemContainers(OldItemStack.Item);
+		BindReplicatedItem(ItemStack.Item);
+		LinkItemContainers(ItemStack.Item);
+	}
+
 	BroadcastChange(Faerie::Inventory::Tags::SlotClientReplication);
 }
\ No newline at end of file
@@ -1,13 +1,21 @@
 ﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
 
 #include "FaerieItemStorage.h"
+#include "FaerieContainerTransaction.h"
+#include "FaerieDataSystemMemory.h"
+#include "FaerieDataSystemTrace.h"
 #include "FaerieInventoryLog.h"
 #include "FaerieInventorySettings.h"
 #include "FaerieItem.h"
+#include "FaerieItemCompactFormat.h"
+#include "FaerieItemInternTable.h"
+#include "FaerieItemStorageLazySource.h"
 #include "FaerieItemStorageStatics.h"
+#include "FaerieItemToken.h"
 #include "InventoryStorageProxy.h"
 #include "ItemContainerExtensionBase.h"
 
+#include "Algo/Compare.h"
 #include "Algo/Transform.h"
 #include "Net/UnrealNetwork.h"
 
@@ -25,6 +33,11 @@
 DECLARE_STATS_GROUP(TEXT("FaerieItemStorage"), STATGROUP_FaerieItemStorage, STATCAT_Advanced);
 DECLARE_CYCLE_STAT(TEXT("Add to Storage"), STAT_Storage_Add, STATGROUP_FaerieItemStorage);
 DECLARE_CYCLE_STAT(TEXT("Remove from Storage"), STAT_Storage_Remove, STATGROUP_FaerieItemStorage);
+DECLARE_CYCLE_STAT(TEXT("Make Save Data"), STAT_Storage_MakeSaveData, STATGROUP_FaerieItemStorage);
+DECLARE_CYCLE_STAT(TEXT("Load Save Data"), STAT_Storage_LoadSaveData, STATGROUP_FaerieItemStorage);
+
+TRACE_DECLARE_INT_COUNTER(FaerieStorage_EntriesCreated, TEXT("FaerieDataSystem/Storage/Entries Created"));
+TRACE_DECLARE_INT_COUNTER(FaerieStorage_EntriesRemoved, TEXT("FaerieDataSystem/Storage/Entries Removed"));
 
 namespace Faerie::Storage
 {
@@ -62,6 +75,14 @@ namespace Faerie::Storage
 
 	using namespace Container;
 
+	// Compares what client prediction can change about an entry.
+	bool PredictedEntriesMatch(const FInventoryEntry& A, const FInventoryEntry& B)
+	{
+		return A.Key == B.Key &&
+			A.GetItem() == B.GetItem() &&
+			Algo::Compare(A.GetStacks(), B.GetStacks());
+	}
+
 	class FEntryFilter_ForInterface final : public IFilter
 	{
 	public:
@@ -174,12 +195,25 @@ FInstancedStruct UFaerieItemStorage::MakeSaveData(TMap<FGuid, FInstancedStruct>&
 	ensureMsgf(GetDefault<UFaerieInventorySettings>()->ContainerMutableBehavior == EFaerieContainerOwnershipBehavior::Rename,
 		TEXT("Flakes relies on ownership of sub-objects. Rename must be enabled! (ProjectSettings -> Faerie Inventory -> Container Mutable Behavior)"));
 
+	FAERIE_SCOPE_CYCLE_COUNTER(STAT_Storage_MakeSaveData);
+
 	RavelExtensionData(ExtensionData);
+
+	if (GetDefault<UFaerieInventorySettings>()->UseCompactStorageSaveData)
+	{
+		return FInstancedStruct::Make(MakeCompactSaveData());
+	}
+
+	// The full entry array is copied, so every item must exist first.
+	const_cast<UFaerieItemStorage*>(this)->EntryMap.MaterializeAll();
 	return FInstancedStruct::Make(EntryMap);
 }
 
 void UFaerieItemStorage::LoadSaveData(const FConstStructView ItemData, UFaerieItemContainerExtensionData* ExtensionData)
 {
+	FAERIE_SCOPE_CYCLE_COUNTER(STAT_Storage_LoadSaveData);
+	LLM_SCOPE_BYTAG(ItemStorage);
+
 	// Clear out state
 
 	Clear(Faerie::Inventory::Tags::RemovalDeletion);
@@ -188,22 +222,49 @@ void UFaerieItemStorage::LoadSaveData(const FConstStructView ItemData, UFaerieIt
 	Extensions->DeinitializeExtension(this);
 
 	// Load in save data
-	EntryMap = ItemData.Get<const FInventoryContent>();
-	TArray<FEntryKey, TInlineAllocator<4>> InvalidKeys;
-	for (const FInventoryEntry& Entry : EntryMap)
+	if (const FFaerieItemStorageSaveData* CompactData = ItemData.GetPtr<const FFaerieItemStorageSaveData>())
 	{
-		if (!Faerie::ValidateItemData(Entry.GetItem()))
+		// Compact data validates items as it reads them.
+		if (!LoadCompactSaveData(*CompactData))
 		{
-			InvalidKeys.Add(Entry.Key);
+			// A partial read can't be trusted to be a consistent subset of the save, so load nothing instead.
+			UE_LOG(LogFaerieInventory, Error, TEXT("LoadSaveData: '%s' will be empty, as its save data could not be loaded."), *GetName())
+			EntryMap.Entries.Reset();
+			EntryMap.LazySource.Reset();
 		}
 	}
-
-	for (const FEntryKey InvalidKey : InvalidKeys)
+	else
 	{
-		EntryMap.Remove(InvalidKey);
+		EntryMap = ItemData.Get<const FInventoryContent>();
+
+		TArray<FEntryKey, TInlineAllocator<4>> InvalidKeys;
+		for (FInventoryEntry& Entry : EntryMap.Entries)
+		{
+			if (!Faerie::ValidateItemData(Entry.GetItem()))
+			{
+				InvalidKeys.Add(Entry.Key);
+				continue;
+			}
+
+			// Merge immutable items with identical ones that are already loaded.
+			if (const UFaerieItem* Loaded = Entry.GetItem();
+				Faerie::ItemData::FItemInternTable::CanIntern(Loaded))
+			{
+				Entry.ItemObject = Faerie::ItemData::FItemInternTable::Get().Intern(const_cast<UFaerieItem*>(Loaded));
+			}
+
+			// Loaded items are already bound to us, but containers in them still need linking.
+			LinkItemContainers(Entry.GetItem());
+		}
+
+		for (const FEntryKey InvalidKey : InvalidKeys)
+		{
+			EntryMap.Remove(InvalidKey);
+		}
 	}
 
 	EntryMap.MarkArrayDirty();
+	TokenIndex.Invalidate();
 
 	// Rebind replication functions out into this class.
 	EntryMap.ChangeListener = this;
@@ -355,6 +416,59 @@ TArray<FFaerieAddress> UFaerieItemStorage::FILTER_GetKeyAddresses(const FEntryKe
 	return GetAddressesForEntry(Key);
 }
 
+void UFaerieItemStorage::GetMemoryUsage(Faerie::Memory::FReport& Report) const
+{
+	Super::GetMemoryUsage(Report);
+
+	Report.AddAllocation(TEXT("Entries"), EntryMap.Entries);
+	for (const FInventoryEntry& Entry : EntryMap.Entries)
+	{
+		Report.AddAllocation(TEXT("Entries"), Entry.Stacks);
+
+		// Only mutable instances belong to a single storage. Immutable items are shared, either with an asset, or between
+		// every container holding one through the intern table. Unmaterialized items are skipped, rather than created.
+		const UFaerieItem* Item = Entry.ItemObject;
+		if (!Entry.IsMaterialized() || !IsValid(Item) || !Item->IsInstanceMutable()) continue;
+
+		Report.Add(TEXT("Items"), Item->GetClass()->GetStructureSize());
+		Report.Add(TEXT("Items"), Item->GetTokens().NumBytes());
+		Report.Add(TEXT("Items"), Item->GetTokenLookupSize());
+		for (const UFaerieItemToken* Token : Item->GetTokens())
+		{
+			if (IsValid(Token) && Token->GetOuter() == Item)
+			{
+				Report.Add(TEXT("Tokens"), Token->GetClass()->GetStructureSize());
+			}
+		}
+	}
+
+	Report.AddAllocation(TEXT("Replication"), EntryMap.ItemMap);
+	Report.AddAllocation(TEXT("Replication"), EntryMap.GuidReferencesMap);
+
+	Report.AddAllocation(TEXT("Stack Proxies"), LocalStackProxies);
+	for (auto&& Proxy : LocalStackProxies)
+	{
+		if (Proxy.Value.IsValid())
+		{
+			Report.Add(TEXT("Stack Proxies"), Proxy.Value->GetClass()->GetStructureSize());
+		}
+	}
+
+	Report.AddAllocation(TEXT("Transaction"), TransactionEntries);
+	Report.AddAllocation(TEXT("Transaction"), TransactionReclaimedItems);
+	Report.Add(TEXT("Prediction"), Prediction.GetAllocatedSize());
+
+	if (EntryMap.LazySource.IsValid())
+	{
+		Report.Add(TEXT("Lazy Load Source"), EntryMap.LazySource->GetAllocatedSize());
+	}
+
+	if (IndexTokens)
+	{
+		Report.Add(TEXT("Token Index"), TokenIndex.GetAllocatedSize());
+	}
+}
+
 FFaerieItemStack UFaerieItemStorage::Release(const FFaerieItemStackView Stack)
 {
 	const FEntryKey Key = FindItem(Stack.Item.Get(), EFaerieItemEqualsCheck::ComparePointers);
@@ -400,6 +514,12 @@ void UFaerieItemStorage::PostContentAdded(const FInventoryEntry& Entry)
 		return;
 	}
 
+	// The index is kept current during transactions too, so that filters run by the transaction see its edits.
+	TokenIndex.OnEntryAdded(Entry);
+
+	// Events are held back until the transaction commits. See EndTransaction.
+	if (IsInTransaction()) return;
+
 	OnKeyAdded.Broadcast(this, Entry.Key);
 
 	// Proxies may already exist for keys on the client if they are replicated by extensions or other means, and
@@ -433,6 +553,10 @@ void UFaerieItemStorage::PreContentRemoved(const FInventoryEntry& Entry)
 		return;
 	}
 
+	TokenIndex.OnEntryRemoved(Entry.Key);
+
+	if (IsInTransaction()) return;
+
 	OnKeyRemoved.Broadcast(this, Entry.Key);
 
 	// Collate addresses
@@ -465,7 +589,9 @@ void UFaerieItemStorage::PostContentChanged(const FInventoryEntry& Entry, const
 		return;
 	}
 
-	if (!Entry.IsValid())
+	TokenIndex.OnEntryChanged(Entry);
+
+	if (!Entry.IsValid() || IsInTransaction())
 	{
 		return;
 	}
@@ -556,6 +682,98 @@ void UFaerieItemStorage::PostContentChanged(const FInventoryEntry& Entry, const
 	}
 }
 
+void UFaerieItemStorage::BeginTransaction()
+{
+	Super::BeginTransaction();
+	TransactionEntries = EntryMap.Entries;
+}
+
+void UFaerieItemStorage::RollbackTransaction()
+{
+	// Items gained during the transaction are given up, and items lost are reclaimed once every container has rolled
+	// back, so that items moved between two storages have been released by the other side first.
+	TSet<const UFaerieItem*> OriginalItems;
+	OriginalItems.Reserve(TransactionEntries.Num());
+	for (const FInventoryEntry& Entry : TransactionEntries)
+	{
+		OriginalItems.Add(Entry.ItemObject);
+	}
+
+	TSet<const UFaerieItem*> CurrentItems;
+	CurrentItems.Reserve(EntryMap.Num());
+	for (const FInventoryEntry& Entry : EntryMap.Entries)
+	{
+		CurrentItems.Add(Entry.ItemObject);
+		if (IsValid(Entry.ItemObject) && !OriginalItems.Contains(Entry.ItemObject))
+		{
+			Faerie::ReleaseOwnership(this, Entry.ItemObject);
+		}
+	}
+
+	for (const UFaerieItem* Item : OriginalItems)
+	{
+		if (IsValid(Item) && !CurrentItems.Contains(Item))
+		{
+			TransactionReclaimedItems.Add(Item);
+		}
+	}
+
+	// The restored entries still carry the replication keys clients last saw, so nothing is re-sent for them.
+	EntryMap.Entries = MoveTemp(TransactionEntries);
+	EntryMap.MarkArrayDirty();
+	TokenIndex.Invalidate();
+
+	// Restore extensions now that our content is back.
+	Super::RollbackTransaction();
+}
+
+void UFaerieItemStorage::EndTransaction(const bool Committed)
+{
+	Super::EndTransaction(Committed);
+
+	TArray<FInventoryEntry> OriginalEntries = MoveTemp(TransactionEntries);
+	TArray<const UFaerieItem*> ReclaimedItems = MoveTemp(TransactionReclaimedItems);
+
+	if (!Committed)
+	{
+		for (const UFaerieItem* Item : ReclaimedItems)
+		{
+			Faerie::TakeOwnership(this, Item);
+		}
+		return;
+	}
+
+	// Send the net result of the transaction. Both arrays are sorted by key, so they can be walked together.
+	int32 OriginalIndex = 0;
+	int32 CurrentIndex = 0;
+	while (OriginalIndex < OriginalEntries.Num() || CurrentIndex < EntryMap.Num())
+	{
+		const FInventoryEntry* Original = OriginalEntries.IsValidIndex(OriginalIndex) ? &OriginalEntries[OriginalIndex] : nullptr;
+		const FInventoryEntry* Current = EntryMap.Entries.IsValidIndex(CurrentIndex) ? &EntryMap.Entries[CurrentIndex] : nullptr;
+
+		if (Original && (!Current || Original->Key < Current->Key))
+		{
+			// Removal events are late, so they are sent with the entry as it was.
+			PreContentRemoved(*Original);
+			++OriginalIndex;
+		}
+		else if (Current && (!Original || Current->Key < Original->Key))
+		{
+			PostContentAdded(*Current);
+			++CurrentIndex;
+		}
+		else
+		{
+			if (!Faerie::Storage::PredictedEntriesMatch(*Original, *Current))
+			{
+				PostContentChanged(*Current, FInventoryContent::Server_ItemHandleClosed, nullptr);
+			}
+			++OriginalIndex;
+			++CurrentIndex;
+		}
+	}
+}
+
 void UFaerieItemStorage::BroadcastAddressEvent(const EFaerieAddressEventType Type, const FFaerieAddress Address)
 {
 	OnAddressEventCallback.Broadcast(this, Type, MakeArrayView(&Address, 1));
@@ -571,6 +789,182 @@ void UFaerieItemStorage::BroadcastAddressEventBulk(const EFaerieAddressEventType
 	}
 }
 
+FFaerieItemStorageSaveData UFaerieItemStorage::MakeCompactSaveData() const
+{
+	Faerie::ItemData::FCompactItemWriter Writer(this);
+	FArchive& Body = Writer.GetBodyArchive();
+
+	uint32 NumEntries = EntryMap.Num();
+	Body.SerializeIntPacked(NumEntries);
+
+	// Entry keys, and stack keys within an entry, are sorted, so they are written as deltas from the previous key.
+	int32 PreviousEntryKey = 0;
+	for (const FInventoryEntry& Entry : EntryMap)
+	{
+		uint32 EntryKeyDelta = Entry.Key.Value() - PreviousEntryKey;
+		uint32 ItemIndex = Writer.AddItem(Entry.GetItem());
+		uint32 NumStacks = Entry.Stacks.Num();
+		Body.SerializeIntPacked(EntryKeyDelta);
+		Body.SerializeIntPacked(ItemIndex);
+		Body.SerializeIntPacked(NumStacks);
+		PreviousEntryKey = Entry.Key.Value();
+
+		int32 PreviousStackKey = 0;
+		for (const FKeyedStack& Stack : Entry.Stacks)
+		{
+			uint32 StackKeyDelta = Stack.Key.Value() - PreviousStackKey;
+			uint32 Amount = Stack.Stack;
+			Body.SerializeIntPacked(StackKeyDelta);
+			Body.SerializeIntPacked(Amount);
+			PreviousStackKey = Stack.Key.Value();
+		}
+	}
+
+	FFaerieItemStorageSaveData SaveData;
+	Writer.Finish(SaveData.Data, SaveData.FallbackItems);
+	return SaveData;
+}
+
+bool UFaerieItemStorage::LoadCompactSaveData(const FFaerieItemStorageSaveData& SaveData)
+{
+	EntryMap.LazySource.Reset();
+
+	// The reader is kept on the heap, so that it can be handed off to lazily loaded entries.
+	TUniquePtr<Faerie::ItemData::FCompactItemReader> ReaderPtr =
+		MakeUnique<Faerie::ItemData::FCompactItemReader>(SaveData.Data, SaveData.FallbackItems);
+	Faerie::ItemData::FCompactItemReader& Reader = *ReaderPtr;
+	if (Reader.HasError())
+	{
+		UE_LOG(LogFaerieInventory, Error, TEXT("LoadCompactSaveData: Failed to read save data for '%s'!"), *GetName())
+		return false;
+	}
+
+	FArchive& Body = Reader.GetBodyArchive();
+
+	uint32 NumEntries = 0;
+	Body.SerializeIntPacked(NumEntries);
+	if (NumEntries > Body.TotalSize())
+	{
+		Body.SetError();
+	}
+	else
+	{
+		EntryMap.Entries.Reserve(NumEntries);
+	}
+
+	// Large storages only index their entries, and leave creating items until they are first accessed.
+	const int32 LazyThreshold = GetDefault<UFaerieInventorySettings>()->LazyLoadEntryThreshold;
+	TSharedPtr<Faerie::Storage::FLazyItemSource> LazySource;
+	if (LazyThreshold > 0 && NumEntries > static_cast<uint32>(LazyThreshold))
+	{
+		LazySource = MakeShared<Faerie::Storage::FLazyItemSource>(this, MoveTemp(ReaderPtr));
+	}
+
+	int32 EntryKey = 0;
+	for (uint32 i = 0; i < NumEntries && !Body.IsError(); ++i)
+	{
+		uint32 EntryKeyDelta = 0;
+		uint32 ItemIndex = 0;
+		uint32 NumStacks = 0;
+		Body.SerializeIntPacked(EntryKeyDelta);
+		Body.SerializeIntPacked(ItemIndex);
+		Body.SerializeIntPacked(NumStacks);
+		if (NumStacks > Body.TotalSize())
+		{
+			Body.SetError();
+			break;
+		}
+		EntryKey += EntryKeyDelta;
+
+		FInventoryEntry Entry;
+		Entry.Key = FEntryKey(EntryKey);
+		Entry.Stacks.Reserve(NumStacks);
+
+		int32 StackKey = 0;
+		for (uint32 j = 0; j < NumStacks; ++j)
+		{
+			uint32 StackKeyDelta = 0;
+			uint32 Amount = 0;
+			Body.SerializeIntPacked(StackKeyDelta);
+			Body.SerializeIntPacked(Amount);
+			StackKey += StackKeyDelta;
+			Entry.Stacks.Emplace(FStackKey(StackKey), static_cast<int32>(Amount));
+		}
+
+		if (!Entry.Stacks.IsEmpty())
+		{
+			Entry.KeyGen.SetPosition(Entry.Stacks.Last().Key);
+		}
+
+		if (LazySource.IsValid())
+		{
+			Entry.LazySource = LazySource;
+			Entry.LazyItemIndex = ItemIndex;
+
+			// Fallback items already exist, and nothing else is keeping them alive, so they are taken immediately.
+			if (Reader.IsItemLoaded(ItemIndex))
+			{
+				Entry.GetItem();
+			}
+
+			EntryMap.Entries.Add(MoveTemp(Entry));
+			continue;
+		}
+
+		Entry.ItemObject = Reader.GetItem(ItemIndex);
+
+		if (!Faerie::ValidateItemData(Entry.GetItem()))
+		{
+			continue;
+		}
+
+		// Packed items are created fresh, and need to be bound to us.
+		if (Entry.ItemObject->GetOuter() == GetTransientPackage() && Entry.ItemObject->CanMutate())
+		{
+			Faerie::TakeOwnership(this, Entry.ItemObject);
+		}
+		else
+		{
+			LinkItemContainers(Entry.ItemObject);
+		}
+
+		Entry.UpdateCachedStackLimit();
+		EntryMap.Entries.Add(MoveTemp(Entry));
+	}
+
+	if (Body.IsError())
+	{
+		UE_LOG(LogFaerieInventory, Error, TEXT("LoadCompactSaveData: Corrupt entry data for '%s'!"), *GetName())
+		return false;
+	}
+
+	EntryMap.LazySource = LazySource;
+	return true;
+}
+
+void UFaerieItemStorage::RemoveInvalidLazyEntries(const UFaerieItem* Placeholder)
+{
+	if (!IsValid(Placeholder))
+	{
+		return;
+	}
+
+	TArray<FEntryKey> InvalidKeys;
+	for (const FInventoryEntry& Entry : EntryMap.Entries)
+	{
+		// Compared directly, so that entries which haven't been accessed yet aren't created here.
+		if (Entry.ItemObject == Placeholder)
+		{
+			InvalidKeys.Add(Entry.Key);
+		}
+	}
+
+	for (const FEntryKey Key : InvalidKeys)
+	{
+		RemoveFromEntryImpl(Key, Faerie::ItemData::EntireStack, Faerie::Inventory::Tags::RemovalDeletion);
+	}
+}
+
 
 /**------------------------------*/
 	/*	  INTERNAL IMPLEMENTATIONS	 */
@@ -581,6 +975,17 @@ const FInventoryEntry* UFaerieItemStorage::GetEntrySafe(const FEntryKey Key) con
 	return EntryMap.Find(Key);
 }
 
+const Faerie::Storage::FTokenIndex* UFaerieItemStorage::GetTokenIndex() const
+{
+	if (!IndexTokens)
+	{
+		return nullptr;
+	}
+
+	TokenIndex.Sync(EntryMap);
+	return &TokenIndex;
+}
+
 UInventoryStackProxy* UFaerieItemStorage::GetStackProxyImpl(const FFaerieAddress Address) const
 {
 	// Don't create proxies for invalid keys.
@@ -594,6 +999,8 @@ UInventoryStackProxy* UFaerieItemStorage::GetStackProxyImpl(const FFaerieAddress
 		}
 	}
 
+	LLM_SCOPE_BYTAG(ItemStorageProxies);
+
 	ThisClass* This = const_cast<ThisClass*>(this);
 
 	FEntryKey Entry;
@@ -627,7 +1034,9 @@ Faerie::Inventory::FEventLog UFaerieItemStorage::AddStackImpl(const FFaerieItemS
 		return Faerie::Inventory::FEventLog::AdditionFailed("AddStackImpl was passed an invalid stack.");
 	}
 
-	SCOPE_CYCLE_COUNTER(STAT_Storage_Add);
+	FAERIE_SCOPE_CYCLE_COUNTER(STAT_Storage_Add);
+
+	Faerie::Container::FTransaction::PreEdit(this);
 
 	Faerie::Inventory::FEventLog Event;
 
@@ -671,6 +1080,7 @@ Faerie::Inventory::FEventLog UFaerieItemStorage::AddStackImpl(const FFaerieItemS
 
 		EntryMap.AppendUnsafe(NewEntry);
 		Event.EntryTouched = NewEntry.Key;
+		TRACE_COUNTER_INCREMENT(FaerieStorage_EntriesCreated);
 	}
 
 	Event.Success = true;
@@ -684,10 +1094,12 @@ Faerie::Inventory::FEventLog UFaerieItemStorage::AddStackImpl(const FFaerieItemS
 Faerie::Inventory::FEventLog UFaerieItemStorage::RemoveFromEntryImpl(const FEntryKey Key, const int32 Amount,
 																	 const FFaerieInventoryTag Reason)
 {
-	SCOPE_CYCLE_COUNTER(STAT_Storage_Remove);
+	FAERIE_SCOPE_CYCLE_COUNTER(STAT_Storage_Remove);
 
 	// RemoveEntryImpl should not be called with unvalidated parameters.
 	check(Contains(Key));
+
+	Faerie::Container::FTransaction::PreEdit(this);
 	check(Faerie::ItemData::IsValidStackAmount(Amount));
 	check(Reason.MatchesTag(Faerie::Inventory::Tags::RemovalBase))
 
@@ -727,6 +1139,7 @@ Faerie::Inventory::FEventLog UFaerieItemStorage::RemoveFromEntryImpl(const FEntr
 	{
 		UE_LOG(LogFaerieInventory, Log, TEXT("Removing entire entry at: '%s'"), *Key.ToString());
 		EntryMap.Remove(Key);
+		TRACE_COUNTER_INCREMENT(FaerieStorage_EntriesRemoved);
 	}
 
 	Event.Success = true;
@@ -739,10 +1152,12 @@ Faerie::Inventory::FEventLog UFaerieItemStorage::RemoveFromEntryImpl(const FEntr
 Faerie::Inventory::FEventLog UFaerieItemStorage::RemoveFromStackImpl(const FFaerieAddress Address, const int32 Amount,
 																	 const FFaerieInventoryTag Reason)
 {
-	SCOPE_CYCLE_COUNTER(STAT_Storage_Remove);
+	FAERIE_SCOPE_CYCLE_COUNTER(STAT_Storage_Remove);
 
 	// RemoveFromStackImpl should not be called with unvalidated parameters.
 	check(Contains(Address));
+
+	Faerie::Container::FTransaction::PreEdit(this);
 	check(Faerie::ItemData::IsValidStackAmount(Amount));
 	check(Reason.MatchesTag(Faerie::Inventory::Tags::RemovalBase))
 
@@ -799,6 +1214,7 @@ Faerie::Inventory::FEventLog UFaerieItemStorage::RemoveFromStackImpl(const FFaer
 	{
 		UE_LOG(LogFaerieInventory, Log, TEXT("Removing entire stack at: '%s_%s'"), *EntryKey.ToString(), *StackKey.ToString());
 		EntryMap.Remove(EntryKey);
+		TRACE_COUNTER_INCREMENT(FaerieStorage_EntriesRemoved);
 	}
 
 	// De-tally from total items.
@@ -990,6 +1406,11 @@ FFaerieAddress UFaerieItemStorage::QueryFirst(const Faerie::Container::FAddressP
 	return FFaerieAddress();
 }
 
+bool UFaerieItemStorage::HasUnmaterializedEntries() const
+{
+	return EntryMap.HasUnmaterializedEntries();
+}
+
 bool UFaerieItemStorage::CanAddStack(const FFaerieItemStackView Stack, const EFaerieStorageAddStackBehavior AddStackBehavior) const
 {
 	if (!Stack.Item.IsValid() ||
@@ -998,10 +1419,10 @@ bool UFaerieItemStorage::CanAddStack(const FFaerieItemStackView Stack, const EFa
 		return false;
 	}
 
-	if (UFaerieItem* Mutable = Stack.Item->MutateCast())
+	if (const UFaerieItem* Mutable = Stack.Item->MutateCast())
 	{
 		// Prevent recursive storage for mutable items
-		if (Faerie::GetAllContainersInItemRecursive(Mutable).Contains(this))
+		if (IsNestedIn(Mutable))
 		{
 			return false;
 		}
@@ -1028,10 +1449,10 @@ bool UFaerieItemStorage::CanAddStacks(const TArray<FFaerieItemStackView>& Stacks
 			return false;
 		}
 
-		if (UFaerieItem* Mutable = Stack.Item->MutateCast())
+		if (const UFaerieItem* Mutable = Stack.Item->MutateCast())
 		{
 			// Prevent recursive storage for mutable items
-			if (Faerie::GetAllContainersInItemRecursive(Mutable).Contains(this))
+			if (IsNestedIn(Mutable))
 			{
 				return false;
 			}
@@ -1349,13 +1770,16 @@ bool UFaerieItemStorage::MergeStacks(const FEntryKey Entry, const FStackKey From
 	const int32 AmountB = EntryPtr->GetStack(ToStack);
 
 	// Ensure both stacks exist and B isn't already full
-	if (EntryPtr->Contains(FromStack) ||
-		AmountB != INDEX_NONE ||
+	if (FromStack == ToStack ||
+		!EntryPtr->Contains(FromStack) ||
+		!EntryPtr->Contains(ToStack) ||
 		AmountB == EntryPtr->GetCachedStackLimit())
 	{
 		return false;
 	}
 
+	const int32 MoveAmount = Amount == Faerie::ItemData::EntireStack ? EntryPtr->GetStack(FromStack) : Amount;
+
 	Faerie::Inventory::FEventLog Event;
 	Event.Amount = AmountB; // Initially store the amount in stack B here.
 	Event.Item = EntryPtr->GetItem();
@@ -1365,10 +1789,12 @@ bool UFaerieItemStorage::MergeStacks(const FEntryKey Entry, const FStackKey From
 	Event.Type = Faerie::Inventory::Tags::Merge;
 	Event.Success = true;
 
+	Faerie::Container::FTransaction::PreEdit(this);
+
 	// Open Mutable Scope
 	{
 		FInventoryEntry::FMutableAccess Handle = EntryMap.GetMutableEntry(Entry);
-		const int32 Remainder = Handle.MoveStack(FromStack, ToStack, Amount);
+		const int32 Remainder = Handle.MoveStack(FromStack, ToStack, MoveAmount);
 
 		// We didn't move this many.
 		Event.Amount -= Remainder;
@@ -1412,6 +1838,8 @@ bool UFaerieItemStorage::SplitStack(const FFaerieAddress Address, const int32 Am
 	Event.Type = Faerie::Inventory::Tags::Split;
 	Event.Success = true;
 
+	Faerie::Container::FTransaction::PreEdit(this);
+
 	// Split the stack
 	{
 		FInventoryEntry::FMutableAccess Handle = EntryMap.GetMutableEntry(Entry);
@@ -1463,6 +1891,166 @@ void UFaerieItemStorage::Dump(UFaerieItemStorage* ToStorage)
 	}
 }
 
+void UFaerieItemStorage::MaterializeAllEntries()
+{
+	EntryMap.MaterializeAll();
+}
+
+void UFaerieItemStorage::SetTokenIndexEnabled(const bool Enabled)
+{
+	IndexTokens = Enabled;
+
+	// Either frees the index, or has it built the next time a filter reads it.
+	TokenIndex.Invalidate();
+}
+
+bool UFaerieItemStorage::HasPendingPredictions() const
+{
+	return Prediction.IsPredicting();
+}
+
+bool UFaerieItemStorage::PredictSplitStack(UFaerieInventoryClient* Client, const Faerie::ClientAction::FPredictionKey Key,
+										   const FFaerieAddress Address, const int32 Amount)
+{
+	FEntryKey Entry;
+	FStackKey Stack;
+	Decode(Address, Entry, Stack);
+	const FInventoryEntry* EntryPtr = GetEntrySafe(Entry);
+	if (!EntryPtr ||
+		Amount <= 0 ||
+		Amount >= EntryPtr->GetStack(Stack))
+	{
+		return false;
+	}
+
+	if (!CanEditStack(Address, Faerie::Inventory::Tags::Split))
+	{
+		return false;
+	}
+
+	return PredictEdit(Client, Key,
+		[this, Entry, Stack, Amount]
+		{
+			FInventoryEntry::FMutableAccess Handle = EntryMap.GetMutableEntry(Entry);
+
+			// Stack keys are generated on the server, so sync the local generator to the newest key we know of. The server
+			// may have used keys that were removed since, in which case this guess is replaced during reconciliation.
+			Handle->KeyGen.Reset();
+			Handle->KeyGen.SetPosition(Handle->Stacks.Last().Key);
+
+			Handle.SplitStack(Stack, Amount);
+			return true;
+		});
+}
+
+bool UFaerieItemStorage::PredictMergeStacks(UFaerieInventoryClient* Client, const Faerie::ClientAction::FPredictionKey Key,
+											const FEntryKey Entry, const FStackKey FromStack, const FStackKey ToStack, const int32 Amount)
+{
+	const FInventoryEntry* EntryPtr = GetEntrySafe(Entry);
+	if (!EntryPtr ||
+		FromStack == ToStack ||
+		!EntryPtr->Contains(FromStack) ||
+		!EntryPtr->Contains(ToStack) ||
+		EntryPtr->GetStack(ToStack) == EntryPtr->GetCachedStackLimit())
+	{
+		return false;
+	}
+
+	if (!CanEditStack(Encode(Entry, FromStack), Faerie::Inventory::Tags::Merge) ||
+		!CanEditStack(Encode(Entry, ToStack), Faerie::Inventory::Tags::Merge))
+	{
+		return false;
+	}
+
+	const int32 MoveAmount = Amount == Faerie::ItemData::EntireStack ? EntryPtr->GetStack(FromStack) : Amount;
+
+	return PredictEdit(Client, Key,
+		[this, Entry, FromStack, ToStack, MoveAmount]
+		{
+			FInventoryEntry::FMutableAccess Handle = EntryMap.GetMutableEntry(Entry);
+			Handle.MoveStack(FromStack, ToStack, MoveAmount);
+			return true;
+		});
+}
+
+bool UFaerieItemStorage::PredictEdit(UFaerieInventoryClient* Client, const Faerie::ClientAction::FPredictionKey Key,
+									 const TFunctionRef<bool()> Edit)
+{
+	if (!Prediction.Predict(Key, EntryMap.Entries, Edit, &Faerie::Storage::PredictedEntriesMatch))
+	{
+		return false;
+	}
+
+	PredictionListener.Bind(Client, Faerie::ClientAction::FPredictionResolved::FDelegate::CreateUObject(this, &ThisClass::OnPredictionResolved));
+	return true;
+}
+
+void UFaerieItemStorage::RecordReplicatedEntry(const FInventoryEntry& Entry, const bool Removed)
+{
+	if (Removed)
+	{
+		Prediction.RecordReplicatedRemove(Entry.Key);
+		UnbindReplicatedItem(Entry.GetItem());
+		UnlinkItemContainers(Entry.GetItem());
+	}
+	else
+	{
+		Prediction.RecordReplicatedItem(Entry);
+		BindReplicatedItem(Entry.GetItem());
+		LinkItemContainers(Entry.GetItem());
+	}
+}
+
+void UFaerieItemStorage::PostContentReplicated()
+{
+	if (Prediction.IsPredicting())
+	{
+		ReconcilePrediction();
+	}
+}
+
+void UFaerieItemStorage::PreEntryEdit(const FInventoryEntry& Entry)
+{
+	Prediction.RecordPreEdit(Entry);
+}
+
+void UFaerieItemStorage::OnPredictionResolved(const Faerie::ClientAction::FPredictionKey Key, const bool Accepted)
+{
+	if (Prediction.Resolve(Key, Accepted))
+	{
+		ReconcilePrediction();
+	}
+}
+
+void UFaerieItemStorage::ReconcilePrediction()
+{
+	// Replacing entries while something is iterating them isn't safe. The next update will catch up.
+	if (!ensure(EntryMap.WriteLock == 0))
+	{
+		return;
+	}
+
+	TArray<FEntryKey> ChangedEntries;
+	Prediction.Reconcile(EntryMap.Entries, &Faerie::Storage::PredictedEntriesMatch, ChangedEntries);
+
+	// Entries were replaced wholesale, so the Fast Array's index map and token index are stale.
+	EntryMap.MarkArrayDirty();
+	TokenIndex.Invalidate();
+
+	for (const FEntryKey Key : ChangedEntries)
+	{
+		if (const FInventoryEntry* Entry = GetEntrySafe(Key))
+		{
+			PostContentChanged(*Entry, FInventoryContent::Client_SomethingReplicated, nullptr);
+		}
+	}
+
+	if (!Prediction.IsPredicting())
+	{
+		PredictionListener.Unbind();
+	}
+}
+
 
 /*
  * Footnote1: You might think that even at runtime we could reset the key during Clear, since all items are removed,
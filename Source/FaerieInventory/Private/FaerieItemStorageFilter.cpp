@@ -43,6 +43,13 @@ namespace Faerie::Storage
 
 	FEntryFilter& FEntryFilter::Run(Container::IItemDataFilter&& Filter)
 	{
+		// Token and tag filters are intersected with the index's columns instead, when the storage keeps one.
+		if (const FTokenIndex* Index = ReadTokenIndex(*Storage);
+			Index && Filter.PassesIndexed(*Index, KeyBits))
+		{
+			return *this;
+		}
+
 		FilterEntriesByItem(KeyBits, ReadInventoryContent(*Storage),
 			[&Filter](const UFaerieItem* Item)
 			{
@@ -12,6 +12,12 @@ namespace Faerie::Storage
 		return Storage.EntryMap;
 	}
 
+	// ReSharper disable once CppMemberFunctionMayBeStatic
+	const FTokenIndex* FStorageDataAccess::ReadTokenIndex(const UFaerieItemStorage& Storage)
+	{
+		return Storage.GetTokenIndex();
+	}
+
 	FFaerieItemSnapshot FStorageDataAccess::MakeSnapshot(const UFaerieItemStorage& Storage, const int32 Index)
 	{
 		auto&& Entry = ReadInventoryContent(Storage).GetElementAt(Index);
@@ -0,0 +1,85 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "FaerieItemStorageLazySource.h"
+#include "FaerieInventoryLog.h"
+#include "FaerieItem.h"
+#include "FaerieItemCompactFormat.h"
+#include "FaerieItemStorage.h"
+#include "FaerieItemStorageStatics.h"
+#include "Containers/Ticker.h"
+#include "UObject/Package.h"
+
+namespace Faerie::Storage
+{
+	FLazyItemSource::FLazyItemSource(UFaerieItemStorage* Owner, TUniquePtr<ItemData::FCompactItemReader>&& Reader)
+	  : Owner(Owner),
+		Reader(MoveTemp(Reader)) {}
+
+	FLazyItemSource::~FLazyItemSource() = default;
+
+	const UFaerieItem* FLazyItemSource::Materialize(const uint32 ItemIndex)
+	{
+		if (const TObjectPtr<UFaerieItem>* Existing = MaterializedItems.Find(ItemIndex))
+		{
+			return *Existing;
+		}
+
+		QUICK_SCOPE_CYCLE_COUNTER(FLazyItemSource_Materialize);
+
+		UFaerieItem* Item = const_cast<UFaerieItem*>(Reader->GetItem(ItemIndex));
+
+		// The entry may be in use by whoever asked for its item, so it can't be dropped right now. Bad items are replaced
+		// with a placeholder that is safe to read, and the storage removes their entries once the current frame is done.
+		if (!IsValid(Item) || !ValidateItemData(Item))
+		{
+			UE_LOG(LogFaerieInventory, Error, TEXT("FLazyItemSource: Item '%u' in save data for '%s' is invalid! Its entry will be removed."),
+				ItemIndex, *GetNameSafe(Owner.Get()))
+
+			if (!InvalidItemPlaceholder)
+			{
+				InvalidItemPlaceholder = UFaerieItem::CreateNewInstance({}, EFaerieItemInstancingMutability::Immutable);
+
+				FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda(
+					[WeakOwner = Owner, WeakPlaceholder = TWeakObjectPtr<const UFaerieItem>(InvalidItemPlaceholder)](float)
+					{
+						if (UFaerieItemStorage* Storage = WeakOwner.Get())
+						{
+							Storage->RemoveInvalidLazyEntries(WeakPlaceholder.Get());
+						}
+						return false;
+					}));
+			}
+
+			Item = InvalidItemPlaceholder;
+		}
+		// Packed items are created fresh, and need to be bound to the storage.
+		else if (Item->GetOuter() == GetTransientPackage() && Item->CanMutate() && Owner.IsValid())
+		{
+			TakeOwnership(Owner.Get(), Item);
+		}
+
+		MaterializedItems.Add(ItemIndex, Item);
+		return Item;
+	}
+
+	SIZE_T FLazyItemSource::GetAllocatedSize() const
+	{
+		SIZE_T Size = sizeof(FLazyItemSource) + MaterializedItems.GetAllocatedSize();
+		if (Reader.IsValid())
+		{
+			Size += Reader->GetAllocatedSize();
+		}
+		return Size;
+	}
+
+	void FLazyItemSource::AddReferencedObjects(FReferenceCollector& Collector)
+	{
+		Collector.AddReferencedObjects(MaterializedItems);
+		Collector.AddReferencedObject(InvalidItemPlaceholder);
+	}
+
+	FString FLazyItemSource::GetReferencerName() const
+	{
+		return TEXT("Faerie::Storage::FLazyItemSource");
+	}
+}
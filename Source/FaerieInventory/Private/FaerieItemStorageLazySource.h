@@ -0,0 +1,48 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "UObject/GCObject.h"
+
+class UFaerieItem;
+class UFaerieItemStorage;
+
+namespace Faerie::ItemData
+{
+	class FCompactItemReader;
+}
+
+namespace Faerie::Storage
+{
+	/**
+	 * Shared by the entries of a storage that was lazily loaded from compact save data. Holds onto the save data, so that
+	 * entries can create their item the first time it is accessed. Items are kept alive here once created, so that entries
+	 * sharing an item, or copies of an entry, always resolve to the same object.
+	 */
+	class FLazyItemSource final : public FGCObject, FNoncopyable
+	{
+	public:
+		FLazyItemSource(UFaerieItemStorage* Owner, TUniquePtr<ItemData::FCompactItemReader>&& Reader);
+		virtual ~FLazyItemSource() override;
+
+		// Get the item at an index in the save data, creating it if this is the first time. Never returns nullptr. Items
+		// that fail to load are replaced with an empty placeholder, and their entries are removed on the next tick.
+		const UFaerieItem* Materialize(uint32 ItemIndex);
+
+		// Heap memory held for lazy loading, including the save data. Does not include the items materialized so far.
+		SIZE_T GetAllocatedSize() const;
+
+		//~ FGCObject
+		virtual void AddReferencedObjects(FReferenceCollector& Collector) override;
+		virtual FString GetReferencerName() const override;
+		//~ FGCObject
+
+	private:
+		TWeakObjectPtr<UFaerieItemStorage> Owner;
+		TUniquePtr<ItemData::FCompactItemReader> Reader;
+		TMap<uint32, TObjectPtr<UFaerieItem>> MaterializedItems;
+
+		// Stands in for items that failed to load, until their entries are removed.
+		TObjectPtr<UFaerieItem> InvalidItemPlaceholder;
+	};
+}
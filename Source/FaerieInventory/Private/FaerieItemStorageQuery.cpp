@@ -2,9 +2,12 @@
 
 #include "FaerieItemStorageQuery.h"
 #include "FaerieContainerFilterTypes.h"
+#include "FaerieDataSystemTrace.h"
 #include "FaerieFunctionTemplates.h"
 #include "FaerieItemDataComparator.h"
+#include "FaerieItemContainerPath.h"
 #include "FaerieItemDataFilter.h"
+#include "FaerieItemDataFilterProgram.h"
 #include "FaerieItemStorage.h"
 #include "FaerieItemStorageIterators.h"
 
@@ -13,6 +16,7 @@
 DECLARE_STATS_GROUP(TEXT("FaerieItemStorage"), STATGROUP_FaerieItemStorageQuery, STATCAT_Advanced);
 DECLARE_CYCLE_STAT(TEXT("Query (First)"), STAT_Storage_QueryFirst, STATGROUP_FaerieItemStorageQuery);
 DECLARE_CYCLE_STAT(TEXT("Query (All)"), STAT_Storage_QueryAll, STATGROUP_FaerieItemStorageQuery);
+DECLARE_CYCLE_STAT(TEXT("Query (Containers)"), STAT_Storage_QueryContainers, STATGROUP_FaerieItemStorageQuery);
 
 bool UFaerieItemStorageQuery::IsSortBound() const
 {
@@ -133,12 +137,7 @@ void UFaerieItemStorageQuery::SetFilterByObject(const UFaerieItemDataFilter* Obj
 {
 	if (Object != FilterObject)
 	{
-		FilterFunction.Emplace<Faerie::Container::FSnapshotPredicate>([Object](const FFaerieItemSnapshot& Snapshot)
-			{
-				const FFaerieItemStackView View{Snapshot.ItemObject, Snapshot.Copies};
-				return Object->Exec(View);
-			});
-		FilterObject = Object;
+		BindFilterObject(Object);
 		OnQueryChanged.Broadcast(this);
 	}
 	else if (IsFilterBound())
@@ -149,6 +148,29 @@ void UFaerieItemStorageQuery::SetFilterByObject(const UFaerieItemDataFilter* Obj
 	}
 }
 
+void UFaerieItemStorageQuery::RecompileFilterObject()
+{
+	// Only filters set by SetFilterByObject are compiled.
+	if (const UFaerieItemDataFilter* Object = Cast<UFaerieItemDataFilter>(FilterObject);
+		IsValid(Object) && FilterFunction.IsType<Faerie::Container::FSnapshotPredicate>())
+	{
+		BindFilterObject(Object);
+		OnQueryChanged.Broadcast(this);
+	}
+}
+
+void UFaerieItemStorageQuery::BindFilterObject(const UFaerieItemDataFilter* Object)
+{
+	// Compiled once here, and shared by every container this query is run on.
+	FilterFunction.Emplace<Faerie::Container::FSnapshotPredicate>(
+		[Program = Faerie::ItemData::FFilterProgram::Compile(Object)](const FFaerieItemSnapshot& Snapshot)
+		{
+			const FFaerieItemStackView View{Snapshot.ItemObject, Snapshot.Copies};
+			return Program.Exec(View);
+		});
+	FilterObject = Object;
+}
+
 void UFaerieItemStorageQuery::SetSort(Faerie::Container::FItemComparator&& Comparator, UObject* AssociatedUObject)
 {
 	if (Comparator.IsSet())
@@ -295,7 +317,7 @@ void UFaerieItemStorageQuery::SetInvertSort(const bool Invert)
 
 FFaerieAddress UFaerieItemStorageQuery::QueryFirstAddress(const UFaerieItemStorage* Storage) const
 {
-	SCOPE_CYCLE_COUNTER(STAT_Storage_QueryFirst);
+	FAERIE_SCOPE_CYCLE_COUNTER(STAT_Storage_QueryFirst);
 
 	if (!IsFilterBound()) return {};
 
@@ -315,7 +337,7 @@ FFaerieAddress UFaerieItemStorageQuery::QueryFirstAddress(const UFaerieItemStora
 
 void UFaerieItemStorageQuery::QueryAllAddresses(const UFaerieItemStorage* Storage, TArray<FFaerieAddress>& OutAddresses) const
 {
-	SCOPE_CYCLE_COUNTER(STAT_Storage_QueryAll);
+	FAERIE_SCOPE_CYCLE_COUNTER(STAT_Storage_QueryAll);
 
 	// Ensure we are starting with a blank slate.
 	OutAddresses.Empty();
@@ -376,6 +398,137 @@ void UFaerieItemStorageQuery::QueryAllAddresses(const UFaerieItemStorage* Storag
 	}
 }
 
+void UFaerieItemStorageQuery::QueryAllContainers(const TArray<UFaerieItemContainerBase*>& Containers, const bool IncludeChildren,
+												  TArray<FFaerieAddressableHandle>& OutHandles) const
+{
+	FAERIE_SCOPE_CYCLE_COUNTER(STAT_Storage_QueryContainers);
+
+	// Ensure we are starting with a blank slate.
+	OutHandles.Reset();
+
+	// Each container to search, once, even when it's both given directly and nested inside another.
+	TArray<UFaerieItemContainerBase*, TInlineAllocator<8>> Sources;
+	for (UFaerieItemContainerBase* Container : Containers)
+	{
+		if (!IsValid(Container)) continue;
+
+		if (IncludeChildren)
+		{
+			TArray<FFaerieItemContainerPath> Paths;
+			FFaerieItemContainerPath::BuildChildrenPaths(Container, Paths);
+			for (const FFaerieItemContainerPath& Path : Paths)
+			{
+				Sources.AddUnique(Path.GetTail());
+			}
+		}
+		else
+		{
+			Sources.AddUnique(Container);
+		}
+	}
+
+	struct FEntry
+	{
+		int32 Source;
+		FFaerieAddress Address;
+		FFaerieItemSnapshot Snapshot;
+	};
+
+	// Snapshots are made once per entry, and shared by the filter and every comparison made while sorting.
+	// Entries are grouped by source, and RunStarts[i] is where the entries for Sources[i] begin.
+	TArray<FEntry> Entries;
+	TArray<int32, TInlineAllocator<9>> RunStarts;
+
+	for (int32 i = 0; i < Sources.Num(); ++i)
+	{
+		RunStarts.Add(Entries.Num());
+
+		const UFaerieItemContainerBase* Container = Sources[i];
+		for (const FFaerieAddress Address : Faerie::Container::AddressRange(Container))
+		{
+			const FFaerieItemStackView View = Container->ViewStack(Address);
+
+			FFaerieItemSnapshot Snapshot;
+			Snapshot.Owner = Container;
+			Snapshot.ItemObject = View.Item.Get();
+			Snapshot.Copies = View.Copies;
+
+			if (!IsSnapshotIncluded(Snapshot))
+			{
+				continue;
+			}
+
+			Entries.Add({i, Address, MoveTemp(Snapshot)});
+		}
+	}
+	RunStarts.Add(Entries.Num());
+
+	OutHandles.Reserve(Entries.Num());
+
+	auto EmitHandle = [&Sources, &OutHandles](const FEntry& Entry)
+		{
+			FFaerieAddressableHandle& Handle = OutHandles.AddDefaulted_GetRef();
+			Handle.Container = Sources[Entry.Source];
+			Handle.Address = Entry.Address;
+		};
+
+	if (!IsSortBound())
+	{
+		for (const FEntry& Entry : Entries)
+		{
+			EmitHandle(Entry);
+		}
+
+		if (InvertSort)
+		{
+			Algo::Reverse(OutHandles);
+		}
+		return;
+	}
+
+	auto Less = [this](const FEntry& A, const FEntry& B)
+		{
+			return SortsBefore(A.Snapshot, B.Snapshot);
+		};
+
+	// Sort the entries of each container on their own, then merge the sorted runs together.
+	for (int32 i = 0; i < Sources.Num(); ++i)
+	{
+		Algo::Sort(MakeArrayView(Entries.GetData() + RunStarts[i], RunStarts[i + 1] - RunStarts[i]), Less);
+	}
+
+	// Heap of the next entry in each run. Equal entries are taken in the order their containers were given.
+	auto HeapLess = [&Entries, &Less](const int32 A, const int32 B)
+		{
+			if (Less(Entries[A], Entries[B])) return true;
+			if (Less(Entries[B], Entries[A])) return false;
+			return A < B;
+		};
+
+	TArray<int32, TInlineAllocator<8>> Heads;
+	for (int32 i = 0; i < Sources.Num(); ++i)
+	{
+		if (RunStarts[i] < RunStarts[i + 1])
+		{
+			Heads.HeapPush(RunStarts[i], HeapLess);
+		}
+	}
+
+	while (!Heads.IsEmpty())
+	{
+		int32 Next;
+		Heads.HeapPop(Next, HeapLess, EAllowShrinking::No);
+
+		const FEntry& Entry = Entries[Next];
+		EmitHandle(Entry);
+
+		if (Next + 1 < RunStarts[Entry.Source + 1])
+		{
+			Heads.HeapPush(Next + 1, HeapLess);
+		}
+	}
+}
+
 FFaerieItemSnapshot MakeSnapshot(const UFaerieItemStorage* Storage, const FFaerieAddress Address)
 {
 	const FFaerieItemStackView StorageA = Storage->ViewStack(Address);
@@ -449,3 +602,47 @@ bool UFaerieItemStorageQuery::IsAddressFiltered(const UFaerieItemStorage* Storag
 		return false;
 	}
 }
+
+bool UFaerieItemStorageQuery::IsSnapshotIncluded(const FFaerieItemSnapshot& Snapshot) const
+{
+	return !IsFilterBound() || PassesFilter(Snapshot) != InvertFilter;
+}
+
+bool UFaerieItemStorageQuery::SortsBefore(const FFaerieItemSnapshot& SnapshotA, const FFaerieItemSnapshot& SnapshotB) const
+{
+	return InvertSort
+		? CompareSnapshots(SnapshotB, SnapshotA)
+		: CompareSnapshots(SnapshotA, SnapshotB);
+}
+
+bool UFaerieItemStorageQuery::PassesFilter(const FFaerieItemSnapshot& Snapshot) const
+{
+	switch (FilterFunction.GetIndex())
+	{
+	case 1:
+		return FilterFunction.Get<Faerie::Container::FItemPredicate>()(Snapshot.ItemObject);
+	case 2:
+		return FilterFunction.Get<Faerie::Container::FStackPredicate>()(FFaerieItemStackView{Snapshot.ItemObject, Snapshot.Copies});
+	case 3:
+		return FilterFunction.Get<Faerie::Container::FSnapshotPredicate>()(Snapshot);
+	default:
+		return true;
+	}
+}
+
+bool UFaerieItemStorageQuery::CompareSnapshots(const FFaerieItemSnapshot& SnapshotA, const FFaerieItemSnapshot& SnapshotB) const
+{
+	switch (SortFunction.GetIndex())
+	{
+	case 1:
+		return SortFunction.Get<Faerie::Container::FItemComparator>()(SnapshotA.ItemObject, SnapshotB.ItemObject);
+	case 2:
+		return SortFunction.Get<Faerie::Container::FStackComparator>()(
+			FFaerieItemStackView{SnapshotA.ItemObject, SnapshotA.Copies},
+			FFaerieItemStackView{SnapshotB.ItemObject, SnapshotB.Copies});
+	case 3:
+		return SortFunction.Get<Faerie::Container::FSnapshotComparator>()(SnapshotA, SnapshotB);
+	default:
+		return false;
+	}
+}
@@ -121,6 +121,11 @@ namespace Faerie
 
 				// Unbind from the mutation hook.
 				MutableItem->GetNotifyOwnerOfSelfMutation().Unbind();
+
+				if (UFaerieItemContainerBase* OwnerContainer = Cast<UFaerieItemContainerBase>(Owner))
+				{
+					OwnerContainer->UnlinkItemContainers(MutableItem);
+				}
 			}
 		}
 	}
@@ -170,6 +175,12 @@ namespace Faerie
 				{
 					MutableItem->GetNotifyOwnerOfSelfMutation().BindRaw(OwnerInterface, &IFaerieItemOwnerInterface::OnItemMutated);
 				}
+
+				// Containers in children are linked to the container their own item is in, not to this one.
+				if (UFaerieItemContainerBase* OwnerContainer = Cast<UFaerieItemContainerBase>(Owner))
+				{
+					OwnerContainer->LinkItemContainers(MutableItem);
+				}
 			}
 
 			// @todo this logic could be moved to UFaerieItem::PostRename (if we enforce the RenameBehavior)
@@ -0,0 +1,356 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "FaerieItemStorageTokenIndex.h"
+#include "FaerieDataSystemTrace.h"
+#include "FaerieItem.h"
+#include "InventoryDataStructs.h"
+#include "Algo/BinarySearch.h"
+#include "Tokens/FaerieTagToken.h"
+
+namespace Faerie::Storage
+{
+	template <typename KeyType>
+	static void SetColumnBit(TMap<KeyType, TBitArray<>>& Columns, const KeyType& Key, const int32 Index)
+	{
+		// Columns are only as long as their last set bit needs, so appending a row doesn't touch every column.
+		TBitArray<>& Column = Columns.FindOrAdd(Key);
+		if (Column.Num() <= Index)
+		{
+			Column.Add(false, Index + 1 - Column.Num());
+		}
+		Column[Index] = true;
+	}
+
+	// Drop the bits of removed rows, and pad the column out to the full number of rows.
+	static void CompactBits(TBitArray<>& Bits, const TBitArray<>& Removed, const int32 NumRows)
+	{
+		TBitArray<> Compacted;
+		Compacted.Reserve(NumRows);
+		for (int32 i = 0; i < Bits.Num(); ++i)
+		{
+			if (!Removed[i])
+			{
+				Compacted.Add(Bits[i]);
+			}
+		}
+		Compacted.Add(false, NumRows - Compacted.Num());
+		Bits = MoveTemp(Compacted);
+	}
+
+	template <typename KeyType>
+	static void PadColumns(TMap<KeyType, TBitArray<>>& Columns, const int32 NumRows)
+	{
+		for (auto&& Column : Columns)
+		{
+			if (Column.Value.Num() < NumRows)
+			{
+				Column.Value.Add(false, NumRows - Column.Value.Num());
+			}
+		}
+	}
+
+	template <typename KeyType>
+	static void CompactColumns(TMap<KeyType, TBitArray<>>& Columns, const TBitArray<>& Removed, const int32 NumRows)
+	{
+		for (auto&& Column : Columns)
+		{
+			CompactBits(Column.Value, Removed, NumRows);
+		}
+	}
+
+	template <typename KeyType>
+	static SIZE_T GetColumnsAllocatedSize(const TMap<KeyType, TBitArray<>>& Columns)
+	{
+		SIZE_T Size = Columns.GetAllocatedSize();
+		for (auto&& Column : Columns)
+		{
+			Size += Column.Value.GetAllocatedSize();
+		}
+		return Size;
+	}
+
+	void FTokenIndex::OnEntryAdded(const FInventoryEntry& Entry)
+	{
+		// There is nothing to keep up to date until the next rebuild.
+		if (NeedsRebuild) return;
+
+		LLM_SCOPE_BYTAG(ItemStorage);
+
+		const int32 Index = Algo::LowerBound(Keys, Entry.Key);
+		if (Keys.IsValidIndex(Index) && Keys[Index] == Entry.Key)
+		{
+			// A key that was removed and added again, as when a transaction is rolled back, reuses its row.
+			if (Removed[Index])
+			{
+				Removed[Index] = false;
+				NumRemoved--;
+			}
+
+			// Already indexed. Events are sent again for the net result once a transaction commits.
+			OnEntryChanged(Entry);
+			return;
+		}
+
+		if (Index != Keys.Num())
+		{
+			// Keys only ever grow, so this is rare, and would mean shifting every column.
+			Invalidate();
+			return;
+		}
+
+		AppendRow(Entry.Key);
+
+		if (Entry.IsMaterialized())
+		{
+			IndexRow(Index, Entry.GetItem());
+		}
+		else
+		{
+			Unindexed[Index] = true;
+		}
+	}
+
+	void FTokenIndex::OnEntryChanged(const FInventoryEntry& Entry)
+	{
+		if (NeedsRebuild) return;
+
+		const int32 Index = Algo::BinarySearch(Keys, Entry.Key);
+		if (Index == INDEX_NONE || Removed[Index])
+		{
+			OnEntryAdded(Entry);
+			return;
+		}
+
+		ClearRow(Index);
+
+		if (Entry.IsMaterialized())
+		{
+			IndexRow(Index, Entry.GetItem());
+		}
+		else
+		{
+			Unindexed[Index] = true;
+		}
+	}
+
+	void FTokenIndex::OnEntryRemoved(const FEntryKey Key)
+	{
+		if (NeedsRebuild) return;
+
+		const int32 Index = Algo::BinarySearch(Keys, Key);
+		if (Index == INDEX_NONE || Removed[Index]) return;
+
+		// Only the row's own bits are cleared here. The row itself is dropped by the next Sync.
+		ClearRow(Index);
+		Removed[Index] = true;
+		NumRemoved++;
+	}
+
+	void FTokenIndex::Invalidate()
+	{
+		Reset();
+		NeedsRebuild = true;
+	}
+
+	void FTokenIndex::Sync(const FInventoryContent& Content)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(FaerieTokenIndex_Sync, FaerieDataSystemChannel);
+		LLM_SCOPE_BYTAG(ItemStorage);
+
+		if (!NeedsRebuild && NumRemoved > 0)
+		{
+			Compact();
+		}
+
+		const int32 NumEntries = Content.Num();
+		if (NeedsRebuild ||
+			Keys.Num() != NumEntries ||
+			(NumEntries > 0 && (Keys[0] != Content.GetKeyAt(0) || Keys.Last() != Content.GetKeyAt(NumEntries - 1))))
+		{
+			Rebuild(Content);
+			return;
+		}
+
+		if (Unindexed.Find(true) != INDEX_NONE)
+		{
+			// Queries create items as they test them anyway, so we can do the same for anything left unindexed.
+			for (TConstSetBitIterator<> It(Unindexed); It; ++It)
+			{
+				IndexRow(It.GetIndex(), Content.GetElementAt(It.GetIndex()).GetItem());
+			}
+			Unindexed.Init(false, Keys.Num());
+		}
+
+		// Queries intersect whole columns, so every column has to cover every row.
+		PadColumns(ClassColumns, NumEntries);
+		PadColumns(ExactTagColumns, NumEntries);
+		PadColumns(TagColumns, NumEntries);
+	}
+
+	void FTokenIndex::Reset()
+	{
+		Keys.Empty();
+		Rows.Empty();
+		Unindexed.Empty();
+		Removed.Empty();
+		NumRemoved = 0;
+		ClassColumns.Empty();
+		ExactTagColumns.Empty();
+		TagColumns.Empty();
+	}
+
+	bool FTokenIndex::IsIndexedTokenClass(const UClass* TokenClass)
+	{
+		return TokenClass &&
+			TokenClass != UFaerieItemToken::StaticClass() &&
+			TokenClass->IsChildOf(UFaerieItemToken::StaticClass());
+	}
+
+	const TBitArray<>* FTokenIndex::FindTokenClass(const UClass* TokenClass) const
+	{
+		return ClassColumns.Find(TObjectKey<UClass>(TokenClass));
+	}
+
+	const TBitArray<>* FTokenIndex::FindTag(const FGameplayTag& Tag, const bool Exact) const
+	{
+		return Exact ? ExactTagColumns.Find(Tag) : TagColumns.Find(Tag);
+	}
+
+	SIZE_T FTokenIndex::GetAllocatedSize() const
+	{
+		SIZE_T Size = Keys.GetAllocatedSize() + Rows.GetAllocatedSize() + Unindexed.GetAllocatedSize() + Removed.GetAllocatedSize();
+		for (const FRow& Row : Rows)
+		{
+			Size += Row.Classes.GetAllocatedSize();
+			Size += (Row.Tags.Num() + Row.TagsWithParents.Num()) * sizeof(FGameplayTag);
+		}
+		Size += GetColumnsAllocatedSize(ClassColumns);
+		Size += GetColumnsAllocatedSize(ExactTagColumns);
+		Size += GetColumnsAllocatedSize(TagColumns);
+		return Size;
+	}
+
+	void FTokenIndex::Rebuild(const FInventoryContent& Content)
+	{
+		Reset();
+
+		const int32 NumEntries = Content.Num();
+		Keys.Reserve(NumEntries);
+		for (const FInventoryEntry& Entry : Content)
+		{
+			Keys.Add(Entry.Key);
+		}
+		Rows.SetNum(NumEntries);
+		Unindexed.Init(false, NumEntries);
+		Removed.Init(false, NumEntries);
+
+		for (int32 i = 0; i < NumEntries; ++i)
+		{
+			IndexRow(i, Content.GetElementAt(i).GetItem());
+		}
+
+		PadColumns(ClassColumns, NumEntries);
+		PadColumns(ExactTagColumns, NumEntries);
+		PadColumns(TagColumns, NumEntries);
+
+		NeedsRebuild = false;
+	}
+
+	void FTokenIndex::Compact()
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(FaerieTokenIndex_Compact, FaerieDataSystemChannel);
+
+		const int32 NumRows = Keys.Num() - NumRemoved;
+
+		// Each column is rewritten once, however many entries were removed since the last Sync.
+		CompactColumns(ClassColumns, Removed, NumRows);
+		CompactColumns(ExactTagColumns, Removed, NumRows);
+		CompactColumns(TagColumns, Removed, NumRows);
+		CompactBits(Unindexed, Removed, NumRows);
+
+		int32 Write = 0;
+		for (int32 Read = 0; Read < Keys.Num(); ++Read)
+		{
+			if (!Removed[Read])
+			{
+				Keys[Write] = Keys[Read];
+				Rows[Write] = MoveTemp(Rows[Read]);
+				Write++;
+			}
+		}
+		Keys.SetNum(NumRows);
+		Rows.SetNum(NumRows);
+
+		Removed.Init(false, NumRows);
+		NumRemoved = 0;
+	}
+
+	void FTokenIndex::AppendRow(const FEntryKey Key)
+	{
+		Keys.Add(Key);
+		Rows.AddDefaulted();
+		Unindexed.Add(false);
+		Removed.Add(false);
+	}
+
+	void FTokenIndex::IndexRow(const int32 Index, const UFaerieItem* Item)
+	{
+		if (!IsValid(Item)) return;
+
+		FRow& Row = Rows[Index];
+
+		for (const UFaerieItemToken* Token : Item->GetTokens())
+		{
+			if (!IsValid(Token)) continue;
+
+			// Index the whole class hierarchy, so that filtering by a parent class finds its children too.
+			for (const UClass* Class = Token->GetClass();
+				 Class && Class != UFaerieItemToken::StaticClass();
+				 Class = Class->GetSuperClass())
+			{
+				const TObjectKey<UClass> ClassKey(Class);
+				if (Row.Classes.Contains(ClassKey)) continue;
+
+				Row.Classes.Add(ClassKey);
+				SetColumnBit(ClassColumns, ClassKey, Index);
+			}
+		}
+
+		// Match the tag filter rules, which only read the first tag token.
+		if (const UFaerieTagToken* TagToken = Item->GetToken<UFaerieTagToken>())
+		{
+			Row.Tags = TagToken->GetTags();
+			Row.TagsWithParents = Row.Tags.GetGameplayTagParents();
+
+			for (const FGameplayTag& Tag : Row.Tags)
+			{
+				SetColumnBit(ExactTagColumns, Tag, Index);
+			}
+			for (const FGameplayTag& Tag : Row.TagsWithParents)
+			{
+				SetColumnBit(TagColumns, Tag, Index);
+			}
+		}
+	}
+
+	void FTokenIndex::ClearRow(const int32 Index)
+	{
+		FRow& Row = Rows[Index];
+
+		for (const TObjectKey<UClass>& Class : Row.Classes)
+		{
+			ClassColumns[Class][Index] = false;
+		}
+		for (const FGameplayTag& Tag : Row.Tags)
+		{
+			ExactTagColumns[Tag][Index] = false;
+		}
+		for (const FGameplayTag& Tag : Row.TagsWithParents)
+		{
+			TagColumns[Tag][Index] = false;
+		}
+
+		Row = FRow();
+		Unindexed[Index] = false;
+	}
+}
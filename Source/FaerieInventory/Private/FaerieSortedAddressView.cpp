@@ -0,0 +1,414 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "FaerieSortedAddressView.h"
+#include "FaerieContainerIterator.h"
+#include "FaerieDataSystemTrace.h"
+#include "FaerieItemContainerBase.h"
+#include "FaerieItemStorageQuery.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(FaerieSortedAddressView)
+
+namespace Faerie::Storage
+{
+	void FSortedAddressView::Rebuild(const UFaerieItemContainerBase* Container, const UFaerieItemStorageQuery* Query)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(FSortedAddressView_Rebuild, FaerieDataSystemChannel);
+
+		Reset();
+
+		if (!IsValid(Container))
+		{
+			return;
+		}
+
+		TArray<TPair<FFaerieAddress, FFaerieItemSnapshot>> Rows;
+		for (const FFaerieAddress Address : Faerie::Container::AddressRange(Container))
+		{
+			if (FFaerieItemSnapshot Snapshot; MakeSnapshot(Container, Query, Address, Snapshot))
+			{
+				Rows.Emplace(Address, MoveTemp(Snapshot));
+			}
+		}
+
+		if (IsValid(Query) && Query->IsSortBound())
+		{
+			Algo::Sort(Rows,
+				[Query](const TPair<FFaerieAddress, FFaerieItemSnapshot>& A, const TPair<FFaerieAddress, FFaerieItemSnapshot>& B)
+				{
+					return Query->SortsBefore(A.Value, B.Value);
+				});
+		}
+
+		Nodes.Reserve(Rows.Num());
+		Lookup.Reserve(Rows.Num());
+		for (const TPair<FFaerieAddress, FFaerieItemSnapshot>& Row : Rows)
+		{
+			Root = Merge(Root, AllocateNode(Row.Key, Row.Value));
+		}
+		if (Root != INDEX_NONE)
+		{
+			Nodes[Root].Parent = INDEX_NONE;
+		}
+	}
+
+	void FSortedAddressView::Update(const UFaerieItemContainerBase* Container, const UFaerieItemStorageQuery* Query, const FFaerieAddress Address)
+	{
+		FFaerieItemSnapshot Snapshot;
+		if (!MakeSnapshot(Container, Query, Address, Snapshot))
+		{
+			Remove(Address);
+			return;
+		}
+
+		const bool Sorted = IsValid(Query) && Query->IsSortBound();
+
+		if (const int32* Existing = Lookup.Find(Address))
+		{
+			const int32 Node = *Existing;
+			Nodes[Node].Snapshot = MoveTemp(Snapshot);
+
+			// Without a sort, rows stay where they were first added.
+			if (!Sorted)
+			{
+				return;
+			}
+
+			const int32 OldIndex = RankOf(Node);
+			Detach(OldIndex);
+			const int32 NewIndex = FindInsertIndex(Query, Nodes[Node].Snapshot);
+			Insert(Node, NewIndex);
+
+			if (NewIndex != OldIndex)
+			{
+				AddChange(EFaerieSortedViewChangeType::Moved, OldIndex, NewIndex);
+			}
+			return;
+		}
+
+		const int32 Index = Sorted ? FindInsertIndex(Query, Snapshot) : Num();
+		Insert(AllocateNode(Address, Snapshot), Index);
+		AddChange(EFaerieSortedViewChangeType::Inserted, Index);
+	}
+
+	void FSortedAddressView::Remove(const FFaerieAddress Address)
+	{
+		int32 Node;
+		if (!Lookup.RemoveAndCopyValue(Address, Node))
+		{
+			return;
+		}
+
+		const int32 Index = RankOf(Node);
+		Detach(Index);
+		FreeNode(Node);
+		AddChange(EFaerieSortedViewChangeType::Removed, Index);
+	}
+
+	void FSortedAddressView::Reset()
+	{
+		Nodes.Reset();
+		FreeNodes.Reset();
+		Lookup.Reset();
+		Changes.Reset();
+		Root = INDEX_NONE;
+	}
+
+	int32 FSortedAddressView::IndexOf(const FFaerieAddress Address) const
+	{
+		if (const int32* Node = Lookup.Find(Address))
+		{
+			return RankOf(*Node);
+		}
+		return INDEX_NONE;
+	}
+
+	FFaerieAddress FSortedAddressView::GetAt(int32 Index) const
+	{
+		if (Index < 0 || Index >= Num())
+		{
+			return FFaerieAddress();
+		}
+
+		int32 Node = Root;
+		while (Node != INDEX_NONE)
+		{
+			const int32 LeftSize = SizeOf(Nodes[Node].Left);
+			if (Index < LeftSize)
+			{
+				Node = Nodes[Node].Left;
+			}
+			else if (Index == LeftSize)
+			{
+				return Nodes[Node].Address;
+			}
+			else
+			{
+				Index -= LeftSize + 1;
+				Node = Nodes[Node].Right;
+			}
+		}
+
+		checkNoEntry();
+		return FFaerieAddress();
+	}
+
+	void FSortedAddressView::GetAddresses(TArray<FFaerieAddress>& OutAddresses) const
+	{
+		OutAddresses.Reset(Num());
+
+		// In-order walk, without recursion.
+		TArray<int32, TInlineAllocator<32>> Stack;
+		int32 Node = Root;
+		while (Node != INDEX_NONE || !Stack.IsEmpty())
+		{
+			while (Node != INDEX_NONE)
+			{
+				Stack.Push(Node);
+				Node = Nodes[Node].Left;
+			}
+
+			Node = Stack.Pop(EAllowShrinking::No);
+			OutAddresses.Add(Nodes[Node].Address);
+			Node = Nodes[Node].Right;
+		}
+	}
+
+	void FSortedAddressView::GetRange(int32 Start, const int32 Count, TArray<FFaerieAddress>& OutAddresses) const
+	{
+		OutAddresses.Reset();
+
+		if (Start < 0 || Start >= Num() || Count <= 0)
+		{
+			return;
+		}
+
+		OutAddresses.Reserve(FMath::Min(Count, Num() - Start));
+
+		// Descend to the first row, keeping each node we pass on its left, as those are the rows that follow it.
+		TArray<int32, TInlineAllocator<32>> Stack;
+		int32 Node = Root;
+		while (Node != INDEX_NONE)
+		{
+			const int32 LeftSize = SizeOf(Nodes[Node].Left);
+			if (Start < LeftSize)
+			{
+				Stack.Push(Node);
+				Node = Nodes[Node].Left;
+			}
+			else if (Start == LeftSize)
+			{
+				Stack.Push(Node);
+				break;
+			}
+			else
+			{
+				Start -= LeftSize + 1;
+				Node = Nodes[Node].Right;
+			}
+		}
+
+		// Continue in-order from there.
+		while (OutAddresses.Num() < Count && !Stack.IsEmpty())
+		{
+			Node = Stack.Pop(EAllowShrinking::No);
+			OutAddresses.Add(Nodes[Node].Address);
+
+			for (Node = Nodes[Node].Right; Node != INDEX_NONE; Node = Nodes[Node].Left)
+			{
+				Stack.Push(Node);
+			}
+		}
+	}
+
+	SIZE_T FSortedAddressView::GetAllocatedSize() const
+	{
+		return Nodes.GetAllocatedSize() + FreeNodes.GetAllocatedSize() + Lookup.GetAllocatedSize() + Changes.GetAllocatedSize();
+	}
+
+	void FSortedAddressView::AddReferencedObjects(FReferenceCollector& Collector)
+	{
+		// Free nodes are reset, so they have nothing to report.
+		for (FNode& Node : Nodes)
+		{
+			Collector.AddReferencedObject(Node.Snapshot.ItemObject);
+			Collector.AddReferencedObject(Node.Snapshot.Owner.GetObjectRef());
+		}
+	}
+
+	bool FSortedAddressView::MakeSnapshot(const UFaerieItemContainerBase* Container, const UFaerieItemStorageQuery* Query,
+										  const FFaerieAddress Address, FFaerieItemSnapshot& OutSnapshot)
+	{
+		if (!IsValid(Container))
+		{
+			return false;
+		}
+
+		const FFaerieItemStackView View = Container->ViewStack(Address);
+		if (!View.Item.IsValid())
+		{
+			return false;
+		}
+
+		OutSnapshot.Owner = Container;
+		OutSnapshot.ItemObject = View.Item.Get();
+		OutSnapshot.Copies = View.Copies;
+
+		return !IsValid(Query) || Query->IsSnapshotIncluded(OutSnapshot);
+	}
+
+	int32 FSortedAddressView::AllocateNode(const FFaerieAddress Address, const FFaerieItemSnapshot& Snapshot)
+	{
+		const int32 Node = FreeNodes.IsEmpty() ? Nodes.AddDefaulted() : FreeNodes.Pop(EAllowShrinking::No);
+
+		FNode& NewNode = Nodes[Node];
+		NewNode = FNode();
+		NewNode.Address = Address;
+		NewNode.Snapshot = Snapshot;
+		NewNode.Priority = Priorities.GetUnsignedInt();
+
+		Lookup.Add(Address, Node);
+		return Node;
+	}
+
+	void FSortedAddressView::FreeNode(const int32 Node)
+	{
+		Nodes[Node] = FNode();
+		FreeNodes.Add(Node);
+	}
+
+	void FSortedAddressView::Pull(const int32 Node)
+	{
+		FNode& Parent = Nodes[Node];
+		Parent.Size = 1 + SizeOf(Parent.Left) + SizeOf(Parent.Right);
+		if (Parent.Left != INDEX_NONE)
+		{
+			Nodes[Parent.Left].Parent = Node;
+		}
+		if (Parent.Right != INDEX_NONE)
+		{
+			Nodes[Parent.Right].Parent = Node;
+		}
+	}
+
+	int32 FSortedAddressView::Merge(const int32 A, const int32 B)
+	{
+		if (A == INDEX_NONE) return B;
+		if (B == INDEX_NONE) return A;
+
+		if (Nodes[A].Priority > Nodes[B].Priority)
+		{
+			Nodes[A].Right = Merge(Nodes[A].Right, B);
+			Pull(A);
+			return A;
+		}
+
+		Nodes[B].Left = Merge(A, Nodes[B].Left);
+		Pull(B);
+		return B;
+	}
+
+	void FSortedAddressView::Split(const int32 Node, const int32 Count, int32& OutLeft, int32& OutRight)
+	{
+		if (Node == INDEX_NONE)
+		{
+			OutLeft = OutRight = INDEX_NONE;
+			return;
+		}
+
+		const int32 LeftSize = SizeOf(Nodes[Node].Left);
+		if (Count <= LeftSize)
+		{
+			Split(Nodes[Node].Left, Count, OutLeft, Nodes[Node].Left);
+			OutRight = Node;
+		}
+		else
+		{
+			Split(Nodes[Node].Right, Count - LeftSize - 1, Nodes[Node].Right, OutRight);
+			OutLeft = Node;
+		}
+		Pull(Node);
+	}
+
+	int32 FSortedAddressView::RankOf(int32 Node) const
+	{
+		int32 Rank = SizeOf(Nodes[Node].Left);
+		for (int32 Parent = Nodes[Node].Parent; Parent != INDEX_NONE; Node = Parent, Parent = Nodes[Node].Parent)
+		{
+			if (Nodes[Parent].Right == Node)
+			{
+				Rank += SizeOf(Nodes[Parent].Left) + 1;
+			}
+		}
+		return Rank;
+	}
+
+	int32 FSortedAddressView::FindInsertIndex(const UFaerieItemStorageQuery* Query, const FFaerieItemSnapshot& Snapshot) const
+	{
+		// Rows that sort the same as this one stay before it, so equal rows keep the order they were added in.
+		int32 Index = 0;
+		int32 Node = Root;
+		while (Node != INDEX_NONE)
+		{
+			if (Query->SortsBefore(Snapshot, Nodes[Node].Snapshot))
+			{
+				Node = Nodes[Node].Left;
+			}
+			else
+			{
+				Index += SizeOf(Nodes[Node].Left) + 1;
+				Node = Nodes[Node].Right;
+			}
+		}
+		return Index;
+	}
+
+	void FSortedAddressView::Insert(const int32 Node, const int32 Index)
+	{
+		int32 Left, Right;
+		Split(Root, Index, Left, Right);
+
+		Nodes[Node].Left = Nodes[Node].Right = INDEX_NONE;
+		Nodes[Node].Size = 1;
+
+		Root = Merge(Merge(Left, Node), Right);
+		Nodes[Root].Parent = INDEX_NONE;
+	}
+
+	void FSortedAddressView::Detach(const int32 Index)
+	{
+		int32 Left, Middle, Right;
+		Split(Root, Index, Left, Middle);
+		Split(Middle, 1, Middle, Right);
+
+		Root = Merge(Left, Right);
+		if (Root != INDEX_NONE)
+		{
+			Nodes[Root].Parent = INDEX_NONE;
+		}
+	}
+
+	void FSortedAddressView::AddChange(const EFaerieSortedViewChangeType Type, const int32 Index, const int32 NewIndex)
+	{
+		// Runs of rows inserted or removed next to each other are reported as one range.
+		if (!Changes.IsEmpty() && Changes.Last().Type == Type)
+		{
+			FFaerieSortedViewChange& Last = Changes.Last();
+			if (Type == EFaerieSortedViewChangeType::Inserted && Index == Last.Index + Last.Count)
+			{
+				Last.Count++;
+				return;
+			}
+			if (Type == EFaerieSortedViewChangeType::Removed && (Index == Last.Index || Index + 1 == Last.Index))
+			{
+				Last.Index = FMath::Min(Index, Last.Index);
+				Last.Count++;
+				return;
+			}
+		}
+
+		FFaerieSortedViewChange& Change = Changes.AddDefaulted_GetRef();
+		Change.Type = Type;
+		Change.Index = Index;
+		Change.NewIndex = NewIndex;
+	}
+}
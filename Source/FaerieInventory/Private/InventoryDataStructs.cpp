@@ -2,19 +2,33 @@
 
 // ReSharper disable CppMemberFunctionMayBeConst
 #include "InventoryDataStructs.h"
+#include "FaerieDataSystemMemory.h"
 #include "FaerieItemStorage.h"
+#include "FaerieItemStorageLazySource.h"
 #include "InventoryDataEnums.h"
-#include "HAL/LowLevelMemStats.h"
 #include "Tokens/FaerieStackLimiterToken.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(InventoryDataStructs)
 
-DECLARE_LLM_MEMORY_STAT(TEXT("ItemStorage"), STAT_StorageLLM, STATGROUP_LLMFULL);
-DECLARE_LLM_MEMORY_STAT(TEXT("ItemStorage"), STAT_StorageSummaryLLM, STATGROUP_LLM);
-LLM_DEFINE_TAG(ItemStorage, NAME_None, NAME_None, GET_STATFNAME(STAT_StorageLLM), GET_STATFNAME(STAT_StorageSummaryLLM));
+FAERIE_LLM_DEFINE_TAG(ItemStorage);
 
 FEntryKey FEntryKey::InvalidKey;
 
+bool FKeyedStack::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	uint32 KeyValue = static_cast<uint32>(Key.Value());
+	uint32 StackValue = static_cast<uint32>(Stack);
+	Ar.SerializeIntPacked(KeyValue);
+	Ar.SerializeIntPacked(StackValue);
+	if (Ar.IsLoading())
+	{
+		Key = FStackKey(static_cast<int32>(KeyValue));
+		Stack = static_cast<int32>(StackValue);
+	}
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
+
 FInventoryEntry::FInventoryEntry(const UFaerieItem* InItem)
 	: ItemObject(InItem)
 {
@@ -65,6 +79,24 @@ void FInventoryEntry::UpdateCachedStackLimit()
 	Limit = ItemObject ? UFaerieStackLimiterToken::GetItemStackLimit(ItemObject) : 0;
 }
 
+void FInventoryEntry::MaterializeItem() const
+{
+	// Entries only live in non-const arrays, so it's safe to fill in the item from a const accessor.
+	FInventoryEntry& This = const_cast<FInventoryEntry&>(*this);
+	This.ItemObject = LazySource->Materialize(LazyItemIndex);
+	This.LazySource.Reset();
+	This.UpdateCachedStackLimit();
+}
+
+int32 FInventoryEntry::GetCachedStackLimit() const
+{
+	if (LazySource.IsValid())
+	{
+		MaterializeItem();
+	}
+	return Limit;
+}
+
 bool FInventoryEntry::Contains(const FStackKey InKey) const
 {
 	return GetStackIndex(InKey) != INDEX_NONE;
@@ -113,7 +145,7 @@ int32 FInventoryEntry::StackSum() const
 bool FInventoryEntry::IsValid() const
 {
 	// No item, obviously invalid
-	if (!ItemObject) return false;
+	if (!GetItem()) return false;
 
 	// No stacks, invalid
 	if (Stacks.IsEmpty()) return false;
@@ -138,7 +170,7 @@ FFaerieItemStackView FInventoryEntry::ToItemStackView() const
 {
 	return FFaerieItemStackView
 	{
-		ItemObject,
+		GetItem(),
 		StackSum()
 	};
 }
@@ -161,16 +193,19 @@ void FInventoryEntry::PostScriptConstruct()
 
 void FInventoryEntry::PreReplicatedRemove(const FInventoryContent& InArraySerializer)
 {
+	InArraySerializer.RecordReplicatedEntry(*this, true);
 	InArraySerializer.PreEntryReplicatedRemove(*this);
 }
 
 void FInventoryEntry::PostReplicatedAdd(const FInventoryContent& InArraySerializer)
 {
+	InArraySerializer.RecordReplicatedEntry(*this, false);
 	InArraySerializer.PostEntryReplicatedAdd(*this);
 }
 
 void FInventoryEntry::PostReplicatedChange(const FInventoryContent& InArraySerializer)
 {
+	InArraySerializer.RecordReplicatedEntry(*this, false);
 	InArraySerializer.PostEntryReplicatedChange_Client(*this);
 }
 
@@ -179,9 +214,9 @@ bool FInventoryEntry::IsEqualTo(const FInventoryEntry& A, const FInventoryEntry&
 #define TEST_FLAG(Flag, Test)\
 	if (EnumHasAnyFlags(CheckFlags, EEntryEquivalencyFlags::Test_##Flag)) if (!(Test)) return false;
 
-	TEST_FLAG(Limit, A.Limit == B.Limit);
+	TEST_FLAG(Limit, A.GetCachedStackLimit() == B.GetCachedStackLimit());
 	TEST_FLAG(StackSum, A.StackSum() == B.StackSum());
-	TEST_FLAG(ItemData, UFaerieItem::Compare(A.ItemObject, B.ItemObject, EFaerieItemComparisonFlags::Default));
+	TEST_FLAG(ItemData, UFaerieItem::Compare(A.GetItem(), B.GetItem(), EFaerieItemComparisonFlags::Default));
 
 #undef TEST_FLAG
 
@@ -193,7 +228,11 @@ FInventoryEntry::FMutableAccess::FMutableAccess(FInventoryContent& Source, const
 	Source(Source)
 {
 	Source.WriteLock++;
+	Source.PreEntryEdit(Handle);
 	ChangeMask.Init(false, Handle.NumStacks());
+
+	// Stack edits depend on the limit, which needs the item.
+	Handle.GetCachedStackLimit();
 }
 
 FInventoryEntry::FMutableAccess::FMutableAccess(FInventoryContent& Source, const FEntryKey Key)
@@ -201,7 +240,11 @@ FInventoryEntry::FMutableAccess::FMutableAccess(FInventoryContent& Source, const
 	Source(Source)
 {
 	Source.WriteLock++;
+	Source.PreEntryEdit(Handle);
 	ChangeMask.Init(false, Handle.NumStacks());
+
+	// Stack edits depend on the limit, which needs the item.
+	Handle.GetCachedStackLimit();
 }
 
 FInventoryEntry::FMutableAccess::~FMutableAccess()
@@ -480,6 +523,36 @@ void FInventoryContent::Remove(const FEntryKey Key)
 	}
 }
 
+bool FInventoryContent::NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+{
+	if (DeltaParms.Writer && HasUnmaterializedEntries())
+	{
+		// Clients need real items, so anything still lazy has to be created before it can be sent. Storages that no one
+		// is viewing hold their content back instead, and stay lazy until they are opened.
+		if (IsValid(ChangeListener) && ChangeListener->IsLazyReplicationDeferred())
+		{
+			return false;
+		}
+		MaterializeAll();
+	}
+	return Faerie::Hacks::FastArrayDeltaSerialize<FInventoryEntry, FInventoryContent>(Entries, DeltaParms, *this);
+}
+
+void FInventoryContent::MaterializeAll()
+{
+	if (!LazySource.IsValid())
+	{
+		return;
+	}
+
+	for (const FInventoryEntry& Entry : Entries)
+	{
+		Entry.GetItem();
+	}
+
+	LazySource.Reset();
+}
+
 void FInventoryContent::LockWriteAccess() const
 {
 	WriteLock++;
@@ -490,6 +563,30 @@ void FInventoryContent::UnlockWriteAccess() const
 	WriteLock--;
 }
 
+void FInventoryContent::RecordReplicatedEntry(const FInventoryEntry& Entry, const bool Removed) const
+{
+	if (IsValid(ChangeListener))
+	{
+		ChangeListener->RecordReplicatedEntry(Entry, Removed);
+	}
+}
+
+void FInventoryContent::PreEntryEdit(const FInventoryEntry& Entry) const
+{
+	if (IsValid(ChangeListener))
+	{
+		ChangeListener->PreEntryEdit(Entry);
+	}
+}
+
+void FInventoryContent::PostReplicatedReceive(const FPostReplicatedReceiveParameters& Parameters) const
+{
+	if (IsValid(ChangeListener))
+	{
+		ChangeListener->PostContentReplicated();
+	}
+}
+
 void FInventoryContent::PreEntryReplicatedRemove(const FInventoryEntry& Entry) const
 {
 	if (IsValid(ChangeListener))
@@ -9,6 +9,8 @@
 #endif
 
 #include "AssetLoadFlagFixer.h"
+#include "FaerieDataSystemMemory.h"
+#include "FaerieDataSystemTrace.h"
 #include "FaerieInventoryLog.h"
 #include "Engine/EngineTypes.h"
 #include "GameFramework/Actor.h"
@@ -19,6 +21,18 @@
 
 #define LOCTEXT_NAMESPACE "ItemContainerExtensionGroup"
 
+DECLARE_STATS_GROUP(TEXT("FaerieContainerExtensions"), STATGROUP_FaerieContainerExtensions, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Initialize Extension"), STAT_Extension_Initialize, STATGROUP_FaerieContainerExtensions);
+DECLARE_CYCLE_STAT(TEXT("Deinitialize Extension"), STAT_Extension_Deinitialize, STATGROUP_FaerieContainerExtensions);
+DECLARE_CYCLE_STAT(TEXT("Allows Addition"), STAT_Extension_AllowsAddition, STATGROUP_FaerieContainerExtensions);
+DECLARE_CYCLE_STAT(TEXT("Pre Addition"), STAT_Extension_PreAddition, STATGROUP_FaerieContainerExtensions);
+DECLARE_CYCLE_STAT(TEXT("Post Addition"), STAT_Extension_PostAddition, STATGROUP_FaerieContainerExtensions);
+DECLARE_CYCLE_STAT(TEXT("Allows Removal"), STAT_Extension_AllowsRemoval, STATGROUP_FaerieContainerExtensions);
+DECLARE_CYCLE_STAT(TEXT("Pre Removal"), STAT_Extension_PreRemoval, STATGROUP_FaerieContainerExtensions);
+DECLARE_CYCLE_STAT(TEXT("Post Removal"), STAT_Extension_PostRemoval, STATGROUP_FaerieContainerExtensions);
+DECLARE_CYCLE_STAT(TEXT("Allows Edit"), STAT_Extension_AllowsEdit, STATGROUP_FaerieContainerExtensions);
+DECLARE_CYCLE_STAT(TEXT("Post Entry Changed"), STAT_Extension_PostEntryChanged, STATGROUP_FaerieContainerExtensions);
+
 using namespace Faerie;
 
 void UItemContainerExtensionBase::PostDuplicate(const EDuplicateMode::Type DuplicateMode)
@@ -40,6 +54,14 @@ void UItemContainerExtensionBase::InitializeNetObject(AActor* Actor)
 			"	Failing Extension: '%s'"), *GetFullName());
 }
 
+void UItemContainerExtensionBase::RestoreTransactionSnapshot(const UFaerieItemContainerBase* Container, const FInstancedStruct& Snapshot)
+{
+	if (Snapshot.IsValid())
+	{
+		LoadSaveData(Container, Snapshot);
+	}
+}
+
 void UItemContainerExtensionBase::SetIdentifier(const FGuid* GuidToUse)
 {
 	if (GuidToUse)
@@ -290,8 +312,11 @@ void UItemContainerExtensionGroup::InitializeExtension(const UFaerieItemContaine
 
 	Containers.Emplace(Container);
 
+	FAERIE_SCOPE_CYCLE_COUNTER(STAT_Extension_Initialize);
+	LLM_SCOPE_BYTAG(ContainerExtensions);
 	for (auto Extension : Extension::FExtensionIterator(this))
 	{
+		FAERIE_TRACE_OBJECT_SCOPE(Extension);
 		Extension->InitializeExtension(Container);
 	}
 }
@@ -301,8 +326,10 @@ void UItemContainerExtensionGroup::DeinitializeExtension(const UFaerieItemContai
 	if (!ensure(IsValid(Container))) return;
 	if (!Containers.Contains(Container)) return;
 
+	FAERIE_SCOPE_CYCLE_COUNTER(STAT_Extension_Deinitialize);
 	for (auto Extension : Extension::FExtensionIterator(this))
 	{
+		FAERIE_TRACE_OBJECT_SCOPE(Extension);
 		Extension->DeinitializeExtension(Container);
 	}
 
@@ -313,11 +340,14 @@ EEventExtensionResponse UItemContainerExtensionGroup::AllowsAddition(const UFaer
 																	 const TConstArrayView<FFaerieItemStackView> Views,
 																	 const FFaerieExtensionAllowsAdditionArgs Args) const
 {
+	FAERIE_SCOPE_CYCLE_COUNTER(STAT_Extension_AllowsAddition);
+
 	EEventExtensionResponse Response = EEventExtensionResponse::NoExplicitResponse;
 
 	// Check each extension, to see if the reason is allowed or denied.
 	for (auto Extension : Extension::FConstExtensionIterator(this))
 	{
+		FAERIE_TRACE_OBJECT_SCOPE(Extension);
 		switch (Extension->AllowsAddition(Container, Views, Args))
 		{
 		case EEventExtensionResponse::Allowed:
@@ -341,8 +371,11 @@ EEventExtensionResponse UItemContainerExtensionGroup::AllowsAddition(const UFaer
 
 void UItemContainerExtensionGroup::PreAddition(const UFaerieItemContainerBase* Container, const FFaerieItemStackView Stack)
 {
+	FAERIE_SCOPE_CYCLE_COUNTER(STAT_Extension_PreAddition);
+	LLM_SCOPE_BYTAG(ContainerExtensions);
 	for (auto Extension : Extension::FExtensionIterator(this))
 	{
+		FAERIE_TRACE_OBJECT_SCOPE(Extension);
 		Extension->PreAddition(Container, Stack);
 	}
 }
@@ -350,8 +383,17 @@ void UItemContainerExtensionGroup::PreAddition(const UFaerieItemContainerBase* C
 void UItemContainerExtensionGroup::PostAddition(const UFaerieItemContainerBase* Container,
 												const Inventory::FEventLog& Event)
 {
+	FAERIE_SCOPE_CYCLE_COUNTER(STAT_Extension_PostAddition);
+	LLM_SCOPE_BYTAG(ContainerExtensions);
 	for (auto Extension : Extension::FExtensionIterator(this))
 	{
+		if (Container->IsInTransaction() && !Extension->RunsHooksInTransaction())
+		{
+			ConstCast(Container)->HoldExtensionHook(Extension, UFaerieItemContainerBase::EHeldHook::PostAddition, Event);
+			continue;
+		}
+
+		FAERIE_TRACE_OBJECT_SCOPE(Extension);
 		Extension->PostAddition(Container, Event);
 	}
 }
@@ -359,11 +401,14 @@ void UItemContainerExtensionGroup::PostAddition(const UFaerieItemContainerBase*
 EEventExtensionResponse UItemContainerExtensionGroup::AllowsRemoval(const UFaerieItemContainerBase* Container,
 																	const FFaerieAddress Address, const FFaerieInventoryTag Reason) const
 {
+	FAERIE_SCOPE_CYCLE_COUNTER(STAT_Extension_AllowsRemoval);
+
 	EEventExtensionResponse Response = EEventExtensionResponse::NoExplicitResponse;
 
 	// Check each extension, to see if the reason is allowed or denied.
 	for (auto Extension : Extension::FConstExtensionIterator(this))
 	{
+		FAERIE_TRACE_OBJECT_SCOPE(Extension);
 		switch (Extension->AllowsRemoval(Container, Address, Reason))
 		{
 		case EEventExtensionResponse::Allowed:
@@ -387,8 +432,10 @@ EEventExtensionResponse UItemContainerExtensionGroup::AllowsRemoval(const UFaeri
 
 void UItemContainerExtensionGroup::PreRemoval(const UFaerieItemContainerBase* Container, const FEntryKey Key, const int32 Removal)
 {
+	FAERIE_SCOPE_CYCLE_COUNTER(STAT_Extension_PreRemoval);
 	for (auto Extension : Extension::FExtensionIterator(this))
 	{
+		FAERIE_TRACE_OBJECT_SCOPE(Extension);
 		Extension->PreRemoval(Container, Key, Removal);
 	}
 }
@@ -396,8 +443,17 @@ void UItemContainerExtensionGroup::PreRemoval(const UFaerieItemContainerBase* Co
 void UItemContainerExtensionGroup::PostRemoval(const UFaerieItemContainerBase* Container,
                                            const Inventory::FEventLog& Event)
 {
+	FAERIE_SCOPE_CYCLE_COUNTER(STAT_Extension_PostRemoval);
+	LLM_SCOPE_BYTAG(ContainerExtensions);
 	for (auto Extension : Extension::FExtensionIterator(this))
 	{
+		if (Container->IsInTransaction() && !Extension->RunsHooksInTransaction())
+		{
+			ConstCast(Container)->HoldExtensionHook(Extension, UFaerieItemContainerBase::EHeldHook::PostRemoval, Event);
+			continue;
+		}
+
+		FAERIE_TRACE_OBJECT_SCOPE(Extension);
 		Extension->PostRemoval(Container, Event);
 	}
 }
@@ -406,11 +462,14 @@ EEventExtensionResponse UItemContainerExtensionGroup::AllowsEdit(const UFaerieIt
 																 const FEntryKey Key,
 																 const FFaerieInventoryTag EditTag) const
 {
+	FAERIE_SCOPE_CYCLE_COUNTER(STAT_Extension_AllowsEdit);
+
 	EEventExtensionResponse Response = EEventExtensionResponse::NoExplicitResponse;
 
 	// Check each extension, to see if the reason is allowed or denied.
 	for (auto Extension : Extension::FConstExtensionIterator(this))
 	{
+		FAERIE_TRACE_OBJECT_SCOPE(Extension);
 		switch (Extension->AllowsEdit(Container, Key, EditTag))
 		{
 		case EEventExtensionResponse::Allowed:
@@ -435,12 +494,30 @@ EEventExtensionResponse UItemContainerExtensionGroup::AllowsEdit(const UFaerieIt
 void UItemContainerExtensionGroup::PostEntryChanged(const UFaerieItemContainerBase* Container,
 	const Inventory::FEventLog& Event)
 {
+	FAERIE_SCOPE_CYCLE_COUNTER(STAT_Extension_PostEntryChanged);
+	LLM_SCOPE_BYTAG(ContainerExtensions);
 	for (auto Extension : Extension::FExtensionIterator(this))
 	{
+		if (Container->IsInTransaction() && !Extension->RunsHooksInTransaction())
+		{
+			ConstCast(Container)->HoldExtensionHook(Extension, UFaerieItemContainerBase::EHeldHook::PostEntryChanged, Event);
+			continue;
+		}
+
+		FAERIE_TRACE_OBJECT_SCOPE(Extension);
 		Extension->PostEntryChanged(Container, Event);
 	}
 }
 
+void UItemContainerExtensionGroup::GetMemoryUsage(const UFaerieItemContainerBase* Container,
+	Memory::FReport& Report) const
+{
+	for (auto Extension : Extension::FRecursiveConstExtensionIterator(this))
+	{
+		Extension->GetMemoryUsage(Container, Report);
+	}
+}
+
 UItemContainerExtensionGroup* UItemContainerExtensionGroup::GetExtensionGroup() const
 {
 	return const_cast<UItemContainerExtensionGroup*>(this);
@@ -526,6 +603,8 @@ bool UItemContainerExtensionGroup::AddExtension(UItemContainerExtensionBase* Ext
 		return false;
 	}
 
+	LLM_SCOPE_BYTAG(ContainerExtensions);
+
 	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, Extensions, this);
 	DynamicExtensions.Add(Extension);
 	for (auto&& Container : Containers)
@@ -2,11 +2,57 @@
 
 #pragma once
 
+#include "FaerieClientPrediction.h"
+#include "FaerieItemContainerStructs.h"
 #include "FaerieItemStackView.h"
+#include "StructUtils/InstancedStruct.h"
 #include "FaerieClientActionBase.generated.h"
 
 class UFaerieInventoryClient;
 
+UENUM()
+enum class EFaerieClientRequestBatchType : uint8
+{
+	// This batch is for sending multiple individual requests at once. Each one will be run, even if some fail.
+	Individuals,
+
+	// This batch is for sending a sequence of requests. If one fails, no more will run.
+	Sequence,
+
+	// Like a sequence, but if one fails, every edit made by the earlier requests is undone as well.
+	Transaction
+};
+
+namespace Faerie::ClientAction
+{
+	// Helpers for writing compact NetSerialize functions for client actions. Values are zigzag encoded into packed ints,
+	// as they are usually small, and often -1.
+	FAERIEINVENTORY_API void NetSerializeInt(FArchive& Ar, int32& Value);
+	FAERIEINVENTORY_API void NetSerializeAddress(FArchive& Ar, FFaerieAddress& Address);
+	FAERIEINVENTORY_API void NetSerializeIntPoint(FArchive& Ar, FIntPoint& Point);
+
+	template <
+		typename TKey
+		UE_REQUIRES(TIsDerivedFrom<TKey, FFaerieItemKeyBase>::Value)
+	>
+	void NetSerializeKey(FArchive& Ar, TKey& Key)
+	{
+		int32 Value = Key.Value();
+		NetSerializeInt(Ar, Value);
+		if (Ar.IsLoading())
+		{
+			Key = TKey(Value);
+		}
+	}
+
+	// The most actions a client may send in a single batch.
+	static constexpr int32 MaxBatchActions = 256;
+
+	// Checksum of the table of action structs used to pack batches. Packed batches can only be read by a machine with
+	// the same checksum. This changes when a module that adds actions is loaded.
+	FAERIEINVENTORY_API uint32 GetActionTableChecksum();
+}
+
 USTRUCT()
 struct FAERIEINVENTORY_API FFaerieClientActionBase
 {
@@ -20,6 +66,40 @@ struct FAERIEINVENTORY_API FFaerieClientActionBase
 	 */
 	virtual bool Server_Execute(const UFaerieInventoryClient* Client) const
 	PURE_VIRTUAL(FFaerieClientActionBase::Server_Execute, return false; )
+
+	/*
+	 * Runs on the owning client when it makes this request, if the client has prediction enabled.
+	 * Override to apply the expected result locally, tracked under Key, so the client doesn't have to wait for the
+	 * server to see it. Return true if anything was predicted. Predictions are rolled back if the server rejects them.
+	 */
+	virtual bool Client_Predict(UFaerieInventoryClient* Client, Faerie::ClientAction::FPredictionKey Key) const { return false; }
+};
+
+/**
+ * A batch of client actions, packed for sending to the server. Instead of each action's struct path, actions are written
+ * as an index into a table of all action structs, and actions that implement NetSerialize use it for their data.
+ */
+USTRUCT()
+struct FAERIEINVENTORY_API FFaerieClientActionBatch
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<TInstancedStruct<FFaerieClientActionBase>> Actions;
+
+	UPROPERTY()
+	EFaerieClientRequestBatchType Type = EFaerieClientRequestBatchType::Individuals;
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FFaerieClientActionBatch> : public TStructOpsTypeTraitsBase2<FFaerieClientActionBatch>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
 };
 
 USTRUCT()
@@ -0,0 +1,331 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "Algo/BinarySearch.h"
+#include "Delegates/Delegate.h"
+#include "Net/Serialization/FastArraySerializer.h"
+#include "Templates/Function.h"
+#include "Templates/UnrealTemplate.h"
+#include "UObject/WeakObjectPtr.h"
+
+class UFaerieInventoryClient;
+
+namespace Faerie::ClientAction
+{
+	// Identifies a request that a client has predicted locally. Assigned by UFaerieInventoryClient. 0 is never used.
+	using FPredictionKey = int32;
+
+	// Broadcast on the client when the server has accepted or rejected a predicted request.
+	using FPredictionResolved = TMulticastDelegate<void(FPredictionKey, bool)>;
+
+	/**
+	 * Subscribes an object holding predicted state to the client that made the predictions. Only one client is tracked
+	 * at a time, as only the locally controlled client ever predicts.
+	 */
+	class FAERIEINVENTORY_API FPredictionListener : FNoncopyable
+	{
+	public:
+		~FPredictionListener();
+
+		void Bind(UFaerieInventoryClient* Client, FPredictionResolved::FDelegate&& Callback);
+		void Unbind();
+
+	private:
+		TWeakObjectPtr<UFaerieInventoryClient> BoundClient;
+		FDelegateHandle Handle;
+	};
+
+	/**
+	 * Tracks edits a client has predicted on the items of a replicated Fast Array, so they can be undone if the server
+	 * rejects them.
+	 *
+	 * Predicted edits are made directly to the live items, so all read paths see them without knowing about prediction.
+	 * A copy of the items as last replicated is kept alongside, and kept in sync from the Fast Array's replication
+	 * callbacks, which is only taken once prediction starts. Each edit records the items it changed, before and after.
+	 * The items are copied as their edit handles open, so an edit only pays for what it touches. To reconcile, the live items are reset to the
+	 * replicated copy, and each edit still pending is applied again, as long as the items it touched are still in the
+	 * state it was predicted from. An edit whose result has already replicated is left alone, so an edit is never applied
+	 * twice, regardless of whether the server's acknowledgement or its replicated result arrives first.
+	 *
+	 * TItem must have a Key member, that is sorted with operator<, and is unique within the array.
+	 */
+	template <typename TItem>
+	class TPredictedItems : FNoncopyable
+	{
+		using FKeyType = decltype(TItem::Key);
+
+	public:
+		// Compares the parts of two items that may be predicted. Replication bookkeeping should be ignored.
+		using FItemsMatch = TFunctionRef<bool(const TItem&, const TItem&)>;
+
+		// Are any edits waiting to be confirmed?
+		bool IsPredicting() const { return !Edits.IsEmpty(); }
+
+		int32 NumPendingEdits() const { return Edits.Num(); }
+
+		/**
+		 * Makes a predicted edit to the live items. Edit should change existing items only, each through a handle that
+		 * calls RecordPreEdit before changing it, and return false if it couldn't be made. Returns true if the edit was
+		 * made and is now tracked under Key.
+		 */
+		bool Predict(const FPredictionKey Key, TArray<TItem>& LiveItems, const TFunctionRef<bool()> Edit, FItemsMatch Matches)
+		{
+			check(Recording == nullptr);
+
+			TArray<TItem, TInlineAllocator<2>> Touched;
+			{
+				TGuardValue<decltype(Recording)> RecordingScope(Recording, &Touched);
+				if (!Edit())
+				{
+					return false;
+				}
+			}
+
+			FPendingEdit PendingEdit;
+			PendingEdit.Key = Key;
+
+			for (const TItem& Previous : Touched)
+			{
+				if (const TItem* Item = LiveItems.FindByPredicate([&Previous](const TItem& Live) { return Live.Key == Previous.Key; });
+					Item && !Matches(Previous, *Item))
+				{
+					PendingEdit.Before.Add(Previous);
+					PendingEdit.After.Add(*Item);
+				}
+			}
+
+			// Nothing actually changed, so there is nothing to track.
+			if (PendingEdit.Before.IsEmpty())
+			{
+				return false;
+			}
+
+			SortByKey(PendingEdit.Before);
+			SortByKey(PendingEdit.After);
+
+			if (!IsPredicting())
+			{
+				// Nothing else was pending, so apart from this edit, the live items are what was last replicated.
+				Authority = LiveItems;
+				SortByKey(Authority);
+				for (const TItem& Previous : PendingEdit.Before)
+				{
+					Authority[Algo::BinarySearchBy(Authority, Previous.Key, &TItem::Key)] = Previous;
+				}
+			}
+
+			Edits.Add(MoveTemp(PendingEdit));
+			return true;
+		}
+
+		// Called by edit handles before they change Item. Keeps a copy of the item if an edit is being predicted.
+		void RecordPreEdit(const TItem& Item)
+		{
+			if (Recording &&
+				!Recording->ContainsByPredicate([&Item](const TItem& Recorded) { return Recorded.Key == Item.Key; }))
+			{
+				Recording->Add(Item);
+			}
+		}
+
+		// Records an item added or changed by replication.
+		void RecordReplicatedItem(const TItem& Item)
+		{
+			if (!IsPredicting()) return;
+
+			const int32 Index = Algo::LowerBoundBy(Authority, Item.Key, &TItem::Key);
+			if (Authority.IsValidIndex(Index) && Authority[Index].Key == Item.Key)
+			{
+				Authority[Index] = Item;
+			}
+			else
+			{
+				Authority.Insert(Item, Index);
+			}
+		}
+
+		// Records an item removed by replication.
+		void RecordReplicatedRemove(const FKeyType Key)
+		{
+			if (!IsPredicting()) return;
+
+			if (const int32 Index = Algo::BinarySearchBy(Authority, Key, &TItem::Key);
+				Index != INDEX_NONE)
+			{
+				Authority.RemoveAt(Index);
+			}
+		}
+
+		/**
+		 * Marks the edit for Key as accepted or rejected. Rejected edits are dropped immediately. Accepted edits are kept
+		 * until their result has replicated. Returns true if this tracked the key. Call Reconcile afterward.
+		 */
+		bool Resolve(const FPredictionKey Key, const bool Accepted)
+		{
+			const int32 Index = Edits.IndexOfByPredicate([Key](const FPendingEdit& Edit) { return Edit.Key == Key; });
+			if (Index == INDEX_NONE)
+			{
+				return false;
+			}
+
+			if (Accepted)
+			{
+				Edits[Index].Accepted = true;
+			}
+			else
+			{
+				Edits.RemoveAt(Index);
+			}
+			return true;
+		}
+
+		/**
+		 * Rebuilds the live items from the replicated copy, and applies the edits that are still pending on top.
+		 * Edits that no longer apply are dropped. OutChanged receives the keys of items that differ from before.
+		 */
+		void Reconcile(TArray<TItem>& LiveItems, FItemsMatch Matches, TArray<FKeyType>& OutChanged)
+		{
+			if (!IsPredicting()) return;
+
+			TArray<TItem> Previous = MoveTemp(LiveItems);
+			LiveItems = Authority;
+
+			for (auto It = Edits.CreateIterator(); It; ++It)
+			{
+				switch (Replay(*It, LiveItems, Matches))
+				{
+				case EReplay::Applied:
+					break;
+				case EReplay::AlreadyReplicated:
+					// Once the server has confirmed the edit, and its result has arrived, it's done.
+					if (It->Accepted)
+					{
+						It.RemoveCurrent();
+					}
+					break;
+				case EReplay::Diverged:
+					// The items have changed under this edit. Whatever the server did is what we show now.
+					It.RemoveCurrent();
+					break;
+				}
+			}
+
+			if (!IsPredicting())
+			{
+				Authority.Empty();
+			}
+
+			SortByKey(Previous);
+			for (const TItem& Item : LiveItems)
+			{
+				if (const TItem* PreviousItem = FindByKey(Previous, Item.Key);
+					!PreviousItem || !Matches(*PreviousItem, Item))
+				{
+					OutChanged.Add(Item.Key);
+				}
+			}
+		}
+
+		// Forget all predictions without touching the live items.
+		void Reset()
+		{
+			Edits.Empty();
+			Authority.Empty();
+		}
+
+		// Heap memory used by the replicated copy and pending edits. Allocations owned by the items themselves are not included.
+		SIZE_T GetAllocatedSize() const
+		{
+			SIZE_T Size = Authority.GetAllocatedSize() + Edits.GetAllocatedSize();
+			for (const FPendingEdit& Edit : Edits)
+			{
+				Size += Edit.Before.GetAllocatedSize() + Edit.After.GetAllocatedSize();
+			}
+			return Size;
+		}
+
+	private:
+		struct FPendingEdit
+		{
+			FPredictionKey Key = 0;
+			bool Accepted = false;
+
+			// The items this edit changed, sorted by key, before and after the edit.
+			TArray<TItem> Before;
+			TArray<TItem> After;
+		};
+
+		enum class EReplay : uint8
+		{
+			Applied,
+			AlreadyReplicated,
+			Diverged
+		};
+
+		static EReplay Replay(const FPendingEdit& Edit, TArray<TItem>& LiveItems, FItemsMatch Matches)
+		{
+			TArray<TItem*, TInlineAllocator<2>> Targets;
+			bool AllReplicated = true;
+
+			for (int32 i = 0; i < Edit.Before.Num(); ++i)
+			{
+				TItem* Live = LiveItems.FindByPredicate([Key = Edit.Before[i].Key](const TItem& Item) { return Item.Key == Key; });
+				if (!Live)
+				{
+					return EReplay::Diverged;
+				}
+
+				if (Matches(*Live, Edit.After[i]))
+				{
+					continue;
+				}
+
+				if (!Matches(*Live, Edit.Before[i]))
+				{
+					return EReplay::Diverged;
+				}
+
+				AllReplicated = false;
+				Targets.Add(Live);
+			}
+
+			if (AllReplicated)
+			{
+				return EReplay::AlreadyReplicated;
+			}
+
+			for (TItem* Live : Targets)
+			{
+				const int32 Index = Algo::BinarySearchBy(Edit.After, Live->Key, &TItem::Key);
+
+				// Keep the live item's replication bookkeeping, only the data is predicted.
+				const FFastArraySerializerItem Bookkeeping = *Live;
+				*Live = Edit.After[Index];
+				static_cast<FFastArraySerializerItem&>(*Live) = Bookkeeping;
+			}
+
+			return EReplay::Applied;
+		}
+
+		static void SortByKey(TArray<TItem>& Items)
+		{
+			Items.Sort([](const TItem& A, const TItem& B) { return A.Key < B.Key; });
+		}
+
+		static const TItem* FindByKey(const TArray<TItem>& SortedItems, const FKeyType Key)
+		{
+			const int32 Index = Algo::BinarySearchBy(SortedItems, Key, &TItem::Key);
+			return Index != INDEX_NONE ? &SortedItems[Index] : nullptr;
+		}
+
+		// The items as last replicated, sorted by key. Only kept while predicting.
+		TArray<TItem> Authority;
+
+		// Edits in the order they were predicted.
+		TArray<FPendingEdit> Edits;
+
+		// The items touched by the edit being predicted, as they were before it. Only set during Predict.
+		TArray<TItem, TInlineAllocator<2>>* Recording = nullptr;
+	};
+}
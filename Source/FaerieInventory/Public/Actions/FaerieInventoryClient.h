@@ -8,19 +8,11 @@
 #include "StructUtils/InstancedStruct.h"
 #include "FaerieInventoryClient.generated.h"
 
+enum class EModuleChangeReason;
 class UFaerieInventoryClient;
+class UFaerieInventoryComponent;
 class UFaerieItemContainerBase;
 
-UENUM()
-enum class EFaerieClientRequestBatchType : uint8
-{
-	// This batch is for sending multiple individual requests at once. Each one will be run, even if some fail.
-	Individuals,
-
-	// This batch is for sending a sequence of requests. If one fails, no more will run.
-	Sequence
-};
-
 USTRUCT(BlueprintType)
 struct FFaerieClientStackPromptResult
 {
@@ -62,12 +54,22 @@ class FAERIEINVENTORY_API UFaerieInventoryClient : public UActorComponent
 public:
 	UFaerieInventoryClient();
 
+	//~ UObject
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	//~ UObject
+
+	//~ UActorComponent
+	virtual void BeginPlay() override;
+	virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
+	//~ UActorComponent
+
 	// Overrides for allowing a client to run a request on the server.
 	virtual bool CanAccessContainer(const UFaerieItemContainerBase* Container, const UScriptStruct* RequestType) const;
 
 	/**
 	 * Sends a request to the server to perform an inventory related edit.
 	 * To define custom actions, derive a struct from FFaerieClientActionBase, and override Server_Execute.
+	 * If CoalesceRequests is enabled, the request is queued, and sent with any others made in the same window.
 	 */
 	void RequestExecuteAction(const FFaerieClientActionBase& Args);
 
@@ -83,6 +85,25 @@ public:
 	 */
 	void RequestMoveAction(const FFaerieClientAction_MoveHandlerBase& MoveFrom, const FFaerieClientAction_MoveHandlerBase& MoveTo);
 
+	// Immediately send all requests queued by RequestExecuteAction.
+	UFUNCTION(BlueprintCallable, Category = "Faerie|InventoryClient")
+	void FlushPendingActions();
+
+	int32 NumPendingActions() const { return PendingActions.Num(); }
+
+	UFUNCTION(BlueprintCallable, Category = "Faerie|InventoryClient")
+	void SetPredictRequests(const bool Enabled) { PredictRequests = Enabled; }
+
+	// Broadcast when the server accepts or rejects a request that this client predicted.
+	Faerie::ClientAction::FPredictionResolved::RegistrationType& GetOnPredictionResolved() { return OnPredictionResolved; }
+
+	/**
+	 * Tells the server whether this client has a container open. UIs should call this when showing and hiding a container.
+	 * Inventories with a replication policy that sleeps while unviewed only replicate while someone is viewing them.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Faerie|InventoryClient")
+	void SetContainerViewed(UFaerieItemContainerBase* Container, bool Viewed);
+
 	UFUNCTION(BlueprintCallable, BlueprintCosmetic, Category = "Faerie|InventoryClient")
 	bool PromptStackChoice(const FFaerieClientStackPromptArgs& Args, const FFaerieClientStackPromptCallback& Callback);
 
@@ -117,11 +138,75 @@ protected:
 	UFUNCTION(BlueprintCallable, Server, Reliable, Category = "Faerie|InventoryClient")
 	void RequestMoveAction(const TInstancedStruct<FFaerieClientAction_MoveHandlerBase>& MoveFrom, const TInstancedStruct<FFaerieClientAction_MoveHandlerBase>& MoveTo);
 
+	// Compact version of RequestExecuteAction_Batch, used by the native API.
+	UFUNCTION(Server, Reliable)
+	void RequestExecuteAction_Packed(const FFaerieClientActionBatch& Batch);
+
+	// Version of RequestExecuteAction for requests that were predicted. The server acknowledges each with ClientAckPrediction.
+	UFUNCTION(Server, Reliable)
+	void RequestExecuteAction_Predicted(const TInstancedStruct<FFaerieClientActionBase>& Args, int32 PredictionKey);
+
+	UFUNCTION(Client, Reliable)
+	void ClientAckPrediction(int32 PredictionKey, bool Accepted);
+
+	UFUNCTION(Server, Reliable)
+	void ServerSetContainerViewed(UFaerieItemContainerBase* Container, bool Viewed);
+
+	// Should requests that support it be applied locally as soon as they are made, instead of waiting for the server to
+	// replicate the result? Predicted edits are undone if the server rejects the request. Predicted requests are sent
+	// right away, even if CoalesceRequests is enabled.
+	UPROPERTY(EditAnywhere, Category = "Requests")
+	bool PredictRequests = false;
+
+	// Should requests made with RequestExecuteAction be queued, and sent together in batches? This keeps mass-edits, like
+	// moving a whole inventory, from flooding the reliable buffer with one RPC per action.
+	UPROPERTY(EditAnywhere, Category = "Requests")
+	bool CoalesceRequests = false;
+
+	// How long to collect requests for, in seconds, before sending them. At 0, requests are sent on the next tick.
+	UPROPERTY(EditAnywhere, Category = "Requests", meta = (ClampMin = 0, EditCondition = "CoalesceRequests"))
+	float CoalesceWindow = 0.f;
+
+	// The most actions that are sent in a single RPC. Larger queues are split into multiple batches.
+	UPROPERTY(EditAnywhere, Category = "Requests", meta = (ClampMin = 1, ClampMax = 256, EditCondition = "CoalesceRequests"))
+	int32 MaxActionsPerBatch = 64;
+
 private:
+	// Predicts a request, and sends it to the server if a prediction was made. Returns false if nothing was sent.
+	bool TrySendPredicted(const FFaerieClientActionBase& Args);
+
+	void SendBatch(TArray<TInstancedStruct<FFaerieClientActionBase>>&& Actions, EFaerieClientRequestBatchType Type);
+
+	void OnModulesChanged(FName ModuleName, EModuleChangeReason Reason);
+	void UpdateServerActionTableChecksum();
+
 	void Server_RequestExecuteAction(const FFaerieClientActionBase& Args);
 	void Server_RequestExecuteAction_Batch(const TArray<const FFaerieClientActionBase*>& Args, EFaerieClientRequestBatchType Type);
 	void Server_RequestMoveAction(const FFaerieClientAction_MoveHandlerBase& MoveFrom, const FFaerieClientAction_MoveHandlerBase& MoveTo);
+	void Server_SetContainerViewed(UFaerieItemContainerBase* Container, bool Viewed);
 
 	FFaerieClientStackPromptHandler StackPromptHandler;
 	FFaerieClientStackPromptCallback ActivePromptCallback;
+
+	// The server's action table checksum. Batches are only sent packed when this matches our own, as the server can't
+	// read them otherwise. Zero until it has replicated.
+	UPROPERTY(Replicated)
+	uint32 ServerActionTableChecksum = 0;
+
+	// Requests waiting to be sent by FlushPendingActions.
+	TArray<TInstancedStruct<FFaerieClientActionBase>> PendingActions;
+	FTimerHandle FlushTimer;
+
+	struct FViewedContainer
+	{
+		TWeakObjectPtr<UFaerieItemContainerBase> Container;
+		TWeakObjectPtr<UFaerieInventoryComponent> Inventory;
+	};
+
+	// Containers this client has open, and the inventory each is in. An inventory stays viewed while any of its
+	// containers are open. Only tracked on the server.
+	TArray<FViewedContainer> ViewedContainers;
+
+	Faerie::ClientAction::FPredictionKey LastPredictionKey = 0;
+	Faerie::ClientAction::FPredictionResolved OnPredictionResolved;
 };
\ No newline at end of file
@@ -74,6 +74,8 @@ struct FFaerieClientAction_RequestMoveEntry final : public FFaerieClientActionBa
 
 	virtual bool Server_Execute(const UFaerieInventoryClient* Client) const override;
 
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+
 	UPROPERTY(BlueprintReadWrite, Category = "MoveEntry")
 	TObjectPtr<UFaerieItemStorage> Storage = nullptr;
 
@@ -87,12 +89,24 @@ struct FFaerieClientAction_RequestMoveEntry final : public FFaerieClientActionBa
 	TObjectPtr<UFaerieItemStorage> ToStorage = nullptr;
 };
 
+template<>
+struct TStructOpsTypeTraits<FFaerieClientAction_RequestMoveEntry> : public TStructOpsTypeTraitsBase2<FFaerieClientAction_RequestMoveEntry>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
+
 USTRUCT(BlueprintType)
 struct FFaerieClientAction_MergeStacks final : public FFaerieClientActionBase
 {
 	GENERATED_BODY()
 
 	virtual bool Server_Execute(const UFaerieInventoryClient* Client) const override;
+	virtual bool Client_Predict(UFaerieInventoryClient* Client, Faerie::ClientAction::FPredictionKey Key) const override;
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
 
 	UPROPERTY(BlueprintReadWrite, Category = "MergeStacks")
 	TObjectPtr<UFaerieItemStorage> Storage = nullptr;
@@ -111,12 +125,24 @@ struct FFaerieClientAction_MergeStacks final : public FFaerieClientActionBase
 	int32 Amount = -1;
 };
 
+template<>
+struct TStructOpsTypeTraits<FFaerieClientAction_MergeStacks> : public TStructOpsTypeTraitsBase2<FFaerieClientAction_MergeStacks>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
+
 USTRUCT(BlueprintType)
 struct FFaerieClientAction_SplitStack final : public FFaerieClientActionBase
 {
 	GENERATED_BODY()
 
 	virtual bool Server_Execute(const UFaerieInventoryClient* Client) const override;
+	virtual bool Client_Predict(UFaerieInventoryClient* Client, Faerie::ClientAction::FPredictionKey Key) const override;
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
 
 	UPROPERTY(BlueprintReadWrite, Category = "SplitStack")
 	TObjectPtr<UFaerieItemStorage> Storage = nullptr;
@@ -126,4 +152,13 @@ struct FFaerieClientAction_SplitStack final : public FFaerieClientActionBase
 
 	UPROPERTY(BlueprintReadWrite, Category = "SplitStack")
 	int32 Amount = 1;
+};
+
+template<>
+struct TStructOpsTypeTraits<FFaerieClientAction_SplitStack> : public TStructOpsTypeTraitsBase2<FFaerieClientAction_SplitStack>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
 };
\ No newline at end of file
@@ -4,11 +4,17 @@
 
 #include "FaerieContainerFilter.h"
 #include "FaerieContainerIterator.h"
+#include "FaerieDataSystemTrace.h"
 #include "FaerieItemProxy.h"
 #include "Misc/TVariant.h"
 
 class UFaerieItemContainerBase;
 
+namespace Faerie::Storage
+{
+	class FTokenIndex;
+}
+
 namespace Faerie::Container
 {
 	template <typename T>
@@ -110,6 +116,10 @@ namespace Faerie::Container
 	{
 		virtual ~IItemDataFilter() = default;
 		virtual bool Passes(const UFaerieItem* Item) = 0;
+
+		// Filters that can be answered by a storage's token index disable failing bits in KeyBits directly, and return
+		// true. Returning false falls back to calling Passes for each item.
+		virtual bool PassesIndexed(const Storage::FTokenIndex& Index, TBitArray<>& KeyBits) { return false; }
 	};
 
 	struct FAERIEINVENTORY_API ISnapshotFilter
@@ -328,6 +338,7 @@ namespace Faerie::Container
 		template <CFilterType T>
 		void Run(T&& Filter)
 		{
+			TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(FaerieMemoryFilter_Run, FaerieDataSystemChannel);
 			for (auto It(FilterMemory.CreateIterator()); It; ++It)
 			{
 				if constexpr (TIsDerivedFrom<T, IEntryKeyFilter>::Value)
@@ -633,6 +644,7 @@ namespace Faerie::Container
 		template <ESortDirection Direction>
 		void SortBy(const FVariantComparator& Sort)
 		{
+			TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(FaerieMemoryFilter_SortBy, FaerieDataSystemChannel);
 			switch (Sort.GetIndex())
 			{
 			case 1:
@@ -3,8 +3,11 @@
 #pragma once
 
 #include "FaerieContainerFilter.h"
+#include "GameplayTagContainer.h"
+#include "Templates/SubclassOf.h"
 
 class UFaerieItemDataFilter;
+class UFaerieItemToken;
 
 namespace Faerie::Container
 {
@@ -54,6 +57,54 @@ namespace Faerie::Container
 	};
 
 
+	// Passes items with a token of this class, or a child of it.
+	struct FAERIEINVENTORY_API FTokenClassFilter final : IItemDataFilter
+	{
+		FTokenClassFilter() = default;
+		explicit FTokenClassFilter(const TSubclassOf<UFaerieItemToken> TokenClass) : TokenClass(TokenClass) {}
+		virtual bool Passes(const UFaerieItem* Item) override;
+		virtual bool PassesIndexed(const Storage::FTokenIndex& Index, TBitArray<>& KeyBits) override;
+		TSubclassOf<UFaerieItemToken> TokenClass;
+	};
+
+
+	// Passes items whose tag token has this tag. Child tags also match, unless Exact is set.
+	struct FAERIEINVENTORY_API FItemTagFilter final : IItemDataFilter
+	{
+		FItemTagFilter() = default;
+		explicit FItemTagFilter(const FGameplayTag& Tag, const bool Exact = false) : Tag(Tag), Exact(Exact) {}
+		virtual bool Passes(const UFaerieItem* Item) override;
+		virtual bool PassesIndexed(const Storage::FTokenIndex& Index, TBitArray<>& KeyBits) override;
+		FGameplayTag Tag;
+		bool Exact = false;
+	};
+
+
+	// Passes items whose tag token has any of these tags, or all of them if All is set.
+	struct FAERIEINVENTORY_API FItemTagsFilter final : IItemDataFilter
+	{
+		FItemTagsFilter() = default;
+		explicit FItemTagsFilter(const FGameplayTagContainer& Tags, const bool All = false, const bool Exact = false)
+		  : Tags(Tags), All(All), Exact(Exact) {}
+		virtual bool Passes(const UFaerieItem* Item) override;
+		virtual bool PassesIndexed(const Storage::FTokenIndex& Index, TBitArray<>& KeyBits) override;
+		FGameplayTagContainer Tags;
+		bool All = false;
+		bool Exact = false;
+	};
+
+
+	// Passes items whose tag token matches this query.
+	struct FAERIEINVENTORY_API FItemTagQueryFilter final : IItemDataFilter
+	{
+		FItemTagQueryFilter() = default;
+		explicit FItemTagQueryFilter(const FGameplayTagQuery& Query) : Query(Query) {}
+		virtual bool Passes(const UFaerieItem* Item) override;
+		virtual bool PassesIndexed(const Storage::FTokenIndex& Index, TBitArray<>& KeyBits) override;
+		FGameplayTagQuery Query;
+	};
+
+
 	struct FAERIEINVENTORY_API FSnapshotFilterObj : ISnapshotFilter
 	{
 		virtual bool Passes(const FFaerieItemSnapshot& Snapshot) override;
@@ -0,0 +1,46 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "UObject/WeakObjectPtr.h"
+
+class UFaerieItemContainerBase;
+
+namespace Faerie::Container
+{
+	/**
+	 * Makes every edit to item containers made within its scope all-or-nothing. Containers join the transaction when
+	 * they are first edited, by capturing their content and the state of their extensions. If the transaction goes out of
+	 * scope without being committed, every container that joined is restored. Containers hold back their events, and the
+	 * hooks of extensions that can't be restored, until the transaction commits, so nothing sees edits that are rolled back.
+	 * Transactions only exist on the server. A transaction opened while another is running folds into the outer one.
+	 * Token edits made to mutable items are not captured.
+	 */
+	class FAERIEINVENTORY_API FTransaction : FNoncopyable
+	{
+	public:
+		FTransaction();
+		~FTransaction();
+
+		// Keep all edits, and send the events that were held back.
+		void Commit();
+
+		// Is any transaction currently running?
+		static bool IsActive() { return Active != nullptr; }
+
+		// Containers must call this before making any edit. Joins the running transaction, if there is one.
+		static void PreEdit(UFaerieItemContainerBase* Container);
+
+	private:
+		void End(bool Committed);
+
+		static FTransaction* Active;
+
+		// Containers that have captured their state for this transaction, in the order they joined.
+		TArray<TWeakObjectPtr<UFaerieItemContainerBase>> Containers;
+
+		// Is this the outermost transaction? Nested transactions leave everything to it.
+		bool IsOuter = false;
+		bool Ended = false;
+	};
+}
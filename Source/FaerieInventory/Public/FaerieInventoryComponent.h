@@ -11,8 +11,38 @@ enum class EFaerieAddressEventType : uint8;
 struct FFaerieAddress;
 class UItemContainerExtensionGroup;
 class UItemContainerExtensionBase;
+class UFaerieInventoryClient;
 class UFaerieItemStorage;
 
+/**
+ * How an inventory's owning actor replicates. Containers that are shared, like banks and world chests, can use this to stop
+ * costing the server anything while no one has them open. Policies apply to the whole actor, including the storage's
+ * extensions. When an actor has several inventories, it uses the highest rate and priority, and only sleeps if all of
+ * them allow it.
+ */
+USTRUCT(BlueprintType)
+struct FFaerieContainerReplicationPolicy
+{
+	GENERATED_BODY()
+
+	// The most times per second the owning actor will replicate. Only ever lowers the actor's own rate. 0 is uncapped.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ReplicationPolicy", meta = (ClampMin = 0, Units = "Hz"))
+	float MaxUpdateRate = 0.f;
+
+	// Replication priority of the owning actor. 0 leaves the actor's own priority unchanged.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ReplicationPolicy", meta = (ClampMin = 0))
+	float Priority = 0.f;
+
+	// Should the owning actor go dormant while no client is viewing this inventory? Clients mark inventories as viewed
+	// with UFaerieInventoryClient::SetContainerViewed. Don't enable this for inventories a client needs to see unprompted,
+	// such as a player's own.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ReplicationPolicy")
+	bool DormantWhenUnviewed = false;
+
+	// Does this policy change anything about the owning actor?
+	bool IsDefault() const { return MaxUpdateRate <= 0.f && Priority <= 0.f && !DormantWhenUnviewed; }
+};
+
 /**
  *	This is the core of the inventory system. The actual component added to actors to allow them to contain item data.
  *	It supports extension objects which customize and add to its functionality, eg: adding capacity limits, or crafting features.
@@ -51,6 +81,24 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Faerie|InventoryComponent")
 	UFaerieItemStorage* GetStorage() const { return ItemStorage; }
 
+	UFUNCTION(BlueprintCallable, Category = "Faerie|InventoryComponent")
+	const FFaerieContainerReplicationPolicy& GetReplicationPolicy() const { return ReplicationPolicy; }
+
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Faerie|InventoryComponent")
+	void SetReplicationPolicy(const FFaerieContainerReplicationPolicy& Policy);
+
+	// Is any client currently viewing this inventory? Only tracked on the server.
+	UFUNCTION(BlueprintCallable, Category = "Faerie|InventoryComponent")
+	bool IsViewed() const { return !Viewers.IsEmpty(); }
+
+	// Called by clients when they open or close this inventory.
+	void AddViewer(const UFaerieInventoryClient* Client);
+	void RemoveViewer(const UFaerieInventoryClient* Client);
+
+private:
+	// Applies the policies of all inventories on our owner to it.
+	void ApplyReplicationPolicy();
+
 
 	/**-------------*/
 	/*	 VARIABLES	*/
@@ -62,4 +110,24 @@ protected:
 	// Subobjects responsible for adding or customizing Inventory behavior.
 	UPROPERTY(EditAnywhere, Instanced, NoClear, Category = "ItemStorage")
 	TObjectPtr<UItemContainerExtensionGroup> Extensions;
+
+	UPROPERTY(EditAnywhere, Category = "ItemStorage")
+	FFaerieContainerReplicationPolicy ReplicationPolicy;
+
+private:
+	// Clients that currently have this inventory open.
+	TArray<TWeakObjectPtr<const UFaerieInventoryClient>> Viewers;
+
+	// The owner's own net settings, from before any policy was applied to it.
+	struct FOwnerNetSettings
+	{
+		float NetUpdateFrequency = 0.f;
+		float NetPriority = 0.f;
+
+		// Set only while a policy is what put the owner to sleep.
+		TOptional<ENetDormancy> DormancyBeforeSleep;
+	};
+
+	// Only one inventory on an actor holds these: whichever first applied a policy to it.
+	TOptional<FOwnerNetSettings> SavedOwnerSettings;
 };
\ No newline at end of file
@@ -32,4 +32,14 @@ public:
 	// Usage of the MakeSaveData/LoadSaveData functions' default implementations require this.
 	UPROPERTY(EditAnywhere, Config, Category = "Faerie|Inventory")
 	EFaerieContainerOwnershipBehavior ContainerMutableBehavior = EFaerieContainerOwnershipBehavior::None;
+
+	// Should storages save with the compact binary format, instead of the full entry array. Either format can always be
+	// loaded, but saves made with this enabled can't be read by builds from before the format was added.
+	UPROPERTY(EditAnywhere, Config, Category = "Faerie|Inventory")
+	bool UseCompactStorageSaveData = false;
+
+	// Storages loading more entries than this from compact save data will only index them, and create each item the first
+	// time it is accessed. Items that are never touched are never created. 0 disables lazy loading.
+	UPROPERTY(EditAnywhere, Config, Category = "Faerie|Inventory", meta = (ClampMin = 0))
+	int32 LazyLoadEntryThreshold = 0;
 };
\ No newline at end of file
@@ -15,6 +15,12 @@ namespace Faerie::Container
 {
 	class IIterator;
 	class IFilter;
+	class FTransaction;
+}
+
+namespace Faerie::Memory
+{
+	class FReport;
 }
 
 class UFaerieItemContainerBase;
@@ -144,6 +150,88 @@ protected:
 	int32 GetStack_Address(const FFaerieAddress Address) const { return GetStack(Address); }
 
 
+	/**------------------------------*/
+	/*		  CONTAINER GRAPH		 */
+	/**------------------------------*/
+public:
+	// The container holding the item this one is nested in. Null for containers that aren't in an item, or whose item
+	// isn't in a container.
+	UFaerieItemContainerBase* GetParentContainer() const { return ParentContainer.Get(); }
+
+	// The item this container is nested in, if any.
+	const UFaerieItem* GetOwningItem() const;
+
+	// Containers nested in items held by this one.
+	TConstArrayView<TWeakObjectPtr<UFaerieItemContainerBase>> GetChildContainers() const { return ChildContainers; }
+
+	// Is this container nested inside Item, at any depth? Walks up through parent containers, so this is O(depth), unless
+	// the walk stops at a container in an item that isn't linked to a parent, in which case Item's containers are searched.
+	bool IsNestedIn(const UFaerieItem* Item) const;
+
+	// Make this the parent of each container in an item, or stop being their parent. Called when ownership of an item is
+	// taken or released, so only needs calling directly when items are bound to a container some other way. Clients don't
+	// take ownership of replicated items, so containers call this from their replication callbacks instead.
+	void LinkItemContainers(const UFaerieItem* Item);
+	void UnlinkItemContainers(const UFaerieItem* Item);
+
+protected:
+	// Clients don't take ownership of replicated items, so replication callbacks bind to their token changes with these,
+	// to link containers in tokens that replicate after the item does.
+	void BindReplicatedItem(const UFaerieItem* Item);
+	void UnbindReplicatedItem(const UFaerieItem* Item);
+
+private:
+	void OnReplicatedItemMutated(const UFaerieItem* Item, const UFaerieItemToken* Token, FGameplayTag EditTag);
+
+	// Link or unlink the container of a container token added to, or removed from, one of our items.
+	void RelinkTokenContainer(const UFaerieItemToken* Token, FGameplayTag EditTag);
+
+	void LinkChildContainer(UFaerieItemContainerBase* Child);
+	void UnlinkChildContainer(UFaerieItemContainerBase* Child);
+
+
+	/**------------------------------*/
+	/*			 MEMORY API			 */
+	/**------------------------------*/
+public:
+	// Break down the memory this container is responsible for, including what its extensions hold for it. Items that are
+	// shared with other containers or assets are not counted. Subclasses must call Super.
+	virtual void GetMemoryUsage(Faerie::Memory::FReport& Report) const;
+
+
+	/**------------------------------*/
+	/*		 TRANSACTION API		 */
+	/**------------------------------*/
+
+	friend Faerie::Container::FTransaction;
+	friend class UItemContainerExtensionGroup;
+
+public:
+	// Has this container joined the running Faerie::Container::FTransaction?
+	bool IsInTransaction() const { return InTransaction; }
+
+private:
+	enum class EHeldHook : uint8
+	{
+		PostAddition,
+		PostRemoval,
+		PostEntryChanged
+	};
+
+	// Keep an extension hook to run once the transaction commits. See UItemContainerExtensionBase::RunsHooksInTransaction.
+	void HoldExtensionHook(UItemContainerExtensionBase* Extension, EHeldHook Hook, const Faerie::Inventory::FEventLog& Event);
+
+protected:
+	// Capture everything needed to undo edits made while the transaction runs. Subclasses must call Super.
+	virtual void BeginTransaction();
+
+	// Return to the state captured by BeginTransaction. Subclasses must call Super, after restoring their own content.
+	virtual void RollbackTransaction();
+
+	// Called on every container in the transaction once it has been committed or rolled back. Subclasses must call Super.
+	virtual void EndTransaction(bool Committed);
+
+
 	/**------------------------------*/
 	/*			 VARIABLES			 */
 	/**------------------------------*/
@@ -158,4 +246,24 @@ protected:
 	TObjectPtr<UFaerieItemContainerExtensionData> UnclaimedExtensionData;
 
 	Faerie::TKeyGen<FEntryKey> KeyGen;
+
+private:
+	// Extension state captured when joining a transaction.
+	TArray<TPair<TWeakObjectPtr<UItemContainerExtensionBase>, FInstancedStruct>> TransactionExtensionState;
+
+	struct FHeldExtensionHook
+	{
+		TWeakObjectPtr<UItemContainerExtensionBase> Extension;
+		EHeldHook Hook;
+		Faerie::Inventory::FEventLog Event;
+	};
+
+	// Extension hooks held until the transaction commits, in the order they were called.
+	TArray<FHeldExtensionHook> HeldExtensionHooks;
+
+	// Links in the graph of nested containers. See LinkItemContainers.
+	TWeakObjectPtr<UFaerieItemContainerBase> ParentContainer;
+	TArray<TWeakObjectPtr<UFaerieItemContainerBase>> ChildContainers;
+
+	bool InTransaction = false;
 };
\ No newline at end of file
@@ -39,6 +39,11 @@ public:
 	virtual void LoadSaveData(FConstStructView ItemData, UFaerieItemContainerExtensionData* ExtensionData) override;
 	virtual bool Contains(FEntryKey Key) const override;
 
+protected:
+	virtual void BeginTransaction() override;
+	virtual void RollbackTransaction() override;
+	virtual void EndTransaction(bool Committed) override;
+
 private:
 	virtual FFaerieItemStackView View(FEntryKey Key) const override;
 	virtual FFaerieItemStack Release(FEntryKey Key, int32 Copies) override;
@@ -119,7 +124,7 @@ public:
 
 protected:
 	UFUNCTION(/* Replication */)
-	void OnRep_ItemStack();
+	void OnRep_ItemStack(const FFaerieItemStack& OldItemStack);
 
 	// Broadcast when the item filling this container is removed, a new item is set, or the item had its data mutated.
 	UPROPERTY(BlueprintAssignable, Category = "Events")
@@ -134,4 +139,10 @@ protected:
 	// Incremented each time a new item is stored in this stack. Not changed when stack Copies is edited.
 	UPROPERTY(Replicated)
 	FEntryKey StoredKey;
+
+private:
+	// The stack as it was when we joined the running transaction, and whether to take its item back after a rollback.
+	FFaerieItemStack TransactionStack;
+	FEntryKey TransactionKey;
+	bool ReclaimTransactionItem = false;
 };
@@ -3,15 +3,18 @@
 #pragma once
 
 #include "FaerieItemContainerBase.h"
+#include "Actions/FaerieClientPrediction.h"
 #include "ItemContainerEvent.h"
 #include "FaerieItemStack.h"
 #include "FaerieItemStorageFilter.h"
+#include "FaerieItemStorageTokenIndex.h"
 #include "InventoryDataEnums.h"
 #include "InventoryDataStructs.h"
 
 #include "FaerieItemStorage.generated.h"
 
 struct FFaerieExtensionAllowsAdditionArgs;
+class UFaerieInventoryClient;
 class UInventoryStackProxy;
 
 namespace Faerie
@@ -22,6 +25,24 @@ namespace Faerie
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FEntryKeyEvent, UFaerieItemStorage*, Storage, FEntryKey, Key);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FFaerieAddressEvent, UFaerieItemStorage*, Storage, EFaerieAddressEventType, Type, FFaerieAddress, Key);
 
+/**
+ * Compact save data for a UFaerieItemStorage. Items and entries are packed into a versioned binary blob with
+ * Faerie::ItemData::FCompactItemWriter.
+ */
+USTRUCT()
+struct FFaerieItemStorageSaveData
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<uint8> Data;
+
+	// Items that couldn't be packed (ones with instanced sub-objects, like nested containers). These are saved with
+	// regular tagged property serialization, and referenced by index from Data.
+	UPROPERTY()
+	TArray<TObjectPtr<UFaerieItem>> FallbackItems;
+};
+
 /**
  *
  */
@@ -36,6 +57,9 @@ class FAERIEINVENTORY_API UFaerieItemStorage : public UFaerieItemContainerBase
 	// Allow iterators and filters to read our data.
 	friend Faerie::Storage::FStorageDataAccess;
 
+	// Allow lazily loaded items to remove their entry if they fail to load.
+	friend Faerie::Storage::FLazyItemSource;
+
 public:
 	//~ UObject
 	virtual void PostInitProperties() override;
@@ -70,6 +94,14 @@ private:
 
 	virtual FEntryKey FILTER_GetBaseKey(FFaerieAddress Address) const override;
 	virtual TArray<FFaerieAddress> FILTER_GetKeyAddresses(FEntryKey Key) const override;
+
+public:
+	virtual void GetMemoryUsage(Faerie::Memory::FReport& Report) const override;
+
+protected:
+	virtual void BeginTransaction() override;
+	virtual void RollbackTransaction() override;
+	virtual void EndTransaction(bool Committed) override;
 	//~ UFaerieItemContainerBase
 
 public:
@@ -91,6 +123,9 @@ private:
 
 	const FInventoryEntry* GetEntrySafe(FEntryKey Key) const;
 
+	// Get the token index, synced with our entries, or nullptr if it's disabled.
+	const Faerie::Storage::FTokenIndex* GetTokenIndex() const;
+
 	UInventoryStackProxy* GetStackProxyImpl(FFaerieAddress Address) const;
 
 	// Internal implementation for adding items.
@@ -104,9 +139,24 @@ private:
 	void PreContentRemoved(const FInventoryEntry& Entry);
 	void PostContentChanged(const FInventoryEntry& Entry, FInventoryContent::EChangeType ChangeType, const TBitArray<>* ChangeMask);
 
+	// Remove the entries whose lazily loaded item failed to load, and was replaced with Placeholder.
+	void RemoveInvalidLazyEntries(const UFaerieItem* Placeholder);
+
+	// Replication hooks for client prediction.
+	void RecordReplicatedEntry(const FInventoryEntry& Entry, bool Removed);
+	void PostContentReplicated();
+	void PreEntryEdit(const FInventoryEntry& Entry);
+
+	bool PredictEdit(UFaerieInventoryClient* Client, Faerie::ClientAction::FPredictionKey Key, TFunctionRef<bool()> Edit);
+	void OnPredictionResolved(Faerie::ClientAction::FPredictionKey Key, bool Accepted);
+	void ReconcilePrediction();
+
 	void BroadcastAddressEvent(EFaerieAddressEventType Type, FFaerieAddress Address);
 	void BroadcastAddressEventBulk(EFaerieAddressEventType Type, TConstArrayView<FFaerieAddress> Address);
 
+	FFaerieItemStorageSaveData MakeCompactSaveData() const;
+	bool LoadCompactSaveData(const FFaerieItemStorageSaveData& SaveData);
+
 
 	/**------------------------------*/
 	/*	  STORAGE API - ALL USERS    */
@@ -168,6 +218,10 @@ public:
 	// Query function to filter for the first matching address.
 	FFaerieAddress QueryFirst(const Faerie::Container::FAddressPredicate& Filter) const;
 
+	// Are there entries lazily loaded from save data, whose item hasn't been created yet?
+	UFUNCTION(BlueprintCallable, Category = "Storage")
+	bool HasUnmaterializedEntries() const;
+
 	UFUNCTION(BlueprintCallable, Category = "Storage|Permissions")
 	bool CanAddStack(FFaerieItemStackView Stack, EFaerieStorageAddStackBehavior AddStackBehavior) const;
 
@@ -269,6 +323,47 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Storage")
 	void Dump(UFaerieItemStorage* ToStorage);
 
+	/**
+	 * Create the items for all entries that were lazily loaded from save data. Entries otherwise only create their item
+	 * when it is first accessed. Use this before handing the storage to code that reads items outside the storage API.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Storage")
+	void MaterializeAllEntries();
+
+	/**
+	 * While deferred, entries that are still lazily loaded are held back from replication, instead of being created so
+	 * that they can be sent. Set by UFaerieInventoryComponent for inventories that sleep while no one is viewing them.
+	 */
+	void SetLazyReplicationDeferred(const bool Deferred) { DeferLazyReplication = Deferred; }
+	bool IsLazyReplicationDeferred() const { return DeferLazyReplication; }
+
+	/**
+	 * Maintain an index of the token classes and gameplay tags of every entry, so that token and tag filters can be
+	 * answered without testing each item. This costs memory, and a little time on every edit, so it is only worth
+	 * enabling for large storages that are filtered often.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Storage|Query")
+	void SetTokenIndexEnabled(bool Enabled);
+
+	UFUNCTION(BlueprintCallable, Category = "Storage|Query")
+	bool IsTokenIndexEnabled() const { return IndexTokens; }
+
+
+	/**----------------------------------*/
+	/*	 STORAGE API - CLIENT PREDICTION  */
+	/**----------------------------------*/
+
+	// Are there edits predicted by a local client, that the server hasn't confirmed yet?
+	UFUNCTION(BlueprintCallable, Category = "Storage|Prediction")
+	bool HasPendingPredictions() const;
+
+	// Locally applies the expected result of a SplitStack request made by Client. The new stack's key is only a guess,
+	// and is replaced by the server's once it replicates.
+	bool PredictSplitStack(UFaerieInventoryClient* Client, Faerie::ClientAction::FPredictionKey Key, FFaerieAddress Address, int32 Amount);
+
+	// Locally applies the expected result of a MergeStacks request made by Client.
+	bool PredictMergeStacks(UFaerieInventoryClient* Client, Faerie::ClientAction::FPredictionKey Key, FEntryKey Entry, FStackKey FromStack, FStackKey ToStack, int32 Amount);
+
 
 	/**-------------*/
 	/*	 DELEGATES	*/
@@ -307,4 +402,22 @@ private:
 	// should be stored in a strong pointer by whatever requested them, and once nothing needs the proxies, they will die.
 	UPROPERTY(Transient)
 	TMap<FFaerieAddress, TWeakObjectPtr<UInventoryStackProxy>> LocalStackProxies;
+
+	// Entries as they were when we joined the running transaction, and items to take back after a rollback.
+	TArray<FInventoryEntry> TransactionEntries;
+	TArray<const UFaerieItem*> TransactionReclaimedItems;
+
+	// Edits predicted by a local client, that the server hasn't confirmed yet. Only used on clients.
+	Faerie::ClientAction::TPredictedItems<FInventoryEntry> Prediction;
+	Faerie::ClientAction::FPredictionListener PredictionListener;
+
+	// Should TokenIndex be maintained? See SetTokenIndexEnabled.
+	UPROPERTY(EditAnywhere, Category = "Query")
+	bool IndexTokens = false;
+
+	// Columns of token classes and tags per entry, for filters to read. Brought up to date when read.
+	mutable Faerie::Storage::FTokenIndex TokenIndex;
+
+	// See SetLazyReplicationDeferred.
+	bool DeferLazyReplication = false;
 };
\ No newline at end of file
@@ -13,10 +13,13 @@ class UFaerieItemStorage;
 
 namespace Faerie::Storage
 {
+	class FTokenIndex;
+
 	class FStorageDataAccess
 	{
 	protected:
 		static const FInventoryContent& ReadInventoryContent(const UFaerieItemStorage& Storage);
+		static const FTokenIndex* ReadTokenIndex(const UFaerieItemStorage& Storage);
 		static FFaerieItemSnapshot MakeSnapshot(const UFaerieItemStorage& Storage, const int32 Index);
 	};
 
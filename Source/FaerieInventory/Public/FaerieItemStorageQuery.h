@@ -4,10 +4,12 @@
 
 #include "FaerieContainerFilter.h"
 #include "FaerieFunctionTemplates.h"
+#include "FaerieItemContainerStructs.h"
 #include "UObject/Object.h"
 #include "FaerieItemStorageQuery.generated.h"
 
 class UFaerieItemDataComparator;
+class UFaerieItemContainerBase;
 class UFaerieItemDataFilter;
 class UFaerieItemStorage;
 class UFaerieItemStorageQuery;
@@ -61,9 +63,15 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Faerie|Storage Query", DisplayName = "Set Filter by Snapshot Delegate")
 	void SetFilterByDelegate_Snapshot(const UFaerieFunctionTemplates::FFaerieSnapshotPredicate& Delegate);
 
+	// Filter by a filter object. The object is compiled when it's set, so later edits to it (or to filters it contains)
+	// aren't seen until RecompileFilterObject is called. Setting the current filter object again clears the filter.
 	UFUNCTION(BlueprintCallable, Category = "Faerie|Storage Query")
 	void SetFilterByObject(const UFaerieItemDataFilter* Object);
 
+	// Compile the current filter object again, after it has been edited.
+	UFUNCTION(BlueprintCallable, Category = "Faerie|Storage Query")
+	void RecompileFilterObject();
+
 	void SetSort(Faerie::Container::FItemComparator&& Comparator, UObject* AssociatedUObject);
 	void SetSort(Faerie::Container::FStackComparator&& Comparator, UObject* AssociatedUObject);
 	void SetSort(Faerie::Container::FSnapshotComparator&& Comparator, UObject* AssociatedUObject);
@@ -93,6 +101,18 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Faerie|Storage Query")
 	void QueryAllAddresses(const UFaerieItemStorage* Storage, TArray<FFaerieAddress>& OutAddresses) const;
 
+	// Query function to filter and sort the contents of several containers together. Entries from every container are
+	// returned as one sorted list. If IncludeChildren is set, containers nested inside items in these are searched too.
+	UFUNCTION(BlueprintCallable, Category = "Faerie|Storage Query")
+	void QueryAllContainers(const TArray<UFaerieItemContainerBase*>& Containers, bool IncludeChildren,
+							TArray<FFaerieAddressableHandle>& OutHandles) const;
+
+	// Should an entry with this snapshot be in the results of this query? Accounts for InvertFilter.
+	bool IsSnapshotIncluded(const FFaerieItemSnapshot& Snapshot) const;
+
+	// Should SnapshotA be sorted before SnapshotB? Accounts for InvertSort.
+	bool SortsBefore(const FFaerieItemSnapshot& SnapshotA, const FFaerieItemSnapshot& SnapshotB) const;
+
 	UFUNCTION(BlueprintCallable, Category = "Faerie|Storage Query")
 	bool CompareAddresses(const UFaerieItemStorage* Storage, const FFaerieAddress AddressA, const FFaerieAddress AddressB) const;
 
@@ -100,6 +120,11 @@ public:
 	bool IsAddressFiltered(const UFaerieItemStorage* Storage, const FFaerieAddress Address) const;
 
 private:
+	void BindFilterObject(const UFaerieItemDataFilter* Object);
+
+	bool PassesFilter(const FFaerieItemSnapshot& Snapshot) const;
+	bool CompareSnapshots(const FFaerieItemSnapshot& SnapshotA, const FFaerieItemSnapshot& SnapshotB) const;
+
 	// Filter object to keep alive.
 	UPROPERTY()
 	TObjectPtr<const UObject> FilterObject;
@@ -0,0 +1,91 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "FaerieItemContainerStructs.h"
+#include "GameplayTagContainer.h"
+#include "UObject/ObjectKey.h"
+
+struct FInventoryContent;
+struct FInventoryEntry;
+class UFaerieItemToken;
+
+namespace Faerie::Storage
+{
+	/**
+	 * A columnar index over the tokens of the items in a UFaerieItemStorage. Each token class, and each gameplay tag
+	 * found on a UFaerieTagToken, owns a column with a bit per entry, in the same order as the storage's entries. This is
+	 * the same layout as FEntryFilter::KeyBits, so token and tag filters can be answered by intersecting bit arrays,
+	 * instead of visiting each item.
+	 * Entries whose items haven't been created yet from lazily loaded save data are left unindexed until a query needs
+	 * them.
+	 * Mutations never shift columns. New entries are appended as rows, and columns only grow when a bit is set in them.
+	 * Removed entries leave a tombstone row behind, and all tombstones are compacted at once by the next Sync.
+	 */
+	class FAERIEINVENTORY_API FTokenIndex
+	{
+	public:
+		// Keep the index in step with the storage. These are safe to call more than once for the same change.
+		void OnEntryAdded(const FInventoryEntry& Entry);
+		void OnEntryChanged(const FInventoryEntry& Entry);
+		void OnEntryRemoved(FEntryKey Key);
+
+		// Discard all columns. They are rebuilt the next time the index is synced.
+		void Invalidate();
+
+		// Bring the index in line with Content. Rebuilds everything if the index was invalidated or has fallen out of
+		// step, otherwise compacts removed rows, and indexes entries that were added before their item existed.
+		void Sync(const FInventoryContent& Content);
+
+		void Reset();
+
+		int32 Num() const { return Keys.Num() - NumRemoved; }
+
+		// Does the index keep a column for this class? The base token class has none, as nearly every item would be in it.
+		static bool IsIndexedTokenClass(const UClass* TokenClass);
+
+		// Find the column of entries with a token of this class, or a child of it. Returns nullptr if no entry has one.
+		// Only meaningful for classes that pass IsIndexedTokenClass.
+		const TBitArray<>* FindTokenClass(const UClass* TokenClass) const;
+
+		// Find the column of entries tagged with this tag. Child tags are included, unless Exact is set.
+		const TBitArray<>* FindTag(const FGameplayTag& Tag, bool Exact) const;
+
+		// Tags on the first UFaerieTagToken of the entry at Index.
+		const FGameplayTagContainer& GetTags(const int32 Index) const { return Rows[Index].Tags; }
+
+		SIZE_T GetAllocatedSize() const;
+
+	private:
+		void Rebuild(const FInventoryContent& Content);
+		void Compact();
+		void AppendRow(FEntryKey Key);
+		void IndexRow(int32 Index, const UFaerieItem* Item);
+		void ClearRow(int32 Index);
+
+		struct FRow
+		{
+			// Every class that this row has set a bit for, so it can be cleared without scanning all columns.
+			TArray<TObjectKey<UClass>, TInlineAllocator<4>> Classes;
+			FGameplayTagContainer Tags;
+			FGameplayTagContainer TagsWithParents;
+		};
+
+		// Keys in the order of the storage's entries, which is the order of every column.
+		TArray<FEntryKey> Keys;
+		TArray<FRow> Rows;
+
+		// Entries added before their item was created.
+		TBitArray<> Unindexed;
+
+		// Rows of entries that have been removed since the last Sync. Their bits are already cleared.
+		TBitArray<> Removed;
+		int32 NumRemoved = 0;
+
+		TMap<TObjectKey<UClass>, TBitArray<>> ClassColumns;
+		TMap<FGameplayTag, TBitArray<>> ExactTagColumns;
+		TMap<FGameplayTag, TBitArray<>> TagColumns;
+
+		bool NeedsRebuild = true;
+	};
+}
@@ -0,0 +1,133 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "FaerieItemContainerStructs.h"
+#include "FaerieItemProxy.h"
+#include "Math/RandomStream.h"
+#include "FaerieSortedAddressView.generated.h"
+
+class UFaerieItemContainerBase;
+class UFaerieItemStorageQuery;
+
+UENUM(BlueprintType)
+enum class EFaerieSortedViewChangeType : uint8
+{
+	Inserted,
+	Removed,
+	Moved
+};
+
+/**
+ * A change made to the rows of a sorted view. Changes are listed in the order they were made, and the indices of each
+ * are relative to the view as it was after the changes before it.
+ */
+USTRUCT(BlueprintType)
+struct FAERIEINVENTORY_API FFaerieSortedViewChange
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "SortedViewChange")
+	EFaerieSortedViewChangeType Type = EFaerieSortedViewChangeType::Inserted;
+
+	// The first row inserted or removed, or the row that was moved.
+	UPROPERTY(BlueprintReadOnly, Category = "SortedViewChange")
+	int32 Index = 0;
+
+	// Number of rows inserted or removed. Moves are always one row.
+	UPROPERTY(BlueprintReadOnly, Category = "SortedViewChange")
+	int32 Count = 1;
+
+	// Where a moved row is now.
+	UPROPERTY(BlueprintReadOnly, Category = "SortedViewChange")
+	int32 NewIndex = INDEX_NONE;
+};
+
+namespace Faerie::Storage
+{
+	/**
+	 * The addresses in a container that pass a UFaerieItemStorageQuery, kept in the query's sort order as the container
+	 * changes. Rows are held in a treap where each node knows the size of its subtree, so finding, inserting, removing
+	 * and moving a row are all O(log n). The snapshot of each address is kept with its row, so comparisons don't look
+	 * entries up in the container again. Snapshots hold object pointers, so whatever owns the view must report them to
+	 * the garbage collector with AddReferencedObjects.
+	 * Changes made since the last call to ClearChanges are recorded, so list views can update only the rows affected.
+	 */
+	class FAERIEINVENTORY_API FSortedAddressView
+	{
+	public:
+		// Fill the view with every address in Container that passes Query, fully sorted. Pending changes are discarded,
+		// as the whole view should be displayed again.
+		void Rebuild(const UFaerieItemContainerBase* Container, const UFaerieItemStorageQuery* Query);
+
+		// Add an address, or move it to where it now sorts, or remove it if it no longer passes the query.
+		void Update(const UFaerieItemContainerBase* Container, const UFaerieItemStorageQuery* Query, FFaerieAddress Address);
+
+		void Remove(FFaerieAddress Address);
+
+		void Reset();
+
+		int32 Num() const { return Lookup.Num(); }
+		bool Contains(const FFaerieAddress Address) const { return Lookup.Contains(Address); }
+
+		// Index of the row for an address, or INDEX_NONE if it isn't in the view.
+		int32 IndexOf(FFaerieAddress Address) const;
+
+		FFaerieAddress GetAt(int32 Index) const;
+
+		// Every address in the view, in order.
+		void GetAddresses(TArray<FFaerieAddress>& OutAddresses) const;
+
+		// Up to Count addresses, in order, starting at row Start. Costs O(log n + Count), so views of very large
+		// containers can be paged through without copying the whole view.
+		void GetRange(int32 Start, int32 Count, TArray<FFaerieAddress>& OutAddresses) const;
+
+		TConstArrayView<FFaerieSortedViewChange> GetChanges() const { return Changes; }
+		bool HasChanges() const { return !Changes.IsEmpty(); }
+		void ClearChanges() { Changes.Reset(); }
+
+		SIZE_T GetAllocatedSize() const;
+
+		// Report the item and owner of each row's snapshot.
+		void AddReferencedObjects(FReferenceCollector& Collector);
+
+	private:
+		struct FNode
+		{
+			FFaerieAddress Address;
+			FFaerieItemSnapshot Snapshot;
+			uint32 Priority = 0;
+			int32 Size = 1;
+			int32 Parent = INDEX_NONE;
+			int32 Left = INDEX_NONE;
+			int32 Right = INDEX_NONE;
+		};
+
+		static bool MakeSnapshot(const UFaerieItemContainerBase* Container, const UFaerieItemStorageQuery* Query,
+								 FFaerieAddress Address, FFaerieItemSnapshot& OutSnapshot);
+
+		int32 AllocateNode(FFaerieAddress Address, const FFaerieItemSnapshot& Snapshot);
+		void FreeNode(int32 Node);
+
+		int32 SizeOf(const int32 Node) const { return Node == INDEX_NONE ? 0 : Nodes[Node].Size; }
+		void Pull(int32 Node);
+		int32 Merge(int32 A, int32 B);
+		void Split(int32 Node, int32 Count, int32& OutLeft, int32& OutRight);
+
+		int32 RankOf(int32 Node) const;
+		int32 FindInsertIndex(const UFaerieItemStorageQuery* Query, const FFaerieItemSnapshot& Snapshot) const;
+		void Insert(int32 Node, int32 Index);
+		void Detach(int32 Index);
+
+		void AddChange(EFaerieSortedViewChangeType Type, int32 Index, int32 NewIndex = INDEX_NONE);
+
+		TArray<FNode> Nodes;
+		TArray<int32> FreeNodes;
+		TMap<FFaerieAddress, int32> Lookup;
+		int32 Root = INDEX_NONE;
+
+		TArray<FFaerieSortedViewChange> Changes;
+
+		FRandomStream Priorities{0x46414552};
+	};
+}
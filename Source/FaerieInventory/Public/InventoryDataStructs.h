@@ -50,10 +50,28 @@ struct FKeyedStack
 	{
 		return !(Lhs == Rhs);
 	}
+
+	// Keys and counts are both small and non-negative in practice, so each is sent as a packed int.
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FKeyedStack> : public TStructOpsTypeTraitsBase2<FKeyedStack>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
 };
 
 struct FInventoryContent;
 class UFaerieItem;
+class UFaerieItemStorage;
+
+namespace Faerie::Storage
+{
+	class FLazyItemSource;
+}
 
 /**
  * The struct for containing one inventory entry.
@@ -63,6 +81,9 @@ struct FInventoryEntry : public FFastArraySerializerItem
 {
 	GENERATED_BODY()
 
+	// Allow the storage to rebuild entries directly when loading save data.
+	friend UFaerieItemStorage;
+
 	FInventoryEntry() = default;
 	FInventoryEntry(const UFaerieItem* InItem);
 	FInventoryEntry(FFaerieItemStackView InStack, TArray<FStackKey>& OutAddedKeys);
@@ -85,18 +106,36 @@ private:
 	// Internal count of how many stacks we've made. Used to track key creation. Only valid on the server.
 	Faerie::TKeyGen<FStackKey> KeyGen;
 
+	// Set while ItemObject hasn't been created from lazily loaded save data yet. Only valid on the server.
+	TSharedPtr<Faerie::Storage::FLazyItemSource> LazySource;
+	uint32 LazyItemIndex = 0;
+
 	int32 GetStackIndex(FStackKey InKey) const;
 	const FKeyedStack* GetStackPtr(FStackKey InKey) const;
 
 	void UpdateCachedStackLimit();
 
+	// Create ItemObject from the lazy source.
+	void MaterializeItem() const;
+
 public:
-	FORCEINLINE const UFaerieItem* GetItem() const { return ItemObject; }
+	FORCEINLINE const UFaerieItem* GetItem() const
+	{
+		if (LazySource.IsValid())
+		{
+			MaterializeItem();
+		}
+		return ItemObject;
+	}
+
 	FORCEINLINE TConstArrayView<FKeyedStack> GetStacks() const { return Stacks; }
 
 	FORCEINLINE int32 NumStacks() const { return Stacks.Num(); }
 
-	int32 GetCachedStackLimit() const { return Limit; }
+	// Has ItemObject been created yet? Entries are only unmaterialized when lazily loaded from save data.
+	FORCEINLINE bool IsMaterialized() const { return !LazySource.IsValid(); }
+
+	int32 GetCachedStackLimit() const;
 
 	bool Contains(FStackKey Key) const;
 
@@ -186,8 +225,6 @@ struct TStructOpsTypeTraits<FInventoryEntry> : public TStructOpsTypeTraitsBase2<
 	};
 };
 
-class UFaerieItemStorage;
-
 /**
  * FInventoryContent is a Fast Array, containing all FInventoryEntries for an inventory. Lookup is O(Log(n)), as FEntryKeys
  * are used to keep Entries in numeric order, allowing for binary-search accelerated accessors.
@@ -219,7 +256,17 @@ private:
 	// Is writing to Entries locked? Enabled while ItemHandles are active.
 	mutable uint32 WriteLock = 0;
 
+	// Source of items for lazily loaded entries. Cleared once they have all been materialized.
+	TSharedPtr<Faerie::Storage::FLazyItemSource> LazySource;
+
 public:
+	FInventoryContent()
+	{
+		// Send changed entries as property deltas against what each connection last acknowledged. An entry whose stack
+		// count changed only sends that one FKeyedStack, instead of its item reference and whole stack array.
+		SetDeltaSerializationEnabled(true);
+	}
+
 	/**
 	 * Adds a new key and entry to the end of the Items array. Performs a quick check that the new key is sequentially
 	 * following the end of the array, but does not enforce or check for the entire array being sorted. Use this function
@@ -243,6 +290,12 @@ public:
 
 	void Remove(FEntryKey Key);
 
+	// Create the items for all entries that were lazily loaded, and haven't been accessed yet.
+	void MaterializeAll();
+
+	// Are there any entries that haven't created their item yet?
+	bool HasUnmaterializedEntries() const { return LazySource.IsValid(); }
+
 	bool IsEmpty() const { return Entries.IsEmpty(); }
 
 	int32 Num() const { return Entries.Num(); }
@@ -256,10 +309,7 @@ public:
 		return FInventoryEntry::FMutableAccess(*this, Key);
 	}
 
-	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
-	{
-		return Faerie::Hacks::FastArrayDeltaSerialize<FInventoryEntry, FInventoryContent>(Entries, DeltaParms, *this);
-	}
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms);
 
 	enum EChangeType
 	{
@@ -279,6 +329,13 @@ public:
 	void PostReplicatedChange(const TArrayView<int32> ChangedIndices, int32 FinalSize) const;
 	*/
 
+	// Keeps the listener's copy of replicated state up to date, while it has predicted edits. Only called by replication.
+	void RecordReplicatedEntry(const FInventoryEntry& Entry, bool Removed) const;
+
+	// Lets the listener copy an entry before a handle edits it, in case the edit is being predicted.
+	void PreEntryEdit(const FInventoryEntry& Entry) const;
+	void PostReplicatedReceive(const FPostReplicatedReceiveParameters& Parameters) const;
+
 	void PreEntryReplicatedRemove(const FInventoryEntry& Entry) const;
 	void PostEntryReplicatedAdd(const FInventoryEntry& Entry) const;
 	void PostEntryReplicatedChange_Server(const FInventoryEntry& Entry, EChangeType ChangeType, const TBitArray<>& ChangeMask) const;
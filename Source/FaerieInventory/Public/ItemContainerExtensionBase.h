@@ -18,6 +18,11 @@ namespace Faerie::Inventory
 	class FEventLog;
 }
 
+namespace Faerie::Memory
+{
+	class FReport;
+}
+
 UENUM()
 enum class EEventExtensionResponse : uint8
 {
@@ -67,6 +72,16 @@ protected:
 	virtual FInstancedStruct MakeSaveData(const UFaerieItemContainerBase* Container) const { return {}; }
 	virtual void LoadSaveData(const UFaerieItemContainerBase* Container, const FInstancedStruct& SaveData) {}
 
+	/* Capture state for a container joining a transaction, to restore if it rolls back. Defaults to the save data. */
+	virtual FInstancedStruct MakeTransactionSnapshot(const UFaerieItemContainerBase* Container) const { return MakeSaveData(Container); }
+	/* Called after the container's content has been rolled back. Extensions that cache state derived from content, but
+	 * have no save data, should override this to rebuild it. */
+	virtual void RestoreTransactionSnapshot(const UFaerieItemContainerBase* Container, const FInstancedStruct& Snapshot);
+	/* May this extension's Post* hooks run while its container is in a transaction? Only return true if everything they
+	 * change is put back by RestoreTransactionSnapshot. Otherwise, they are held until the transaction commits, and
+	 * dropped if it rolls back. */
+	virtual bool RunsHooksInTransaction() const { return false; }
+
 	/* Called at begin play or when the extension is created during runtime */
 	virtual void InitializeExtension(const UFaerieItemContainerBase* Container) {}
 	virtual void DeinitializeExtension(const UFaerieItemContainerBase* Container) {}
@@ -95,6 +110,10 @@ protected:
 
 	virtual void PostEntryChanged(const UFaerieItemContainerBase* Container, const Faerie::Inventory::FEventLog& Event) {}
 
+	/* Add the memory this extension holds on behalf of a container to its report. Data shared by all containers the
+	 * extension is registered to should be attributed to each of them in full. */
+	virtual void GetMemoryUsage(const UFaerieItemContainerBase* Container, Faerie::Memory::FReport& Report) const {}
+
 public:
 	void SetIdentifier(const FGuid* GuidToUse = nullptr);
 
@@ -255,6 +274,7 @@ public:
 	//~ UItemContainerExtensionBase
 	virtual void InitializeExtension(const UFaerieItemContainerBase* Container) override;
 	virtual void DeinitializeExtension(const UFaerieItemContainerBase* Container) override;
+	virtual bool RunsHooksInTransaction() const override { return true; }
 	virtual EEventExtensionResponse AllowsAddition(const UFaerieItemContainerBase* Container, TConstArrayView<FFaerieItemStackView> Views, FFaerieExtensionAllowsAdditionArgs Args) const override;
 	virtual void PreAddition(const UFaerieItemContainerBase* Container, FFaerieItemStackView Stack) override;
 	virtual void PostAddition(const UFaerieItemContainerBase* Container, const Faerie::Inventory::FEventLog& Event) override;
@@ -264,6 +284,7 @@ public:
 	virtual EEventExtensionResponse AllowsEdit(const UFaerieItemContainerBase* Container, FEntryKey Key, FFaerieInventoryTag EditTag) const override;
 	// @todo PreEntryChanged
 	virtual void PostEntryChanged(const UFaerieItemContainerBase* Container, const Faerie::Inventory::FEventLog& Event) override;
+	virtual void GetMemoryUsage(const UFaerieItemContainerBase* Container, Faerie::Memory::FReport& Report) const override;
 	//~ UItemContainerExtensionBase
 
 	//~ IFaerieContainerExtensionInterface
@@ -89,6 +89,27 @@ bool FFaerieClientAction_MoveItemOnGrid::Server_Execute(const UFaerieInventoryCl
 	return false;
 }
 
+bool FFaerieClientAction_MoveItemOnGrid::Client_Predict(UFaerieInventoryClient* Client, const Faerie::ClientAction::FPredictionKey Key) const
+{
+	if (!IsValid(Storage)) return false;
+
+	if (auto&& GridExtension = GetExtension<UInventoryGridExtensionBase>(Storage, true))
+	{
+		return GridExtension->PredictMoveItem(Client, Key, Address, DragEnd);
+	}
+
+	return false;
+}
+
+bool FFaerieClientAction_MoveItemOnGrid::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	Ar << Storage;
+	Faerie::ClientAction::NetSerializeAddress(Ar, Address);
+	Faerie::ClientAction::NetSerializeIntPoint(Ar, DragEnd);
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
+
 bool FFaerieClientAction_RotateGridEntry::Server_Execute(const UFaerieInventoryClient* Client) const
 {
 	if (!IsValid(Storage)) return false;
@@ -100,4 +121,16 @@ bool FFaerieClientAction_RotateGridEntry::Server_Execute(const UFaerieInventoryC
 	}
 
 	return false;
-}
\ No newline at end of file
+}
+
+bool FFaerieClientAction_RotateGridEntry::Client_Predict(UFaerieInventoryClient* Client, const Faerie::ClientAction::FPredictionKey Key) const
+{
+	if (!IsValid(Storage)) return false;
+
+	if (auto&& GridExtension = GetExtension<UInventoryGridExtensionBase>(Storage, true))
+	{
+		return GridExtension->PredictRotateItem(Client, Key, Address);
+	}
+
+	return false;
+}
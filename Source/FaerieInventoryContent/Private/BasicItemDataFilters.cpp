@@ -2,6 +2,7 @@
 
 #include "BasicItemDataFilters.h"
 #include "FaerieItem.h"
+#include "FaerieItemDataFilterProgram.h"
 #include "Tokens/FaerieStackLimiterToken.h"
 #include "Tokens/FaerieTagToken.h"
 
@@ -9,6 +10,11 @@
 
 #define LOCTEXT_NAMESPACE "BasicItemDataFilters"
 
+void UFilterRule_Literal::Compile(Faerie::ItemData::FFilterCompiler& Compiler) const
+{
+	Compiler.EmitLiteral(true);
+}
+
 #if WITH_EDITOR
 EItemDataMutabilityStatus UFilterRule_LogicalOr::GetMutabilityStatus() const
 {
@@ -55,6 +61,11 @@ bool UFilterRule_LogicalOr::Exec(const FFaerieItemStackView View) const
 	return false;
 }
 
+void UFilterRule_LogicalOr::Compile(Faerie::ItemData::FFilterCompiler& Compiler) const
+{
+	Compiler.CompileOr(Rules);
+}
+
 #if WITH_EDITOR
 EItemDataMutabilityStatus UFilterRule_LogicalAnd::GetMutabilityStatus() const
 {
@@ -102,6 +113,11 @@ bool UFilterRule_LogicalAnd::Exec(const FFaerieItemStackView View) const
 	return true;
 }
 
+void UFilterRule_LogicalAnd::Compile(Faerie::ItemData::FFilterCompiler& Compiler) const
+{
+	Compiler.CompileAnd(Rules);
+}
+
 #if WITH_EDITOR
 EItemDataMutabilityStatus UFilterRule_Condition::GetMutabilityStatus() const
 {
@@ -121,6 +137,16 @@ bool UFilterRule_Condition::Exec(const FFaerieItemStackView View) const
 	return FalseBranch;
 }
 
+void UFilterRule_Condition::Compile(Faerie::ItemData::FFilterCompiler& Compiler) const
+{
+	if (!ConditionRule)
+	{
+		Compiler.EmitLiteral(false);
+		return;
+	}
+	Compiler.CompileSelect(ConditionRule, TrueBranch, FalseBranch);
+}
+
 #if WITH_EDITOR
 EItemDataMutabilityStatus UFilterRule_Ternary::GetMutabilityStatus() const
 {
@@ -141,6 +167,16 @@ bool UFilterRule_Ternary::Exec(const FFaerieItemStackView View) const
 	return FalseBranch->Exec(View);
 }
 
+void UFilterRule_Ternary::Compile(Faerie::ItemData::FFilterCompiler& Compiler) const
+{
+	if (!ConditionRule)
+	{
+		Compiler.EmitLiteral(false);
+		return;
+	}
+	Compiler.CompileSelect(ConditionRule, TrueBranch, FalseBranch);
+}
+
 #if WITH_EDITOR
 EItemDataMutabilityStatus UFilterRule_LogicalNot::GetMutabilityStatus() const
 {
@@ -157,6 +193,11 @@ bool UFilterRule_LogicalNot::Exec(const FFaerieItemStackView View) const
 	return !InvertedRule->Exec(View);
 }
 
+void UFilterRule_LogicalNot::Compile(Faerie::ItemData::FFilterCompiler& Compiler) const
+{
+	Compiler.CompileNot(InvertedRule);
+}
+
 #if WITH_EDITOR
 EItemDataMutabilityStatus UFilterRule_Mutability::GetMutabilityStatus() const
 {
@@ -169,6 +210,11 @@ bool UFilterRule_Mutability::Exec(const FFaerieItemStackView View) const
 	return View.Item->CanMutate() == RequireMutable;
 }
 
+void UFilterRule_Mutability::Compile(Faerie::ItemData::FFilterCompiler& Compiler) const
+{
+	Compiler.EmitMutable(RequireMutable);
+}
+
 #if WITH_EDITOR
 EItemDataMutabilityStatus UFilterRule_MatchTemplate::GetMutabilityStatus() const
 {
@@ -199,6 +245,23 @@ bool UFilterRule_MatchTemplate::Exec(const FFaerieItemStackView View) const
 	return false;
 }
 
+void UFilterRule_MatchTemplate::Compile(Faerie::ItemData::FFilterCompiler& Compiler) const
+{
+#if WITH_EDITOR
+	// Templates can be edited while this is compiled, so call through to them, so that they always see their latest
+	// pattern.
+	Compiler.EmitCall(this);
+#else
+	// Inline the template's pattern, rather than calling through TryMatch.
+	if (IsValid(Template))
+	{
+		Compiler.Compile(Template->GetPattern());
+		return;
+	}
+	Compiler.EmitLiteral(false);
+#endif
+}
+
 #if WITH_EDITOR
 EItemDataMutabilityStatus UFilterRule_HasTokens::GetMutabilityStatus() const
 {
@@ -263,6 +326,28 @@ bool UFilterRule_HasTokens::Exec(const FFaerieItemStackView View) const
 	return TokenClassesCopy.IsEmpty();
 }
 
+void UFilterRule_HasTokens::Compile(Faerie::ItemData::FFilterCompiler& Compiler) const
+{
+	if (!Compiler.EmitHasTokens(TokenClasses))
+	{
+		Compiler.EmitCall(this);
+	}
+}
+
+static Faerie::ItemData::EFilterCompare ToFilterCompare(const ECopiesCompareOperator Operator)
+{
+	switch (Operator)
+	{
+	case ECopiesCompareOperator::Less:				return Faerie::ItemData::EFilterCompare::Less;
+	case ECopiesCompareOperator::LessOrEqual:		return Faerie::ItemData::EFilterCompare::LessOrEqual;
+	case ECopiesCompareOperator::Greater:			return Faerie::ItemData::EFilterCompare::Greater;
+	case ECopiesCompareOperator::GreaterOrEqual:	return Faerie::ItemData::EFilterCompare::GreaterOrEqual;
+	case ECopiesCompareOperator::Equal:				return Faerie::ItemData::EFilterCompare::Equal;
+	case ECopiesCompareOperator::NotEqual:			return Faerie::ItemData::EFilterCompare::NotEqual;
+	default: return Faerie::ItemData::EFilterCompare::Equal;
+	}
+}
+
 #if WITH_EDITOR
 EItemDataMutabilityStatus UFilterRule_Copies::GetMutabilityStatus() const
 {
@@ -297,6 +382,44 @@ bool UFilterRule_Copies::Exec(const FFaerieItemStackView View) const
 	}
 }
 
+void UFilterRule_Copies::Compile(Faerie::ItemData::FFilterCompiler& Compiler) const
+{
+	Compiler.EmitCompareCopies(ToFilterCompare(Operator), AmountToCompare);
+}
+
+static Faerie::ItemData::EFilterCompare ToFilterCompare(const EStackCompareOperator Operator)
+{
+	switch (Operator)
+	{
+	case EStackCompareOperator::Less:			return Faerie::ItemData::EFilterCompare::Less;
+	case EStackCompareOperator::LessOrEqual:	return Faerie::ItemData::EFilterCompare::LessOrEqual;
+	case EStackCompareOperator::Greater:		return Faerie::ItemData::EFilterCompare::Greater;
+	case EStackCompareOperator::GreaterOrEqual:	return Faerie::ItemData::EFilterCompare::GreaterOrEqual;
+	case EStackCompareOperator::Equal:			return Faerie::ItemData::EFilterCompare::Equal;
+	case EStackCompareOperator::NotEqual:		return Faerie::ItemData::EFilterCompare::NotEqual;
+	default: return Faerie::ItemData::EFilterCompare::Equal;
+	}
+}
+
+// Native versions of UFilterRule_StackLimit::Exec, so compiled filters don't need to call through the rule.
+static bool CompareStackLimit(const FFaerieItemStackView& View, const Faerie::ItemData::EFilterCompare Compare, const int32 Amount)
+{
+	const int32 Limit = UFaerieStackLimiterToken::GetItemStackLimit(View.Item.Get());
+	if (Limit == Faerie::ItemData::UnlimitedStack)
+	{
+		// Unlimited stacks are greater than any amount.
+		return Compare == Faerie::ItemData::EFilterCompare::Greater ||
+			   Compare == Faerie::ItemData::EFilterCompare::GreaterOrEqual ||
+			   Compare == Faerie::ItemData::EFilterCompare::NotEqual;
+	}
+	return Faerie::ItemData::CompareValues(Limit, Compare, Amount);
+}
+
+static bool HasStackLimit(const FFaerieItemStackView& View, Faerie::ItemData::EFilterCompare, const int32 Limited)
+{
+	return (UFaerieStackLimiterToken::GetItemStackLimit(View.Item.Get()) != Faerie::ItemData::UnlimitedStack) == (Limited != 0);
+}
+
 #if WITH_EDITOR
 EItemDataMutabilityStatus UFilterRule_StackLimit::GetMutabilityStatus() const
 {
@@ -354,6 +477,22 @@ bool UFilterRule_StackLimit::Exec(const FFaerieItemStackView View) const
 	}
 }
 
+void UFilterRule_StackLimit::Compile(Faerie::ItemData::FFilterCompiler& Compiler) const
+{
+	switch (Operator)
+	{
+	case EStackCompareOperator::HasLimit:
+		Compiler.EmitNative(&HasStackLimit, Faerie::ItemData::EFilterCompare::Equal, 1);
+		break;
+	case EStackCompareOperator::HasNoLimit:
+		Compiler.EmitNative(&HasStackLimit, Faerie::ItemData::EFilterCompare::Equal, 0);
+		break;
+	default:
+		Compiler.EmitNative(&CompareStackLimit, ToFilterCompare(Operator), AmountToCompare);
+		break;
+	}
+}
+
 bool UFilterRule_GameplayTagAny::Exec(const FFaerieItemStackView View) const
 {
 	if (const UFaerieTagToken* TagToken = View.Item->GetToken<UFaerieTagToken>())
@@ -363,6 +502,11 @@ bool UFilterRule_GameplayTagAny::Exec(const FFaerieItemStackView View) const
 	return false;
 }
 
+void UFilterRule_GameplayTagAny::Compile(Faerie::ItemData::FFilterCompiler& Compiler) const
+{
+	Compiler.EmitTags(Tags, false);
+}
+
 bool UFilterRule_GameplayTagAll::Exec(const FFaerieItemStackView View) const
 {
 	if (const UFaerieTagToken* TagToken = View.Item->GetToken<UFaerieTagToken>())
@@ -372,4 +516,9 @@ bool UFilterRule_GameplayTagAll::Exec(const FFaerieItemStackView View) const
 	return false;
 }
 
+void UFilterRule_GameplayTagAll::Compile(Faerie::ItemData::FFilterCompiler& Compiler) const
+{
+	Compiler.EmitTags(Tags, true);
+}
+
 #undef LOCTEXT_NAMESPACE
\ No newline at end of file
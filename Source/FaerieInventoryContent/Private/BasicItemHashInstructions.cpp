@@ -3,6 +3,7 @@
 #include "BasicItemHashInstructions.h"
 #include "FaerieHashStatics.h"
 #include "FaerieItemDataFilter.h"
+#include "FaerieItemStackHashProgram.h"
 #include "FaerieItemToken.h"
 #include "FaerieItemTokenFilter.h"
 #include "Squirrel.h"
@@ -26,6 +27,11 @@ uint32 UFISHI_Literial::Hash(const FFaerieItemStackView StackView) const
 	return Value.Hash;
 }
 
+void UFISHI_Literial::Compile(Faerie::Hash::FHashCompiler& Compiler) const
+{
+	Compiler.EmitLiteral(Value.Hash);
+}
+
 uint32 UFISHI_IsValid::Hash(const FFaerieItemStackView StackView) const
 {
 	if (StackView.IsValid())
@@ -35,6 +41,11 @@ uint32 UFISHI_IsValid::Hash(const FFaerieItemStackView StackView) const
 	return VALIDATED_FALSE;
 }
 
+void UFISHI_IsValid::Compile(Faerie::Hash::FHashCompiler& Compiler) const
+{
+	Compiler.EmitValid(VALIDATED_TRUE, VALIDATED_FALSE);
+}
+
 uint32 UFISHI_And::Hash(const FFaerieItemStackView StackView) const
 {
 	int32 Hash = 0;
@@ -47,6 +58,11 @@ uint32 UFISHI_And::Hash(const FFaerieItemStackView StackView) const
 	return Hash;
 }
 
+void UFISHI_And::Compile(Faerie::Hash::FHashCompiler& Compiler) const
+{
+	Compiler.CompileCombine(Instructions);
+}
+
 uint32 UFISHI_Or::Hash(const FFaerieItemStackView StackView) const
 {
 	for (auto Instruction : Instructions)
@@ -61,6 +77,11 @@ uint32 UFISHI_Or::Hash(const FFaerieItemStackView StackView) const
 	return HASH_FAILURE;
 }
 
+void UFISHI_Or::Compile(Faerie::Hash::FHashCompiler& Compiler) const
+{
+	Compiler.CompileFirstNotFailed(Instructions);
+}
+
 uint32 UFISHI_BooleanFilter::Hash(const FFaerieItemStackView StackView) const
 {
 	if (!ensure(IsValid(Pattern)))
@@ -76,6 +97,17 @@ uint32 UFISHI_BooleanFilter::Hash(const FFaerieItemStackView StackView) const
 	return BOOLEAN_FILTER_FALSE;
 }
 
+void UFISHI_BooleanFilter::Compile(Faerie::Hash::FHashCompiler& Compiler) const
+{
+	if (!ensure(IsValid(Pattern)))
+	{
+		Compiler.EmitLiteral(HASH_FAILURE);
+		return;
+	}
+
+	Compiler.EmitFilter(Pattern, BOOLEAN_FILTER_TRUE, BOOLEAN_FILTER_FALSE);
+}
+
 uint32 UFISHI_BooleanSelect::Hash(const FFaerieItemStackView StackView) const
 {
 	if (!ensure(IsValid(Pattern)))
@@ -91,6 +123,17 @@ uint32 UFISHI_BooleanSelect::Hash(const FFaerieItemStackView StackView) const
 	return ChildHash(False, StackView);
 }
 
+void UFISHI_BooleanSelect::Compile(Faerie::Hash::FHashCompiler& Compiler) const
+{
+	if (!ensure(IsValid(Pattern)))
+	{
+		Compiler.EmitLiteral(HASH_FAILURE);
+		return;
+	}
+
+	Compiler.CompileSelect(Pattern, True, False);
+}
+
 uint32 UFISHI_Tokens::Hash(const FFaerieItemStackView StackView) const
 {
 	uint32 Hash = 0;
@@ -113,4 +156,9 @@ uint32 UFISHI_Tokens::Hash(const FFaerieItemStackView StackView) const
 	}
 
 	return Hash;
+}
+
+void UFISHI_Tokens::Compile(Faerie::Hash::FHashCompiler& Compiler) const
+{
+	Compiler.EmitTokens(TokenClasses, TOKEN_HASH_EMPTY);
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "Extensions/InventoryCapacityExtension.h"
 #include "FaerieInventoryContentLog.h"
 
+#include "FaerieDataSystemMemory.h"
 #include "FaerieItem.h"
 #include "FaerieItemStorage.h"
 #include "Net/UnrealNetwork.h"
@@ -77,6 +78,24 @@ void UInventoryCapacityExtension::DeinitializeExtension(const UFaerieItemContain
 	HandleStateChanged();
 }
 
+void UInventoryCapacityExtension::RestoreTransactionSnapshot(const UFaerieItemContainerBase* Container, const FInstancedStruct& Snapshot)
+{
+	if (!ensure(IsValid(Container))) return;
+
+	// Drop entries that no longer exist, then refresh the ones that do.
+	if (auto&& ContainerCache = ServerCapacityCache.Find(Container))
+	{
+		TArray<FEntryKey> CachedKeys;
+		ContainerCache->GetKeys(CachedKeys);
+		for (const FEntryKey Key : CachedKeys)
+		{
+			UpdateCacheForEntry(Container, Key);
+		}
+	}
+
+	InitializeExtension(Container);
+}
+
 EEventExtensionResponse UInventoryCapacityExtension::AllowsAddition(const UFaerieItemContainerBase* Container,
 																	const TConstArrayView<FFaerieItemStackView> Views,
 																	const FFaerieExtensionAllowsAdditionArgs Args) const
@@ -145,6 +164,14 @@ void UInventoryCapacityExtension::PostEntryChanged(const UFaerieItemContainerBas
 	HandleStateChanged();
 }
 
+void UInventoryCapacityExtension::GetMemoryUsage(const UFaerieItemContainerBase* Container, Faerie::Memory::FReport& Report) const
+{
+	if (auto&& ContainerCache = ServerCapacityCache.Find(Container))
+	{
+		Report.AddAllocation(TEXT("Capacity Cache"), *ContainerCache);
+	}
+}
+
 FWeightAndVolume UInventoryCapacityExtension::GetEntryWeightAndVolume(const UFaerieItemContainerBase* Container, const FEntryKey Key)
 {
 	FWeightAndVolume Out;
@@ -186,6 +213,8 @@ void UInventoryCapacityExtension::UpdateCacheForEntry(const UFaerieItemContainer
 {
 	if (!ensure(IsValid(Container))) return;
 
+	LLM_SCOPE_BYTAG(FaerieInventoryContent);
+
 	auto&& ContainerCache = ServerCapacityCache.FindOrAdd(Container);
 	auto&& PrevCache = ContainerCache.Find(Key);
 
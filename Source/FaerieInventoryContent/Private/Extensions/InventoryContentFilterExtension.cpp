@@ -5,15 +5,30 @@
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(InventoryContentFilterExtension)
 
+#if WITH_EDITOR
+void UInventoryContentFilterExtension::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	CompiledFilter.Reset();
+	FilterResults.Reset();
+}
+#endif
+
 EEventExtensionResponse UInventoryContentFilterExtension::AllowsAddition(const UFaerieItemContainerBase*,
                                                                          const TConstArrayView<FFaerieItemStackView> Views,
                                                                          FFaerieExtensionAllowsAdditionArgs) const
 {
 	if (ensure(IsValid(Filter)))
 	{
-		for (auto&& View : Views)
+		if (!CompiledFilter.IsCompiled())
+		{
+			CompiledFilter = Faerie::ItemData::FFilterProgram::Compile(Filter);
+			FilterResults.Reset();
+		}
+
+		for (const FFaerieItemStackView& View : Views)
 		{
-			if (!Filter->Exec(View))
+			if (!FilterResults.FindOrExec(CompiledFilter, View))
 			{
 				return EEventExtensionResponse::Disallowed;
 			}
@@ -1,6 +1,7 @@
 ﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
 
 #include "Extensions/InventoryEjectionHandlerExtension.h"
+#include "FaerieDataSystemMemory.h"
 #include "FaerieInventoryContentLog.h"
 #include "FaerieItemStorage.h"
 #include "ItemContainerEvent.h"
@@ -46,6 +47,11 @@ void UInventoryEjectionHandlerExtension::PostRemoval(const UFaerieItemContainerB
 	Enqueue(Stack);
 }
 
+void UInventoryEjectionHandlerExtension::GetMemoryUsage(const UFaerieItemContainerBase* Container, Faerie::Memory::FReport& Report) const
+{
+	Report.AddAllocation(TEXT("Ejection Queue"), PendingEjectionQueue);
+}
+
 void UInventoryEjectionHandlerExtension::Enqueue(const FFaerieItemStack& Stack)
 {
 	PendingEjectionQueue.Add(Stack);
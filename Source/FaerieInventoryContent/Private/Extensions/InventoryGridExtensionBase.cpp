@@ -1,9 +1,12 @@
 ﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
 
 #include "Extensions/InventoryGridExtensionBase.h"
+#include "FaerieDataSystemMemory.h"
+#include "FaerieInventoryContentLog.h"
 #include "FaerieItemContainerBase.h"
 #include "FaerieItemStorage.h"
 #include "FaerieItemStorageIterators.h"
+#include "Actions/FaerieInventoryClient.h"
 #include "Net/UnrealNetwork.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(InventoryGridExtensionBase)
@@ -98,6 +101,11 @@ namespace Faerie
 		return GetNumCells() - GetNumMarked();
 	}
 
+	SIZE_T FCellGrid::GetAllocatedSize() const
+	{
+		return CellBits.GetAllocatedSize();
+	}
+
 	int32 FCellGrid::Ravel(const FIntPoint& Point) const
 	{
 		return Point.Y * Dimensions.X + Point.X;
@@ -109,6 +117,13 @@ namespace Faerie
 		const int32 Y = Index / Dimensions.X;
 		return FIntPoint{ X, Y };
 	}
+
+	// Compares what client prediction can change about a grid stack.
+	static bool PredictedStacksMatch(const FFaerieGridKeyedStack& A, const FFaerieGridKeyedStack& B)
+	{
+		return A.Key == B.Key &&
+			A.Value == B.Value;
+	}
 }
 
 void UInventoryGridExtensionBase::GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const
@@ -131,6 +146,8 @@ void UInventoryGridExtensionBase::PostInitProperties()
 
 void UInventoryGridExtensionBase::InitializeExtension(const UFaerieItemContainerBase* Container)
 {
+	LLM_SCOPE_BYTAG(FaerieInventoryContent);
+
 	checkf(!IsValid(InitializedContainer), TEXT("UInventoryGridExtensionBase doesn't support multi-initialization!"))
 	InitializedContainer = const_cast<UFaerieItemContainerBase*>(Container);
 	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, InitializedContainer, this);
@@ -165,17 +182,99 @@ void UInventoryGridExtensionBase::DeinitializeExtension(const UFaerieItemContain
 	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, InitializedContainer, this);
 }
 
+FInstancedStruct UInventoryGridExtensionBase::MakeTransactionSnapshot(const UFaerieItemContainerBase* Container) const
+{
+	return FInstancedStruct::Make(GridContent);
+}
+
+void UInventoryGridExtensionBase::RestoreTransactionSnapshot(const UFaerieItemContainerBase* Container, const FInstancedStruct& Snapshot)
+{
+	const FFaerieGridContent* SnapshotContent = Snapshot.GetPtr<FFaerieGridContent>();
+	if (!SnapshotContent || !ensure(GridContent.WriteLock == 0))
+	{
+		return;
+	}
+
+	TArray<FFaerieAddress> ChangedStacks;
+	for (const FFaerieGridKeyedStack& Stack : SnapshotContent->Items)
+	{
+		const FFaerieGridKeyedStack* Current = GridContent.Find(Stack.Key);
+		if (!Current || !Faerie::PredictedStacksMatch(*Current, Stack))
+		{
+			ChangedStacks.Add(Stack.Key);
+		}
+	}
+
+	GridContent.Items = SnapshotContent->Items;
+	GridContent.MarkArrayDirty();
+	RebuildOccupiedCells();
+
+	for (const FFaerieAddress Address : ChangedStacks)
+	{
+		if (const FFaerieGridKeyedStack* Stack = GridContent.Find(Address))
+		{
+			PostStackChange(*Stack);
+		}
+	}
+}
+
+void UInventoryGridExtensionBase::GetMemoryUsage(const UFaerieItemContainerBase* Container, Faerie::Memory::FReport& Report) const
+{
+	if (Container != InitializedContainer) return;
+
+	Report.AddAllocation(TEXT("Grid Content"), GridContent.Items);
+	Report.AddAllocation(TEXT("Occupied Cells"), OccupiedCells);
+}
+
 bool UInventoryGridExtensionBase::IsCellOccupied(const FIntPoint& Point) const
 {
 	return OccupiedCells.GetCell(Point);
 }
 
+void UInventoryGridExtensionBase::RebuildOccupiedCells()
+{
+	LLM_SCOPE_BYTAG(FaerieInventoryContent);
+
+	OccupiedCells.Reset(GridSize);
+
+	for (const FFaerieGridKeyedStack& Stack : GridContent)
+	{
+		OccupiedCells.MarkCell(Stack.Value.Origin);
+	}
+}
+
 void UInventoryGridExtensionBase::BroadcastEvent(const FFaerieAddress Address, const EFaerieGridEventType EventType)
 {
 	SpatialStackChangedNative.Broadcast(Address, EventType);
 	SpatialStackChangedDelegate.Broadcast(Address, EventType);
 }
 
+bool UInventoryGridExtensionBase::TryMergeStacks(const FFaerieAddress FromAddress, const FFaerieAddress ToAddress)
+{
+	UFaerieItemStorage* Storage = Cast<UFaerieItemStorage>(InitializedContainer);
+	if (!IsValid(Storage))
+	{
+		return false;
+	}
+
+	const TTuple<FEntryKey, FStackKey> From = UFaerieItemStorage::BreakAddress(FromAddress);
+	const TTuple<FEntryKey, FStackKey> To = UFaerieItemStorage::BreakAddress(ToAddress);
+	if (From.Get<0>() != To.Get<0>())
+	{
+		return false;
+	}
+
+	if (ActivePrediction.Client)
+	{
+		const bool Predicted = Storage->PredictMergeStacks(ActivePrediction.Client, ActivePrediction.Key,
+			From.Get<0>(), From.Get<1>(), To.Get<1>(), Faerie::ItemData::EntireStack);
+		ActivePrediction.PredictedStorage |= Predicted;
+		return Predicted;
+	}
+
+	return Storage->MergeStacks(From.Get<0>(), From.Get<1>(), To.Get<1>());
+}
+
 void UInventoryGridExtensionBase::OnRep_GridSize()
 {
 	GridSizeChangedNative.Broadcast(GridSize);
@@ -215,4 +314,120 @@ void UInventoryGridExtensionBase::SetGridSize(const FIntPoint& NewGridSize)
 		// OnReps must be called manually on the server in c++
 		OnRep_GridSize();
 	}
-}
\ No newline at end of file
+}
+
+bool UInventoryGridExtensionBase::HasPendingPredictions() const
+{
+	return Prediction.IsPredicting();
+}
+
+bool UInventoryGridExtensionBase::PredictMoveItem(UFaerieInventoryClient* Client, const Faerie::ClientAction::FPredictionKey Key,
+												  const FFaerieAddress Address, const FIntPoint& TargetPoint)
+{
+	if (!GridContent.Contains(Address))
+	{
+		return false;
+	}
+
+	return PredictEdit(Client, Key,
+		[this, Address, TargetPoint]
+		{
+			return MoveItem(Address, TargetPoint);
+		});
+}
+
+bool UInventoryGridExtensionBase::PredictRotateItem(UFaerieInventoryClient* Client, const Faerie::ClientAction::FPredictionKey Key,
+													const FFaerieAddress Address)
+{
+	if (!GridContent.Contains(Address))
+	{
+		return false;
+	}
+
+	return PredictEdit(Client, Key,
+		[this, Address]
+		{
+			return RotateItem(Address);
+		});
+}
+
+bool UInventoryGridExtensionBase::PredictEdit(UFaerieInventoryClient* Client, const Faerie::ClientAction::FPredictionKey Key,
+											  const TFunctionRef<bool()> Edit)
+{
+	// Moves are tested against the occupied cells, which aren't maintained on clients.
+	RebuildOccupiedCells();
+
+	ActivePrediction = { Client, Key, false };
+	const bool PredictedGrid = Prediction.Predict(Key, GridContent.Items, Edit, &Faerie::PredictedStacksMatch);
+	const bool PredictedStorage = ActivePrediction.PredictedStorage;
+	ActivePrediction = FActivePrediction();
+
+	if (PredictedGrid)
+	{
+		PredictionListener.Bind(Client, Faerie::ClientAction::FPredictionResolved::FDelegate::CreateUObject(this, &ThisClass::OnPredictionResolved));
+	}
+
+	return PredictedGrid || PredictedStorage;
+}
+
+void UInventoryGridExtensionBase::RecordReplicatedStack(const FFaerieGridKeyedStack& Stack, const bool Removed)
+{
+	if (Removed)
+	{
+		Prediction.RecordReplicatedRemove(Stack.Key);
+	}
+	else
+	{
+		Prediction.RecordReplicatedItem(Stack);
+	}
+}
+
+void UInventoryGridExtensionBase::PostContentReplicated()
+{
+	if (Prediction.IsPredicting())
+	{
+		ReconcilePrediction();
+	}
+}
+
+void UInventoryGridExtensionBase::PreStackEdit(const FFaerieGridKeyedStack& Stack)
+{
+	Prediction.RecordPreEdit(Stack);
+}
+
+void UInventoryGridExtensionBase::OnPredictionResolved(const Faerie::ClientAction::FPredictionKey Key, const bool Accepted)
+{
+	if (Prediction.Resolve(Key, Accepted))
+	{
+		ReconcilePrediction();
+	}
+}
+
+void UInventoryGridExtensionBase::ReconcilePrediction()
+{
+	// Replacing stacks while something is iterating them isn't safe. The next update will catch up.
+	if (!ensure(GridContent.WriteLock == 0))
+	{
+		return;
+	}
+
+	TArray<FFaerieAddress> ChangedStacks;
+	Prediction.Reconcile(GridContent.Items, &Faerie::PredictedStacksMatch, ChangedStacks);
+
+	// Stacks were replaced wholesale, so the Fast Array's index map is stale.
+	GridContent.MarkArrayDirty();
+	RebuildOccupiedCells();
+
+	for (const FFaerieAddress Address : ChangedStacks)
+	{
+		if (const FFaerieGridKeyedStack* Stack = GridContent.Find(Address))
+		{
+			PostStackChange(*Stack);
+		}
+	}
+
+	if (!Prediction.IsPredicting())
+	{
+		PredictionListener.Unbind();
+	}
+}
@@ -3,6 +3,7 @@
 #include "Extensions/InventoryItemLimitExtension.h"
 #include "FaerieInventoryContentLog.h"
 
+#include "FaerieDataSystemMemory.h"
 #include "FaerieItemStorage.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(InventoryItemLimitExtension)
@@ -29,6 +30,21 @@ void UInventoryItemLimitExtension::DeinitializeExtension(const UFaerieItemContai
 	}
 }
 
+void UInventoryItemLimitExtension::RestoreTransactionSnapshot(const UFaerieItemContainerBase* Container, const FInstancedStruct& Snapshot)
+{
+	if (!ensure(IsValid(Container))) return;
+
+	// Drop entries that no longer exist, then refresh the ones that do.
+	TArray<FEntryKey> CachedKeys;
+	EntryAmountCache.GetKeys(CachedKeys);
+	for (const FEntryKey Key : CachedKeys)
+	{
+		UpdateCacheForEntry(Container, Key);
+	}
+
+	InitializeExtension(Container);
+}
+
 EEventExtensionResponse UInventoryItemLimitExtension::AllowsAddition(const UFaerieItemContainerBase*,
                                                                      const TConstArrayView<FFaerieItemStackView> Views,
                                                                      const FFaerieExtensionAllowsAdditionArgs Args) const
@@ -84,6 +100,12 @@ void UInventoryItemLimitExtension::PostEntryChanged(const UFaerieItemContainerBa
 	UpdateCacheForEntry(Container, Event.EntryTouched);
 }
 
+void UInventoryItemLimitExtension::GetMemoryUsage(const UFaerieItemContainerBase* Container, Faerie::Memory::FReport& Report) const
+{
+	// The cache is keyed by entry alone, so it is reported against every container this is added to.
+	Report.AddAllocation(TEXT("Item Limit Cache"), EntryAmountCache);
+}
+
 int32 UInventoryItemLimitExtension::GetTotalItemCount() const
 {
 	return CurrentTotalItemCopies;
@@ -134,6 +156,8 @@ void UInventoryItemLimitExtension::UpdateCacheForEntry(const UFaerieItemContaine
 {
 	if (!ensure(IsValid(Container))) return;
 
+	LLM_SCOPE_BYTAG(FaerieInventoryContent);
+
 	int32 PrevEntryAmount = 0;
 	if (auto&& ExistingCache = EntryAmountCache.Find(Key))
 	{
@@ -1,6 +1,7 @@
 ﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
 
 #include "Extensions/InventoryLoggerExtension.h"
+#include "FaerieDataSystemMemory.h"
 #include "FaerieItemContainerBase.h"
 
 #include "Net/UnrealNetwork.h"
@@ -32,6 +33,19 @@ void UInventoryLoggerExtension::PostEntryChanged(const UFaerieItemContainerBase*
 	HandleNewEvent({Container, Event});
 }
 
+void UInventoryLoggerExtension::GetMemoryUsage(const UFaerieItemContainerBase* Container, Faerie::Memory::FReport& Report) const
+{
+	// The log is shared by every container, so only count the events this one logged.
+	for (const FLoggedInventoryEvent& Logged : EventLog)
+	{
+		if (Logged.Container != Container) continue;
+
+		Report.Add(TEXT("Event Log"), sizeof(FLoggedInventoryEvent));
+		Report.AddAllocation(TEXT("Event Log"), Logged.Event.StackKeys);
+		Report.AddAllocation(TEXT("Event Log"), Logged.Event.ErrorMessage);
+	}
+}
+
 void UInventoryLoggerExtension::HandleNewEvent(const FLoggedInventoryEvent& Event)
 {
 	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, EventLog, this);
@@ -1,7 +1,9 @@
 // Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
 
 #include "Extensions/InventorySimpleGridExtension.h"
+#include "FaerieInventoryContentLog.h"
 
+#include "FaerieContainerTransaction.h"
 #include "FaerieItemContainerBase.h"
 #include "FaerieItemStorage.h"
 #include "ItemContainerEvent.h"
@@ -145,6 +147,8 @@ bool UInventorySimpleGridExtension::CanAddAtLocation(const FFaerieItemStackView
 
 bool UInventorySimpleGridExtension::AddItemToGrid(const FFaerieAddress Address, const UFaerieItem* Item)
 {
+	LLM_SCOPE_BYTAG(FaerieInventoryContent);
+
 	if (!Address.IsValid())
 	{
 		return false;
@@ -170,6 +174,8 @@ bool UInventorySimpleGridExtension::AddItemToGrid(const FFaerieAddress Address,
 
 bool UInventorySimpleGridExtension::MoveItem(const FFaerieAddress Address, const FIntPoint& TargetPoint)
 {
+	Faerie::Container::FTransaction::PreEdit(InitializedContainer);
+
 	if (const FFaerieAddress OverlappingAddress = FindOverlappingItem(Address);
 		OverlappingAddress.IsValid())
 	{
@@ -186,8 +192,7 @@ bool UInventorySimpleGridExtension::MoveItem(const FFaerieAddress Address, const
 			}
 
 			// Try merging them. This is known to be safe, since all stacks with the same key share immutability.
-			if (UFaerieItemStorage* Storage = Cast<UFaerieItemStorage>(InitializedContainer);
-				Storage->MergeStacks(Key.Get<0>(), Key.Get<1>(), OverlappingKey.Get<1>()))
+			if (TryMergeStacks(Address, OverlappingAddress))
 			{
 				return true;
 			}
@@ -206,6 +211,7 @@ bool UInventorySimpleGridExtension::MoveItem(const FFaerieAddress Address, const
 
 bool UInventorySimpleGridExtension::RotateItem(const FFaerieAddress Address)
 {
+	Faerie::Container::FTransaction::PreEdit(InitializedContainer);
 	const FFaerieGridContent::FScopedStackHandle Handle = GridContent.GetHandle(Address);
 	Handle->Rotation = GetNextRotation(Handle->Rotation);
 	return true;
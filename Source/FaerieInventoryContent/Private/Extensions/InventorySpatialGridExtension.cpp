@@ -3,6 +3,8 @@
 #include "Extensions/InventorySpatialGridExtension.h"
 #include "FaerieInventoryContentLog.h"
 
+#include "FaerieContainerTransaction.h"
+#include "FaerieDataSystemTrace.h"
 #include "FaerieItemContainerBase.h"
 #include "FaerieItemStorage.h"
 #include "ItemContainerEvent.h"
@@ -12,6 +14,10 @@
 
 DECLARE_STATS_GROUP(TEXT("InventorySpatialGridExtension"), STATGROUP_FaerieSpatialGrid, STATCAT_Advanced);
 DECLARE_CYCLE_STAT(TEXT("Client OccupiedCells rebuild"), STAT_Client_CellRebuild, STATGROUP_FaerieSpatialGrid);
+DECLARE_CYCLE_STAT(TEXT("Add Item to Grid"), STAT_Grid_AddItem, STATGROUP_FaerieSpatialGrid);
+DECLARE_CYCLE_STAT(TEXT("Can Add Items to Grid"), STAT_Grid_CanAddItems, STATGROUP_FaerieSpatialGrid);
+DECLARE_CYCLE_STAT(TEXT("Fits in Grid (Any Rotation)"), STAT_Grid_FitsAnyRotation, STATGROUP_FaerieSpatialGrid);
+DECLARE_CYCLE_STAT(TEXT("Find Overlapping Item"), STAT_Grid_FindOverlapping, STATGROUP_FaerieSpatialGrid);
 
 namespace Faerie
 {
@@ -338,6 +344,9 @@ bool UInventorySpatialGridExtension::CanAddAtLocation(const FFaerieItemStackView
 
 bool UInventorySpatialGridExtension::AddItemToGrid(const FFaerieAddress Address, const UFaerieItem* Item)
 {
+	FAERIE_SCOPE_CYCLE_COUNTER(STAT_Grid_AddItem);
+	LLM_SCOPE_BYTAG(FaerieInventoryContent);
+
 	if (!Address.IsValid())
 	{
 		return false;
@@ -368,6 +377,8 @@ bool UInventorySpatialGridExtension::AddItemToGrid(const FFaerieAddress Address,
 
 bool UInventorySpatialGridExtension::MoveItem(const FFaerieAddress Address, const FIntPoint& TargetPoint)
 {
+	Faerie::Container::FTransaction::PreEdit(InitializedContainer);
+
 	const FFaerieGridShapeConstView ItemShape = GetItemShape_Impl(Address);
 
 	// Create placement at target point with current rotation
@@ -393,8 +404,7 @@ bool UInventorySpatialGridExtension::MoveItem(const FFaerieAddress Address, cons
 			}
 
 			// Try merging them. This is known to be safe, since all stacks with the same key share immutability.
-			if (UFaerieItemStorage* Storage = Cast<UFaerieItemStorage>(InitializedContainer);
-				Storage->MergeStacks(Key.Get<0>(), Key.Get<1>(), OverlappingKey.Get<1>()))
+			if (TryMergeStacks(Address, OverlappingAddress))
 			{
 				return true;
 			}
@@ -434,6 +444,8 @@ bool UInventorySpatialGridExtension::RotateItem(const FFaerieAddress Address)
 	// No Point in Trying to Rotate
 	if (ItemShape.IsSymmetrical()) return false;
 
+	Faerie::Container::FTransaction::PreEdit(InitializedContainer);
+
 	const FFaerieGridContent::FScopedStackHandle Handle = GridContent.GetHandle(Address);
 
 	// Store old points before transformations so we can clear them from the bit grid
@@ -487,7 +499,8 @@ void UInventorySpatialGridExtension::RemoveItemBatch(const TConstArrayView<FFaer
 
 void UInventorySpatialGridExtension::RebuildOccupiedCells()
 {
-	SCOPE_CYCLE_COUNTER(STAT_Client_CellRebuild);
+	FAERIE_SCOPE_CYCLE_COUNTER(STAT_Client_CellRebuild);
+	LLM_SCOPE_BYTAG(FaerieInventoryContent);
 
 	OccupiedCells.Reset(GridSize);
 
@@ -539,6 +552,8 @@ bool UInventorySpatialGridExtension::CanAddItemToGrid(const FFaerieGridShapeCons
 
 bool UInventorySpatialGridExtension::CanAddItemsToGrid(const TArray<FFaerieGridShapeConstView>& Shapes) const
 {
+	FAERIE_SCOPE_CYCLE_COUNTER(STAT_Grid_CanAddItems);
+
 	// @todo obviously this is not very ideal. It just throws each item into the grid first place it goes. A proper shape-packing algo would be nice.
 
 	// Copy occupied cells so we can test if each shape can fit in it.
@@ -626,6 +641,8 @@ Faerie::FExclusionSet UInventorySpatialGridExtension::MakeExclusionSet(const TCo
 
 bool UInventorySpatialGridExtension::FitsInGridAnyRotation(const FFaerieGridShapeConstView& Shape, const FIntPoint Origin, const Faerie::FExclusionSet& ExclusionSet) const
 {
+	FAERIE_SCOPE_CYCLE_COUNTER(STAT_Grid_FitsAnyRotation);
+
 	FFaerieGridShape Translated = Shape.Copy().Translate(Origin);
 
 	// Try 4 times if it FitsInGrid, rotating by 90 degrees between each test
@@ -643,6 +660,8 @@ bool UInventorySpatialGridExtension::FitsInGridAnyRotation(const FFaerieGridShap
 FFaerieAddress UInventorySpatialGridExtension::FindOverlappingItem(const FFaerieGridShapeConstView& TranslatedShape,
 																  const FFaerieAddress ExcludeAddress) const
 {
+	FAERIE_SCOPE_CYCLE_COUNTER(STAT_Grid_FindOverlapping);
+
 	if (const FFaerieGridKeyedStack* Stack = GridContent.FindByPredicate(
 		[this, &TranslatedShape, ExcludeAddress](const FFaerieGridKeyedStack& Other)
 		{
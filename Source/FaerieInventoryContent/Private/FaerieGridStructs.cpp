@@ -7,16 +7,19 @@
 
 void FFaerieGridKeyedStack::PreReplicatedRemove(const FFaerieGridContent& InArraySerializer)
 {
+	InArraySerializer.RecordReplicatedStack(*this, true);
 	InArraySerializer.PreStackReplicatedRemove(*this);
 }
 
 void FFaerieGridKeyedStack::PostReplicatedAdd(FFaerieGridContent& InArraySerializer)
 {
+	InArraySerializer.RecordReplicatedStack(*this, false);
 	InArraySerializer.PostStackReplicatedAdd(*this);
 }
 
 void FFaerieGridKeyedStack::PostReplicatedChange(const FFaerieGridContent& InArraySerializer)
 {
+	InArraySerializer.RecordReplicatedStack(*this, false);
 	InArraySerializer.PostStackReplicatedChange(*this);
 }
 
@@ -25,6 +28,7 @@ FFaerieGridContent::FScopedStackHandle::FScopedStackHandle(const FFaerieAddress
 	Source(Source)
 {
 	Source.WriteLock++;
+	Source.PreStackEdit(Handle);
 }
 
 FFaerieGridContent::FScopedStackHandle::~FScopedStackHandle()
@@ -38,6 +42,30 @@ FFaerieGridContent::FScopedStackHandle::~FScopedStackHandle()
 	Source.PostStackReplicatedChange(Handle);
 }
 
+void FFaerieGridContent::RecordReplicatedStack(const FFaerieGridKeyedStack& Stack, const bool Removed) const
+{
+	if (IsValid(ChangeListener))
+	{
+		ChangeListener->RecordReplicatedStack(Stack, Removed);
+	}
+}
+
+void FFaerieGridContent::PreStackEdit(const FFaerieGridKeyedStack& Stack) const
+{
+	if (IsValid(ChangeListener))
+	{
+		ChangeListener->PreStackEdit(Stack);
+	}
+}
+
+void FFaerieGridContent::PostReplicatedReceive(const FPostReplicatedReceiveParameters& Parameters) const
+{
+	if (IsValid(ChangeListener))
+	{
+		ChangeListener->PostContentReplicated();
+	}
+}
+
 void FFaerieGridContent::PreStackReplicatedRemove(const FFaerieGridKeyedStack& Stack) const
 {
 	if (IsValid(ChangeListener))
@@ -2,6 +2,10 @@
 
 #pragma once
 
+#include "HAL/LowLevelMemTracker.h"
 #include "Logging/LogMacros.h"
 
 DEFINE_LOG_CATEGORY_STATIC(LogFaerieInventoryContent, Log, All);
+
+// Extension caches and grid state.
+LLM_DECLARE_TAG(FaerieInventoryContent);
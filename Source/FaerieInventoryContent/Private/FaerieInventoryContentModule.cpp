@@ -1,8 +1,12 @@
 // Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
 
 #include "FaerieInventoryContentModule.h"
+#include "FaerieDataSystemMemory.h"
+#include "FaerieInventoryContentLog.h"
 #include "Modules/ModuleManager.h"
 
+FAERIE_LLM_DEFINE_TAG(FaerieInventoryContent);
+
 #define LOCTEXT_NAMESPACE "FaerieInventoryContentModule"
 
 void FFaerieInventoryContentModule::StartupModule()
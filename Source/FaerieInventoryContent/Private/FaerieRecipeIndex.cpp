@@ -0,0 +1,194 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "FaerieRecipeIndex.h"
+#include "FaerieContainerFilterTypes.h"
+#include "FaerieDataSystemTrace.h"
+#include "FaerieItemDataFilterProgram.h"
+#include "FaerieItemRecipe.h"
+#include "FaerieItemStorage.h"
+#include "FaerieItemStorageFilter.h"
+#include "FaerieItemTemplate.h"
+
+namespace Faerie::Crafting
+{
+	void FRecipeIndex::Add(const UFaerieItemRecipe* Recipe)
+	{
+		if (!IsValid(Recipe))
+		{
+			return;
+		}
+
+		Remove(Recipe);
+
+		const FFaerieCraftingSlotsView SlotsView = GetCraftingSlots(Recipe);
+		if (!SlotsView.IsValid())
+		{
+			return;
+		}
+
+		FRecipeRow& Row = Recipes.AddDefaulted_GetRef();
+		Row.Recipe = Recipe;
+
+		// Required slots are matched first, so recipes missing one are rejected before any optional slot is matched.
+		for (auto&& RequiredSlot : SlotsView.Get().RequiredSlots)
+		{
+			Row.Slots.Add({RequiredSlot.Key, FindOrAddTemplate(RequiredSlot.Value), false});
+		}
+		for (auto&& OptionalSlot : SlotsView.Get().OptionalSlots)
+		{
+			Row.Slots.Add({OptionalSlot.Key, FindOrAddTemplate(OptionalSlot.Value), true});
+		}
+	}
+
+	void FRecipeIndex::Remove(const UFaerieItemRecipe* Recipe)
+	{
+		// Templates are left in place, as other recipes may share them.
+		Recipes.RemoveAll(
+			[Recipe](const FRecipeRow& Row)
+			{
+				return Row.Recipe == Recipe;
+			});
+	}
+
+	void FRecipeIndex::Reset()
+	{
+		Recipes.Empty();
+		Templates.Empty();
+		TemplateLookup.Empty();
+	}
+
+	TArray<FCraftableRecipe> FRecipeIndex::FindCraftable(const UFaerieItemStorage* Storage) const
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(FRecipeIndex_FindCraftable, FaerieDataSystemChannel);
+
+		TArray<FCraftableRecipe> Craftable;
+		if (!IsValid(Storage))
+		{
+			return Craftable;
+		}
+
+		// Addresses matching each template, filled in the first time a recipe needs them.
+		TArray<TOptional<TArray<FFaerieAddress>>> Matches;
+		Matches.SetNum(Templates.Num());
+
+		for (const FRecipeRow& Row : Recipes)
+		{
+			const UFaerieItemRecipe* Recipe = Row.Recipe.Get();
+			if (!IsValid(Recipe))
+			{
+				continue;
+			}
+
+			FCraftableRecipe Candidate;
+			Candidate.Recipe = Recipe;
+			Candidate.Slots.Reserve(Row.Slots.Num());
+
+			bool CanCraft = true;
+			for (const FSlot& Slot : Row.Slots)
+			{
+				TOptional<TArray<FFaerieAddress>>& Match = Matches[Slot.Template];
+				if (!Match.IsSet())
+				{
+					MatchTemplate(Storage, Slot.Template, Match.Emplace());
+				}
+
+				if (!Slot.Optional && Match->IsEmpty())
+				{
+					CanCraft = false;
+					break;
+				}
+
+				Candidate.Slots.Add({Slot.Handle, Slot.Optional, *Match});
+			}
+
+			if (CanCraft)
+			{
+				Craftable.Add(MoveTemp(Candidate));
+			}
+		}
+
+		return Craftable;
+	}
+
+	SIZE_T FRecipeIndex::GetAllocatedSize() const
+	{
+		SIZE_T Size = Recipes.GetAllocatedSize() + Templates.GetAllocatedSize() + TemplateLookup.GetAllocatedSize();
+		for (const FRecipeRow& Row : Recipes)
+		{
+			Size += Row.Slots.GetAllocatedSize();
+		}
+		for (const FTemplateKeys& Keys : Templates)
+		{
+			Size += Keys.TokenClasses.GetAllocatedSize() + Keys.Tags.Num() * sizeof(FGameplayTag);
+		}
+		return Size;
+	}
+
+	int32 FRecipeIndex::FindOrAddTemplate(const UFaerieItemTemplate* Template)
+	{
+		if (const int32* Existing = TemplateLookup.Find(Template))
+		{
+			return *Existing;
+		}
+
+		const int32 Index = Templates.AddDefaulted();
+		TemplateLookup.Add(Template, Index);
+
+		FTemplateKeys& Keys = Templates[Index];
+		Keys.Template = Template;
+
+		if (IsValid(Template))
+		{
+			const ItemData::FFilterProgram Program = ItemData::FFilterProgram::Compile(Template->GetPattern());
+			Program.GetRequirements(Keys.TokenClasses, Keys.Tags);
+		}
+
+		return Index;
+	}
+
+	void FRecipeIndex::MatchTemplate(const UFaerieItemStorage* Storage, const int32 Index, TArray<FFaerieAddress>& OutAddresses) const
+	{
+		const FTemplateKeys& Keys = Templates[Index];
+		const UFaerieItemTemplate* Template = Keys.Template.Get();
+		if (!IsValid(Template))
+		{
+			return;
+		}
+
+		// Narrow down to the entries that have every key first. These filters read the storage's token index, if it has
+		// one, so this doesn't need to visit any items.
+		Storage::FEntryFilter Filter(Storage);
+		for (const UClass* TokenClass : Keys.TokenClasses)
+		{
+			Filter.Run(Container::FTokenClassFilter(const_cast<UClass*>(TokenClass)));
+		}
+		if (!Keys.Tags.IsEmpty())
+		{
+			Filter.Run(Container::FItemTagsFilter(Keys.Tags, true));
+		}
+
+		if (Filter.IsEmpty())
+		{
+			return;
+		}
+
+		TArray<FEntryKey> Entries;
+		Entries.Reserve(Filter.Num());
+		for (const FEntryKey Key : Filter)
+		{
+			Entries.Add(Key);
+		}
+
+		// The keys don't capture everything in the pattern, so each stack of what's left still has to be matched.
+		for (const FEntryKey Key : Entries)
+		{
+			for (const FFaerieAddress Address : Storage->GetAddressesForEntry(Key))
+			{
+				if (Template->TryMatch(Storage->ViewStack(Address)))
+				{
+					OutAddresses.Add(Address);
+				}
+			}
+		}
+	}
+}
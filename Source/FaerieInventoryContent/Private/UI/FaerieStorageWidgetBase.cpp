@@ -19,6 +19,12 @@ UFaerieStorageWidgetBase::UFaerieStorageWidgetBase(const FObjectInitializer& Obj
 	StorageQuery = CreateDefaultSubobject<UFaerieItemStorageQuery>(TEXT("StorageQuery"));
 }
 
+void UFaerieStorageWidgetBase::AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector)
+{
+	Super::AddReferencedObjects(InThis, Collector);
+	CastChecked<ThisClass>(InThis)->SortedView.AddReferencedObjects(Collector);
+}
+
 bool UFaerieStorageWidgetBase::Initialize()
 {
 	// Request Resort after any change to our Query Object.
@@ -50,24 +56,43 @@ void UFaerieStorageWidgetBase::NativeTick(const FGeometry& MyGeometry, const flo
 
 	if (NeedsResort)
 	{
-		if (ItemStorage.IsValid())
-		{
-			StorageQuery->QueryAllAddresses(ItemStorage.Get(), SortedAndFilteredAddresses);
-		}
+		SortedView.Rebuild(ItemStorage.Get(), StorageQuery);
 		NeedsReconstructEntries = true;
 		NeedsResort = false;
 	}
 
 	if (NeedsReconstructEntries)
 	{
+		SyncSortedAddresses();
+		SortedView.ClearChanges();
 		DisplayAddresses();
 		NeedsReconstructEntries = false;
 	}
+	else if (SortedView.HasChanges())
+	{
+		SyncSortedAddresses();
+		const TArray<FFaerieSortedViewChange> Changes(SortedView.GetChanges());
+		SortedView.ClearChanges();
+		DisplayChanges(Changes);
+	}
+}
+
+void UFaerieStorageWidgetBase::SyncSortedAddresses()
+{
+	if (bVirtualizeRows)
+	{
+		SortedAndFilteredAddresses.Empty();
+	}
+	else
+	{
+		SortedView.GetAddresses(SortedAndFilteredAddresses);
+	}
 }
 
 void UFaerieStorageWidgetBase::Reset()
 {
 	SortedAndFilteredAddresses.Empty();
+	SortedView.Reset();
 	StorageQuery->SetInvertSort(false);
 	StorageQuery->SetInvertFilter(false);
 
@@ -98,15 +123,16 @@ void UFaerieStorageWidgetBase::HandleAddressEvent(UFaerieItemStorage* Storage, c
 			break;
 		case EFaerieAddressEventType::PreRemove:
 			{
-				SortedAndFilteredAddresses.Remove(Address);
+				SortedView.Remove(Address);
 				OnAddressRemoved(Address);
 			}
 			break;
 		case EFaerieAddressEventType::Edit:
 			{
-				if (bAlwaysAddNewToSortOrder)
+				// Edits can change where an address sorts to, or whether it passes the filter at all.
+				if (bAlwaysAddNewToSortOrder && !NeedsResort)
 				{
-					AddToSortOrder(Address, false);
+					SortedView.Update(ItemStorage.Get(), StorageQuery, Address);
 				}
 				OnAddressUpdated(Address);
 			}
@@ -153,68 +179,43 @@ void UFaerieStorageWidgetBase::AddToSortOrder(const FFaerieAddress Address, cons
 		return;
 	}
 
-	// This address is filtered, skip adding to list.
-	if (StorageQuery->IsAddressFiltered(ItemStorage.Get(), Address))
+	if (SortedView.Contains(Address))
 	{
+		if (WarnIfAlreadyExists)
+		{
+			UE_LOG(LogFaerieInventoryContent, Warning, TEXT("Cannot add sort key that already exists in the array"));
+		}
 		return;
 	}
 
-	if (SortedAndFilteredAddresses.IsEmpty())
-	{
-		SortedAndFilteredAddresses.Add(Address);
-	}
-	else
-	{
-		if (StorageQuery->IsSortBound())
-		{
-			auto SortPredicate = [this](const FFaerieAddress A, const FFaerieAddress B)
-			{
-				return StorageQuery->CompareAddresses(ItemStorage.Get(), A, B);
-			};
-
-			// Use binary search to find position to insert the new key.
-			const int32 Index = Algo::LowerBound(SortedAndFilteredAddresses, Address, SortPredicate);
-
-			// Return if the key we were sorted to or above is ourself.
-			if ((SortedAndFilteredAddresses.IsValidIndex(Index) && (SortedAndFilteredAddresses[Index] == Address)) ||
-				((SortedAndFilteredAddresses.IsValidIndex(Index+1) && (SortedAndFilteredAddresses[Index+1] == Address))))
-			{
-				if (WarnIfAlreadyExists)
-				{
-					UE_LOG(LogFaerieInventoryContent, Warning, TEXT("Cannot add sort key that already exists in the array"));
-				}
-				return;
-			}
+	// Filtered addresses are skipped by the view. Without a sort, the address is added to the end.
+	SortedView.Update(ItemStorage.Get(), StorageQuery, Address);
+}
 
-			if (!ensureAlwaysMsgf(!SortedAndFilteredAddresses.Contains(Address), TEXT("Cannot add key that already exists. How did code get here?")))
-			{
-				return;
-			}
+void UFaerieStorageWidgetBase::RequestResort()
+{
+	NeedsResort = true;
+}
 
-			SortedAndFilteredAddresses.Insert(Address, Index);
-		}
-		else
-		{
-			UE_LOG(LogFaerieInventoryContent, Warning, TEXT("StorageQuery's Sort is invalid. Content will not be sorted!"));
-			if (SortedAndFilteredAddresses.Find(Address) != INDEX_NONE)
-			{
-				if (WarnIfAlreadyExists)
-				{
-					UE_LOG(LogFaerieInventoryContent, Warning, TEXT("Cannot add sort key that already exists in the array"));
-				}
-				return;
-			}
+int32 UFaerieStorageWidgetBase::GetSortedIndex(const FFaerieAddress Address) const
+{
+	return SortedView.IndexOf(Address);
+}
 
-			SortedAndFilteredAddresses.Add(Address);
-		}
-	}
+int32 UFaerieStorageWidgetBase::GetSortedCount() const
+{
+	return SortedView.Num();
+}
 
-	NeedsReconstructEntries = true;
+int32 UFaerieStorageWidgetBase::GetAddressPage(const int32 Start, const int32 Count, TArray<FFaerieAddress>& Addresses) const
+{
+	SortedView.GetRange(Start, Count, Addresses);
+	return SortedView.Num();
 }
 
-void UFaerieStorageWidgetBase::RequestResort()
+void UFaerieStorageWidgetBase::DisplayChanges_Implementation(const TArray<FFaerieSortedViewChange>& Changes)
 {
-	NeedsResort = true;
+	DisplayAddresses();
 }
 
 #undef LOCTEXT_NAMESPACE
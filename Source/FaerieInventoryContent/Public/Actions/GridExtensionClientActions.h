@@ -36,6 +36,9 @@ struct FFaerieClientAction_MoveItemOnGrid final : public FFaerieClientActionBase
 	GENERATED_BODY()
 
 	virtual bool Server_Execute(const UFaerieInventoryClient* Client) const override;
+	virtual bool Client_Predict(UFaerieInventoryClient* Client, Faerie::ClientAction::FPredictionKey Key) const override;
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
 
 	UPROPERTY(BlueprintReadWrite, Category = "MoveItemOnGrid")
 	TObjectPtr<UFaerieItemStorage> Storage = nullptr;
@@ -47,12 +50,22 @@ struct FFaerieClientAction_MoveItemOnGrid final : public FFaerieClientActionBase
 	FIntPoint DragEnd = FIntPoint::ZeroValue;
 };
 
+template<>
+struct TStructOpsTypeTraits<FFaerieClientAction_MoveItemOnGrid> : public TStructOpsTypeTraitsBase2<FFaerieClientAction_MoveItemOnGrid>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
+
 USTRUCT(BlueprintType)
 struct FFaerieClientAction_RotateGridEntry final : public FFaerieClientActionBase
 {
 	GENERATED_BODY()
 
 	virtual bool Server_Execute(const UFaerieInventoryClient* Client) const override;
+	virtual bool Client_Predict(UFaerieInventoryClient* Client, Faerie::ClientAction::FPredictionKey Key) const override;
 
 	UPROPERTY(BlueprintReadWrite, Category = "RotateGridEntry")
 	TObjectPtr<UFaerieItemStorage> Storage = nullptr;
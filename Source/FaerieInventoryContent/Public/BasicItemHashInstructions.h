@@ -20,6 +20,7 @@ class UFISHI_Literial : public UFaerieItemStackHashInstruction
 
 public:
 	virtual uint32 Hash(FFaerieItemStackView StackView) const override;
+	virtual void Compile(Faerie::Hash::FHashCompiler& Compiler) const override;
 
 protected:
 	UPROPERTY(EditAnywhere, Category = "FISHI")
@@ -36,6 +37,7 @@ class UFISHI_IsValid : public UFaerieItemStackHashInstruction
 
 public:
 	virtual uint32 Hash(FFaerieItemStackView StackView) const override;
+	virtual void Compile(Faerie::Hash::FHashCompiler& Compiler) const override;
 };
 
 
@@ -49,6 +51,7 @@ class UFISHI_And : public UFaerieItemStackHashInstruction
 
 public:
 	virtual uint32 Hash(FFaerieItemStackView StackView) const override;
+	virtual void Compile(Faerie::Hash::FHashCompiler& Compiler) const override;
 
 protected:
 	UPROPERTY(EditAnywhere, Instanced, Category = "FISHI")
@@ -66,6 +69,7 @@ class UFISHI_Or : public UFaerieItemStackHashInstruction
 
 public:
 	virtual uint32 Hash(FFaerieItemStackView StackView) const override;
+	virtual void Compile(Faerie::Hash::FHashCompiler& Compiler) const override;
 
 protected:
 	UPROPERTY(EditAnywhere, Instanced, Category = "FISHI")
@@ -83,6 +87,7 @@ class UFISHI_BooleanFilter : public UFaerieItemStackHashInstruction
 
 public:
 	virtual uint32 Hash(FFaerieItemStackView StackView) const override;
+	virtual void Compile(Faerie::Hash::FHashCompiler& Compiler) const override;
 
 protected:
 	// Pattern used to determine if an item qualifies as fitting this template.
@@ -100,6 +105,7 @@ class UFISHI_BooleanSelect : public UFaerieItemStackHashInstruction
 
 public:
 	virtual uint32 Hash(FFaerieItemStackView StackView) const override;
+	virtual void Compile(Faerie::Hash::FHashCompiler& Compiler) const override;
 
 protected:
 	// Pattern used to determine if an item qualifies as fitting this template.
@@ -124,6 +130,7 @@ class UFISHI_Tokens : public UFaerieItemStackHashInstruction
 
 public:
 	virtual uint32 Hash(FFaerieItemStackView StackView) const override;
+	virtual void Compile(Faerie::Hash::FHashCompiler& Compiler) const override;
 
 protected:
 	// Pattern used to determine if an item qualifies as fitting this template.
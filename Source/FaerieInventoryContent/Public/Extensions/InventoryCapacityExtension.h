@@ -104,10 +104,13 @@ protected:
     //~ UItemContainerExtensionBase
     virtual void InitializeExtension(const UFaerieItemContainerBase* Container) override;
     virtual void DeinitializeExtension(const UFaerieItemContainerBase* Container) override;
+    virtual void RestoreTransactionSnapshot(const UFaerieItemContainerBase* Container, const FInstancedStruct& Snapshot) override;
+    virtual bool RunsHooksInTransaction() const override { return true; }
     virtual EEventExtensionResponse AllowsAddition(const UFaerieItemContainerBase* Container, TConstArrayView<FFaerieItemStackView> Views, FFaerieExtensionAllowsAdditionArgs Args) const override;
     virtual void PostAddition(const UFaerieItemContainerBase* Container, const Faerie::Inventory::FEventLog& Event) override;
     virtual void PostRemoval(const UFaerieItemContainerBase* Container, const Faerie::Inventory::FEventLog& Event) override;
     virtual void PostEntryChanged(const UFaerieItemContainerBase* Container, const Faerie::Inventory::FEventLog& Event) override;
+    virtual void GetMemoryUsage(const UFaerieItemContainerBase* Container, Faerie::Memory::FReport& Report) const override;
     //~ UItemContainerExtensionBase
 
 private:
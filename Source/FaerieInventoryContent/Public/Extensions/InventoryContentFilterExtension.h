@@ -3,6 +3,7 @@
 #pragma once
 
 #include "ItemContainerExtensionBase.h"
+#include "FaerieItemDataFilterProgram.h"
 
 #include "InventoryContentFilterExtension.generated.h"
 
@@ -17,6 +18,12 @@ class FAERIEINVENTORYCONTENT_API UInventoryContentFilterExtension : public UItem
 	GENERATED_BODY()
 
 public:
+#if WITH_EDITOR
+	//~ UObject
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+	//~ UObject
+#endif
+
 	//~ UItemContainerExtensionBase
 	virtual EEventExtensionResponse AllowsAddition(const UFaerieItemContainerBase* Container, TConstArrayView<FFaerieItemStackView> Views, FFaerieExtensionAllowsAdditionArgs Args) const override;
 	//~ UItemContainerExtensionBase
@@ -25,4 +32,11 @@ protected:
 	// Filter used to determine if an item can be contained in the inventory
 	UPROPERTY(EditAnywhere, Category = "Config", meta = (DisplayThumbnail = false))
 	TObjectPtr<UFaerieItemDataFilter> Filter;
+
+private:
+	// Filter, compiled the first time it's used.
+	mutable Faerie::ItemData::FFilterProgram CompiledFilter;
+
+	// Results of running the filter on items that have been offered to us.
+	mutable Faerie::ItemData::FFilterResultCache FilterResults;
 };
\ No newline at end of file
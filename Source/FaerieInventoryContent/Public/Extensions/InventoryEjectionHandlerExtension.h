@@ -33,6 +33,7 @@ public:
 	//~ UItemContainerExtensionBase
 	virtual EEventExtensionResponse AllowsRemoval(const UFaerieItemContainerBase* Container, FFaerieAddress Address, FFaerieInventoryTag Reason) const override;
 	virtual void PostRemoval(const UFaerieItemContainerBase* Container, const Faerie::Inventory::FEventLog& Event) override;
+	virtual void GetMemoryUsage(const UFaerieItemContainerBase* Container, Faerie::Memory::FReport& Report) const override;
 	//~ UItemContainerExtensionBase
 
 private:
@@ -5,8 +5,11 @@
 #include "FaerieGridEnums.h"
 #include "FaerieGridStructs.h"
 #include "ItemContainerExtensionBase.h"
+#include "Actions/FaerieClientPrediction.h"
 #include "InventoryGridExtensionBase.generated.h"
 
+class UFaerieInventoryClient;
+
 using FFaerieGridSizeChangedNative = TMulticastDelegate<void(FIntPoint)>;
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FFaerieGridSizeChanged, FIntPoint, NewGridSize);
 
@@ -33,6 +36,8 @@ namespace Faerie
 		int32 GetNumMarked() const;
 		int32 GetNumUnmarked() const;
 
+		SIZE_T GetAllocatedSize() const;
+
 	protected:
 		// Convert a point into a grid index
 		int32 Ravel(const FIntPoint& Point) const;
@@ -66,6 +71,10 @@ protected:
 	//~ UItemContainerExtensionBase
 	virtual void InitializeExtension(const UFaerieItemContainerBase* Container) override;
 	virtual void DeinitializeExtension(const UFaerieItemContainerBase* Container) override;
+	virtual FInstancedStruct MakeTransactionSnapshot(const UFaerieItemContainerBase* Container) const override;
+	virtual void RestoreTransactionSnapshot(const UFaerieItemContainerBase* Container, const FInstancedStruct& Snapshot) override;
+	virtual bool RunsHooksInTransaction() const override { return true; }
+	virtual void GetMemoryUsage(const UFaerieItemContainerBase* Container, Faerie::Memory::FReport& Report) const override;
 	//~ UItemContainerExtensionBase
 
 	virtual void PreStackRemove_Client(const FFaerieGridKeyedStack& Stack) {}
@@ -74,6 +83,10 @@ protected:
 	virtual void PostStackAdd(const FFaerieGridKeyedStack& Stack) {}
 	virtual void PostStackChange(const FFaerieGridKeyedStack& Stack) {}
 
+	// Rebuilds OccupiedCells from GridContent. Clients don't track cells as stacks replicate, so this is used to bring
+	// them up to date when needed. By default, each stack occupies the cell at its origin.
+	virtual void RebuildOccupiedCells();
+
 public:
 	// Publicly accessible actions. Only call on server.
 	virtual FFaerieAddress GetKeyAt(const FIntPoint& Position) const PURE_VIRTUAL(UInventoryGridExtensionBase::GetKeyAt, return FFaerieAddress(); )
@@ -85,6 +98,9 @@ public:
 protected:
 	void BroadcastEvent(FFaerieAddress Address, EFaerieGridEventType EventType);
 
+	// Merges two stacks of the same entry in the storage. While predicting a move, the merge is predicted as well.
+	bool TryMergeStacks(FFaerieAddress FromAddress, FFaerieAddress ToAddress);
+
 	UFUNCTION(/* Replication */)
 	virtual void OnRep_GridSize();
 
@@ -102,6 +118,16 @@ public:
 	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Faerie|Grid")
 	void SetGridSize(const FIntPoint& NewGridSize);
 
+	// Are there moves predicted by a local client, that the server hasn't confirmed yet?
+	UFUNCTION(BlueprintCallable, Category = "Faerie|Grid")
+	bool HasPendingPredictions() const;
+
+	// Locally applies the expected result of a MoveItem request made by Client.
+	bool PredictMoveItem(UFaerieInventoryClient* Client, Faerie::ClientAction::FPredictionKey Key, FFaerieAddress Address, const FIntPoint& TargetPoint);
+
+	// Locally applies the expected result of a RotateItem request made by Client.
+	bool PredictRotateItem(UFaerieInventoryClient* Client, Faerie::ClientAction::FPredictionKey Key, FFaerieAddress Address);
+
 	FFaerieGridStackChangedNative::RegistrationType& GetOnSpatialStackChanged() { return SpatialStackChangedNative; }
 	FFaerieGridSizeChangedNative::RegistrationType& GetOnGridSizeChanged() { return GridSizeChangedNative; }
 
@@ -132,4 +158,26 @@ private:
 
 	FFaerieGridStackChangedNative SpatialStackChangedNative;
 	FFaerieGridSizeChangedNative GridSizeChangedNative;
+
+	// Replication hooks for client prediction.
+	void RecordReplicatedStack(const FFaerieGridKeyedStack& Stack, bool Removed);
+	void PostContentReplicated();
+	void PreStackEdit(const FFaerieGridKeyedStack& Stack);
+
+	bool PredictEdit(UFaerieInventoryClient* Client, Faerie::ClientAction::FPredictionKey Key, TFunctionRef<bool()> Edit);
+	void OnPredictionResolved(Faerie::ClientAction::FPredictionKey Key, bool Accepted);
+	void ReconcilePrediction();
+
+	// Moves predicted by a local client, that the server hasn't confirmed yet. Only used on clients.
+	Faerie::ClientAction::TPredictedItems<FFaerieGridKeyedStack> Prediction;
+	Faerie::ClientAction::FPredictionListener PredictionListener;
+
+	// Set while a predicted edit is being made, so that storage edits it causes can be predicted under the same key.
+	struct FActivePrediction
+	{
+		UFaerieInventoryClient* Client = nullptr;
+		Faerie::ClientAction::FPredictionKey Key = 0;
+		bool PredictedStorage = false;
+	};
+	FActivePrediction ActivePrediction;
 };
\ No newline at end of file
@@ -51,15 +51,15 @@ protected:
 	virtual bool AddItemToGrid(FFaerieAddress Address, const UFaerieItem* Item) override;
 	virtual bool MoveItem(FFaerieAddress Address, const FIntPoint& TargetPoint) override;
 	virtual bool RotateItem(FFaerieAddress Address) override;
+
+	// The client has to manually rebuild its cell after a removal, as the item's shape is likely lost.
+	virtual void RebuildOccupiedCells() override;
 	//~ UInventoryGridExtensionBase
 
 private:
 	void RemoveItem(FFaerieAddress Address, const UFaerieItem* Item);
 	void RemoveItemBatch(const TConstArrayView<FFaerieAddress>& Addresses, const UFaerieItem* Item);
 
-	// The client has to manually rebuild its cell after a removal, as the item's shape is likely lost.
-	void RebuildOccupiedCells();
-
 	// Gets a shape from a shape token on the item, or returns a single cell at 0,0 for items with no token.
 	FFaerieGridShapeConstView GetItemShape_Impl(const UFaerieItem* Item) const;
 	FFaerieGridShapeConstView GetItemShape_Impl(FFaerieAddress Address) const;
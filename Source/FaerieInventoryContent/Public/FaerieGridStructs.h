@@ -119,6 +119,13 @@ public:
 		return FScopedStackHandle(Key, *this);
 	}
 
+	// Keeps the listener's copy of replicated state up to date, while it has predicted edits. Only called by replication.
+	void RecordReplicatedStack(const FFaerieGridKeyedStack& Stack, bool Removed) const;
+
+	// Lets the listener copy a stack before a handle edits it, in case the edit is being predicted.
+	void PreStackEdit(const FFaerieGridKeyedStack& Stack) const;
+	void PostReplicatedReceive(const FPostReplicatedReceiveParameters& Parameters) const;
+
 	void PreStackReplicatedRemove(const FFaerieGridKeyedStack& Stack) const;
 	void PostStackReplicatedAdd(const FFaerieGridKeyedStack& Stack) const;
 	void PostStackReplicatedChange(const FFaerieGridKeyedStack& Stack) const;
@@ -0,0 +1,85 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "FaerieItemContainerStructs.h"
+#include "GameplayTagContainer.h"
+#include "ItemSlotHandle.h"
+#include "UObject/ObjectKey.h"
+
+class UFaerieItemRecipe;
+class UFaerieItemStorage;
+class UFaerieItemTemplate;
+
+namespace Faerie::Crafting
+{
+	struct FRecipeSlotCandidates
+	{
+		FFaerieItemSlotHandle Slot;
+		bool Optional = false;
+
+		// Addresses in the storage whose stack matches the slot's template.
+		TArray<FFaerieAddress> Addresses;
+	};
+
+	struct FCraftableRecipe
+	{
+		const UFaerieItemRecipe* Recipe = nullptr;
+
+		// Required slots first, then optional ones. Optional slots are included even when nothing matches them.
+		TArray<FRecipeSlotCandidates> Slots;
+	};
+
+	/**
+	 * Answers which recipes can be crafted from a storage, without matching every stack against every slot.
+	 * The slot templates of each recipe are reduced once, when added, to the token classes and tags that an item must
+	 * have to fill them. A query only matches the entries that have all of these, which is answered by the storage's
+	 * token index when it keeps one. Templates shared by several recipes are only matched once per query.
+	 * Recipes and templates are not kept alive by the index, and must be added again if their slots are edited.
+	 */
+	class FAERIEINVENTORYCONTENT_API FRecipeIndex
+	{
+	public:
+		void Add(const UFaerieItemRecipe* Recipe);
+		void Remove(const UFaerieItemRecipe* Recipe);
+		void Reset();
+
+		int32 Num() const { return Recipes.Num(); }
+
+		// Find every recipe whose required slots can each be filled from Storage, along with the addresses that match
+		// each slot. Slots are matched independently, so the same stack may be offered for more than one slot.
+		TArray<FCraftableRecipe> FindCraftable(const UFaerieItemStorage* Storage) const;
+
+		SIZE_T GetAllocatedSize() const;
+
+	private:
+		int32 FindOrAddTemplate(const UFaerieItemTemplate* Template);
+		void MatchTemplate(const UFaerieItemStorage* Storage, int32 Index, TArray<FFaerieAddress>& OutAddresses) const;
+
+		struct FTemplateKeys
+		{
+			TWeakObjectPtr<const UFaerieItemTemplate> Template;
+
+			// What an item must have to match the template. See FFilterProgram::GetRequirements.
+			TArray<const UClass*> TokenClasses;
+			FGameplayTagContainer Tags;
+		};
+
+		struct FSlot
+		{
+			FFaerieItemSlotHandle Handle;
+			int32 Template = INDEX_NONE;
+			bool Optional = false;
+		};
+
+		struct FRecipeRow
+		{
+			TWeakObjectPtr<const UFaerieItemRecipe> Recipe;
+			TArray<FSlot> Slots;
+		};
+
+		TArray<FRecipeRow> Recipes;
+		TArray<FTemplateKeys> Templates;
+		TMap<TObjectKey<UFaerieItemTemplate>, int32> TemplateLookup;
+	};
+}
@@ -4,6 +4,7 @@
 
 #include "Blueprint/UserWidget.h"
 #include "FaerieItemStorage.h"
+#include "FaerieSortedAddressView.h"
 #include "FaerieStorageWidgetBase.generated.h"
 
 class UFaerieItemStorageQuery;
@@ -20,6 +21,10 @@ class FAERIEINVENTORYCONTENT_API UFaerieStorageWidgetBase : public UUserWidget
 public:
 	UFaerieStorageWidgetBase(const FObjectInitializer& ObjectInitializer);
 
+	//~ UObject
+	static void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector);
+	//~ UObject
+
 	virtual bool Initialize() override;
 	virtual void NativeConstruct() override;
 	virtual void NativeDestruct() override;
@@ -27,6 +32,7 @@ public:
 
 protected:
 	virtual void Reset();
+	void SyncSortedAddresses();
 	virtual void HandleAddressEvent(UFaerieItemStorage* Storage, const EFaerieAddressEventType Type, TConstArrayView<FFaerieAddress> Addresses);
 
 public:
@@ -50,6 +56,21 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Faerie|StorageWidget")
 	void RequestResort();
 
+	// Index of an address in the sorted and filtered rows, or -1 if it isn't displayed.
+	UFUNCTION(BlueprintCallable, Category = "Faerie|StorageWidget")
+	int32 GetSortedIndex(FFaerieAddress Address) const;
+
+	// Number of sorted and filtered rows, whether or not they are copied to SortedAndFilteredAddresses.
+	UFUNCTION(BlueprintCallable, Category = "Faerie|StorageWidget")
+	int32 GetSortedCount() const;
+
+	/**
+	 * Get a window of the sorted and filtered rows, e.g., only those currently scrolled into view. Costs O(log n + Count),
+	 * regardless of how large the storage is. Returns the total number of rows.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Faerie|StorageWidget")
+	int32 GetAddressPage(int32 Start, int32 Count, TArray<FFaerieAddress>& Addresses) const;
+
 protected:
 	UFUNCTION(BlueprintImplementableEvent, Category = "Faerie|StorageWidget")
 	void OnInitWithInventory();
@@ -57,6 +78,14 @@ protected:
 	UFUNCTION(BlueprintImplementableEvent, Category = "Faerie|StorageWidget")
 	void DisplayAddresses();
 
+	/**
+	 * Called once a frame when rows have been inserted, removed, or moved since the last display, instead of redisplaying
+	 * everything. SortedAndFilteredAddresses is already up to date when this is called. Override to update only the rows
+	 * that changed; by default this calls DisplayAddresses.
+	 */
+	UFUNCTION(BlueprintNativeEvent, Category = "Faerie|StorageWidget")
+	void DisplayChanges(const TArray<FFaerieSortedViewChange>& Changes);
+
 	UFUNCTION(BlueprintImplementableEvent, Category = "Faerie|StorageWidget")
 	void OnReset();
 
@@ -80,9 +109,15 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Config")
 	bool bAlwaysAddNewToSortOrder = true;
 
+	// Don't copy every row into SortedAndFilteredAddresses. Enable this for storage with many entries, where only the
+	// rows on screen are displayed, and request them with GetAddressPage instead.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Config")
+	bool bVirtualizeRows = false;
+
 
 	/// ***		RUNTIME		*** ///
 
+	// Every displayed address, in order. Left empty when bVirtualizeRows is enabled.
 	UPROPERTY(BlueprintReadOnly, Category = "Runtime")
 	TArray<FFaerieAddress> SortedAndFilteredAddresses;
 
@@ -94,6 +129,10 @@ protected:
 	TWeakObjectPtr<UFaerieItemStorage> ItemStorage;
 
 private:
+	// The sorted rows this widget displays. Unless rows are virtualized, SortedAndFilteredAddresses is copied from this
+	// once per frame. Its snapshots are reported in AddReferencedObjects.
+	Faerie::Storage::FSortedAddressView SortedView;
+
 	bool NeedsResort = false;
 	bool NeedsReconstructEntries = false;
 };
\ No newline at end of file
@@ -2,12 +2,18 @@
 
 #include "FaerieCardGenerator.h"
 #include "CardTokens/FaerieItemCardToken.h"
+#include "FaerieDataSystemTrace.h"
 #include "FaerieItem.h"
 #include "FaerieItemCardLog.h"
 #include "Engine/AssetManager.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(FaerieCardGenerator)
 
+DECLARE_STATS_GROUP(TEXT("FaerieItemCard"), STATGROUP_FaerieItemCard, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Generate Card (Sync)"), STAT_Card_Generate, STATGROUP_FaerieItemCard);
+DECLARE_CYCLE_STAT(TEXT("Generate Card (Async Request)"), STAT_Card_GenerateAsync, STATGROUP_FaerieItemCard);
+DECLARE_CYCLE_STAT(TEXT("Card Class Loaded"), STAT_Card_ClassLoaded, STATGROUP_FaerieItemCard);
+
 TSoftClassPtr<UFaerieCardBase> UFaerieCardGenerator::GetCardClassFromProxy(const FFaerieItemProxy Proxy, const FFaerieItemCardType& Type) const
 {
 	auto&& Item = Proxy.GetItemObject();
@@ -44,6 +50,8 @@ TSoftClassPtr<UFaerieCardBase> UFaerieCardGenerator::GetCardClassFromProxy(const
 
 UFaerieCardBase* UFaerieCardGenerator::Generate(const Faerie::Card::FSyncGeneration& Params)
 {
+	FAERIE_SCOPE_CYCLE_COUNTER(STAT_Card_Generate);
+
 	if (!Params.Proxy.IsValid() ||
 		!IsValid(Params.Player) ||
 		!Params.Tag.IsValid())
@@ -69,6 +77,8 @@ UFaerieCardBase* UFaerieCardGenerator::Generate(const Faerie::Card::FSyncGenerat
 
 void UFaerieCardGenerator::GenerateAsync(const Faerie::Card::FAsyncGeneration& Params)
 {
+	FAERIE_SCOPE_CYCLE_COUNTER(STAT_Card_GenerateAsync);
+
 	if (!Params.Proxy.IsValid() ||
 		!Params.Player.IsValid() ||
 		!Params.Tag.IsValid())
@@ -92,6 +102,8 @@ void UFaerieCardGenerator::GenerateAsync(const Faerie::Card::FAsyncGeneration& P
 
 void UFaerieCardGenerator::OnCardClassLoaded(FAsyncCallback Params)
 {
+	FAERIE_SCOPE_CYCLE_COUNTER(STAT_Card_ClassLoaded);
+
 	if (const TSubclassOf<UFaerieCardBase> LoadedClass = Params.CardClass.Get();
 		IsValid(LoadedClass) && Params.Player.IsValid())
 	{
@@ -1,6 +1,7 @@
 ﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
 
 #include "FaerieHashStatics.h"
+#include "FaerieDataSystemTrace.h"
 #include "FaerieItem.h"
 #include "FaerieItemStackHashInstruction.h"
 #include "FaerieItemTokenFilter.h"
@@ -13,6 +14,11 @@
 #define COMBINING_HASHING_SEED 561333781
 #define UNSET_OPTIONAL_SEED 21294577
 
+DECLARE_STATS_GROUP(TEXT("FaerieItemData"), STATGROUP_FaerieItemData, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Hash Struct By Props"), STAT_Hash_StructByProps, STATGROUP_FaerieItemData);
+DECLARE_CYCLE_STAT(TEXT("Hash Object By Props"), STAT_Hash_ObjectByProps, STATGROUP_FaerieItemData);
+DECLARE_CYCLE_STAT(TEXT("Hash Item Set"), STAT_Hash_ItemSet, STATGROUP_FaerieItemData);
+
 namespace Faerie::Hash
 {
 	[[nodiscard]] uint32 Combine(const uint32 A, const uint32 B)
@@ -151,6 +157,7 @@ namespace Faerie::Hash
 
 	uint32 HashStructByProps(const void* Ptr, const UScriptStruct* Struct, const bool IncludeSuper)
 	{
+		FAERIE_SCOPE_CYCLE_COUNTER(STAT_Hash_StructByProps);
 		check(Ptr);
 		check(Struct);
 		return HashProps(Ptr, Struct, IncludeSuper);
@@ -158,6 +165,7 @@ namespace Faerie::Hash
 
 	uint32 HashObjectByProps(const UObject* Obj, const bool IncludeSuper)
 	{
+		FAERIE_SCOPE_CYCLE_COUNTER(STAT_Hash_ObjectByProps);
 		check(Obj);
 		return HashProps(Obj, Obj->GetClass(), IncludeSuper);
 	}
@@ -165,6 +173,8 @@ namespace Faerie::Hash
 	FFaerieHash HashItemSet(const TSet<const UFaerieItem*>& Items,
 							const FItemHashFunction& Function)
 	{
+		FAERIE_SCOPE_CYCLE_COUNTER(STAT_Hash_ItemSet);
+
 		TArray<uint32> Hashes;
 
 		for (const UFaerieItem* Item : Items)
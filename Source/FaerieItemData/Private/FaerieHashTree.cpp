@@ -0,0 +1,203 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "FaerieHashTree.h"
+#include "FaerieHashStatics.h"
+#include "Algo/BinarySearch.h"
+
+// WARNING: Changing this will invalidate existing hashes generated with FHashTree.
+#define BUCKET_HASHING_SEED 792641117
+
+namespace Faerie::Hash
+{
+	FHashTree::FHashTree(const int32 InWidthLog2)
+	  : WidthLog2(FMath::Clamp(InWidthLog2, 0, 16)),
+		BucketCount(1 << WidthLog2)
+	{
+		Buckets.SetNum(BucketCount);
+		BucketSums.SetNumZeroed(BucketCount);
+		Nodes.SetNumZeroed(BucketCount * 2 - 1);
+		DirtyBuckets.Init(false, BucketCount);
+	}
+
+	void FHashTree::SetLeaf(const uint32 LeafID, const uint32 Hash)
+	{
+		const int32 BucketIndex = GetBucketIndex(LeafID);
+		TArray<FLeaf>& Bucket = Buckets[BucketIndex];
+
+		const int32 Index = Algo::LowerBoundBy(Bucket, LeafID, &FLeaf::ID);
+		if (Bucket.IsValidIndex(Index) && Bucket[Index].ID == LeafID)
+		{
+			if (Bucket[Index].Hash == Hash)
+			{
+				// Nothing changed, so the path doesn't need to be rehashed.
+				return;
+			}
+			BucketSums[BucketIndex] -= HashLeaf(Bucket[Index]);
+			Bucket[Index].Hash = Hash;
+			BucketSums[BucketIndex] += HashLeaf(Bucket[Index]);
+		}
+		else
+		{
+			const FLeaf& Leaf = Bucket.Insert_GetRef({ LeafID, Hash }, Index);
+			BucketSums[BucketIndex] += HashLeaf(Leaf);
+			LeafCount++;
+		}
+
+		MarkBucketDirty(BucketIndex);
+	}
+
+	bool FHashTree::RemoveLeaf(const uint32 LeafID)
+	{
+		const int32 BucketIndex = GetBucketIndex(LeafID);
+		TArray<FLeaf>& Bucket = Buckets[BucketIndex];
+
+		const int32 Index = Algo::BinarySearchBy(Bucket, LeafID, &FLeaf::ID);
+		if (Index == INDEX_NONE)
+		{
+			return false;
+		}
+
+		BucketSums[BucketIndex] -= HashLeaf(Bucket[Index]);
+		Bucket.RemoveAt(Index);
+		LeafCount--;
+		MarkBucketDirty(BucketIndex);
+		return true;
+	}
+
+	const uint32* FHashTree::FindLeaf(const uint32 LeafID) const
+	{
+		const TArray<FLeaf>& Bucket = Buckets[GetBucketIndex(LeafID)];
+		if (const int32 Index = Algo::BinarySearchBy(Bucket, LeafID, &FLeaf::ID);
+			Index != INDEX_NONE)
+		{
+			return &Bucket[Index].Hash;
+		}
+		return nullptr;
+	}
+
+	void FHashTree::Reset()
+	{
+		for (TArray<FLeaf>& Bucket : Buckets)
+		{
+			Bucket.Reset();
+		}
+		FMemory::Memzero(BucketSums.GetData(), BucketSums.Num() * sizeof(uint32));
+		FMemory::Memzero(Nodes.GetData(), Nodes.Num() * sizeof(uint32));
+		DirtyBuckets.SetRange(0, BucketCount, false);
+		HasDirtyBuckets = false;
+		LeafCount = 0;
+	}
+
+	FFaerieHash FHashTree::GetRoot() const
+	{
+		UpdateDirtyPaths();
+		return FFaerieHash(Nodes[0]);
+	}
+
+	void FHashTree::Diff(const FHashTree& Other, TArray<uint32>& OutLeafIDs) const
+	{
+		if (!ensureMsgf(Other.BucketCount == BucketCount, TEXT("Cannot diff hash trees of different widths!")))
+		{
+			return;
+		}
+
+		UpdateDirtyPaths();
+		Other.UpdateDirtyPaths();
+		DiffNode(Other, 0, OutLeafIDs);
+	}
+
+	int32 FHashTree::GetBucketIndex(const uint32 LeafID) const
+	{
+		// Leaf IDs are typically either sequential keys or hashes, both of which distribute well by their low bits.
+		return LeafID & (BucketCount - 1);
+	}
+
+	uint32 FHashTree::HashLeaf(const FLeaf& Leaf)
+	{
+		return Combine(Leaf.ID, Leaf.Hash);
+	}
+
+	void FHashTree::MarkBucketDirty(const int32 BucketIndex)
+	{
+		DirtyBuckets[BucketIndex] = true;
+		HasDirtyBuckets = true;
+	}
+
+	void FHashTree::UpdateDirtyPaths() const
+	{
+		if (!HasDirtyBuckets)
+		{
+			return;
+		}
+
+		const int32 FirstBucketNode = BucketCount - 1;
+
+		for (TConstSetBitIterator<> It(DirtyBuckets); It; ++It)
+		{
+			// The bucket sum is already up to date, so only the path needs rehashing.
+			const uint32 BucketHash = Buckets[It.GetIndex()].IsEmpty() ? 0 :
+				Combine(BUCKET_HASHING_SEED, BucketSums[It.GetIndex()]);
+
+			int32 NodeIndex = FirstBucketNode + It.GetIndex();
+			Nodes[NodeIndex] = BucketHash;
+
+			// Walk up to the root, rehashing each parent.
+			while (NodeIndex > 0)
+			{
+				NodeIndex = (NodeIndex - 1) / 2;
+				const uint32 Left = Nodes[NodeIndex * 2 + 1];
+				const uint32 Right = Nodes[NodeIndex * 2 + 2];
+				Nodes[NodeIndex] = (Left == 0 && Right == 0) ? 0 : Combine(Left, Right);
+			}
+		}
+
+		DirtyBuckets.SetRange(0, BucketCount, false);
+		HasDirtyBuckets = false;
+	}
+
+	void FHashTree::DiffNode(const FHashTree& Other, const int32 NodeIndex, TArray<uint32>& OutLeafIDs) const
+	{
+		if (Nodes[NodeIndex] == Other.Nodes[NodeIndex])
+		{
+			return;
+		}
+
+		const int32 FirstBucketNode = BucketCount - 1;
+
+		if (NodeIndex < FirstBucketNode)
+		{
+			DiffNode(Other, NodeIndex * 2 + 1, OutLeafIDs);
+			DiffNode(Other, NodeIndex * 2 + 2, OutLeafIDs);
+			return;
+		}
+
+		// Merge the two sorted buckets to find differing leaves.
+		const TArray<FLeaf>& A = Buckets[NodeIndex - FirstBucketNode];
+		const TArray<FLeaf>& B = Other.Buckets[NodeIndex - FirstBucketNode];
+
+		int32 IndexA = 0;
+		int32 IndexB = 0;
+		while (IndexA < A.Num() || IndexB < B.Num())
+		{
+			if (IndexB >= B.Num() || (IndexA < A.Num() && A[IndexA].ID < B[IndexB].ID))
+			{
+				OutLeafIDs.Add(A[IndexA++].ID);
+			}
+			else if (IndexA >= A.Num() || B[IndexB].ID < A[IndexA].ID)
+			{
+				OutLeafIDs.Add(B[IndexB++].ID);
+			}
+			else
+			{
+				if (A[IndexA].Hash != B[IndexB].Hash)
+				{
+					OutLeafIDs.Add(A[IndexA].ID);
+				}
+				IndexA++;
+				IndexB++;
+			}
+		}
+	}
+}
+
+#undef BUCKET_HASHING_SEED
@@ -3,16 +3,23 @@
 #include "FaerieItem.h"
 #include "FaerieItemToken.h"
 #include "AssetLoadFlagFixer.h"
+#include "FaerieDataSystemTrace.h"
 #include "FaerieItemDataLog.h"
+#include "FaerieItemInternTable.h"
 #include "FaerieItemTokenFilter.h"
 #include "FaerieItemTokenFilterTypes.h"
+#include "Algo/BinarySearch.h"
 #include "Algo/Copy.h"
+#include "Algo/Sort.h"
 #include "Net/UnrealNetwork.h"
 #include "Net/Core/PushModel/PushModel.h"
 #include "UObject/ObjectSaveContext.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(FaerieItem)
 
+DECLARE_STATS_GROUP(TEXT("FaerieItemData"), STATGROUP_FaerieItemData, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Compare With"), STAT_Item_CompareWith, STATGROUP_FaerieItemData);
+
 namespace Faerie::Tags
 {
 	UE_DEFINE_GAMEPLAY_TAG(TokenAdd, "Fae.Token.Add")
@@ -32,11 +39,13 @@ void UFaerieItem::PostInitProperties()
 	Super::PostInitProperties();
 
 	CacheTokenMutability();
+	CacheTokenLookup();
 }
 
 void UFaerieItem::PreSave(FObjectPreSaveContext SaveContext)
 {
 	CacheTokenMutability();
+	CacheTokenLookup();
 
 #if WITH_EDITOR
 	// This is a random hoot I'm adding to be funny. The LastModified timestamp only really matters for mutable items,
@@ -58,6 +67,9 @@ void UFaerieItem::PostLoad()
 	// Items loaded from disk in shipping builds don't need to re-cache this.
 	CacheTokenMutability();
 #endif
+
+	// The lookup isn't saved, so it's always built for loaded items.
+	CacheTokenLookup();
 }
 
 void UFaerieItem::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
@@ -98,6 +110,8 @@ void UFaerieItem::GetReplicatedCustomConditionState(FCustomPropertyConditionStat
 
 UFaerieItem* UFaerieItem::CreateNewInstance(const TConstArrayView<UFaerieItemToken*> Tokens, const EFaerieItemInstancingMutability Mutability)
 {
+	LLM_SCOPE_BYTAG(FaerieItemData);
+
 	UFaerieItem* Instance = NewObject<UFaerieItem>();
 	EnumAddFlags(Instance->MutabilityFlags, ToFlags(Mutability) | EFaerieItemMutabilityFlags::InstanceMutability);
 	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, MutabilityFlags, Instance);
@@ -125,11 +139,13 @@ UFaerieItem* UFaerieItem::CreateNewInstance(const TConstArrayView<UFaerieItemTok
 
 	// Initialize token mutability.
 	Instance->CacheTokenMutability();
+	Instance->CacheTokenLookup();
 
 	Instance->LastModified = FDateTime::UtcNow();
 	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, LastModified, Instance);
 
-	return Instance;
+	// Immutable items are finished at this point, so share an identical instance if one already exists.
+	return ItemData::FItemInternTable::Get().Intern(Instance);
 }
 
 UFaerieItem* UFaerieItem::CreateInstance(const EFaerieItemInstancingMutability Mutability) const
@@ -168,6 +184,8 @@ UFaerieItem* UFaerieItem::CreateInstance(const EFaerieItemInstancingMutability M
 
 UFaerieItem* UFaerieItem::CreateDuplicate(const EFaerieItemInstancingMutability Mutability) const
 {
+	LLM_SCOPE_BYTAG(FaerieItemData);
+
 	UFaerieItem* Duplicate = NewObject<UFaerieItem>();
 	EnumAddFlags(Duplicate->MutabilityFlags, ToFlags(Mutability) | EFaerieItemMutabilityFlags::InstanceMutability);
 	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, MutabilityFlags, Duplicate);
@@ -190,6 +208,7 @@ UFaerieItem* UFaerieItem::CreateDuplicate(const EFaerieItemInstancingMutability
 
 	// Initialize token mutability.
 	Duplicate->CacheTokenMutability();
+	Duplicate->CacheTokenLookup();
 
 	Duplicate->LastModified = FDateTime::UtcNow();
 
@@ -208,17 +227,10 @@ const UFaerieItemToken* UFaerieItem::GetToken(const TSubclassOf<UFaerieItemToken
 		return nullptr;
 	}
 
-	if (!ensure(Class != UFaerieItemToken::StaticClass()))
-	{
-		return nullptr;
-	}
-
-	for (auto&& Token : Tokens)
+	const int32 Index = FindTokenIndex(Class);
+	if (Index != INDEX_NONE && IsValid(Tokens[Index]))
 	{
-		if (IsValid(Token) && Token.IsA(Class))
-		{
-			return Token;
-		}
+		return Tokens[Index];
 	}
 
 	return nullptr;
@@ -227,15 +239,22 @@ const UFaerieItemToken* UFaerieItem::GetToken(const TSubclassOf<UFaerieItemToken
 UFaerieItemToken* UFaerieItem::GetMutableToken(const TSubclassOf<UFaerieItemToken>& Class)
 {
 	if (!ensure(IsValid(Class)) ||
-		!ensure(Class != UFaerieItemToken::StaticClass()) ||
 		!IsDataMutable())
 	{
 		return {};
 	}
 
-	for (auto&& Token : Tokens)
+	const int32 First = FindTokenIndex(Class);
+	if (First == INDEX_NONE)
 	{
-		if (IsValid(Token) &&
+		return nullptr;
+	}
+
+	// The first token of this class is usually the one, but if it's immutable, keep looking after it.
+	for (int32 i = First; i < Tokens.Num(); ++i)
+	{
+		if (const TObjectPtr<UFaerieItemToken>& Token = Tokens[i];
+			IsValid(Token) &&
 			Token.IsA(Class) &&
 			Token->IsMutable())
 		{
@@ -254,7 +273,7 @@ bool UFaerieItem::Compare(const UFaerieItem* A, const UFaerieItem* B, const EFae
 
 bool UFaerieItem::CompareWith(const UFaerieItem* Other, const EFaerieItemComparisonFlags Flags) const
 {
-	QUICK_SCOPE_CYCLE_COUNTER(UFaerieItem_CompareWith);
+	FAERIE_SCOPE_CYCLE_COUNTER(STAT_Item_CompareWith);
 
 	// If we are the same object, then we already know we're identical
 	if (this == Other)
@@ -391,6 +410,8 @@ bool UFaerieItem::AddToken(UFaerieItemToken* Token)
 
 	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, Tokens, this);
 	Tokens.Add(Token);
+	CacheTokenLookup();
+	++MutationVersion;
 
 	(void)NotifyOwnerOfSelfMutation.ExecuteIfBound(this, Token, Tags::TokenAdd);
 	return true;
@@ -417,9 +438,11 @@ bool UFaerieItem::RemoveToken(UFaerieItemToken* Token)
 	if (!!Tokens.Remove(Token))
 	{
 		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, Tokens, this);
+		CacheTokenLookup();
 
 		LastModified = FDateTime::UtcNow();
 		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, LastModified, this);
+		++MutationVersion;
 
 		(void)NotifyOwnerOfSelfMutation.ExecuteIfBound(this, Token, Tags::TokenRemove);
 
@@ -466,9 +489,11 @@ int32 UFaerieItem::RemoveTokensByClass(const TSubclassOf<UFaerieItemToken> Class
 		}))
 	{
 		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, Tokens, this);
+		CacheTokenLookup();
 
 		LastModified = FDateTime::UtcNow();
 		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, LastModified, this);
+		++MutationVersion;
 
 		for (auto&& Token : TokensRemoved)
 		{
@@ -514,6 +539,7 @@ void UFaerieItem::OnTokenEdited(const UFaerieItemToken* Token)
 	check(CanMutate())
 	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, LastModified, this);
 	LastModified = FDateTime::UtcNow();
+	++MutationVersion;
 	(void)NotifyOwnerOfSelfMutation.ExecuteIfBound(this, Token, Tags::TokenGenericPropertyEdit);
 }
 
@@ -566,6 +592,94 @@ void UFaerieItem::CacheTokenMutability()
 	}
 }
 
+void UFaerieItem::CacheTokenLookup()
+{
+	TokenLookup.Reset();
+
+	for (int32 i = 0; i < Tokens.Num(); ++i)
+	{
+		if (!IsValid(Tokens[i])) continue;
+
+		// The base token class is included, so that asking for it finds the first token, like a scan would.
+		for (const UClass* Class = Tokens[i]->GetClass(); Class; Class = Class->GetSuperClass())
+		{
+			TokenLookup.Add({Class, i});
+			if (Class == UFaerieItemToken::StaticClass()) break;
+		}
+	}
+
+	// Sort by class, then by index, and keep only the first token of each class, as that is what GetToken returns.
+	Algo::Sort(TokenLookup,
+		[](const FTokenLookup& A, const FTokenLookup& B)
+		{
+			return A.Class != B.Class
+				? reinterpret_cast<UPTRINT>(A.Class) < reinterpret_cast<UPTRINT>(B.Class)
+				: A.Index < B.Index;
+		});
+
+	int32 NumUnique = 0;
+	for (int32 i = 0; i < TokenLookup.Num(); ++i)
+	{
+		if (NumUnique == 0 || TokenLookup[NumUnique - 1].Class != TokenLookup[i].Class)
+		{
+			TokenLookup[NumUnique++] = TokenLookup[i];
+		}
+	}
+	TokenLookup.SetNum(NumUnique);
+	TokenLookup.Shrink();
+
+	TokenLookupNum = Tokens.Num();
+}
+
+void UFaerieItem::OnRep_Tokens(const TArray<TObjectPtr<UFaerieItemToken>>& OldTokens)
+{
+	CacheTokenLookup();
+	++MutationVersion;
+
+	// Tokens that haven't replicated yet are null, and are reported once they arrive.
+	for (const UFaerieItemToken* Token : OldTokens)
+	{
+		if (IsValid(Token) && !Tokens.Contains(Token))
+		{
+			(void)NotifyOwnerOfSelfMutation.ExecuteIfBound(this, Token, Tags::TokenRemove);
+		}
+	}
+	for (const UFaerieItemToken* Token : Tokens)
+	{
+		if (IsValid(Token) && !OldTokens.Contains(Token))
+		{
+			(void)NotifyOwnerOfSelfMutation.ExecuteIfBound(this, Token, Tags::TokenAdd);
+		}
+	}
+}
+
+int32 UFaerieItem::FindTokenIndex(const UClass* Class) const
+{
+	if (TokenLookupNum == Tokens.Num())
+	{
+		const int32 LookupIndex = Algo::LowerBoundBy(TokenLookup, reinterpret_cast<UPTRINT>(Class),
+			[](const FTokenLookup& Lookup)
+			{
+				return reinterpret_cast<UPTRINT>(Lookup.Class);
+			});
+
+		if (TokenLookup.IsValidIndex(LookupIndex) && TokenLookup[LookupIndex].Class == Class)
+		{
+			return TokenLookup[LookupIndex].Index;
+		}
+		return INDEX_NONE;
+	}
+
+	for (int32 i = 0; i < Tokens.Num(); ++i)
+	{
+		if (IsValid(Tokens[i]) && Tokens[i].IsA(Class))
+		{
+			return i;
+		}
+	}
+	return INDEX_NONE;
+}
+
 #include "Libraries/FaerieItemDataLibrary.h"
 
 void UFaerieItem::FindTokens(const TSubclassOf<UFaerieItemToken> Class, TArray<UFaerieItemToken*>& FoundTokens) const
@@ -90,6 +90,7 @@ void UFaerieItemAsset::PreSave(FObjectPreSaveContext SaveContext)
 			}
 		}
 	}
+	Item->CacheTokenLookup();
 #endif
 
 	Super::PreSave(SaveContext);
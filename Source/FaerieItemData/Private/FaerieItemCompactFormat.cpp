@@ -0,0 +1,1053 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "FaerieItemCompactFormat.h"
+#include "FaerieItem.h"
+#include "FaerieItemDataLog.h"
+#include "FaerieItemInternTable.h"
+#include "FaerieItemToken.h"
+
+#include "Engine/World.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/StructuredArchive.h"
+#include "UObject/Package.h"
+#include "UObject/SoftObjectPtr.h"
+#include "UObject/UnrealType.h"
+
+// WARNING: Changing this will invalidate all existing compact saves.
+#define COMPACT_FORMAT_MAGIC 0x31534446 // 'FDS1'
+
+namespace Faerie::ItemData
+{
+	namespace Private
+	{
+		class FCompactAccess
+		{
+		public:
+			static EFaerieItemMutabilityFlags GetMutabilityFlags(const UFaerieItem* Item)
+			{
+				return Item->MutabilityFlags;
+			}
+
+			static UFaerieItem* CreateLoadedItem(const EFaerieItemMutabilityFlags Flags, const FDateTime LastModified)
+			{
+				UFaerieItem* Item = NewObject<UFaerieItem>();
+				Item->MutabilityFlags = Flags;
+				Item->LastModified = LastModified;
+				return Item;
+			}
+
+			static void AddLoadedToken(UFaerieItem* Item, UFaerieItemToken* Token)
+			{
+				Item->Tokens.Add(Token);
+			}
+
+			static void FinishLoadedItem(UFaerieItem* Item)
+			{
+				Item->CacheTokenMutability();
+				Item->CacheTokenLookup();
+			}
+		};
+	}
+
+	namespace Compact
+	{
+		enum class EItemRecord : uint8
+		{
+			// The item is written in full.
+			Inline,
+
+			// The item lives in an asset, and is written as a path.
+			Path,
+
+			// The item could not be packed, and was handed back to be saved separately.
+			Fallback
+		};
+
+		enum class ETokenRecord : uint8
+		{
+			Inline,
+			Path
+		};
+
+		static bool IsSavedProperty(const FProperty* Property)
+		{
+			return !Property->HasAnyPropertyFlags(CPF_Transient | CPF_DuplicateTransient | CPF_Deprecated);
+		}
+
+		// Can an object be found again from its path, when loading the save?
+		static bool CanWritePath(const UObject* Object, const UObject* ItemOwner)
+		{
+			// Objects that are part of the save itself are not addressable.
+			if (IsValid(ItemOwner) && Object->IsIn(ItemOwner))
+			{
+				return false;
+			}
+
+			return Object->GetPackage() != GetTransientPackage() && !Object->GetTypedOuter<UWorld>();
+		}
+
+		struct FWriteTables
+		{
+			TArray<FName> Names;
+			TMap<FName, uint32> NameLookup;
+			TArray<FString> Strings;
+			TMap<FString, uint32> StringLookup;
+
+			uint32 AddName(const FName Name)
+			{
+				if (const uint32* Existing = NameLookup.Find(Name))
+				{
+					return *Existing;
+				}
+				return NameLookup.Add(Name, Names.Add(Name));
+			}
+
+			uint32 AddString(const FString& String)
+			{
+				if (const uint32* Existing = StringLookup.Find(String))
+				{
+					return *Existing;
+				}
+				return StringLookup.Add(String, Strings.Add(String));
+			}
+		};
+
+		struct FReadTables
+		{
+			TArray<FName> Names;
+			TArray<FString> Strings;
+			// Weak, as items may be read long after the tables, and unreferenced objects could have been collected since.
+			TMap<uint32, TWeakObjectPtr<UObject>> ResolvedObjects;
+
+			UObject* ResolveObject(const uint32 StringIndex)
+			{
+				if (const TWeakObjectPtr<UObject>* Existing = ResolvedObjects.Find(StringIndex);
+					Existing && Existing->IsValid())
+				{
+					return Existing->Get();
+				}
+
+				UObject* Object = FSoftObjectPath(Strings[StringIndex]).TryLoad();
+				if (!IsValid(Object))
+				{
+					UE_LOG(LogFaerieItemData, Warning, TEXT("Compact item format: Failed to resolve object '%s'"), *Strings[StringIndex])
+				}
+				ResolvedObjects.Add(StringIndex, Object);
+				return Object;
+			}
+		};
+
+		// Archive that writes names and object references as indices into the tables.
+		class FWriterArchive final : public FMemoryWriter
+		{
+		public:
+			FWriterArchive(FWriteTables& Tables, TArray<uint8>& Bytes, const UObject* ItemOwner)
+			  : FMemoryWriter(Bytes, true),
+				Tables(Tables),
+				ItemOwner(ItemOwner) {}
+
+			virtual FString GetArchiveName() const override { return TEXT("FaerieCompactItemWriter"); }
+
+			virtual FArchive& operator<<(FName& Value) override
+			{
+				uint32 Index = Tables.AddName(Value);
+				SerializeIntPacked(Index);
+				return *this;
+			}
+
+			virtual FArchive& operator<<(UObject*& Value) override
+			{
+				// Index 0 is reserved for null.
+				uint32 Index = 0;
+				if (IsValid(Value))
+				{
+					if (CanWritePath(Value, ItemOwner))
+					{
+						Index = Tables.AddString(FSoftObjectPath(Value).ToString()) + 1;
+					}
+					else
+					{
+						HasUnsupportedReference = true;
+					}
+				}
+				SerializeIntPacked(Index);
+				return *this;
+			}
+
+			virtual FArchive& operator<<(FObjectPtr& Value) override
+			{
+				UObject* Object = Value.Get();
+				return *this << Object;
+			}
+
+			virtual FArchive& operator<<(FWeakObjectPtr& Value) override
+			{
+				UObject* Object = Value.Get();
+				return *this << Object;
+			}
+
+			virtual FArchive& operator<<(FSoftObjectPath& Value) override
+			{
+				uint32 Index = Tables.AddString(Value.ToString());
+				SerializeIntPacked(Index);
+				return *this;
+			}
+
+			virtual FArchive& operator<<(FSoftObjectPtr& Value) override
+			{
+				FSoftObjectPath Path = Value.ToSoftObjectPath();
+				return *this << Path;
+			}
+
+			virtual FArchive& operator<<(FLazyObjectPtr& Value) override
+			{
+				HasUnsupportedReference = true;
+				return *this;
+			}
+
+			// Set when a reference to an object that cannot be written as a path is encountered.
+			bool HasUnsupportedReference = false;
+
+		private:
+			FWriteTables& Tables;
+			const UObject* ItemOwner;
+		};
+
+		// Archive that reads names and object references back from the tables.
+		class FReaderArchive final : public FMemoryReaderView
+		{
+		public:
+			FReaderArchive(FReadTables& Tables, const TConstArrayView<uint8> Bytes, const FArchive* VersionSource = nullptr)
+			  : FMemoryReaderView(Bytes, true),
+				Data(Bytes),
+				Tables(Tables)
+			{
+				if (VersionSource)
+				{
+					SetUEVer(VersionSource->UEVer());
+					SetLicenseeUEVer(VersionSource->LicenseeUEVer());
+				}
+			}
+
+			virtual FString GetArchiveName() const override { return TEXT("FaerieCompactItemReader"); }
+
+			virtual FArchive& operator<<(FName& Value) override
+			{
+				uint32 Index = 0;
+				SerializeIntPacked(Index);
+				if (Tables.Names.IsValidIndex(Index))
+				{
+					Value = Tables.Names[Index];
+				}
+				else
+				{
+					Value = NAME_None;
+					SetError();
+				}
+				return *this;
+			}
+
+			virtual FArchive& operator<<(UObject*& Value) override
+			{
+				uint32 Index = 0;
+				SerializeIntPacked(Index);
+				Value = nullptr;
+				if (Index != 0)
+				{
+					if (Tables.Strings.IsValidIndex(Index - 1))
+					{
+						Value = Tables.ResolveObject(Index - 1);
+					}
+					else
+					{
+						SetError();
+					}
+				}
+				return *this;
+			}
+
+			virtual FArchive& operator<<(FObjectPtr& Value) override
+			{
+				UObject* Object = nullptr;
+				*this << Object;
+				Value = Object;
+				return *this;
+			}
+
+			virtual FArchive& operator<<(FWeakObjectPtr& Value) override
+			{
+				UObject* Object = nullptr;
+				*this << Object;
+				Value = Object;
+				return *this;
+			}
+
+			virtual FArchive& operator<<(FSoftObjectPath& Value) override
+			{
+				uint32 Index = 0;
+				SerializeIntPacked(Index);
+				if (Tables.Strings.IsValidIndex(Index))
+				{
+					Value = FSoftObjectPath(Tables.Strings[Index]);
+				}
+				else
+				{
+					Value.Reset();
+					SetError();
+				}
+				return *this;
+			}
+
+			virtual FArchive& operator<<(FSoftObjectPtr& Value) override
+			{
+				FSoftObjectPath Path;
+				*this << Path;
+				Value = Path;
+				return *this;
+			}
+
+			virtual FArchive& operator<<(FLazyObjectPtr& Value) override
+			{
+				return *this;
+			}
+
+			// Get a view of the next bytes, and skip past them. Returns an empty view and errors if out of bounds.
+			TConstArrayView<uint8> ReadSlice(const uint32 Length)
+			{
+				const int64 Start = Tell();
+				if (Start + Length > Data.Num())
+				{
+					SetError();
+					return {};
+				}
+				Seek(Start + Length);
+				return Data.Slice(Start, Length);
+			}
+
+		private:
+			TConstArrayView<uint8> Data;
+			FReadTables& Tables;
+		};
+
+		struct FWriteSchema
+		{
+			uint32 ClassIndex;
+			TArray<const FProperty*> Properties;
+		};
+
+		struct FReadSchema
+		{
+			TSubclassOf<UFaerieItemToken> Class;
+
+			// Properties that no longer exist on the class, or have changed type, are null, and will be skipped.
+			TArray<const FProperty*> Properties;
+		};
+	}
+
+	using namespace Compact;
+
+	/**
+	 * Blob layout:
+	 *	Header:  Magic, FormatVersion, Engine package versions
+	 *	Tables:  Names, Strings, Token Schemas
+	 *	Items:   Count, ByteLength, Item records
+	 *	Body:    ByteLength, Owner specific data
+	 */
+
+	class FCompactItemWriter::FImpl
+	{
+	public:
+		explicit FImpl(const UObject* ItemOwner)
+		  : ItemOwner(ItemOwner),
+			ItemArchive(Tables, ItemBytes, ItemOwner),
+			BodyArchive(Tables, BodyBytes, ItemOwner) {}
+
+		uint32 AddItem(const UFaerieItem* Item)
+		{
+			if (const uint32* Existing = ItemLookup.Find(Item))
+			{
+				return *Existing;
+			}
+
+			const uint32 Index = ItemLookup.Add(Item, ItemLookup.Num());
+			WriteItem(Item);
+			return Index;
+		}
+
+		void Finish(TArray<uint8>& OutBytes, TArray<TObjectPtr<UFaerieItem>>& OutFallbackItems)
+		{
+			OutBytes.Reset();
+			FMemoryWriter Ar(OutBytes, true);
+
+			uint32 Magic = COMPACT_FORMAT_MAGIC;
+			uint32 Version = static_cast<uint32>(ECompactFormatVersion::LatestVersion);
+			int32 FileVersionUE4 = ItemArchive.UEVer().FileVersionUE4;
+			int32 FileVersionUE5 = ItemArchive.UEVer().FileVersionUE5;
+			int32 LicenseeVersion = ItemArchive.LicenseeUEVer();
+			Ar << Magic;
+			Ar.SerializeIntPacked(Version);
+			Ar << FileVersionUE4;
+			Ar << FileVersionUE5;
+			Ar << LicenseeVersion;
+
+			uint32 NumNames = Tables.Names.Num();
+			Ar.SerializeIntPacked(NumNames);
+			for (const FName Name : Tables.Names)
+			{
+				FString NameString = Name.ToString();
+				Ar << NameString;
+			}
+
+			uint32 NumStrings = Tables.Strings.Num();
+			Ar.SerializeIntPacked(NumStrings);
+			for (FString& String : Tables.Strings)
+			{
+				Ar << String;
+			}
+
+			uint32 NumSchemas = Schemas.Num();
+			Ar.SerializeIntPacked(NumSchemas);
+			for (FWriteSchema& Schema : Schemas)
+			{
+				Ar.SerializeIntPacked(Schema.ClassIndex);
+				uint32 NumProperties = Schema.Properties.Num();
+				Ar.SerializeIntPacked(NumProperties);
+				for (const FProperty* Property : Schema.Properties)
+				{
+					// These were added to the table when the schema was made, so they don't need to be written before it.
+					uint32 NameIndex = Tables.NameLookup[Property->GetFName()];
+					uint32 TypeIndex = Tables.NameLookup[Property->GetClass()->GetFName()];
+					Ar.SerializeIntPacked(NameIndex);
+					Ar.SerializeIntPacked(TypeIndex);
+				}
+			}
+
+			uint32 NumItems = ItemLookup.Num();
+			uint32 ItemBytesNum = ItemBytes.Num();
+			Ar.SerializeIntPacked(NumItems);
+			Ar.SerializeIntPacked(ItemBytesNum);
+			Ar.Serialize(ItemBytes.GetData(), ItemBytesNum);
+
+			uint32 BodyBytesNum = BodyBytes.Num();
+			Ar.SerializeIntPacked(BodyBytesNum);
+			Ar.Serialize(BodyBytes.GetData(), BodyBytesNum);
+
+			OutFallbackItems = MoveTemp(FallbackItems);
+		}
+
+	private:
+		uint32 FindOrAddSchema(const UClass* Class)
+		{
+			if (const uint32* Existing = SchemaLookup.Find(Class))
+			{
+				return *Existing;
+			}
+
+			FWriteSchema& Schema = Schemas.AddDefaulted_GetRef();
+			Schema.ClassIndex = Tables.AddString(Class->GetPathName());
+			for (TFieldIterator<FProperty> It(Class); It; ++It)
+			{
+				if (IsSavedProperty(*It))
+				{
+					Schema.Properties.Add(*It);
+					Tables.AddName(It->GetFName());
+					Tables.AddName(It->GetClass()->GetFName());
+				}
+			}
+
+			return SchemaLookup.Add(Class, Schemas.Num() - 1);
+		}
+
+		void WriteItem(const UFaerieItem* Item)
+		{
+			if (!IsValid(Item) || CanWritePath(Item, ItemOwner))
+			{
+				uint8 Record = static_cast<uint8>(EItemRecord::Path);
+				UObject* Object = const_cast<UFaerieItem*>(Item);
+				ItemArchive << Record;
+				ItemArchive << Object;
+				return;
+			}
+
+			const int64 RecordStart = ItemArchive.Tell();
+			ItemArchive.HasUnsupportedReference = false;
+
+			WriteInlineItem(Item);
+
+			if (ItemArchive.HasUnsupportedReference)
+			{
+				// Roll back, and hand the item off to be saved with tagged property serialization instead.
+				ItemBytes.SetNum(RecordStart, EAllowShrinking::No);
+				ItemArchive.Seek(RecordStart);
+
+				uint8 Record = static_cast<uint8>(EItemRecord::Fallback);
+				uint32 FallbackIndex = FallbackItems.Add(const_cast<UFaerieItem*>(Item));
+				ItemArchive << Record;
+				ItemArchive.SerializeIntPacked(FallbackIndex);
+			}
+		}
+
+		void WriteInlineItem(const UFaerieItem* Item)
+		{
+			uint8 Record = static_cast<uint8>(EItemRecord::Inline);
+			uint8 Flags = static_cast<uint8>(Private::FCompactAccess::GetMutabilityFlags(Item));
+			int64 Ticks = Item->GetLastModified().GetTicks();
+			uint32 NumTokens = Item->GetTokens().Num();
+			ItemArchive << Record;
+			ItemArchive << Flags;
+			ItemArchive << Ticks;
+			ItemArchive.SerializeIntPacked(NumTokens);
+
+			for (const TObjectPtr<UFaerieItemToken>& TokenPtr : Item->GetTokens())
+			{
+				UFaerieItemToken* Token = TokenPtr.Get();
+
+				// Tokens not owned by this item are shared from an asset.
+				if (!IsValid(Token) || (Token->GetOuter() != Item && CanWritePath(Token, ItemOwner)))
+				{
+					uint8 TokenRecord = static_cast<uint8>(ETokenRecord::Path);
+					UObject* Object = Token;
+					ItemArchive << TokenRecord;
+					ItemArchive << Object;
+					continue;
+				}
+
+				uint8 TokenRecord = static_cast<uint8>(ETokenRecord::Inline);
+				uint32 SchemaIndex = FindOrAddSchema(Token->GetClass());
+				ItemArchive << TokenRecord;
+				ItemArchive.SerializeIntPacked(SchemaIndex);
+
+				// Only write properties that differ from the class default.
+				const UObject* Defaults = Token->GetClass()->GetDefaultObject();
+				const FWriteSchema& Schema = Schemas[SchemaIndex];
+
+				TArray<uint32, TInlineAllocator<16>> ChangedProperties;
+				for (int32 i = 0; i < Schema.Properties.Num(); ++i)
+				{
+					const FProperty* Property = Schema.Properties[i];
+					for (int32 ArrayIndex = 0; ArrayIndex < Property->ArrayDim; ++ArrayIndex)
+					{
+						if (!Property->Identical_InContainer(Token, Defaults, ArrayIndex))
+						{
+							ChangedProperties.Add(i);
+							break;
+						}
+					}
+				}
+
+				uint32 NumChanged = ChangedProperties.Num();
+				ItemArchive.SerializeIntPacked(NumChanged);
+
+				for (uint32 PropertyIndex : ChangedProperties)
+				{
+					const FProperty* Property = Schema.Properties[PropertyIndex];
+
+					// Each value is length-prefixed, so that properties that have been removed can be skipped when loading.
+					Scratch.Reset();
+					FWriterArchive ScratchArchive(Tables, Scratch, ItemOwner);
+					for (int32 ArrayIndex = 0; ArrayIndex < Property->ArrayDim; ++ArrayIndex)
+					{
+						FStructuredArchiveFromArchive Structured(ScratchArchive);
+						Property->SerializeItem(Structured.GetSlot(), Property->ContainerPtrToValuePtr<void>(Token, ArrayIndex));
+					}
+					ItemArchive.HasUnsupportedReference |= ScratchArchive.HasUnsupportedReference;
+
+					uint32 Length = Scratch.Num();
+					ItemArchive.SerializeIntPacked(PropertyIndex);
+					ItemArchive.SerializeIntPacked(Length);
+					ItemArchive.Serialize(Scratch.GetData(), Length);
+				}
+			}
+		}
+
+		const UObject* ItemOwner;
+
+		FWriteTables Tables;
+		TArray<FWriteSchema> Schemas;
+		TMap<const UClass*, uint32> SchemaLookup;
+
+		TMap<const UFaerieItem*, uint32> ItemLookup;
+		TArray<TObjectPtr<UFaerieItem>> FallbackItems;
+
+		TArray<uint8> ItemBytes;
+		TArray<uint8> BodyBytes;
+		TArray<uint8> Scratch;
+
+	public:
+		FWriterArchive ItemArchive;
+		FWriterArchive BodyArchive;
+	};
+
+	class FCompactItemReader::FImpl
+	{
+	public:
+		FImpl(TArray<uint8>&& InBytes, TArray<TObjectPtr<UFaerieItem>>&& InFallbackItems)
+		  : Bytes(MoveTemp(InBytes)),
+			FallbackItems(MoveTemp(InFallbackItems))
+		{
+			FReaderArchive Ar(Tables, Bytes);
+
+			TConstArrayView<uint8> BodyBytes;
+			uint32 NumItems = 0;
+
+			if (ReadHeaderAndTables(Ar))
+			{
+				uint32 ItemBytesNum = 0;
+				Ar.SerializeIntPacked(NumItems);
+				Ar.SerializeIntPacked(ItemBytesNum);
+				ItemBytes = Ar.ReadSlice(ItemBytesNum);
+
+				uint32 BodyBytesNum = 0;
+				Ar.SerializeIntPacked(BodyBytesNum);
+				BodyBytes = Ar.ReadSlice(BodyBytesNum);
+			}
+
+			Error = Ar.IsError();
+			PackageVersion = Ar.UEVer();
+			LicenseeVersion = Ar.LicenseeUEVer();
+
+			if (!Error)
+			{
+				// Only index where each record starts. Items are created the first time they are asked for.
+				FReaderArchive ItemArchive(Tables, ItemBytes, &Ar);
+				ItemOffsets.Reserve(NumItems);
+				for (uint32 i = 0; i < NumItems && !ItemArchive.IsError(); ++i)
+				{
+					ItemOffsets.Add(ItemArchive.Tell());
+					SkipItem(ItemArchive);
+				}
+				Error = ItemArchive.IsError();
+			}
+
+			if (Error)
+			{
+				UE_LOG(LogFaerieItemData, Error, TEXT("Compact item format: Failed to read data!"))
+				ItemOffsets.Reset();
+				ItemBytes = {};
+				BodyBytes = {};
+			}
+
+			LoadedItems.SetNum(ItemOffsets.Num());
+			BodyArchive = MakeUnique<FReaderArchive>(Tables, BodyBytes, &Ar);
+		}
+
+		UFaerieItem* GetItem(const uint32 Index)
+		{
+			if (!ItemOffsets.IsValidIndex(Index))
+			{
+				return nullptr;
+			}
+
+			// Items are only weakly held, so if the caller let go of an item, it will simply be read again.
+			if (UFaerieItem* Loaded = LoadedItems[Index].Get())
+			{
+				return Loaded;
+			}
+
+			FReaderArchive ItemArchive(Tables, ItemBytes);
+			ItemArchive.SetUEVer(PackageVersion);
+			ItemArchive.SetLicenseeUEVer(LicenseeVersion);
+			ItemArchive.Seek(ItemOffsets[Index]);
+
+			UFaerieItem* Item = ReadItem(ItemArchive);
+			if (ItemArchive.IsError())
+			{
+				UE_LOG(LogFaerieItemData, Error, TEXT("Compact item format: Failed to read item '%u'"), Index)
+				return nullptr;
+			}
+
+			LoadedItems[Index] = Item;
+			return Item;
+		}
+
+		bool IsItemLoaded(const uint32 Index) const
+		{
+			if (!ItemOffsets.IsValidIndex(Index))
+			{
+				return false;
+			}
+
+			// Fallback items already exist, so they never need loading.
+			return LoadedItems[Index].IsValid() ||
+				static_cast<EItemRecord>(ItemBytes[ItemOffsets[Index]]) == EItemRecord::Fallback;
+		}
+
+		bool ReadHeaderAndTables(FReaderArchive& Ar)
+		{
+			uint32 Magic = 0;
+			Ar << Magic;
+			if (Magic != COMPACT_FORMAT_MAGIC)
+			{
+				Ar.SetError();
+				return false;
+			}
+
+			uint32 RawVersion = 0;
+			Ar.SerializeIntPacked(RawVersion);
+			if (RawVersion < static_cast<uint32>(ECompactFormatVersion::Initial) ||
+				RawVersion > static_cast<uint32>(ECompactFormatVersion::LatestVersion))
+			{
+				UE_LOG(LogFaerieItemData, Error, TEXT("Compact item format: Unknown version '%u'"), RawVersion)
+				Ar.SetError();
+				return false;
+			}
+			Version = static_cast<ECompactFormatVersion>(RawVersion);
+
+			int32 FileVersionUE4 = 0;
+			int32 FileVersionUE5 = 0;
+			int32 LicenseeVersion = 0;
+			Ar << FileVersionUE4;
+			Ar << FileVersionUE5;
+			Ar << LicenseeVersion;
+			Ar.SetUEVer(FPackageFileVersion(FileVersionUE4, static_cast<EUnrealEngineObjectUE5Version>(FileVersionUE5)));
+			Ar.SetLicenseeUEVer(LicenseeVersion);
+
+			// Counts are sanity checked against the remaining size, so corrupt data cannot cause huge allocations.
+			auto ReadCount = [&Ar](uint32& Count)
+				{
+					Ar.SerializeIntPacked(Count);
+					if (Count > Ar.TotalSize() - Ar.Tell())
+					{
+						Ar.SetError();
+					}
+					return !Ar.IsError();
+				};
+
+			uint32 NumNames = 0;
+			if (!ReadCount(NumNames)) return false;
+			Tables.Names.Reserve(NumNames);
+			for (uint32 i = 0; i < NumNames; ++i)
+			{
+				FString NameString;
+				Ar << NameString;
+				Tables.Names.Add(FName(*NameString));
+			}
+
+			uint32 NumStrings = 0;
+			if (!ReadCount(NumStrings)) return false;
+			Tables.Strings.Reserve(NumStrings);
+			for (uint32 i = 0; i < NumStrings; ++i)
+			{
+				Ar << Tables.Strings.AddDefaulted_GetRef();
+			}
+
+			uint32 NumSchemas = 0;
+			if (!ReadCount(NumSchemas)) return false;
+			Schemas.Reserve(NumSchemas);
+			for (uint32 i = 0; i < NumSchemas; ++i)
+			{
+				FReadSchema& Schema = Schemas.AddDefaulted_GetRef();
+
+				uint32 ClassIndex = 0;
+				Ar.SerializeIntPacked(ClassIndex);
+				if (!Tables.Strings.IsValidIndex(ClassIndex))
+				{
+					Ar.SetError();
+					return false;
+				}
+
+				Schema.Class = FSoftClassPath(Tables.Strings[ClassIndex]).TryLoadClass<UFaerieItemToken>();
+				if (!IsValid(Schema.Class))
+				{
+					UE_LOG(LogFaerieItemData, Warning, TEXT("Compact item format: Token class '%s' no longer exists. Tokens of this class will be dropped."),
+						*Tables.Strings[ClassIndex])
+				}
+
+				uint32 NumProperties = 0;
+				if (!ReadCount(NumProperties)) return false;
+				Schema.Properties.Reserve(NumProperties);
+				for (uint32 j = 0; j < NumProperties; ++j)
+				{
+					uint32 NameIndex = 0;
+					uint32 TypeIndex = 0;
+					Ar.SerializeIntPacked(NameIndex);
+					Ar.SerializeIntPacked(TypeIndex);
+					if (!Tables.Names.IsValidIndex(NameIndex) || !Tables.Names.IsValidIndex(TypeIndex))
+					{
+						Ar.SetError();
+						return false;
+					}
+
+					const FProperty* Property = nullptr;
+					if (IsValid(Schema.Class))
+					{
+						Property = FindFProperty<FProperty>(Schema.Class, Tables.Names[NameIndex]);
+						if (Property && (Property->GetClass()->GetFName() != Tables.Names[TypeIndex] || !IsSavedProperty(Property)))
+						{
+							Property = nullptr;
+						}
+					}
+					Schema.Properties.Add(Property);
+				}
+			}
+
+			return !Ar.IsError();
+		}
+
+		// Walk past an item record without creating anything.
+		void SkipItem(FReaderArchive& Ar)
+		{
+			uint8 Record = 0;
+			Ar << Record;
+
+			switch (static_cast<EItemRecord>(Record))
+			{
+			case EItemRecord::Inline:
+				{
+					uint8 Flags = 0;
+					int64 Ticks = 0;
+					uint32 NumTokens = 0;
+					Ar << Flags;
+					Ar << Ticks;
+					Ar.SerializeIntPacked(NumTokens);
+
+					for (uint32 i = 0; i < NumTokens && !Ar.IsError(); ++i)
+					{
+						uint8 TokenRecord = 0;
+						uint32 Index = 0;
+						Ar << TokenRecord;
+						Ar.SerializeIntPacked(Index);
+						if (static_cast<ETokenRecord>(TokenRecord) == ETokenRecord::Path)
+						{
+							continue;
+						}
+
+						uint32 NumProperties = 0;
+						Ar.SerializeIntPacked(NumProperties);
+						for (uint32 j = 0; j < NumProperties && !Ar.IsError(); ++j)
+						{
+							uint32 PropertyIndex = 0;
+							uint32 Length = 0;
+							Ar.SerializeIntPacked(PropertyIndex);
+							Ar.SerializeIntPacked(Length);
+							Ar.ReadSlice(Length);
+						}
+					}
+					break;
+				}
+			case EItemRecord::Path:
+			case EItemRecord::Fallback:
+				{
+					uint32 Index = 0;
+					Ar.SerializeIntPacked(Index);
+					break;
+				}
+			default:
+				Ar.SetError();
+			}
+		}
+
+		UFaerieItem* ReadItem(FReaderArchive& Ar)
+		{
+			uint8 Record = 0;
+			Ar << Record;
+
+			switch (static_cast<EItemRecord>(Record))
+			{
+			case EItemRecord::Inline:
+				return ReadInlineItem(Ar);
+			case EItemRecord::Path:
+				{
+					UObject* Object = nullptr;
+					Ar << Object;
+					return Cast<UFaerieItem>(Object);
+				}
+			case EItemRecord::Fallback:
+				{
+					uint32 FallbackIndex = 0;
+					Ar.SerializeIntPacked(FallbackIndex);
+					if (FallbackItems.IsValidIndex(FallbackIndex))
+					{
+						return FallbackItems[FallbackIndex];
+					}
+					UE_LOG(LogFaerieItemData, Error, TEXT("Compact item format: Missing fallback item '%u'"), FallbackIndex)
+					return nullptr;
+				}
+			default:
+				Ar.SetError();
+				return nullptr;
+			}
+		}
+
+		UFaerieItem* ReadInlineItem(FReaderArchive& Ar)
+		{
+			uint8 Flags = 0;
+			int64 Ticks = 0;
+			uint32 NumTokens = 0;
+			Ar << Flags;
+			Ar << Ticks;
+			Ar.SerializeIntPacked(NumTokens);
+
+			UFaerieItem* Item = Private::FCompactAccess::CreateLoadedItem(static_cast<EFaerieItemMutabilityFlags>(Flags), FDateTime(Ticks));
+
+			for (uint32 i = 0; i < NumTokens && !Ar.IsError(); ++i)
+			{
+				uint8 TokenRecord = 0;
+				Ar << TokenRecord;
+
+				if (static_cast<ETokenRecord>(TokenRecord) == ETokenRecord::Path)
+				{
+					UObject* Object = nullptr;
+					Ar << Object;
+					if (UFaerieItemToken* Token = Cast<UFaerieItemToken>(Object))
+					{
+						Private::FCompactAccess::AddLoadedToken(Item, Token);
+					}
+					continue;
+				}
+
+				uint32 SchemaIndex = 0;
+				Ar.SerializeIntPacked(SchemaIndex);
+				if (!Schemas.IsValidIndex(SchemaIndex))
+				{
+					Ar.SetError();
+					break;
+				}
+
+				const FReadSchema& Schema = Schemas[SchemaIndex];
+				UFaerieItemToken* Token = IsValid(Schema.Class) ? NewObject<UFaerieItemToken>(Item, Schema.Class) : nullptr;
+
+				uint32 NumProperties = 0;
+				Ar.SerializeIntPacked(NumProperties);
+				for (uint32 j = 0; j < NumProperties && !Ar.IsError(); ++j)
+				{
+					uint32 PropertyIndex = 0;
+					uint32 Length = 0;
+					Ar.SerializeIntPacked(PropertyIndex);
+					Ar.SerializeIntPacked(Length);
+					const TConstArrayView<uint8> PropertyBytes = Ar.ReadSlice(Length);
+
+					if (!Token || !Schema.Properties.IsValidIndex(PropertyIndex))
+					{
+						continue;
+					}
+
+					if (const FProperty* Property = Schema.Properties[PropertyIndex])
+					{
+						FReaderArchive PropertyArchive(Tables, PropertyBytes, &Ar);
+						for (int32 ArrayIndex = 0; ArrayIndex < Property->ArrayDim; ++ArrayIndex)
+						{
+							FStructuredArchiveFromArchive Structured(PropertyArchive);
+							Property->SerializeItem(Structured.GetSlot(), Property->ContainerPtrToValuePtr<void>(Token, ArrayIndex));
+						}
+
+						if (PropertyArchive.IsError())
+						{
+							// Bad data for one property shouldn't take down the whole save. Reset it to default.
+							UE_LOG(LogFaerieItemData, Warning, TEXT("Compact item format: Failed to read property '%s' on '%s'"),
+								*Property->GetName(), *Schema.Class->GetName())
+							Property->CopyCompleteValue_InContainer(Token, Schema.Class->GetDefaultObject());
+						}
+					}
+				}
+
+				if (Token)
+				{
+					Private::FCompactAccess::AddLoadedToken(Item, Token);
+				}
+			}
+
+			Private::FCompactAccess::FinishLoadedItem(Item);
+
+			// Merge immutable items with identical ones that are already loaded.
+			return FItemInternTable::Get().Intern(Item);
+		}
+
+		TArray<uint8> Bytes;
+		TConstArrayView<uint8> ItemBytes;
+		TArray<int64> ItemOffsets;
+		TArray<TWeakObjectPtr<UFaerieItem>> LoadedItems;
+
+		FReadTables Tables;
+		TArray<FReadSchema> Schemas;
+		TArray<TObjectPtr<UFaerieItem>> FallbackItems;
+		TUniquePtr<FReaderArchive> BodyArchive;
+		FPackageFileVersion PackageVersion;
+		int32 LicenseeVersion = 0;
+		ECompactFormatVersion Version = ECompactFormatVersion::LatestVersion;
+		bool Error = false;
+	};
+
+	FCompactItemWriter::FCompactItemWriter(const UObject* ItemOwner)
+	  : Impl(MakeUnique<FImpl>(ItemOwner)) {}
+
+	FCompactItemWriter::~FCompactItemWriter() = default;
+
+	uint32 FCompactItemWriter::AddItem(const UFaerieItem* Item)
+	{
+		return Impl->AddItem(Item);
+	}
+
+	FArchive& FCompactItemWriter::GetBodyArchive()
+	{
+		return Impl->BodyArchive;
+	}
+
+	void FCompactItemWriter::Finish(TArray<uint8>& OutBytes, TArray<TObjectPtr<UFaerieItem>>& OutFallbackItems)
+	{
+		Impl->Finish(OutBytes, OutFallbackItems);
+	}
+
+	FCompactItemReader::FCompactItemReader(TArray<uint8> Bytes, TArray<TObjectPtr<UFaerieItem>> FallbackItems)
+	{
+		LLM_SCOPE_BYTAG(FaerieItemData);
+		Impl = MakeUnique<FImpl>(MoveTemp(Bytes), MoveTemp(FallbackItems));
+	}
+
+	FCompactItemReader::~FCompactItemReader() = default;
+
+	bool FCompactItemReader::HasError() const
+	{
+		return Impl->Error;
+	}
+
+	ECompactFormatVersion FCompactItemReader::GetVersion() const
+	{
+		return Impl->Version;
+	}
+
+	int32 FCompactItemReader::NumItems() const
+	{
+		return Impl->ItemOffsets.Num();
+	}
+
+	const UFaerieItem* FCompactItemReader::GetItem(const uint32 Index)
+	{
+		LLM_SCOPE_BYTAG(FaerieItemData);
+		return Impl->GetItem(Index);
+	}
+
+	bool FCompactItemReader::IsItemLoaded(const uint32 Index) const
+	{
+		return Impl->IsItemLoaded(Index);
+	}
+
+	FArchive& FCompactItemReader::GetBodyArchive()
+	{
+		return *Impl->BodyArchive;
+	}
+
+	SIZE_T FCompactItemReader::GetAllocatedSize() const
+	{
+		SIZE_T Size = sizeof(FImpl);
+		Size += Impl->Bytes.GetAllocatedSize();
+		Size += Impl->ItemOffsets.GetAllocatedSize();
+		Size += Impl->LoadedItems.GetAllocatedSize();
+		Size += Impl->Tables.Names.GetAllocatedSize();
+		Size += Impl->Tables.Strings.GetAllocatedSize();
+		for (const FString& String : Impl->Tables.Strings)
+		{
+			Size += String.GetAllocatedSize();
+		}
+		Size += Impl->Tables.ResolvedObjects.GetAllocatedSize();
+		Size += Impl->Schemas.GetAllocatedSize();
+		for (const FReadSchema& Schema : Impl->Schemas)
+		{
+			Size += Schema.Properties.GetAllocatedSize();
+		}
+		Size += Impl->FallbackItems.GetAllocatedSize();
+		return Size;
+	}
+}
+
+#undef COMPACT_FORMAT_MAGIC
@@ -1,6 +1,7 @@
 ﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
 
 #include "FaerieItemDataFilter.h"
+#include "FaerieItemDataFilterProgram.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(FaerieItemDataFilter)
 
@@ -21,4 +22,9 @@ bool UFaerieItemDataFilter::ExecWithLog(const FFaerieItemStackView View,
 	}
 
 	return Result;
+}
+
+void UFaerieItemDataFilter::Compile(Faerie::ItemData::FFilterCompiler& Compiler) const
+{
+	Compiler.EmitCall(this);
 }
\ No newline at end of file
@@ -0,0 +1,564 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "FaerieItemDataFilterProgram.h"
+#include "FaerieItemDataFilter.h"
+#include "FaerieItemToken.h"
+#include "Tokens/FaerieTagToken.h"
+
+namespace Faerie::ItemData
+{
+	// Rules nested deeper than this are called instead of compiled.
+	static constexpr int32 MaxCompileDepth = 64;
+
+	// Result caches are cleared once they grow past this, which drops results for items that no longer exist, or have
+	// mutated since.
+	static constexpr int32 MaxCachedResults = 8192;
+
+	struct FFilterProgram::FItemContext
+	{
+		const UFaerieItem* Item = nullptr;
+		const FGameplayTagContainer* ItemTags = nullptr;
+		uint64 TokenMask = 0;
+		bool HasTokenMask = false;
+		bool HasItemTags = false;
+
+		void SetItem(const UFaerieItem* InItem)
+		{
+			if (InItem != Item)
+			{
+				*this = FItemContext();
+				Item = InItem;
+			}
+		}
+	};
+
+	FFilterProgram FFilterProgram::Compile(const UFaerieItemDataFilter* Filter)
+	{
+		FFilterProgram Program;
+		FFilterCompiler Compiler(Program);
+		Compiler.Compile(Filter);
+		Compiler.Finish();
+		return Program;
+	}
+
+	void FFilterProgram::Reset()
+	{
+		Code.Empty();
+		TokenClasses.Empty();
+		Tags.Empty();
+		Natives.Empty();
+		Calls.Empty();
+		DependsOnCopies = false;
+	}
+
+	bool FFilterProgram::Exec(const FFaerieItemStackView& View) const
+	{
+		FItemContext Context;
+		Context.SetItem(View.Item.Get());
+		return Run(View, Context);
+	}
+
+	void FFilterProgram::ExecBatch(const TConstArrayView<FFaerieItemStackView> Views, TBitArray<>& OutResults) const
+	{
+		OutResults.Init(false, Views.Num());
+
+		FItemContext Context;
+		for (int32 i = 0; i < Views.Num(); ++i)
+		{
+			Context.SetItem(Views[i].Item.Get());
+			if (Run(Views[i], Context))
+			{
+				OutResults[i] = true;
+			}
+		}
+	}
+
+	bool FFilterProgram::ExecAll(const TConstArrayView<FFaerieItemStackView> Views) const
+	{
+		FItemContext Context;
+		for (const FFaerieItemStackView& View : Views)
+		{
+			Context.SetItem(View.Item.Get());
+			if (!Run(View, Context))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void FFilterProgram::GetRequirements(TArray<const UClass*>& OutTokenClasses, FGameplayTagContainer& OutTags) const
+	{
+		// Walk the leading tests that are each followed by a jump to the end on failure, or are the last instruction.
+		// Jumps only go forward, so nothing can enter this run part way through.
+		for (int32 Cursor = 0; Cursor < Code.Num(); Cursor += 2)
+		{
+			if (Cursor + 1 < Code.Num() &&
+				(Code[Cursor + 1].Op != EFilterOp::JumpIfFalse || Code[Cursor + 1].Operand < Code.Num()))
+			{
+				return;
+			}
+
+			const FFilterInstruction& Instruction = Code[Cursor];
+			switch (Instruction.Op)
+			{
+			case EFilterOp::HasTokens:
+				for (int32 i = 0; i < TokenClasses.Num(); ++i)
+				{
+					if (Instruction.Mask & (uint64(1) << i))
+					{
+						OutTokenClasses.AddUnique(TokenClasses[i]);
+					}
+				}
+				break;
+			case EFilterOp::TagsAll:
+				OutTags.AppendTags(Tags[Instruction.Index]);
+				break;
+			case EFilterOp::Not:
+			case EFilterOp::Jump:
+			case EFilterOp::JumpIfFalse:
+			case EFilterOp::JumpIfTrue:
+				return;
+			default:
+				// Tests that don't read tokens or tags still have to pass, but can't narrow anything down.
+				break;
+			}
+		}
+	}
+
+	SIZE_T FFilterProgram::GetAllocatedSize() const
+	{
+		SIZE_T Size = Code.GetAllocatedSize() + TokenClasses.GetAllocatedSize() + Tags.GetAllocatedSize() +
+			Natives.GetAllocatedSize() + Calls.GetAllocatedSize();
+		for (const FGameplayTagContainer& Container : Tags)
+		{
+			Size += Container.Num() * sizeof(FGameplayTag);
+		}
+		return Size;
+	}
+
+	bool FFilterProgram::Run(const FFaerieItemStackView& View, FItemContext& Context) const
+	{
+		const FFilterInstruction* Instructions = Code.GetData();
+		const int32 NumInstructions = Code.Num();
+
+		bool Result = false;
+		int32 Cursor = 0;
+		while (Cursor < NumInstructions)
+		{
+			const FFilterInstruction& Instruction = Instructions[Cursor++];
+			switch (Instruction.Op)
+			{
+			case EFilterOp::Literal:
+				Result = Instruction.Operand != 0;
+				break;
+			case EFilterOp::Not:
+				Result = !Result;
+				break;
+			case EFilterOp::Jump:
+				Cursor = Instruction.Operand;
+				break;
+			case EFilterOp::JumpIfFalse:
+				if (!Result) Cursor = Instruction.Operand;
+				break;
+			case EFilterOp::JumpIfTrue:
+				if (Result) Cursor = Instruction.Operand;
+				break;
+			case EFilterOp::HasTokens:
+				{
+					if (!Context.HasTokenMask && Context.Item)
+					{
+						// Match the item's tokens against every class in the program at once.
+						for (const UFaerieItemToken* Token : Context.Item->GetTokens())
+						{
+							if (!IsValid(Token)) continue;
+
+							const UClass* TokenClass = Token->GetClass();
+							for (int32 i = 0; i < TokenClasses.Num(); ++i)
+							{
+								if (TokenClass->IsChildOf(TokenClasses[i]))
+								{
+									Context.TokenMask |= uint64(1) << i;
+								}
+							}
+						}
+						Context.HasTokenMask = true;
+					}
+					Result = Context.Item && (Context.TokenMask & Instruction.Mask) == Instruction.Mask;
+				}
+				break;
+			case EFilterOp::CompareCopies:
+				Result = CompareValues(View.Copies, Instruction.Compare, Instruction.Operand);
+				break;
+			case EFilterOp::Mutable:
+				Result = Context.Item && Context.Item->CanMutate() == (Instruction.Operand != 0);
+				break;
+			case EFilterOp::TagsAny:
+			case EFilterOp::TagsAll:
+				{
+					if (!Context.HasItemTags && Context.Item)
+					{
+						if (const UFaerieTagToken* TagToken = Context.Item->GetToken<UFaerieTagToken>())
+						{
+							Context.ItemTags = &TagToken->GetTags();
+						}
+						Context.HasItemTags = true;
+					}
+
+					if (Context.ItemTags)
+					{
+						Result = Instruction.Op == EFilterOp::TagsAny
+							? Context.ItemTags->HasAny(Tags[Instruction.Index])
+							: Context.ItemTags->HasAll(Tags[Instruction.Index]);
+					}
+					else
+					{
+						Result = false;
+					}
+				}
+				break;
+			case EFilterOp::Native:
+				Result = Natives[Instruction.Index](View, Instruction.Compare, Instruction.Operand);
+				break;
+			case EFilterOp::Call:
+				Result = Calls[Instruction.Index]->Exec(View);
+				break;
+			default:
+				checkNoEntry();
+				return false;
+			}
+		}
+
+		return Result;
+	}
+
+	bool FFilterResultCache::FindOrExec(const FFilterProgram& Program, const FFaerieItemStackView& View)
+	{
+		const UFaerieItem* Item = View.Item.Get();
+		if (!IsValid(Item) || !Program.IsCacheable())
+		{
+			return Program.Exec(View);
+		}
+
+		const FKey Key{Item, Program.ReadsCopies() ? View.Copies : 0};
+		const bool Mutable = Item->CanMutate();
+		const uint32 Version = Mutable ? Item->GetMutationVersion() : 0;
+		const int64 Modified = Mutable ? Item->GetLastModified().GetTicks() : 0;
+
+		if (const FResult* Result = Results.Find(Key);
+			Result && Result->Version == Version && Result->Modified == Modified)
+		{
+			return Result->Passed;
+		}
+
+		if (Results.Num() >= MaxCachedResults)
+		{
+			Results.Reset();
+		}
+
+		const bool Passed = Program.Exec(View);
+		Results.Add(Key, FResult{Version, Modified, Passed});
+		return Passed;
+	}
+
+	void FFilterCompiler::Compile(const UFaerieItemDataFilter* Rule)
+	{
+		if (!IsValid(Rule))
+		{
+			EmitLiteral(false);
+			return;
+		}
+
+		if (Depth >= MaxCompileDepth)
+		{
+			EmitCall(Rule);
+			return;
+		}
+
+		++Depth;
+		Rule->Compile(*this);
+		--Depth;
+	}
+
+	void FFilterCompiler::CompileAnd(const TConstArrayView<TObjectPtr<UFaerieItemDataFilter>> Rules)
+	{
+		CompileJunction(Rules, false);
+	}
+
+	void FFilterCompiler::CompileOr(const TConstArrayView<TObjectPtr<UFaerieItemDataFilter>> Rules)
+	{
+		CompileJunction(Rules, true);
+	}
+
+	void FFilterCompiler::CompileNot(const UFaerieItemDataFilter* Rule)
+	{
+		const int32 Start = Program.Code.Num();
+		Compile(Rule);
+
+		if (bool Value; IsConstant(Start, Value))
+		{
+			Truncate(Start);
+			EmitLiteral(!Value);
+			return;
+		}
+
+		Emit(EFilterOp::Not);
+	}
+
+	void FFilterCompiler::CompileSelect(const UFaerieItemDataFilter* Condition, const UFaerieItemDataFilter* TrueRule,
+										const UFaerieItemDataFilter* FalseRule)
+	{
+		CompileSelectImpl(Condition,
+			[this, TrueRule]{ Compile(TrueRule); },
+			[this, FalseRule]{ Compile(FalseRule); });
+	}
+
+	void FFilterCompiler::CompileSelect(const UFaerieItemDataFilter* Condition, const UFaerieItemDataFilter* TrueRule,
+										const bool FalseResult)
+	{
+		CompileSelectImpl(Condition,
+			[this, TrueRule]{ Compile(TrueRule); },
+			[this, FalseResult]{ EmitLiteral(FalseResult); });
+	}
+
+	void FFilterCompiler::EmitLiteral(const bool Value)
+	{
+		Emit(EFilterOp::Literal, Value ? 1 : 0);
+	}
+
+	void FFilterCompiler::EmitCompareCopies(const EFilterCompare Compare, const int32 Amount)
+	{
+		Program.Code[Emit(EFilterOp::CompareCopies, Amount)].Compare = Compare;
+	}
+
+	void FFilterCompiler::EmitMutable(const bool Mutable)
+	{
+		Emit(EFilterOp::Mutable, Mutable ? 1 : 0);
+	}
+
+	void FFilterCompiler::EmitTags(const FGameplayTagContainer& Tags, const bool All)
+	{
+		// Nothing can have any of no tags.
+		if (!All && Tags.IsEmpty())
+		{
+			EmitLiteral(false);
+			return;
+		}
+
+		int32 Index = Program.Tags.IndexOfByKey(Tags);
+		if (Index == INDEX_NONE)
+		{
+			Index = Program.Tags.Add(Tags);
+		}
+
+		Program.Code[Emit(All ? EFilterOp::TagsAll : EFilterOp::TagsAny)].Index = static_cast<uint16>(Index);
+	}
+
+	void FFilterCompiler::EmitNative(const FNativeFilterRule Rule, const EFilterCompare Compare, const int32 Operand)
+	{
+		int32 Index = Program.Natives.Find(Rule);
+		if (Index == INDEX_NONE)
+		{
+			Index = Program.Natives.Add(Rule);
+		}
+
+		FFilterInstruction& Instruction = Program.Code[Emit(EFilterOp::Native, Operand)];
+		Instruction.Compare = Compare;
+		Instruction.Index = static_cast<uint16>(Index);
+	}
+
+	void FFilterCompiler::EmitCall(const UFaerieItemDataFilter* Rule)
+	{
+		if (!IsValid(Rule))
+		{
+			EmitLiteral(false);
+			return;
+		}
+
+		const int32 Index = Program.Calls.AddUnique(Rule);
+		Program.Code[Emit(EFilterOp::Call)].Index = static_cast<uint16>(Index);
+	}
+
+	bool FFilterCompiler::EmitHasTokens(const TConstArrayView<TSubclassOf<UFaerieItemToken>> Classes)
+	{
+		int32 NumNewClasses = 0;
+		for (const TSubclassOf<UFaerieItemToken>& Class : Classes)
+		{
+			if (!Program.TokenClasses.Contains(Class.Get()))
+			{
+				++NumNewClasses;
+			}
+		}
+
+		if (Program.TokenClasses.Num() + NumNewClasses > 64)
+		{
+			return false;
+		}
+
+		uint64 Mask = 0;
+		for (const TSubclassOf<UFaerieItemToken>& Class : Classes)
+		{
+			// No token is an instance of nothing.
+			if (!IsValid(Class))
+			{
+				EmitLiteral(false);
+				return true;
+			}
+
+			Mask |= uint64(1) << Program.TokenClasses.AddUnique(Class.Get());
+		}
+
+		if (Mask == 0)
+		{
+			EmitLiteral(true);
+			return true;
+		}
+
+		Program.Code[Emit(EFilterOp::HasTokens)].Mask = Mask;
+		return true;
+	}
+
+	void FFilterCompiler::Finish()
+	{
+		TArray<FFilterInstruction>& Code = Program.Code;
+
+		// Jumps that land on another jump, which will be taken, or skipped, with the same result, can go straight to
+		// where that one ends up.
+		for (FFilterInstruction& Instruction : Code)
+		{
+			if (Instruction.Op != EFilterOp::Jump &&
+				Instruction.Op != EFilterOp::JumpIfFalse &&
+				Instruction.Op != EFilterOp::JumpIfTrue)
+			{
+				continue;
+			}
+
+			for (int32 Hops = 0; Hops < Code.Num() && Code.IsValidIndex(Instruction.Operand); ++Hops)
+			{
+				const FFilterInstruction& Target = Code[Instruction.Operand];
+				if (Target.Op == EFilterOp::Jump || Target.Op == Instruction.Op)
+				{
+					Instruction.Operand = Target.Operand;
+				}
+				else if (Instruction.Op != EFilterOp::Jump &&
+						 (Target.Op == EFilterOp::JumpIfFalse || Target.Op == EFilterOp::JumpIfTrue))
+				{
+					// The opposite jump is never taken.
+					Instruction.Operand += 1;
+				}
+				else
+				{
+					break;
+				}
+			}
+		}
+
+		Program.DependsOnCopies = Code.ContainsByPredicate(
+			[](const FFilterInstruction& Instruction)
+			{
+				return Instruction.Op == EFilterOp::CompareCopies ||
+					   Instruction.Op == EFilterOp::Native ||
+					   Instruction.Op == EFilterOp::Call;
+			});
+
+		Code.Shrink();
+		Program.TokenClasses.Shrink();
+		Program.Tags.Shrink();
+		Program.Natives.Shrink();
+		Program.Calls.Shrink();
+	}
+
+	int32 FFilterCompiler::Emit(const EFilterOp Op, const int32 Operand)
+	{
+		FFilterInstruction Instruction;
+		Instruction.Op = Op;
+		Instruction.Operand = Operand;
+		return Program.Code.Add(Instruction);
+	}
+
+	void FFilterCompiler::CompileSelectImpl(const UFaerieItemDataFilter* Condition, const TFunctionRef<void()> CompileTrue,
+											const TFunctionRef<void()> CompileFalse)
+	{
+		const int32 Start = Program.Code.Num();
+		Compile(Condition);
+
+		// Only one branch can ever run.
+		if (bool Value; IsConstant(Start, Value))
+		{
+			Truncate(Start);
+			Value ? CompileTrue() : CompileFalse();
+			return;
+		}
+
+		const int32 ToFalse = Emit(EFilterOp::JumpIfFalse);
+		CompileTrue();
+		const int32 ToEnd = Emit(EFilterOp::Jump);
+		PatchJumps(MakeArrayView(&ToFalse, 1));
+		CompileFalse();
+		PatchJumps(MakeArrayView(&ToEnd, 1));
+	}
+
+	void FFilterCompiler::CompileJunction(const TConstArrayView<TObjectPtr<UFaerieItemDataFilter>> Rules, const bool ShortCircuitValue)
+	{
+		const int32 Start = Program.Code.Num();
+		TArray<int32, TInlineAllocator<8>> Exits;
+
+		for (const UFaerieItemDataFilter* Rule : Rules)
+		{
+			const int32 RuleStart = Program.Code.Num();
+			Compile(Rule);
+
+			if (bool Value; IsConstant(RuleStart, Value))
+			{
+				if (Value == ShortCircuitValue)
+				{
+					// This rule decides the result by itself, and nothing after it can run.
+					Truncate(Start);
+					EmitLiteral(ShortCircuitValue);
+					return;
+				}
+
+				// This rule can't change the result.
+				Truncate(RuleStart);
+				continue;
+			}
+
+			Exits.Add(Emit(ShortCircuitValue ? EFilterOp::JumpIfTrue : EFilterOp::JumpIfFalse));
+		}
+
+		if (Exits.IsEmpty())
+		{
+			// Every rule was constant without deciding anything.
+			EmitLiteral(!ShortCircuitValue);
+			return;
+		}
+
+		// The last rule's result is the result, so it doesn't need to jump out.
+		Truncate(Exits.Pop());
+		PatchJumps(Exits);
+	}
+
+	bool FFilterCompiler::IsConstant(const int32 Start, bool& OutValue) const
+	{
+		if (Program.Code.Num() == Start + 1 &&
+			Program.Code[Start].Op == EFilterOp::Literal)
+		{
+			OutValue = Program.Code[Start].Operand != 0;
+			return true;
+		}
+		return false;
+	}
+
+	void FFilterCompiler::Truncate(const int32 Start)
+	{
+		Program.Code.SetNum(Start, EAllowShrinking::No);
+	}
+
+	void FFilterCompiler::PatchJumps(const TConstArrayView<int32> Jumps)
+	{
+		for (const int32 Jump : Jumps)
+		{
+			Program.Code[Jump].Operand = Program.Code.Num();
+		}
+	}
+}
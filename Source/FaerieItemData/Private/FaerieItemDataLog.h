@@ -2,6 +2,10 @@
 
 #pragma once
 
+#include "HAL/LowLevelMemTracker.h"
 #include "Logging/LogMacros.h"
 
 DEFINE_LOG_CATEGORY_STATIC(LogFaerieItemData, Log, All);
+
+// Items, tokens, and the tables that create or share them.
+LLM_DECLARE_TAG(FaerieItemData);
@@ -1,8 +1,12 @@
 ﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
 
 #include "FaerieItemDataModule.h"
+#include "FaerieDataSystemMemory.h"
+#include "FaerieItemDataLog.h"
 #include "Modules/ModuleManager.h"
 
+FAERIE_LLM_DEFINE_TAG(FaerieItemData);
+
 #define LOCTEXT_NAMESPACE "FaerieItemDataModule"
 
 void FFaerieItemDataModule::StartupModule()
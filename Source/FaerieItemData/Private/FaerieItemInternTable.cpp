@@ -0,0 +1,250 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "FaerieItemInternTable.h"
+#include "FaerieDataSystemMemory.h"
+#include "FaerieDataSystemTrace.h"
+#include "FaerieHashStatics.h"
+#include "FaerieItem.h"
+#include "FaerieItemDataLog.h"
+#include "FaerieItemToken.h"
+
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeLock.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/ObjectAndNameAsStringProxyArchive.h"
+#include "UObject/Package.h"
+#include "UObject/UObjectGlobals.h"
+
+// Fingerprints are never persisted, so this can be freely changed.
+#define ITEM_FINGERPRINT_SEED 830168261
+
+DECLARE_STATS_GROUP(TEXT("FaerieItemData"), STATGROUP_FaerieItemData, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Intern Item"), STAT_InternTable_Intern, STATGROUP_FaerieItemData);
+
+static bool GInternImmutableItems = true;
+static FAutoConsoleVariableRef CVarInternImmutableItems(
+	TEXT("faerie.InternImmutableItems"),
+	GInternImmutableItems,
+	TEXT("Share a single canonical instance between immutable runtime items with identical tokens."));
+
+static Faerie::Memory::FReportSectionRegistration InternTableMemReport(TEXT("Item Intern Table"),
+	[](const TArray<FString>&, FOutputDevice& Ar)
+	{
+		const Faerie::ItemData::FItemInternTable& Table = Faerie::ItemData::FItemInternTable::Get();
+		Ar.Logf(TEXT("  %i entries, %s"), Table.Num(), *Faerie::Memory::FormatBytes(Table.GetAllocatedSize()));
+	});
+
+namespace Faerie::ItemData
+{
+	namespace Intern
+	{
+		// Tokens are shared from an asset when the item doesn't own them. Those only ever match themselves.
+		static bool IsOwnedToken(const UFaerieItem* Item, const UFaerieItemToken* Token)
+		{
+			return Token->GetOuter() == Item;
+		}
+
+		static uint32 HashTokenContent(const UFaerieItemToken* Token)
+		{
+			UClass* Class = Token->GetClass();
+
+			// Only properties that differ from the class default are written, so identical tokens produce identical bytes.
+			TArray<uint8> Bytes;
+			FMemoryWriter Writer(Bytes);
+			FObjectAndNameAsStringProxyArchive Ar(Writer, false);
+			Class->SerializeTaggedProperties(Ar, reinterpret_cast<uint8*>(const_cast<UFaerieItemToken*>(Token)), Class,
+				reinterpret_cast<uint8*>(Class->GetDefaultObject()));
+
+			return Hash::Combine(GetTypeHash(Class), FCrc::MemCrc32(Bytes.GetData(), Bytes.Num()));
+		}
+
+		static bool AreTokensIdentical(const UFaerieItemToken* A, const UFaerieItemToken* B)
+		{
+			if (A->GetClass() != B->GetClass())
+			{
+				return false;
+			}
+
+			for (TFieldIterator<FProperty> It(A->GetClass()); It; ++It)
+			{
+				if (It->HasAnyPropertyFlags(CPF_Transient | CPF_DuplicateTransient))
+				{
+					continue;
+				}
+
+				for (int32 ArrayIndex = 0; ArrayIndex < It->ArrayDim; ++ArrayIndex)
+				{
+					if (!It->Identical_InContainer(A, B, ArrayIndex, PPF_DeepComparison))
+					{
+						return false;
+					}
+				}
+			}
+
+			return true;
+		}
+	}
+
+	FItemInternTable& FItemInternTable::Get()
+	{
+		static FItemInternTable Table;
+		return Table;
+	}
+
+	FItemInternTable::FItemInternTable()
+	{
+		FCoreUObjectDelegates::GetPostGarbageCollect().AddRaw(this, &FItemInternTable::Prune);
+	}
+
+	bool FItemInternTable::IsEnabled()
+	{
+		return GInternImmutableItems;
+	}
+
+	bool FItemInternTable::CanIntern(const UFaerieItem* Item)
+	{
+		return IsValid(Item) &&
+			!Item->CanMutate() &&
+			Item->IsInstanceMutable() &&
+			Item->GetOuter() == GetTransientPackage();
+	}
+
+	UFaerieItem* FItemInternTable::Intern(UFaerieItem* Item)
+	{
+		if (!IsEnabled() || !CanIntern(Item))
+		{
+			return Item;
+		}
+
+		FAERIE_SCOPE_CYCLE_COUNTER(STAT_InternTable_Intern);
+		LLM_SCOPE_BYTAG(FaerieItemData);
+
+		const uint32 Hash = Fingerprint(Item);
+
+		FScopeLock ScopeLock(&Lock);
+
+		if (UFaerieItem* Existing = FindImpl(Item, Hash))
+		{
+			return Existing;
+		}
+
+		Items.Add(Hash, Item);
+		return Item;
+	}
+
+	UFaerieItem* FItemInternTable::Find(const UFaerieItem* Item) const
+	{
+		if (!CanIntern(Item))
+		{
+			return nullptr;
+		}
+
+		const uint32 Hash = Fingerprint(Item);
+
+		FScopeLock ScopeLock(&Lock);
+		return FindImpl(Item, Hash);
+	}
+
+	int32 FItemInternTable::Num() const
+	{
+		FScopeLock ScopeLock(&Lock);
+		return Items.Num();
+	}
+
+	SIZE_T FItemInternTable::GetAllocatedSize() const
+	{
+		FScopeLock ScopeLock(&Lock);
+		return Items.GetAllocatedSize();
+	}
+
+	void FItemInternTable::Prune()
+	{
+		FScopeLock ScopeLock(&Lock);
+		for (auto It = Items.CreateIterator(); It; ++It)
+		{
+			if (!It.Value().IsValid())
+			{
+				It.RemoveCurrent();
+			}
+		}
+		Items.Compact();
+	}
+
+	uint32 FItemInternTable::Fingerprint(const UFaerieItem* Item)
+	{
+		uint32 Hash = Hash::Combine(ITEM_FINGERPRINT_SEED, Item->IsDataMutable());
+
+		for (const TObjectPtr<UFaerieItemToken>& Token : Item->GetTokens())
+		{
+			if (!IsValid(Token))
+			{
+				Hash = Hash::Combine(Hash, 0);
+			}
+			else if (Intern::IsOwnedToken(Item, Token))
+			{
+				Hash = Hash::Combine(Hash, Intern::HashTokenContent(Token));
+			}
+			else
+			{
+				Hash = Hash::Combine(Hash, GetTypeHash(Token.Get()));
+			}
+		}
+
+		return Hash;
+	}
+
+	bool FItemInternTable::AreIdentical(const UFaerieItem* A, const UFaerieItem* B)
+	{
+		if (A == B)
+		{
+			return true;
+		}
+
+		if (A->IsDataMutable() != B->IsDataMutable())
+		{
+			return false;
+		}
+
+		const TConstArrayView<TObjectPtr<UFaerieItemToken>> TokensA = A->GetTokens();
+		const TConstArrayView<TObjectPtr<UFaerieItemToken>> TokensB = B->GetTokens();
+		if (TokensA.Num() != TokensB.Num())
+		{
+			return false;
+		}
+
+		for (int32 i = 0; i < TokensA.Num(); ++i)
+		{
+			const UFaerieItemToken* TokenA = TokensA[i];
+			const UFaerieItemToken* TokenB = TokensB[i];
+
+			if (TokenA == TokenB)
+			{
+				continue;
+			}
+
+			if (!IsValid(TokenA) || !IsValid(TokenB) ||
+				!Intern::IsOwnedToken(A, TokenA) || !Intern::IsOwnedToken(B, TokenB) ||
+				!Intern::AreTokensIdentical(TokenA, TokenB))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	UFaerieItem* FItemInternTable::FindImpl(const UFaerieItem* Item, const uint32 Hash) const
+	{
+		for (auto It = Items.CreateConstKeyIterator(Hash); It; ++It)
+		{
+			UFaerieItem* Candidate = It.Value().Get();
+			if (CanIntern(Candidate) && AreIdentical(Candidate, Item))
+			{
+				return Candidate;
+			}
+		}
+		return nullptr;
+	}
+}
+
+#undef ITEM_FINGERPRINT_SEED
@@ -1,9 +1,15 @@
 ﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
 
 #include "FaerieItemStackHashInstruction.h"
+#include "FaerieItemStackHashProgram.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(FaerieItemStackHashInstruction)
 
+void UFaerieItemStackHashInstruction::Compile(Faerie::Hash::FHashCompiler& Compiler) const
+{
+	Compiler.EmitCall(this);
+}
+
 uint32 UFaerieItemStackHashInstruction::ChildHash(const UFaerieItemStackHashInstruction* Child, const FFaerieItemStackView StackView)
 {
 	if (ensure(IsValid(Child)))
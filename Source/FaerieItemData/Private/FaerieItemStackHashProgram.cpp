@@ -0,0 +1,403 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#include "FaerieItemStackHashProgram.h"
+#include "FaerieHashStatics.h"
+#include "FaerieItem.h"
+#include "FaerieItemDataFilter.h"
+#include "FaerieItemStackHashInstruction.h"
+#include "FaerieItemToken.h"
+
+namespace Faerie::Hash
+{
+	struct FHashProgram::FItemContext
+	{
+		const UFaerieItem* Item = nullptr;
+
+		// Hash of each of the item's tokens, filled in the first time a Tokens instruction reads them.
+		TArray<uint32, TInlineAllocator<16>> TokenHashes;
+		bool HasTokenHashes = false;
+	};
+
+	FHashProgram FHashProgram::Compile(const UFaerieItemStackHashInstruction* Instruction)
+	{
+		FHashProgram Program;
+		FHashCompiler Compiler(Program);
+		Compiler.Compile(Instruction);
+		Compiler.Finish();
+		return Program;
+	}
+
+	void FHashProgram::Reset()
+	{
+		Code.Empty();
+		Filters.Empty();
+		TokenSets.Empty();
+		Calls.Empty();
+	}
+
+	uint32 FHashProgram::Exec(const FFaerieItemStackView& View) const
+	{
+		const FHashInstruction* Instructions = Code.GetData();
+		const int32 NumInstructions = Code.Num();
+
+		FItemContext Context;
+		Context.Item = View.Item.Get();
+
+		TArray<uint32, TInlineAllocator<16>> Stack;
+
+		int32 Cursor = 0;
+		while (Cursor < NumInstructions)
+		{
+			const FHashInstruction& Instruction = Instructions[Cursor++];
+			switch (Instruction.Op)
+			{
+			case EHashOp::Literal:
+				Stack.Push(Instruction.A);
+				break;
+			case EHashOp::Valid:
+				Stack.Push(View.IsValid() ? Instruction.A : Instruction.B);
+				break;
+			case EHashOp::Filter:
+				Stack.Push(Filters[Instruction.Index].Exec(View) ? Instruction.A : Instruction.B);
+				break;
+			case EHashOp::Tokens:
+				Stack.Push(HashTokens(Instruction, Context));
+				break;
+			case EHashOp::Call:
+				Stack.Push(Calls[Instruction.Index]->Hash(View));
+				break;
+			case EHashOp::Combine:
+				{
+					const uint32 Hash = Stack.Pop(EAllowShrinking::No);
+					Stack.Last() = Combine(Stack.Last(), Hash);
+				}
+				break;
+			case EHashOp::Pop:
+				Stack.Pop(EAllowShrinking::No);
+				break;
+			case EHashOp::Jump:
+				Cursor = Instruction.A;
+				break;
+			case EHashOp::JumpIfNotFailed:
+				// A failed hash is dropped, so the next one can take its place.
+				if (Stack.Last() != 0)
+				{
+					Cursor = Instruction.A;
+				}
+				else
+				{
+					Stack.Pop(EAllowShrinking::No);
+				}
+				break;
+			case EHashOp::JumpIfFilterFails:
+				if (!Filters[Instruction.Index].Exec(View))
+				{
+					Cursor = Instruction.A;
+				}
+				break;
+			default:
+				checkNoEntry();
+				return 0;
+			}
+		}
+
+		check(Stack.Num() == 1);
+		return Stack[0];
+	}
+
+	SIZE_T FHashProgram::GetAllocatedSize() const
+	{
+		SIZE_T Size = Code.GetAllocatedSize() + Filters.GetAllocatedSize() + TokenSets.GetAllocatedSize() +
+			Calls.GetAllocatedSize();
+		for (const ItemData::FFilterProgram& Filter : Filters)
+		{
+			Size += Filter.GetAllocatedSize();
+		}
+		for (const TArray<const UClass*>& Classes : TokenSets)
+		{
+			Size += Classes.GetAllocatedSize();
+		}
+		return Size;
+	}
+
+	uint32 FHashProgram::HashTokens(const FHashInstruction& Instruction, FItemContext& Context) const
+	{
+		const TArray<const UClass*>& Classes = TokenSets[Instruction.Index];
+
+		const TConstArrayView<TObjectPtr<UFaerieItemToken>> Tokens = IsValid(Context.Item)
+			? Context.Item->GetTokens()
+			: TConstArrayView<TObjectPtr<UFaerieItemToken>>();
+
+		if (!Context.HasTokenHashes)
+		{
+			Context.TokenHashes.SetNumUninitialized(Tokens.Num());
+			for (int32 i = 0; i < Tokens.Num(); ++i)
+			{
+				Context.TokenHashes[i] = IsValid(Tokens[i]) ? Tokens[i]->GetTokenHash() : 0;
+			}
+			Context.HasTokenHashes = true;
+		}
+
+		uint32 Hash = 0;
+		for (const UClass* Class : Classes)
+		{
+			bool Found = false;
+			for (int32 i = 0; i < Tokens.Num(); ++i)
+			{
+				// Null classes were compiled to UFaerieItemToken, which every token is.
+				if (IsValid(Tokens[i]) && Tokens[i]->IsA(Class))
+				{
+					Hash = Combine(Hash, Context.TokenHashes[i]);
+					Found = true;
+				}
+			}
+
+			// Classes without any tokens still add to the hash, so that which classes are missing is part of it.
+			if (!Found)
+			{
+				Hash = Combine(Hash, Instruction.A);
+			}
+		}
+		return Hash;
+	}
+
+	void FHashCompiler::Compile(const UFaerieItemStackHashInstruction* Instruction)
+	{
+		if (!IsValid(Instruction))
+		{
+			EmitLiteral(0);
+			return;
+		}
+
+		Instruction->Compile(*this);
+	}
+
+	void FHashCompiler::CompileCombine(const TConstArrayView<TObjectPtr<UFaerieItemStackHashInstruction>> Instructions)
+	{
+		// Leading constant instructions are combined here, and only the hash they make is emitted.
+		uint32 ConstantHash = 0;
+		bool Constant = true;
+
+		for (const UFaerieItemStackHashInstruction* Instruction : Instructions)
+		{
+			if (!Constant)
+			{
+				Compile(Instruction);
+				Emit(EHashOp::Combine);
+				continue;
+			}
+
+			const int32 Start = Program.Code.Num();
+			EmitLiteral(ConstantHash);
+			const int32 InstructionStart = Program.Code.Num();
+			Compile(Instruction);
+
+			if (uint32 Hash; IsConstant(InstructionStart, Hash))
+			{
+				Truncate(Start);
+				ConstantHash = Combine(ConstantHash, Hash);
+				continue;
+			}
+
+			Emit(EHashOp::Combine);
+			Constant = false;
+		}
+
+		if (Constant)
+		{
+			EmitLiteral(ConstantHash);
+		}
+	}
+
+	void FHashCompiler::CompileFirstNotFailed(const TConstArrayView<TObjectPtr<UFaerieItemStackHashInstruction>> Instructions)
+	{
+		TArray<int32, TInlineAllocator<8>> Exits;
+		bool Decided = false;
+
+		for (const UFaerieItemStackHashInstruction* Instruction : Instructions)
+		{
+			const int32 Start = Program.Code.Num();
+			Compile(Instruction);
+
+			if (uint32 Hash; IsConstant(Start, Hash))
+			{
+				if (Hash != 0)
+				{
+					// Nothing after this instruction can run.
+					Decided = true;
+					break;
+				}
+
+				// This instruction always fails, so it can't be picked.
+				Truncate(Start);
+				continue;
+			}
+
+			Exits.Add(Emit(EHashOp::JumpIfNotFailed));
+		}
+
+		if (!Decided)
+		{
+			if (Exits.IsEmpty())
+			{
+				EmitLiteral(0);
+				return;
+			}
+
+			// The last instruction's hash is the result, whether it failed or not, so it doesn't need to jump out.
+			Truncate(Exits.Pop());
+		}
+
+		PatchJumps(Exits);
+	}
+
+	void FHashCompiler::CompileSelect(const UFaerieItemDataFilter* Filter, const UFaerieItemStackHashInstruction* TrueInstruction,
+									  const UFaerieItemStackHashInstruction* FalseInstruction)
+	{
+		const int32 ToFalse = Emit(EHashOp::JumpIfFilterFails);
+		Program.Code[ToFalse].Index = static_cast<uint16>(AddFilter(Filter));
+		Compile(TrueInstruction);
+		const int32 ToEnd = Emit(EHashOp::Jump);
+		PatchJumps(MakeArrayView(&ToFalse, 1));
+		Compile(FalseInstruction);
+		PatchJumps(MakeArrayView(&ToEnd, 1));
+	}
+
+	void FHashCompiler::EmitLiteral(const uint32 Hash)
+	{
+		Emit(EHashOp::Literal, Hash);
+	}
+
+	void FHashCompiler::EmitValid(const uint32 ValidHash, const uint32 InvalidHash)
+	{
+		if (ValidHash == InvalidHash)
+		{
+			EmitLiteral(ValidHash);
+			return;
+		}
+
+		Emit(EHashOp::Valid, ValidHash, InvalidHash);
+	}
+
+	void FHashCompiler::EmitFilter(const UFaerieItemDataFilter* Filter, const uint32 PassHash, const uint32 FailHash)
+	{
+		if (PassHash == FailHash)
+		{
+			EmitLiteral(PassHash);
+			return;
+		}
+
+		Program.Code[Emit(EHashOp::Filter, PassHash, FailHash)].Index = static_cast<uint16>(AddFilter(Filter));
+	}
+
+	void FHashCompiler::EmitTokens(const TConstArrayView<TSubclassOf<UFaerieItemToken>> Classes, const uint32 NoTokensHash)
+	{
+		if (Classes.IsEmpty())
+		{
+			EmitLiteral(0);
+			return;
+		}
+
+		TArray<const UClass*> Set;
+		Set.Reserve(Classes.Num());
+		for (const TSubclassOf<UFaerieItemToken>& Class : Classes)
+		{
+			// Null classes don't filter out any tokens.
+			Set.Add(IsValid(Class) ? Class.Get() : UFaerieItemToken::StaticClass());
+		}
+
+		int32 Index = Program.TokenSets.IndexOfByKey(Set);
+		if (Index == INDEX_NONE)
+		{
+			Index = Program.TokenSets.Add(MoveTemp(Set));
+		}
+
+		Program.Code[Emit(EHashOp::Tokens, NoTokensHash)].Index = static_cast<uint16>(Index);
+	}
+
+	void FHashCompiler::EmitCall(const UFaerieItemStackHashInstruction* Instruction)
+	{
+		if (!IsValid(Instruction))
+		{
+			EmitLiteral(0);
+			return;
+		}
+
+		const int32 Index = Program.Calls.AddUnique(Instruction);
+		Program.Code[Emit(EHashOp::Call)].Index = static_cast<uint16>(Index);
+	}
+
+	void FHashCompiler::Finish()
+	{
+		TArray<FHashInstruction>& Code = Program.Code;
+
+		// Jumps that land on another jump can go straight to where that one ends up.
+		for (FHashInstruction& Instruction : Code)
+		{
+			if (Instruction.Op != EHashOp::Jump &&
+				Instruction.Op != EHashOp::JumpIfNotFailed)
+			{
+				continue;
+			}
+
+			for (int32 Hops = 0; Hops < Code.Num() && Code.IsValidIndex(Instruction.A); ++Hops)
+			{
+				if (Code[Instruction.A].Op != EHashOp::Jump)
+				{
+					break;
+				}
+				Instruction.A = Code[Instruction.A].A;
+			}
+		}
+
+		Code.Shrink();
+		Program.Filters.Shrink();
+		Program.TokenSets.Shrink();
+		Program.Calls.Shrink();
+		FilterSources.Empty();
+	}
+
+	int32 FHashCompiler::Emit(const EHashOp Op, const uint32 A, const uint32 B)
+	{
+		FHashInstruction Instruction;
+		Instruction.Op = Op;
+		Instruction.A = A;
+		Instruction.B = B;
+		return Program.Code.Add(Instruction);
+	}
+
+	int32 FHashCompiler::AddFilter(const UFaerieItemDataFilter* Filter)
+	{
+		int32 Index = FilterSources.Find(Filter);
+		if (Index == INDEX_NONE)
+		{
+			Index = FilterSources.Add(Filter);
+			Program.Filters.Add(ItemData::FFilterProgram::Compile(Filter));
+		}
+		return Index;
+	}
+
+	bool FHashCompiler::IsConstant(const int32 Start, uint32& OutHash) const
+	{
+		if (Program.Code.Num() == Start + 1 &&
+			Program.Code[Start].Op == EHashOp::Literal)
+		{
+			OutHash = Program.Code[Start].A;
+			return true;
+		}
+		return false;
+	}
+
+	void FHashCompiler::Truncate(const int32 Start)
+	{
+		Program.Code.SetNum(Start, EAllowShrinking::No);
+	}
+
+	void FHashCompiler::PatchJumps(const TConstArrayView<int32> Jumps)
+	{
+		for (const int32 Jump : Jumps)
+		{
+			Program.Code[Jump].A = Program.Code.Num();
+		}
+	}
+}
@@ -29,6 +29,15 @@ EDataValidationResult UFaerieItemTemplate::IsDataValid(FDataValidationContext& C
 	return Super::IsDataValid(Context);
 }
 
+void UFaerieItemTemplate::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	// Edits to any rule in the pattern are reported here, so the pattern must be compiled again.
+	CompiledPattern.Reset();
+	MatchResults.Reset();
+}
+
 #endif
 
 bool UFaerieItemTemplate::TryMatchWithDescriptions(const FFaerieItemStackView View, TArray<FText>& Errors) const
@@ -71,7 +80,13 @@ bool UFaerieItemTemplate::TryMatch(const FFaerieItemStackView View) const
 {
 	if (ensure(IsValid(Pattern)))
 	{
-		return Pattern->Exec(View);
+		if (!CompiledPattern.IsCompiled())
+		{
+			CompiledPattern = Faerie::ItemData::FFilterProgram::Compile(Pattern);
+			MatchResults.Reset();
+		}
+
+		return MatchResults.FindOrExec(CompiledPattern, View);
 	}
 	return false;
 }
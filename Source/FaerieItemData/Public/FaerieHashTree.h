@@ -0,0 +1,85 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "FaerieHash.h"
+
+namespace Faerie::Hash
+{
+	/**
+	 * An incrementally maintained hash tree (Merkle tree).
+	 * Leaves are identified by a stable ID, and distributed into a fixed number of buckets. Each bucket keeps an
+	 * order-independent sum of its leaf hashes, and buckets are combined pairwise up to a single root. Changing a leaf
+	 * adjusts its bucket's sum in constant time, and only rehashes the path from that bucket to the root.
+	 * Two trees with the same width can be compared subtree by subtree to find which leaves differ between them.
+	 */
+	class FAERIEITEMDATA_API FHashTree
+	{
+	public:
+		// Width is the Log2 of the number of buckets. Trees must have the same width to produce comparable roots.
+		explicit FHashTree(int32 WidthLog2 = 4);
+
+		// Add or update the hash for a leaf.
+		void SetLeaf(uint32 LeafID, uint32 Hash);
+
+		// Remove a leaf. Returns true if the leaf existed.
+		bool RemoveLeaf(uint32 LeafID);
+
+		// Find the current hash for a leaf.
+		const uint32* FindLeaf(uint32 LeafID) const;
+
+		// Remove all leaves.
+		void Reset();
+
+		int32 NumLeaves() const { return LeafCount; }
+		int32 GetWidthLog2() const { return WidthLog2; }
+
+		// Get the root hash of the tree. Rehashes any paths that have been invalidated since the last call.
+		[[nodiscard]] FFaerieHash GetRoot() const;
+
+		// Find the IDs of all leaves that are different, or only exist in one of the two trees.
+		// Subtrees with matching hashes are skipped entirely.
+		void Diff(const FHashTree& Other, TArray<uint32>& OutLeafIDs) const;
+
+		template <typename FuncType>
+		void ForEachLeaf(FuncType&& Func) const
+		{
+			for (auto&& Bucket : Buckets)
+			{
+				for (const FLeaf& Leaf : Bucket)
+				{
+					Func(Leaf.ID, Leaf.Hash);
+				}
+			}
+		}
+
+	private:
+		struct FLeaf
+		{
+			uint32 ID;
+			uint32 Hash;
+		};
+
+		int32 GetBucketIndex(uint32 LeafID) const;
+		static uint32 HashLeaf(const FLeaf& Leaf);
+		void MarkBucketDirty(int32 BucketIndex);
+		void UpdateDirtyPaths() const;
+		void DiffNode(const FHashTree& Other, int32 NodeIndex, TArray<uint32>& OutLeafIDs) const;
+
+		int32 WidthLog2;
+		int32 BucketCount;
+		int32 LeafCount = 0;
+
+		// Leaves, sorted by ID within each bucket.
+		TArray<TArray<FLeaf>> Buckets;
+
+		// Running sum of HashLeaf for each bucket. Addition is commutative, so a leaf can be swapped out without
+		// visiting the rest of its bucket.
+		TArray<uint32> BucketSums;
+
+		// Implicit binary tree. Node 0 is the root, and the last BucketCount nodes are the bucket hashes.
+		mutable TArray<uint32> Nodes;
+		mutable TBitArray<> DirtyBuckets;
+		mutable bool HasDirtyBuckets = false;
+	};
+}
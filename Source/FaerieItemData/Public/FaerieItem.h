@@ -21,6 +21,11 @@ namespace Faerie
 		class FIteratorAccess;
 	}
 
+	namespace ItemData::Private
+	{
+		class FCompactAccess;
+	}
+
 	namespace Tags
 	{
 		FAERIEITEMDATA_API UE_DECLARE_GAMEPLAY_TAG_EXTERN(TokenAdd)
@@ -42,6 +47,7 @@ class FAERIEITEMDATA_API UFaerieItem : public UNetSupportedObject
 	friend UFaerieItemToken;
 	friend class UFaerieItemAsset;
 	friend Faerie::Token::Private::FIteratorAccess;
+	friend Faerie::ItemData::Private::FCompactAccess;
 
 public:
 	//~ Begin UObject interface
@@ -53,6 +59,7 @@ public:
 	//~ Emd UObject interface
 
 	// Creates a new faerie item object with the given tokens. These are instance-mutable by default.
+	// Items that end up immutable are interned, and may return an existing identical item. See FItemInternTable.
 	static UFaerieItem* CreateNewInstance(TConstArrayView<UFaerieItemToken*> Tokens, EFaerieItemInstancingMutability Mutability = EFaerieItemInstancingMutability::Automatic);
 
 	// Creates a new faerie item object using this instance as a template. Instance-mutable only if required by item or flags.
@@ -67,7 +74,7 @@ public:
 	// Gets the token at a specified index. Low-level access for when you know what you are doing.
 	const UFaerieItemToken* GetTokenAtIndex(int32 Index) const;
 
-	// Gets the first token of the specified class.
+	// Gets the first token of the specified class, or a child of it.
 	const UFaerieItemToken* GetToken(const TSubclassOf<UFaerieItemToken>& Class) const;
 
 	// Gets the first token of the specified class.
@@ -118,6 +125,10 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "FaerieItem")
 	FDateTime GetLastModified() const { return LastModified; }
 
+	// Incremented each time a token is added, removed, or edited, alongside NotifyOwnerOfSelfMutation. This is local to
+	// each machine, and isn't replicated.
+	uint32 GetMutationVersion() const { return MutationVersion; }
+
 	// Can this item object be changed whatsoever at runtime? This is not available for asset-referenced or precached items.
 	UFUNCTION(BlueprintCallable, Category = "FaerieItem")
 	bool IsInstanceMutable() const;
@@ -131,17 +142,31 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "FaerieItem")
 	bool CanMutate() const;
 
+	// Memory used by the token lookup table. See CacheTokenLookup.
+	SIZE_T GetTokenLookupSize() const { return TokenLookup.GetAllocatedSize(); }
+
 protected:
 	// Called by our own tokens when they are edited.
 	void OnTokenEdited(const UFaerieItemToken* Token);
 
 	void CacheTokenMutability();
 
+	// Rebuild the table used by GetToken. Must be called whenever Tokens is changed.
+	void CacheTokenLookup();
+
+	// Clients tell their owner about tokens that replicated in or out, as they don't come through AddToken and RemoveToken.
+	UFUNCTION()
+	void OnRep_Tokens(const TArray<TObjectPtr<UFaerieItemToken>>& OldTokens);
+
+private:
+	// Index of the first token of this class, or a child of it, or INDEX_NONE.
+	int32 FindTokenIndex(const UClass* Class) const;
+
 public:
 	Faerie::FNotifyOwnerOfSelfMutation::RegistrationType& GetNotifyOwnerOfSelfMutation() { return NotifyOwnerOfSelfMutation; }
 
 protected:
-	UPROPERTY(Replicated, VisibleInstanceOnly, Category = "FaerieItem")
+	UPROPERTY(ReplicatedUsing = OnRep_Tokens, VisibleInstanceOnly, Category = "FaerieItem")
 	TArray<TObjectPtr<UFaerieItemToken>> Tokens;
 
 	// Keeps track of the last time this item was modified. Allows, for example, sorting items by recently touched.
@@ -163,6 +188,22 @@ private:
 	// Is writing to Tokens locked?
 	mutable uint32 WriteLock = 0;
 
+	uint32 MutationVersion = 0;
+
+	struct FTokenLookup
+	{
+		const UClass* Class = nullptr;
+		int32 Index = INDEX_NONE;
+	};
+
+	// Each class in the hierarchy of each token, up to UFaerieItemToken, with the index of the first token that is one.
+	// Sorted by class, so a token of any class, or a parent of its class, is found with a binary search.
+	TArray<FTokenLookup> TokenLookup;
+
+	// Number of tokens when TokenLookup was built. If Tokens was changed without rebuilding it, GetToken falls back to
+	// searching Tokens directly.
+	int32 TokenLookupNum = INDEX_NONE;
+
 protected:
 	UE_DEPRECATED(5.6, TEXT("Replaced by UFaerieItemDataLibrary::FindTokensByClass"))
 	UFUNCTION(BlueprintCallable, BlueprintPure = false, meta = (DeterminesOutputType = Class, DynamicOutputParam = FoundTokens, deprecated, DeprecationMessage = "Replaced by UFaerieItemDataLibrary::FindTokensByClass"))
@@ -0,0 +1,87 @@
+// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "Serialization/MemoryWriter.h"
+#include "UObject/ObjectPtr.h"
+
+class UFaerieItem;
+class UFaerieItemToken;
+
+namespace Faerie::ItemData
+{
+	enum class ECompactFormatVersion : uint32
+	{
+		Initial = 1,
+
+		// -----<new versions can be added above this line>-------------------------------------------------
+		VersionPlusOne,
+		LatestVersion = VersionPlusOne - 1
+	};
+
+	/**
+	 * Packs a table of items into a compact binary blob. Names, strings and object paths are written once to a table, and
+	 * referred to by index. Token properties are written against a schema that is written once per token class, and only
+	 * properties that differ from the class default are written.
+	 * Items are deduplicated by pointer, so immutable items shared by multiple stacks are only written once. Items that
+	 * live in an asset are written as a path only.
+	 * Items that cannot be packed, because their tokens own instanced sub-objects (e.g., nested containers), are instead
+	 * returned as fallback items for the caller to save with regular tagged property serialization.
+	 */
+	class FAERIEITEMDATA_API FCompactItemWriter : FNoncopyable
+	{
+	public:
+		// Objects that are inside ItemOwner are considered to be part of the save, and will not be written as paths.
+		explicit FCompactItemWriter(const UObject* ItemOwner);
+		~FCompactItemWriter();
+
+		// Get the index of an item in the item table, writing it first if it hasn't been seen yet.
+		uint32 AddItem(const UFaerieItem* Item);
+
+		// Archive for owner specific data, that follows the item table. Supports FNames and object paths.
+		FArchive& GetBodyArchive();
+
+		// Write everything out. The writer cannot be used after this.
+		void Finish(TArray<uint8>& OutBytes, TArray<TObjectPtr<UFaerieItem>>& OutFallbackItems);
+
+	private:
+		class FImpl;
+		TUniquePtr<FImpl> Impl;
+	};
+
+	/**
+	 * Reads back a blob written by FCompactItemWriter. Construction only reads the tables and indexes the item records;
+	 * each item is created the first time it is asked for, outer'd to the transient package. The reader keeps its own copy
+	 * of the blob, so it can be held onto to load items long after the save data it came from is gone.
+	 */
+	class FAERIEITEMDATA_API FCompactItemReader : FNoncopyable
+	{
+	public:
+		FCompactItemReader(TArray<uint8> Bytes, TArray<TObjectPtr<UFaerieItem>> FallbackItems);
+		~FCompactItemReader();
+
+		// Did the blob fail to read? If so, nothing from this reader should be trusted.
+		bool HasError() const;
+
+		ECompactFormatVersion GetVersion() const;
+
+		int32 NumItems() const;
+
+		// Get an item by its index in the item table, reading it if it hasn't been yet. Items are only weakly held by the
+		// reader, so it's up to the caller to keep them alive, otherwise they will be read again next time.
+		const UFaerieItem* GetItem(uint32 Index);
+
+		// Can GetItem return this item without having to read it?
+		bool IsItemLoaded(uint32 Index) const;
+
+		// Archive positioned at the start of the owner specific data.
+		FArchive& GetBodyArchive();
+
+		// Heap memory held by the reader, including its copy of the blob. Does not include the items it has created.
+		SIZE_T GetAllocatedSize() const;
+
+	private:
+		class FImpl;
+		TUniquePtr<FImpl> Impl;
+	};
+}
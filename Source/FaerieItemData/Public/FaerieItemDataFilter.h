@@ -14,6 +14,8 @@ namespace Faerie::ItemData
 	public:
 		TArray<FText> Errors;
 	};
+
+	class FFilterCompiler;
 }
 
 /**
@@ -34,6 +36,10 @@ public:
 
 	virtual bool ExecWithLog(const FFaerieItemStackView View, Faerie::ItemData::FFilterLogger& Logger) const;
 
+	// Lower this rule into instructions for a Faerie::ItemData::FFilterProgram. Rules that don't implement this are
+	// compiled into a call to Exec.
+	virtual void Compile(Faerie::ItemData::FFilterCompiler& Compiler) const;
+
 	UFUNCTION(BlueprintCallable, Category = "Faerie|ItemDataFilter")
 	virtual bool Exec(FFaerieItemStackView View) const PURE_VIRTUAL(UFaerieItemDataFilter::Exec, return false; )
 };
\ No newline at end of file
@@ -0,0 +1,243 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "FaerieItemStackView.h"
+#include "GameplayTagContainer.h"
+#include "Templates/SubclassOf.h"
+#include "UObject/ObjectKey.h"
+
+class UFaerieItemDataFilter;
+class UFaerieItemToken;
+
+namespace Faerie::ItemData
+{
+	enum class EFilterOp : uint8
+	{
+		// Set the result to Operand.
+		Literal,
+
+		// Flip the result.
+		Not,
+
+		// Continue from the instruction at Operand, always, or only for a matching result.
+		Jump,
+		JumpIfFalse,
+		JumpIfTrue,
+
+		// Pass if the item has a token for every bit in Mask. See FFilterProgram::TokenClasses.
+		HasTokens,
+
+		// Compare the stack's copies against Operand.
+		CompareCopies,
+
+		// Pass if the item's mutability equals Operand.
+		Mutable,
+
+		// Pass if the item's tag token has any, or all, of the tags at Index.
+		TagsAny,
+		TagsAll,
+
+		// Call the native function at Index, with Compare and Operand.
+		Native,
+
+		// Call Exec on the filter at Index. Used for rules that don't know how to compile themselves.
+		Call,
+	};
+
+	enum class EFilterCompare : uint8
+	{
+		Less,
+		LessOrEqual,
+		Greater,
+		GreaterOrEqual,
+		Equal,
+		NotEqual,
+	};
+
+	template <typename T>
+	constexpr bool CompareValues(const T A, const EFilterCompare Compare, const T B)
+	{
+		switch (Compare)
+		{
+		case EFilterCompare::Less:				return A < B;
+		case EFilterCompare::LessOrEqual:		return A <= B;
+		case EFilterCompare::Greater:			return A > B;
+		case EFilterCompare::GreaterOrEqual:	return A >= B;
+		case EFilterCompare::Equal:				return A == B;
+		case EFilterCompare::NotEqual:			return A != B;
+		default: return false;
+		}
+	}
+
+	struct FFilterInstruction
+	{
+		EFilterOp Op = EFilterOp::Literal;
+		EFilterCompare Compare = EFilterCompare::Equal;
+		uint16 Index = 0;
+		int32 Operand = 0;
+		uint64 Mask = 0;
+	};
+
+	// Rules that need data from another module can compile to one of these, instead of a call through their UObject.
+	using FNativeFilterRule = bool(*)(const FFaerieItemStackView& View, EFilterCompare Compare, int32 Operand);
+
+	/**
+	 * A UFaerieItemDataFilter tree lowered into a flat array of instructions. Branches with a constant result are folded
+	 * away at compile time, and the token classes tested by the whole tree are matched against an item's tokens in a
+	 * single pass, the first time they are needed.
+	 * Programs don't keep the rules they were compiled from alive, and must be compiled again when those rules change.
+	 */
+	class FAERIEITEMDATA_API FFilterProgram
+	{
+		friend class FFilterCompiler;
+
+	public:
+		// Compile a filter tree. Null filters compile to a program that always fails.
+		static FFilterProgram Compile(const UFaerieItemDataFilter* Filter);
+
+		bool IsCompiled() const { return !Code.IsEmpty(); }
+		int32 Num() const { return Code.Num(); }
+
+		// Can the result depend on the number of copies, and not only on the item? True for programs that call rules
+		// which aren't compiled, as those could read anything from the view.
+		bool ReadsCopies() const { return DependsOnCopies; }
+
+		// Can results be cached per item? Rules that are called instead of compiled may read state outside the view, so
+		// their results can change without the item changing.
+		bool IsCacheable() const { return Calls.IsEmpty(); }
+
+		void Reset();
+
+		// Equivalent to Filter->Exec(View) for the filter this was compiled from.
+		bool Exec(const FFaerieItemStackView& View) const;
+
+		// Run the program for each view. OutResults gets a bit per view. Consecutive views of the same item share their
+		// token lookups.
+		void ExecBatch(TConstArrayView<FFaerieItemStackView> Views, TBitArray<>& OutResults) const;
+
+		// Do all views pass? Stops at the first that fails.
+		bool ExecAll(TConstArrayView<FFaerieItemStackView> Views) const;
+
+		// Gather token classes and tags that every passing item must have. These come from the tests that fail the
+		// program by themselves, e.g., the rules of an And at the root. Rules under a branch are not included, so an item
+		// that has all of these may still fail.
+		void GetRequirements(TArray<const UClass*>& OutTokenClasses, FGameplayTagContainer& OutTags) const;
+
+		SIZE_T GetAllocatedSize() const;
+
+	private:
+		struct FItemContext;
+
+		bool Run(const FFaerieItemStackView& View, FItemContext& Context) const;
+
+		TArray<FFilterInstruction> Code;
+
+		// Every token class tested by the program. Bit N of a HasTokens mask is TokenClasses[N].
+		TArray<const UClass*> TokenClasses;
+
+		TArray<FGameplayTagContainer> Tags;
+		TArray<FNativeFilterRule> Natives;
+
+		// Owned by the tree that was compiled.
+		TArray<const UFaerieItemDataFilter*> Calls;
+
+		bool DependsOnCopies = false;
+	};
+
+	/**
+	 * Remembers the results of a filter for each item it has been run on. Results for immutable items can never change,
+	 * so they are kept until the cache is reset. Results for mutable items are tied to the version of the item they were
+	 * made with, and are replaced once it has mutated.
+	 * The cache doesn't know what filter it is for. It must be reset by its owner when the filter changes.
+	 */
+	class FAERIEITEMDATA_API FFilterResultCache
+	{
+	public:
+		// Find the result of the program for this view, or run it to make one. Views of the same item share their result,
+		// unless the program reads copies. Programs that aren't cacheable are always run.
+		bool FindOrExec(const FFilterProgram& Program, const FFaerieItemStackView& View);
+
+		void Reset() { Results.Reset(); }
+		int32 Num() const { return Results.Num(); }
+		SIZE_T GetAllocatedSize() const { return Results.GetAllocatedSize(); }
+
+	private:
+		struct FKey
+		{
+			TObjectKey<UFaerieItem> Item;
+			int32 Copies = 0;
+
+			friend bool operator==(const FKey& A, const FKey& B)
+			{
+				return A.Item == B.Item && A.Copies == B.Copies;
+			}
+
+			friend uint32 GetTypeHash(const FKey& Key)
+			{
+				return HashCombineFast(GetTypeHash(Key.Item), ::GetTypeHash(Key.Copies));
+			}
+		};
+
+		struct FResult
+		{
+			// Mutation version and modification time of the item when this was made. The version catches local edits,
+			// and the modification time catches edits replicated from the server.
+			uint32 Version = 0;
+			int64 Modified = 0;
+			bool Passed = false;
+		};
+
+		TMap<FKey, FResult> Results;
+	};
+
+	/**
+	 * Used by UFaerieItemDataFilter::Compile to emit instructions for a rule.
+	 */
+	class FAERIEITEMDATA_API FFilterCompiler
+	{
+	public:
+		FFilterCompiler(FFilterProgram& Program) : Program(Program) {}
+
+		// Compile a rule in place. Null rules always fail.
+		void Compile(const UFaerieItemDataFilter* Rule);
+
+		// Compile rules that pass when all of them pass, or any of them, stopping at the first that decides the result.
+		void CompileAnd(TConstArrayView<TObjectPtr<UFaerieItemDataFilter>> Rules);
+		void CompileOr(TConstArrayView<TObjectPtr<UFaerieItemDataFilter>> Rules);
+
+		void CompileNot(const UFaerieItemDataFilter* Rule);
+
+		// Run TrueRule if Condition passes, otherwise run FalseRule, or return FalseResult.
+		void CompileSelect(const UFaerieItemDataFilter* Condition, const UFaerieItemDataFilter* TrueRule, const UFaerieItemDataFilter* FalseRule);
+		void CompileSelect(const UFaerieItemDataFilter* Condition, const UFaerieItemDataFilter* TrueRule, bool FalseResult);
+
+		void EmitLiteral(bool Value);
+		void EmitCompareCopies(EFilterCompare Compare, int32 Amount);
+		void EmitMutable(bool Mutable);
+		void EmitTags(const FGameplayTagContainer& Tags, bool All);
+		void EmitNative(FNativeFilterRule Rule, EFilterCompare Compare, int32 Operand);
+		void EmitCall(const UFaerieItemDataFilter* Rule);
+
+		// Returns false if the program can't track any more token classes, in which case nothing is emitted.
+		[[nodiscard]] bool EmitHasTokens(TConstArrayView<TSubclassOf<UFaerieItemToken>> Classes);
+
+		// Thread jumps, and finish the program. Called once the root rule has been compiled.
+		void Finish();
+
+	private:
+		int32 Emit(EFilterOp Op, int32 Operand = 0);
+		void CompileSelectImpl(const UFaerieItemDataFilter* Condition, TFunctionRef<void()> CompileTrue, TFunctionRef<void()> CompileFalse);
+		void CompileJunction(TConstArrayView<TObjectPtr<UFaerieItemDataFilter>> Rules, bool ShortCircuitValue);
+
+		// Is everything emitted since Start a single literal?
+		bool IsConstant(int32 Start, bool& OutValue) const;
+		void Truncate(int32 Start);
+		void PatchJumps(TConstArrayView<int32> Jumps);
+
+		FFilterProgram& Program;
+
+		// Guards against templates that end up including themselves.
+		int32 Depth = 0;
+	};
+}
@@ -0,0 +1,60 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "UObject/WeakObjectPtrTemplates.h"
+
+class UFaerieItem;
+class UFaerieItemToken;
+
+namespace Faerie::ItemData
+{
+	/**
+	 * Global table of immutable runtime items, keyed by a fingerprint of their token contents. Interning an item returns
+	 * a canonical instance with identical content, so that procedurally created or reloaded copies of the same item share
+	 * a single object (and set of tokens) instead of each being a separate UObject.
+	 * Only runtime items that can never be mutated are interned. Items are held weakly, so canonical instances are still
+	 * garbage collected once nothing else references them.
+	 */
+	class FAERIEITEMDATA_API FItemInternTable : FNoncopyable
+	{
+	public:
+		static FItemInternTable& Get();
+
+		// Is interning enabled? Controlled by the console variable 'faerie.InternImmutableItems'.
+		static bool IsEnabled();
+
+		// Can this item be interned at all? It must be immutable, and a transient runtime instance.
+		static bool CanIntern(const UFaerieItem* Item);
+
+		// Get the canonical instance for an item. If nothing identical has been interned yet, the item itself becomes the
+		// canonical instance. Items that cannot be interned are returned as-is.
+		UFaerieItem* Intern(UFaerieItem* Item);
+
+		// Find the canonical instance for an item without adding it.
+		UFaerieItem* Find(const UFaerieItem* Item) const;
+
+		// Number of live and stale entries in the table.
+		int32 Num() const;
+
+		// Heap memory used by the table itself. The items are owned by whoever created them, not the table.
+		SIZE_T GetAllocatedSize() const;
+
+		// Remove entries whose item has been garbage collected. Called automatically after each garbage collection.
+		void Prune();
+
+		// Fingerprint of the content of an item. Items that are identical will always have the same fingerprint.
+		static uint32 Fingerprint(const UFaerieItem* Item);
+
+		// Are two items identical in every saved token property? Shared tokens are considered identical to themselves.
+		static bool AreIdentical(const UFaerieItem* A, const UFaerieItem* B);
+
+	private:
+		FItemInternTable();
+
+		UFaerieItem* FindImpl(const UFaerieItem* Item, uint32 Hash) const;
+
+		TMultiMap<uint32, TWeakObjectPtr<UFaerieItem>> Items;
+		mutable FCriticalSection Lock;
+	};
+}
@@ -6,6 +6,11 @@
 #include "UObject/Object.h"
 #include "FaerieItemStackHashInstruction.generated.h"
 
+namespace Faerie::Hash
+{
+	class FHashCompiler;
+}
+
 /**
  * Another command class.
  * Base for hashing functions that take a FaerieItemStackView.
@@ -19,6 +24,10 @@ class FAERIEITEMDATA_API UFaerieItemStackHashInstruction : public UObject
 public:
 	virtual uint32 Hash(FFaerieItemStackView StackView) const PURE_VIRTUAL(UFaerieItemStackHashInstruction::Hash, return 0; )
 
+	// Lower this instruction into instructions for a Faerie::Hash::FHashProgram. Instructions that don't implement this
+	// are called through Hash instead.
+	virtual void Compile(Faerie::Hash::FHashCompiler& Compiler) const;
+
 protected:
 	// Utility for hashing an instruction contained in this one.
 	static uint32 ChildHash(const UFaerieItemStackHashInstruction* Child, FFaerieItemStackView StackView);
@@ -0,0 +1,136 @@
+﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
+
+#pragma once
+
+#include "FaerieItemDataFilterProgram.h"
+#include "FaerieItemStackView.h"
+#include "Templates/SubclassOf.h"
+
+class UFaerieItemDataFilter;
+class UFaerieItemStackHashInstruction;
+class UFaerieItemToken;
+
+namespace Faerie::Hash
+{
+	enum class EHashOp : uint8
+	{
+		// Push A.
+		Literal,
+
+		// Push A if the view is valid, otherwise B.
+		Valid,
+
+		// Push A if the filter at Index passes, otherwise B.
+		Filter,
+
+		// Push the combined hashes of the item's tokens of each class in the set at Index. Classes the item has no tokens
+		// of combine A instead.
+		Tokens,
+
+		// Push the result of Hash on the instruction at Index. Used for instructions that don't know how to compile
+		// themselves.
+		Call,
+
+		// Pop two hashes, and push them combined.
+		Combine,
+
+		// Discard the top hash.
+		Pop,
+
+		// Continue from the instruction at A, always, if the top hash isn't a failure (zero), or if the filter at Index fails.
+		Jump,
+		JumpIfNotFailed,
+		JumpIfFilterFails,
+	};
+
+	struct FHashInstruction
+	{
+		EHashOp Op = EHashOp::Literal;
+		uint16 Index = 0;
+		uint32 A = 0;
+		uint32 B = 0;
+	};
+
+	/**
+	 * A UFaerieItemStackHashInstruction tree lowered into a flat array of instructions, run on a small stack of hashes.
+	 * Subtrees that don't read the view are hashed at compile time, and each token's hash is only computed once per run,
+	 * however many instructions read it.
+	 * Programs don't keep the instructions they were compiled from alive, and must be compiled again when those change.
+	 */
+	class FAERIEITEMDATA_API FHashProgram
+	{
+		friend class FHashCompiler;
+
+	public:
+		// Compile an instruction tree. Null instructions compile to a program that always returns 0.
+		static FHashProgram Compile(const UFaerieItemStackHashInstruction* Instruction);
+
+		bool IsCompiled() const { return !Code.IsEmpty(); }
+		int32 Num() const { return Code.Num(); }
+
+		void Reset();
+
+		// Equivalent to Instruction->Hash(View) for the instruction this was compiled from.
+		uint32 Exec(const FFaerieItemStackView& View) const;
+
+		SIZE_T GetAllocatedSize() const;
+
+	private:
+		struct FItemContext;
+
+		uint32 HashTokens(const FHashInstruction& Instruction, FItemContext& Context) const;
+
+		TArray<FHashInstruction> Code;
+		TArray<ItemData::FFilterProgram> Filters;
+		TArray<TArray<const UClass*>> TokenSets;
+
+		// Owned by the tree that was compiled.
+		TArray<const UFaerieItemStackHashInstruction*> Calls;
+	};
+
+	/**
+	 * Used by UFaerieItemStackHashInstruction::Compile to emit instructions. Each compiled instruction must leave exactly
+	 * one hash on the stack.
+	 */
+	class FAERIEITEMDATA_API FHashCompiler
+	{
+	public:
+		FHashCompiler(FHashProgram& Program) : Program(Program) {}
+
+		// Compile an instruction in place. Null instructions hash to 0.
+		void Compile(const UFaerieItemStackHashInstruction* Instruction);
+
+		// Combine the hashes of each instruction in order, starting from 0.
+		void CompileCombine(TConstArrayView<TObjectPtr<UFaerieItemStackHashInstruction>> Instructions);
+
+		// Use the hash of the first instruction that doesn't fail (return zero).
+		void CompileFirstNotFailed(TConstArrayView<TObjectPtr<UFaerieItemStackHashInstruction>> Instructions);
+
+		// Use the hash of TrueInstruction if Filter passes, otherwise FalseInstruction.
+		void CompileSelect(const UFaerieItemDataFilter* Filter, const UFaerieItemStackHashInstruction* TrueInstruction,
+						   const UFaerieItemStackHashInstruction* FalseInstruction);
+
+		void EmitLiteral(uint32 Hash);
+		void EmitValid(uint32 ValidHash, uint32 InvalidHash);
+		void EmitFilter(const UFaerieItemDataFilter* Filter, uint32 PassHash, uint32 FailHash);
+		void EmitTokens(TConstArrayView<TSubclassOf<UFaerieItemToken>> Classes, uint32 NoTokensHash);
+		void EmitCall(const UFaerieItemStackHashInstruction* Instruction);
+
+		// Finish the program. Called once the root instruction has been compiled.
+		void Finish();
+
+	private:
+		int32 Emit(EHashOp Op, uint32 A = 0, uint32 B = 0);
+		int32 AddFilter(const UFaerieItemDataFilter* Filter);
+
+		// Is everything emitted since Start a single literal?
+		bool IsConstant(int32 Start, uint32& OutHash) const;
+		void Truncate(int32 Start);
+		void PatchJumps(TConstArrayView<int32> Jumps);
+
+		FHashProgram& Program;
+
+		// The filter each of the program's filters was compiled from, so that filters used more than once share one.
+		TArray<const UFaerieItemDataFilter*> FilterSources;
+	};
+}
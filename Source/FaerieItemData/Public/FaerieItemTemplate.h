@@ -4,6 +4,7 @@
 
 #include "UObject/Object.h"
 #include "FaerieAssetInfo.h"
+#include "FaerieItemDataFilterProgram.h"
 #include "FaerieItemTemplate.generated.h"
 
 struct FFaerieItemStackView;
@@ -21,6 +22,7 @@ class FAERIEITEMDATA_API UFaerieItemTemplate : public UObject
 public:
 #if WITH_EDITOR
 	virtual EDataValidationResult IsDataValid(FDataValidationContext& Context) const override;
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
 #endif
 
 	bool TryMatchWithDescriptions(FFaerieItemStackView View, TArray<FText>& Errors) const;
@@ -41,4 +43,11 @@ protected:
 	// Pattern used to determine if an item qualifies as fitting this template.
 	UPROPERTY(EditInstanceOnly, Category = "Template", meta = (DisplayThumbnail = false))
 	TObjectPtr<UFaerieItemDataFilter> Pattern;
+
+private:
+	// Pattern, compiled the first time it's matched.
+	mutable Faerie::ItemData::FFilterProgram CompiledPattern;
+
+	// Results of matching items against the pattern.
+	mutable Faerie::ItemData::FFilterResultCache MatchResults;
 };
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "Generation/FaerieItemGenerationRequest.h"
 #include "Generation/FaerieItemGenerationConfig.h"
 
+#include "FaerieDataSystemTrace.h"
 #include "FaerieItem.h"
 #include "FaerieItemGenerationLog.h"
 #include "FaerieItemPool.h"
@@ -16,6 +17,12 @@
 
 #define LOCTEXT_NAMESPACE "FaerieItemGenerationRequest"
 
+DECLARE_STATS_GROUP(TEXT("FaerieItemGenerator"), STATGROUP_FaerieItemGenerator, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Generate"), STAT_Generation_Generate, STATGROUP_FaerieItemGenerator);
+DECLARE_CYCLE_STAT(TEXT("Resolve Generation"), STAT_Generation_Resolve, STATGROUP_FaerieItemGenerator);
+
+TRACE_DECLARE_INT_COUNTER(FaerieGeneration_StacksGenerated, TEXT("FaerieDataSystem/Generation/Stacks Generated"));
+
 void FFaerieItemGenerationRequest::Run(UFaerieCraftingRunner* Runner) const
 {
 	// Step 0: Validate parameters
@@ -133,6 +140,8 @@ void FFaerieItemGenerationRequest::LoadCheck(TSharedPtr<FStreamableHandle> Handl
 
 void FFaerieItemGenerationRequest::Generate(UFaerieCraftingRunner* Runner) const
 {
+	FAERIE_SCOPE_CYCLE_COUNTER(STAT_Generation_Generate);
+
 	FFaerieItemGenerationRequestStorage& Storage = Runner->RequestStorage.GetMutable<FFaerieItemGenerationRequestStorage>();
 
 	// Step 3: Build a context, to use for each pending generation, and resolve them.
@@ -153,6 +162,8 @@ void FFaerieItemGenerationRequest::Generate(UFaerieCraftingRunner* Runner) const
 		ResolveGeneration(Storage, Generation, Context);
 	}
 
+	TRACE_COUNTER_ADD(FaerieGeneration_StacksGenerated, Storage.ProcessStacks.Num());
+
 	// Step 4: Report result.
 
 	if (!Storage.ProcessStacks.IsEmpty())
@@ -169,6 +180,8 @@ void FFaerieItemGenerationRequest::Generate(UFaerieCraftingRunner* Runner) const
 
 void FFaerieItemGenerationRequest::ResolveGeneration(FFaerieItemGenerationRequestStorage& Storage, const Faerie::FPendingItemGeneration& Generation, const FFaerieItemInstancingContext_Crafting& Context) const
 {
+	FAERIE_SCOPE_CYCLE_COUNTER(STAT_Generation_Resolve);
+
 	// If the source object is a Pool, and we are configured to recurse tables,
 	const UObject* SourceObject = Generation.Drop->Asset.Object.Get();
 	if (const UFaerieItemPool* Pool = Cast<UFaerieItemPool>(SourceObject);
@@ -25,14 +25,20 @@ void FFaerieRecipeCraftRequest::Run(UFaerieCraftingRunner* Runner) const
 	if (const FFaerieCraftingSlotsView SlotsView = Faerie::Crafting::GetCraftingSlots(Config);
 		SlotsView.IsValid())
 	{
+		// Look up each request slot by ID once, instead of searching Slots for every recipe slot.
+		TMap<FFaerieItemSlotHandle, int32> SlotLookup;
+		SlotLookup.Reserve(Slots.Num());
+		for (int32 i = 0; i < Slots.Num(); ++i)
+		{
+			SlotLookup.FindOrAdd(Slots[i].SlotID, i);
+		}
+
 		for (auto&& RequiredSlot : SlotsView.Get().RequiredSlots)
 		{
-			if (auto&& SlotPtr = Slots.FindByPredicate(
-				[RequiredSlot](const FFaerieCraftingRequestSlot& Slot)
-				{
-					return Slot.SlotID == RequiredSlot.Key;
-				}))
+			if (const int32* SlotIndex = SlotLookup.Find(RequiredSlot.Key))
 			{
+				const FFaerieCraftingRequestSlot* SlotPtr = &Slots[*SlotIndex];
+
 				if (!IsValid(SlotPtr->ItemProxy.GetObject()))
 				{
 					UE_LOG(LogItemGeneration, Warning, TEXT("%hs: Entry is invalid for slot: %s!"),
@@ -61,12 +67,10 @@ void FFaerieRecipeCraftRequest::Run(UFaerieCraftingRunner* Runner) const
 
 		for (auto&& OptionalSlot : SlotsView.Get().OptionalSlots)
 		{
-			if (auto&& SlotPtr = Slots.FindByPredicate(
-				[OptionalSlot](const FFaerieCraftingRequestSlot& Slot)
-				{
-					return Slot.SlotID == OptionalSlot.Key;
-				}))
+			if (const int32* SlotIndex = SlotLookup.Find(OptionalSlot.Key))
 			{
+				const FFaerieCraftingRequestSlot* SlotPtr = &Slots[*SlotIndex];
+
 				if (!IsValid(SlotPtr->ItemProxy.GetObject()))
 				{
 					UE_LOG(LogItemGeneration, Warning, TEXT("%hs: Entry is invalid for slot: %s!"),
@@ -7,16 +7,38 @@
 #include "Engine/StaticMeshSocket.h"
 #//include "Engine/SkeletalMeshSocket.h"
 
+#include "FaerieDataSystemMemory.h"
+#include "FaerieDataSystemTrace.h"
 #include "FaerieItemMeshLog.h"
 #include "UDynamicMesh.h" // For creating static meshes at runtime
 #include "Engine/AssetManager.h"
 #include "Engine/StaticMesh.h"
 #include "Materials/MaterialInterface.h"
+#include "UObject/UObjectIterator.h"
 
 #include "GeometryScript/MeshAssetFunctions.h"
 #include "GeometryScript/MeshBasicEditFunctions.h"
 #include "GeometryScript/MeshMaterialFunctions.h"
 
+DECLARE_STATS_GROUP(TEXT("FaerieItemMesh"), STATGROUP_FaerieItemMesh, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Load Mesh (Sync)"), STAT_MeshLoader_LoadSync, STATGROUP_FaerieItemMesh);
+DECLARE_CYCLE_STAT(TEXT("Load Mesh (Async Request)"), STAT_MeshLoader_LoadAsync, STATGROUP_FaerieItemMesh);
+
+TRACE_DECLARE_INT_COUNTER(FaerieMeshLoader_CacheHits, TEXT("FaerieDataSystem/Mesh/Cache Hits"));
+TRACE_DECLARE_INT_COUNTER(FaerieMeshLoader_CacheMisses, TEXT("FaerieDataSystem/Mesh/Cache Misses"));
+
+// Mesh caches belong to whoever owns the loader, rather than to a container, so they are reported per loader.
+static Faerie::Memory::FReportSectionRegistration MeshCacheMemReport(TEXT("Cached Item Meshes"),
+	[](const TArray<FString>& Args, FOutputDevice& Ar)
+	{
+		for (TObjectIterator<UFaerieItemMeshLoader_Cached> It; It; ++It)
+		{
+			if (It->GetNumCachedMeshes() == 0) continue;
+			Ar.Logf(TEXT("  %s: %i meshes, %s"), *It->GetPathName(), It->GetNumCachedMeshes(),
+				*Faerie::Memory::FormatBytes(It->GetCacheAllocatedSize()));
+		}
+	});
+
 namespace Faerie
 {
 	FFaerieItemMesh GetDynamicStaticMeshForData(const FFaerieDynamicStaticMesh& MeshData)
@@ -210,6 +232,8 @@ FFaerieItemMesh UFaerieItemMeshLoader::GetDynamicSkeletalMeshForData(const FFaer
 bool UFaerieItemMeshLoader::LoadMeshFromTokenSynchronous(const UFaerieMeshTokenBase* Token, const FGameplayTag Purpose,
 														 FFaerieItemMesh& Mesh)
 {
+	FAERIE_SCOPE_CYCLE_COUNTER(STAT_MeshLoader_LoadSync);
+	LLM_SCOPE_BYTAG(FaerieItemMesh);
 	return Faerie::LoadMeshFromTokenSynchronous(Token, Purpose, Mesh);
 }
 
@@ -222,6 +246,9 @@ bool UFaerieItemMeshLoader::LoadMeshFromProxySynchronous(const FFaerieItemProxy
 void UFaerieItemMeshLoader::LoadMeshFromTokenAsynchronous(const UFaerieMeshTokenBase* Token, const FGameplayTag Purpose,
 	Faerie::FItemMeshAsyncLoadResult Callback)
 {
+	FAERIE_SCOPE_CYCLE_COUNTER(STAT_MeshLoader_LoadAsync);
+	LLM_SCOPE_BYTAG(FaerieItemMesh);
+
 	if (!IsValid(Token))
 	{
 		UE_LOG(LogFaerieItemMesh, Warning, TEXT("%hs: No MeshToken on entry"), __FUNCTION__)
@@ -449,15 +476,19 @@ bool UFaerieItemMeshLoader_Cached::LoadMeshFromTokenSynchronous(const UFaerieMes
 	// If we have already generated this mesh, return that one.
 	if (auto&& CachedMesh = GeneratedMeshes.Find(Key))
 	{
+		TRACE_COUNTER_INCREMENT(FaerieMeshLoader_CacheHits);
 		Mesh = *CachedMesh;
 		return true;
 	}
 
+	TRACE_COUNTER_INCREMENT(FaerieMeshLoader_CacheMisses);
+
 	const bool SuperResult = Super::LoadMeshFromTokenSynchronous(Token, Purpose, Mesh);
 
 	// If the mesh load succeeded, cache the result.
 	if (SuperResult)
 	{
+		LLM_SCOPE_BYTAG(FaerieItemMesh);
 		GeneratedMeshes.Add(Key, Mesh);
 	}
 
@@ -467,6 +498,7 @@ bool UFaerieItemMeshLoader_Cached::LoadMeshFromTokenSynchronous(const UFaerieMes
 void UFaerieItemMeshLoader_Cached::HandleAsyncLoadResult(FFaerieItemMesh&& Mesh,
 	Faerie::FAsyncLoadRequest&& Request)
 {
+	LLM_SCOPE_BYTAG(FaerieItemMesh);
 	const FFaerieCachedMeshKey Key = {Request.Token, Request.Purpose};
 	GeneratedMeshes.Add(Key, Mesh);
 	Super::HandleAsyncLoadResult(MoveTemp(Mesh), MoveTemp(Request));
@@ -2,6 +2,10 @@
 
 #pragma once
 
+#include "HAL/LowLevelMemTracker.h"
 #include "Logging/LogMacros.h"
 
 DEFINE_LOG_CATEGORY_STATIC(LogFaerieItemMesh, Log, All);
+
+// Loaded and generated item meshes.
+LLM_DECLARE_TAG(FaerieItemMesh);
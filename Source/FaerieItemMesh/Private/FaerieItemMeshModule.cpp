@@ -1,8 +1,12 @@
 ﻿// Copyright Guy (Drakynfly) Lundvall. All Rights Reserved.
 
 #include "FaerieItemMeshModule.h"
+#include "FaerieDataSystemMemory.h"
+#include "FaerieItemMeshLog.h"
 #include "Modules/ModuleManager.h"
 
+FAERIE_LLM_DEFINE_TAG(FaerieItemMesh);
+
 #define LOCTEXT_NAMESPACE "FaerieItemMeshModule"
 
 void FFaerieItemMeshModule::StartupModule()
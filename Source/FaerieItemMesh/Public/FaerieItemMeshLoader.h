@@ -133,6 +133,9 @@ public:
 	// Clears the generated cache for a single token.
 	void ResetCacheByKey(const UFaerieMeshTokenBase* Token, const FGameplayTag Purpose);
 
+	int32 GetNumCachedMeshes() const { return GeneratedMeshes.Num(); }
+	SIZE_T GetCacheAllocatedSize() const { return GeneratedMeshes.GetAllocatedSize(); }
+
 private:
 	/**
 	 * Stored meshes for quick lookup